@@ -20,8 +20,14 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <limits>
 #include <string>
 #include "simNotify/Notify.h"
 #include "simCore/Calc/Angle.h"
@@ -34,6 +40,8 @@
 #include "simCore/String/UtfUtils.h"
 #include "simCore/String/ValidNumber.h"
 #include "simCore/EM/AntennaPattern.h"
+#include "simCore/EM/AntennaPatternCompiled.h"
+#include "simCore/EM/AntennaPatternKernels.h"
 
 namespace simCore {
 
@@ -130,398 +138,1048 @@ AntennaPatternType antennaPatternType(const std::string& antPatStr)
   return simCore::NO_ANTENNA_PATTERN;
 }
 
-AntennaPattern* loadPatternFile(const std::string& filename, float freqMHz)
+namespace
 {
-  if (filename.empty())
-    return nullptr;
-
-  // algorithm keywords are all uppercase
-  const std::string& algorithm = upperCase(filename);
-  if (algorithm == ANTENNA_STRING_ALGORITHM_SINXX)
-    return new AntennaPatternSinXX;
-  if (algorithm == ANTENNA_STRING_ALGORITHM_PEDESTAL)
-    return new AntennaPatternPedestal;
-  if (algorithm == ANTENNA_STRING_ALGORITHM_GAUSS)
-    return new AntennaPatternGauss;
-  if (algorithm == ANTENNA_STRING_ALGORITHM_OMNI)
-    return new AntennaPatternOmni;
-  if (algorithm == ANTENNA_STRING_ALGORITHM_CSCSQ)
-    return new AntennaPatternCscSq;
-
-  // pattern table extensions are all lowercase
-  const std::string& extension = simCore::getExtension(filename);
-  if (extension == ANTENNA_STRING_EXTENSION_TABLE)
-  {
-    AntennaPatternTable *antTable = new AntennaPatternTable;
-    if (antTable->readPat(filename) == 0)
-      return antTable;
-    delete antTable;
-    return nullptr;
-  }
-  if (extension == ANTENNA_STRING_EXTENSION_RELATIVE)
-  {
-    AntennaPatternRelativeTable *antTable = new AntennaPatternRelativeTable;
-    if (antTable->readPat(filename) == 0)
-      return antTable;
-    delete antTable;
-    return nullptr;
-  }
-  if (extension == ANTENNA_STRING_EXTENSION_BILINEAR)
-  {
-    AntennaPatternBiLinear *bilinear = new AntennaPatternBiLinear;
-    if (bilinear->readPat(filename, (freqMHz*1e6)) == 0)
-      return bilinear;
-    delete bilinear;
-    return nullptr;
-  }
-  if (extension == ANTENNA_STRING_EXTENSION_CRUISE)
-  {
-    AntennaPatternCRUISE *antTable = new AntennaPatternCRUISE;
-    if (antTable->readPat(filename) == 0)
-      return antTable;
-    delete antTable;
-    return nullptr;
-  }
-  if (extension == ANTENNA_STRING_EXTENSION_MONOPULSE)
-  {
-    AntennaPatternMonopulse *monopulse = new AntennaPatternMonopulse;
-    if (monopulse->readPat(filename, (freqMHz*1e6)) == 0)
-      return monopulse;
-    delete monopulse;
-    return nullptr;
-  }
-  if (extension == ANTENNA_STRING_EXTENSION_NSMA)
+  /**
+  * Returns true for types whose files are parsed as text, which AntennaPatternLazy can defer
+  * @param[in ] type Pattern type
+  * @return true if loads of the type can be deferred
+  */
+  bool lazyPatternType(AntennaPatternType type)
   {
-    AntennaPatternNSMA *antTable = new AntennaPatternNSMA;
-    if (antTable->readPat(filename) == 0)
-      return antTable;
-    delete antTable;
-    return nullptr;
+    switch (type)
+    {
+    case ANTENNA_PATTERN_TABLE:
+    case ANTENNA_PATTERN_RELATIVE:
+    case ANTENNA_PATTERN_BILINEAR:
+    case ANTENNA_PATTERN_CRUISE:
+    case ANTENNA_PATTERN_MONOPULSE:
+    case ANTENNA_PATTERN_NSMA:
+    case ANTENNA_PATTERN_EZNEC:
+    case ANTENNA_PATTERN_XFDTD:
+      return true;
+    default:
+      return false;
+    }
   }
-  if (extension == ANTENNA_STRING_EXTENSION_EZNEC)
-  {
-    AntennaPatternEZNEC *antTable = new AntennaPatternEZNEC;
-    if (antTable->readPat(filename) == 0)
-      return antTable;
-    delete antTable;
+
+  /**
+  * Creates the pattern for an algorithm keyword, or loads a pattern file, see loadPatternFile()
+  * @param[in ] filename Name of the file to load (extension matters)
+  * @param[in ] freqMHz Frequency value to pass to loader, in MHz
+  * @param[in ] options Options of the EZNEC and XFDTD loaders
+  * @return Pointer to antenna pattern instance
+  */
+  AntennaPattern* createPattern(const std::string& filename, float freqMHz, const AntennaPatternLoadOptions& options)
+  {
+    if (filename.empty())
+      return nullptr;
+
+    // algorithm keywords are all uppercase
+    const std::string& algorithm = upperCase(filename);
+    if (algorithm == ANTENNA_STRING_ALGORITHM_SINXX)
+      return new AntennaPatternSinXX;
+    if (algorithm == ANTENNA_STRING_ALGORITHM_PEDESTAL)
+      return new AntennaPatternPedestal;
+    if (algorithm == ANTENNA_STRING_ALGORITHM_GAUSS)
+      return new AntennaPatternGauss;
+    if (algorithm == ANTENNA_STRING_ALGORITHM_OMNI)
+      return new AntennaPatternOmni;
+    if (algorithm == ANTENNA_STRING_ALGORITHM_CSCSQ)
+      return new AntennaPatternCscSq;
+
+    // pattern table extensions are all lowercase
+    const std::string& extension = simCore::getExtension(filename);
+    if (extension == ANTENNA_STRING_EXTENSION_TABLE)
+    {
+      AntennaPatternTable *antTable = new AntennaPatternTable;
+      if (antTable->readPat(filename) == 0)
+        return antTable;
+      delete antTable;
+      return nullptr;
+    }
+    if (extension == ANTENNA_STRING_EXTENSION_RELATIVE)
+    {
+      AntennaPatternRelativeTable *antTable = new AntennaPatternRelativeTable;
+      if (antTable->readPat(filename) == 0)
+        return antTable;
+      delete antTable;
+      return nullptr;
+    }
+    if (extension == ANTENNA_STRING_EXTENSION_BILINEAR)
+    {
+      AntennaPatternBiLinear *bilinear = new AntennaPatternBiLinear;
+      if (bilinear->readPat(filename, (freqMHz*1e6)) == 0)
+        return bilinear;
+      delete bilinear;
+      return nullptr;
+    }
+    if (extension == ANTENNA_STRING_EXTENSION_CRUISE)
+    {
+      AntennaPatternCRUISE *antTable = new AntennaPatternCRUISE;
+      if (antTable->readPat(filename) == 0)
+        return antTable;
+      delete antTable;
+      return nullptr;
+    }
+    if (extension == ANTENNA_STRING_EXTENSION_MONOPULSE)
+    {
+      AntennaPatternMonopulse *monopulse = new AntennaPatternMonopulse;
+      if (monopulse->readPat(filename, (freqMHz*1e6)) == 0)
+        return monopulse;
+      delete monopulse;
+      return nullptr;
+    }
+    if (extension == ANTENNA_STRING_EXTENSION_NSMA)
+    {
+      AntennaPatternNSMA *antTable = new AntennaPatternNSMA;
+      if (antTable->readPat(filename) == 0)
+        return antTable;
+      delete antTable;
+      return nullptr;
+    }
+    if (extension == ANTENNA_STRING_EXTENSION_EZNEC)
+    {
+      AntennaPatternEZNEC *antTable = new AntennaPatternEZNEC;
+      antTable->setLoadOptions(options);
+      if (antTable->readPat(filename) == 0)
+        return antTable;
+      delete antTable;
+      return nullptr;
+    }
+    if (extension == ANTENNA_STRING_EXTENSION_XFDTD)
+    {
+      AntennaPatternXFDTD *antTable = new AntennaPatternXFDTD;
+      antTable->setLoadOptions(options);
+      if (antTable->readPat(filename) == 0)
+        return antTable;
+      delete antTable;
+      return nullptr;
+    }
+    // compiled patterns record their type, and the frequency they were loaded at
+    if (extension == ANTENNA_STRING_EXTENSION_COMPILED)
+      return loadCompiledPattern(filename);
     return nullptr;
   }
-  if (extension == ANTENNA_STRING_EXTENSION_XFDTD)
+}
+
+AntennaPattern* loadPatternFile(const std::string& filename, float freqMHz, bool lazy)
+{
+  if (lazy && lazyPatternType(antennaPatternType(filename)))
   {
-    AntennaPatternXFDTD *antTable = new AntennaPatternXFDTD;
-    if (antTable->readPat(filename) == 0)
-      return antTable;
-    delete antTable;
+    AntennaPatternLazy *pattern = new AntennaPatternLazy(filename, freqMHz);
+    if (pattern->valid())
+      return pattern;
+    delete pattern;
     return nullptr;
   }
-  return nullptr;
-  }
+
+  return loadPatternFile(filename, freqMHz, AntennaPatternLoadOptions());
+}
+
+AntennaPattern* loadPatternFile(const std::string& filename, float freqMHz, const AntennaPatternLoadOptions& options)
+{
+#ifdef SIMCORE_ANTENNA_STATISTICS
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  AntennaPattern* pattern = createPattern(filename, freqMHz, options);
+  if (pattern)
+    pattern->counters().setLoadSeconds(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  return pattern;
+#else
+  return createPattern(filename, freqMHz, options);
+#endif
+}
 
 // ----------------------------------------------------------------------------
+/// AntennaPatternCounters methods
+
+AntennaPatternStatistics::AntennaPatternStatistics()
+  : gains_(0),
+    missedGains_(0),
+    minMaxCalls_(0),
+    minMaxMisses_(0),
+    loadSeconds_(0.0)
+{
+}
 
-AntennaPatternGauss::AntennaPatternGauss()
-  : AntennaPattern(),
-  lastVbw_(-FLT_MAX)
+AntennaPatternCounters::AntennaPatternCounters()
+  : gains_(0),
+    missedGains_(0),
+    minMaxCalls_(0),
+    minMaxMisses_(0),
+    loadSeconds_(0.0)
 {
-  valid_ = true;
-  filename_ = ANTENNA_STRING_ALGORITHM_GAUSS;
 }
 
-float AntennaPatternGauss::gain(const AntennaGainParameters &params)
+// usage belongs to the instance that was used, so a copied pattern starts counting from zero
+AntennaPatternCounters::AntennaPatternCounters(const AntennaPatternCounters& /*other*/)
+  : gains_(0),
+    missedGains_(0),
+    minMaxCalls_(0),
+    minMaxMisses_(0),
+    loadSeconds_(0.0)
 {
-  const double var = sin(0.5*params.vbw_); // Avoid divide by zero below
-  const double antfac = -0.5 * (M_LN2 / square(var == 0.0 ? 1.0 : var));
-  const double patfac = exp(antfac * square(sin(angFixPI(params.elev_))));
-  // Ereps clips below 0.03
-  return static_cast<float>(params.refGain_ + 20. * log10((patfac < 0.03) ? 0.03 : patfac));
 }
 
-void AntennaPatternGauss::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
+AntennaPatternCounters& AntennaPatternCounters::operator=(const AntennaPatternCounters& /*other*/)
 {
-  assert(min && max);
-  if (!min || !max)
-    return;
+  // keeps the counts of this instance, see the copy constructor
+  return *this;
+}
 
-  if (params.vbw_ == lastVbw_)
+void AntennaPatternCounters::countGains(const float *gains, size_t count)
+{
+  uint64_t missed = 0;
+  for (size_t i = 0; i < count; ++i)
   {
-    *min = minGain_ + params.refGain_;
-    *max = maxGain_ + params.refGain_;
-    return;
+    if (gains[i] <= SMALL_DB_COMPARE)
+      ++missed;
   }
+  // counts are independent; other threads need no ordering with them
+  gains_.fetch_add(count, std::memory_order_relaxed);
+  if (missed != 0)
+    missedGains_.fetch_add(missed, std::memory_order_relaxed);
+}
 
-  lastVbw_ = params.vbw_;
-  // determine min & max values
-  AntennaGainParameters agp(params);
-  agp.refGain_ = 0.;
-  for (int jj = -90; jj <= 90; ++jj)
-  {
-    agp.elev_ = static_cast<float>(DEG2RAD*(jj));
-    float radius = gain(agp);
-    if (radius > SMALL_DB_COMPARE)
-    {
-      minGain_ = sdkMin(minGain_, radius);
-    }
-    maxGain_ = sdkMax(maxGain_, radius);
-  } // end for jj
+void AntennaPatternCounters::countMinMax(bool computed)
+{
+  minMaxCalls_.fetch_add(1, std::memory_order_relaxed);
+  if (computed)
+    minMaxMisses_.fetch_add(1, std::memory_order_relaxed);
+}
 
-  *min = minGain_ + params.refGain_;
-  *max = maxGain_ + params.refGain_;
+void AntennaPatternCounters::setLoadSeconds(double seconds)
+{
+  loadSeconds_.store(seconds, std::memory_order_relaxed);
 }
 
-// ----------------------------------------------------------------------------
+AntennaPatternStatistics AntennaPatternCounters::statistics() const
+{
+  AntennaPatternStatistics stats;
+  stats.gains_ = gains_.load(std::memory_order_relaxed);
+  stats.missedGains_ = missedGains_.load(std::memory_order_relaxed);
+  stats.minMaxCalls_ = minMaxCalls_.load(std::memory_order_relaxed);
+  stats.minMaxMisses_ = minMaxMisses_.load(std::memory_order_relaxed);
+  stats.loadSeconds_ = loadSeconds_.load(std::memory_order_relaxed);
+  return stats;
+}
 
-AntennaPatternCscSq::AntennaPatternCscSq()
-  : AntennaPattern(),
-  lastVbw_(-FLT_MAX)
+void AntennaPatternCounters::reset()
 {
-  valid_ = true;
-  filename_ = ANTENNA_STRING_ALGORITHM_CSCSQ;
+  gains_.store(0, std::memory_order_relaxed);
+  missedGains_.store(0, std::memory_order_relaxed);
+  minMaxCalls_.store(0, std::memory_order_relaxed);
+  minMaxMisses_.store(0, std::memory_order_relaxed);
+}
+
+bool AntennaPatternCounters::enabled()
+{
+#ifdef SIMCORE_ANTENNA_STATISTICS
+  return true;
+#else
+  return false;
+#endif
 }
 
-float AntennaPatternCscSq::gain(const AntennaGainParameters &params)
+namespace
 {
-  double delev = angFixPI(params.elev_);
-  double elevFactor;
-  if (delev <= params.vbw_)
+#ifdef SIMCORE_ANTENNA_STATISTICS
+  /**
+  * Counts a gain computed by a file based pattern
+  * @param[in ] counters Counters of the pattern
+  * @param[in ] gain Computed gain (dB)
+  * @return gain
+  */
+  inline float countedGain(AntennaPatternCounters& counters, float gain)
   {
-    double onePlus = 1.0 + delev;
-    if (params.vbw_ != 0.f)
-      onePlus = 1.0 + delev/params.vbw_; // protect against divide by zero with params.vbw_
-    else
-      assert(0); //params.vbw_ should not be zero, would result in a divide by zero
-    elevFactor = sdkMin(1.0, sdkMax(0.03, onePlus));
+    counters.countGains(&gain, 1);
+    return gain;
   }
-  else
+
+  /** Counts the gains of a batch when leaving the scope that computes them */
+  class CountedGains
   {
-    double denom = sin(fabs(delev));
-    if (denom == 0.0)
-      denom = 1.0; // protect against divide by zero below
-    elevFactor = sin(params.vbw_ / denom);
-  }
+  public:
+    /**
+    * Starts counting a batch
+    * @param[in ] counters Counters of the pattern
+    * @param[in ] gains Array of count gains, filled before the end of the scope
+    * @param[in ] count Number of gains
+    */
+    CountedGains(AntennaPatternCounters& counters, const float *gains, size_t count)
+      : counters_(counters), gains_(gains), count_(count) {}
+    ~CountedGains() { counters_.countGains(gains_, count_); }
 
-  if (elevFactor == 0.0)
-    elevFactor = 0.03; // Set to minimum possible result from if block above to avoid log10(0) below
-  return static_cast<float>(params.refGain_ + 20. * log10(elevFactor));
+  private:
+    AntennaPatternCounters& counters_;  ///< Counters of the pattern
+    const float *gains_;                ///< Gains of the batch
+    size_t count_;                      ///< Number of gains
+  };
+
+  /**
+  * Counts a minMaxGain() call of a file based pattern
+  * @param[in ] counters Counters of the pattern
+  * @param[in ] computed True if the bounds were computed rather than found in a cache
+  */
+  inline void countMinMax(AntennaPatternCounters& counters, bool computed)
+  {
+    counters.countMinMax(computed);
+  }
+#else
+  // counting compiled out; these reduce to nothing
+  inline float countedGain(AntennaPatternCounters&, float gain) { return gain; }
+  class CountedGains
+  {
+  public:
+    CountedGains(AntennaPatternCounters&, const float *, size_t) {}
+  };
+  inline void countMinMax(AntennaPatternCounters&, bool) {}
+#endif
 }
 
-void AntennaPatternCscSq::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
+// ----------------------------------------------------------------------------
+
+void AntennaPattern::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
 {
-  assert(min && max);
-  if (!min || !max)
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
     return;
 
-  if (params.vbw_ == lastVbw_)
+  AntennaGainParameters agp(params);
+  for (size_t i = 0; i < count; ++i)
   {
-    *min = minGain_ + params.refGain_;
-    *max = maxGain_ + params.refGain_;
-    return;
+    agp.azim_ = azim[i];
+    agp.elev_ = elev[i];
+    gains[i] = gain(agp);
   }
+}
+
+void AntennaPattern::gainBatchApprox(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  gainBatch(params, azim, elev, count, gains);
+}
+
+void AntennaPattern::polarityGains(const AntennaGainParameters &params, const PolarityType *polarities, size_t count, float *gains) const
+{
+  assert(count == 0 || (polarities && gains));
+  if (count == 0 || !polarities || !gains)
+    return;
 
-  lastVbw_ = params.vbw_;
-  // determine min & max values
   AntennaGainParameters agp(params);
-  agp.refGain_ = 0.;
-  for (int jj = -90; jj <= 90; ++jj)
+  for (size_t i = 0; i < count; ++i)
   {
-    agp.elev_ = static_cast<float>(DEG2RAD*(jj));
-    float radius = gain(agp);
-    if (radius > SMALL_DB_COMPARE)
-    {
-      minGain_ = sdkMin(minGain_, radius);
-    }
-    maxGain_ = sdkMax(maxGain_, radius);
-  } // end for jj
-
-  *min = minGain_ + params.refGain_;
-  *max = maxGain_ + params.refGain_;
+    agp.polarity_ = polarities[i];
+    gains[i] = gain(agp);
+  }
 }
 
-// ----------------------------------------------------------------------------
-
-AntennaPatternSinXX::AntennaPatternSinXX()
-  : AntennaPattern(),
-  lastVbw_(-FLT_MAX),
-  lastHbw_(-FLT_MAX)
+float AntennaPattern::cursorGain(const AntennaGainParameters &params, AntennaLookupCursor& /*cursor*/) const
 {
-  valid_ = true;
-  filename_ = ANTENNA_STRING_ALGORITHM_SINXX;
+  return gain(params);
 }
 
-float AntennaPatternSinXX::gain(const AntennaGainParameters &params)
+float AntennaPattern::upperBoundGain(float /*azimMin*/, float /*azimMax*/, float /*elevMin*/, float /*elevMax*/, const AntennaGainParameters &params) const
 {
-  double delev = angFixPI(params.elev_);
-  double dazim = angFixPI(params.azim_);
+  float minGain = 0.f;
+  float maxGain = 0.f;
+  minMaxGain(&minGain, &maxGain, params);
+  return maxGain;
+}
 
-  // Avoid divide by zero below
-  if (params.hbw_ == 0.f || params.vbw_ == 0.f)
-    return params.refGain_;
+std::unique_ptr<AntennaPatternEvaluator> AntennaPattern::bindFrequency(double freq) const
+{
+  return std::unique_ptr<AntennaPatternEvaluator>(new AntennaPatternEvaluator(*this, freq));
+}
 
-  // Compute angular distance in normalized beam widths
-  double phi = sqrt(square(dazim/params.hbw_) + square(delev/params.vbw_));
+// ----------------------------------------------------------------------------
+/// AntennaPatternEvaluator methods
 
-  // Compute antenna gain
-  if (phi == 0.0)
-    return params.refGain_;
+AntennaGainParameters AntennaPatternEvaluator::boundParams_(const AntennaGainParameters &params) const
+{
+  AntennaGainParameters agp(params);
+  agp.freq_ = freq_;
+  return agp;
+}
 
-  double gain = square(sin(2.783*phi) / (2.783*phi));
-  gain = params.refGain_ + 10.0 * log10(gain);
+AntennaPatternCounters& AntennaPatternEvaluator::counters_() const
+{
+  return pattern_.counters();
+}
 
-  // Add sin x/x side lobe gain
-  if (phi > M_2_SQRTPI)
-    gain += params.firstLobe_ + 13.2;
+float AntennaPatternEvaluator::gain(const AntennaGainParameters &params) const
+{
+  return pattern_.gain(boundParams_(params));
+}
 
-  return static_cast<float>(gain);
+void AntennaPatternEvaluator::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  pattern_.gainBatch(boundParams_(params), azim, elev, count, gains);
 }
 
-void AntennaPatternSinXX::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
+void AntennaPatternEvaluator::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
 {
-  assert(min && max);
-  if (!min || !max)
-    return;
+  pattern_.minMaxGain(min, max, boundParams_(params));
+}
 
-  if (params.vbw_ == lastVbw_ && params.hbw_ == lastHbw_)
+namespace
+{
+  /**
+  * Reads the pattern specific scalars of a compiled pattern, see COMPILED_SECTION_SCALARS
+  * @param[in ] reader Compiled pattern to read
+  * @param[out] values Array of count scalars to fill
+  * @param[in ] count Number of scalars the pattern writes
+  * @return true if the compiled pattern holds exactly count scalars
+  */
+  bool readCompiledScalars(const CompiledPatternReader& reader, double *values, size_t count)
   {
-    *min = minGain_ + params.refGain_;
-    *max = maxGain_ + params.refGain_;
-    return;
+    size_t numValues = 0;
+    const double *scalars = reader.doubles(COMPILED_SECTION_SCALARS, &numValues);
+    if (!scalars || numValues != count)
+      return false;
+    std::copy(scalars, scalars + count, values);
+    return true;
   }
 
-  lastVbw_ = params.vbw_;
-  lastHbw_ = params.hbw_;
-  // determine min & max values
-  float radius;
-  AntennaGainParameters agp(params);
-  agp.refGain_ = 0.;
-  for (int ii = -180; ii <= 180; ++ii)
-  {
-    agp.azim_ = static_cast<float>(DEG2RAD*(ii));
-    for (int jj = -90; jj <= 90; ++jj)
-    {
-      agp.elev_ = static_cast<float>(DEG2RAD*(jj));
-      radius = gain(agp);
-      if (radius > SMALL_DB_COMPARE)
-      {
-        minGain_ = sdkMin(minGain_, radius);
-      }
-      maxGain_ = sdkMax(maxGain_, radius);
-    } // end for jj
-  } // end for ii
+  /// Most 2D lookup tables a compiled pattern can hold, see COMPILED_SECTION_GRID
+  const size_t COMPILED_GRID_LIMIT = (COMPILED_SECTION_ARRAY - COMPILED_SECTION_GRID) / 2;
 
-  *min = minGain_ + params.refGain_;
-  *max = maxGain_ + params.refGain_;
+  /**
+  * Reads the frequencies of a compiled pattern that kept every frequency of its file, from pattern specific array 0
+  * @param[in ] reader Compiled pattern to read
+  * @param[in ] maxCount Most frequencies the pattern can hold
+  * @param[out] frequencies Frequencies to fill (Hz), left empty if the pattern holds a single frequency
+  * @return false if the frequencies are invalid
+  * @pre frequencies valid param
+  */
+  bool readCompiledFrequencies(const CompiledPatternReader& reader, size_t maxCount, std::vector<double> *frequencies)
+  {
+    frequencies->clear();
+    size_t count = 0;
+    const double *freqs = reader.doubles(COMPILED_SECTION_ARRAY, &count);
+    if (!freqs)
+      return true;
+    if (count == 0 || count > maxCount)
+      return false;
+    // lookups expect strictly increasing frequencies
+    for (size_t i = 1; i < count; ++i)
+    {
+      if (!(freqs[i - 1] < freqs[i]))
+        return false;
+    }
+    frequencies->assign(freqs, freqs + count);
+    return true;
+  }
 }
 
-// ----------------------------------------------------------------------------
+int AntennaPattern::writeCompiled(CompiledPatternWriter& writer) const
+{
+  const int32_t polarity = static_cast<int32_t>(polarity_);
+  const float gainLimits[2] = { minGain_, maxGain_ };
+  writer.addInts(COMPILED_SECTION_POLARITY, &polarity, 1);
+  writer.addFloats(COMPILED_SECTION_GAIN_LIMITS, gainLimits, 2);
+  return 0;
+}
 
-AntennaPatternOmni::AntennaPatternOmni()
-  : AntennaPattern()
+int AntennaPattern::readCompiled(const CompiledPatternReader& reader)
 {
-  valid_ = true;
-  filename_ = ANTENNA_STRING_ALGORITHM_OMNI;
+  size_t numPolarity = 0;
+  size_t numLimits = 0;
+  const int32_t *polarity = reader.ints(COMPILED_SECTION_POLARITY, &numPolarity);
+  const float *gainLimits = reader.floats(COMPILED_SECTION_GAIN_LIMITS, &numLimits);
+  if (!polarity || numPolarity != 1 || !gainLimits || numLimits != 2 ||
+    polarity[0] < POLARITY_UNKNOWN || polarity[0] > POLARITY_LINEAR)
+    return 1;
+  polarity_ = static_cast<PolarityType>(polarity[0]);
+  minGain_ = gainLimits[0];
+  maxGain_ = gainLimits[1];
+  filename_ = reader.filename();
+  return 0;
 }
 
-float AntennaPatternOmni::gain(const AntennaGainParameters &params)
+// ----------------------------------------------------------------------------
+/// MinMaxGainCache methods
+
+namespace
 {
-  return params.refGain_;
+  /// Maximum number of results a MinMaxGainCache keeps, the oldest are dropped first
+  const size_t MAX_MIN_MAX_ENTRIES = 16;
 }
 
-void AntennaPatternOmni::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
+bool MinMaxGainCache::find(const Key& key, float *min, float *max) const
 {
   assert(min && max);
-  if (!min || !max)
-    return;
-
-  *min = params.refGain_;
-  *max = params.refGain_;
+  const std::shared_ptr<const std::vector<Entry> > entries = std::atomic_load(&entries_);
+  if (!entries || !min || !max)
+    return false;
+  for (std::vector<Entry>::const_iterator iter = entries->begin(); iter != entries->end(); ++iter)
+  {
+    if (iter->key_ == key)
+    {
+      *min = iter->min_;
+      *max = iter->max_;
+      return true;
+    }
+  }
+  return false;
 }
 
-// ----------------------------------------------------------------------------
+void MinMaxGainCache::store(const Key& key, float min, float max) const
+{
+  const std::shared_ptr<const std::vector<Entry> > entries = std::atomic_load(&entries_);
+  std::shared_ptr<std::vector<Entry> > updated(new std::vector<Entry>);
+  if (entries)
+  {
+    // keep the newest results, leaving room for this one
+    const size_t keep = sdkMin(entries->size(), MAX_MIN_MAX_ENTRIES - 1);
+    updated->assign(entries->end() - keep, entries->end());
+  }
+  Entry entry;
+  entry.key_ = key;
+  entry.min_ = min;
+  entry.max_ = max;
+  updated->push_back(entry);
+  std::atomic_store(&entries_, std::shared_ptr<const std::vector<Entry> >(updated));
+}
 
-AntennaPatternPedestal::AntennaPatternPedestal()
-  : AntennaPattern(),
-  lastVbw_(-FLT_MAX),
-  lastHbw_(-FLT_MAX),
-  lastGain_(SMALL_DB_VAL)
+void MinMaxGainCache::clear()
 {
-  valid_ = true;
-  filename_ = ANTENNA_STRING_ALGORITHM_PEDESTAL;
+  std::atomic_store(&entries_, std::shared_ptr<const std::vector<Entry> >());
 }
 
-float AntennaPatternPedestal::gain(const AntennaGainParameters &params)
+// ----------------------------------------------------------------------------
+
+namespace
 {
-  double gain = 0.;
+  // Single precision approximations for the gainBatchApprox() kernels. They avoid library calls, and select with
+  // bit masks instead of branches, so that the calling loops vectorize for whatever instruction set the library is
+  // built for (SSE/AVX2/AVX-512 on x86, NEON on ARM) without fast-math flags or per platform intrinsics.
 
-  double delev = angFixPI(params.elev_);
-  double dazim = angFixPI(params.azim_);
+  const float APPROX_TWO_PI = static_cast<float>(2.0 * M_PI);
+  const float APPROX_INV_PI = static_cast<float>(M_1_PI);
+  const float APPROX_INV_TWO_PI = static_cast<float>(0.5 * M_1_PI);
+  // pi split into three floats for Cody-Waite range reduction; the first two have few enough significant bits that
+  // their products with the reduction integer are exact
+  const float APPROX_PI_A = 3.140625f;
+  const float APPROX_PI_B = 9.675025939941406e-4f;
+  const float APPROX_PI_C = 1.5099580252808664e-7f;
 
-  // Avoid divide by zero below
-  if (params.hbw_ == 0.f || params.vbw_ == 0.f)
-    return params.refGain_;
+  /** Reinterprets the bits of a float as an integer */
+  inline int32_t floatBits(float value)
+  {
+    int32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
 
-  // Compute angular distance in normalized beam widths
-  double phi = (sqrt(square(dazim/params.hbw_) + square(delev/params.vbw_)));
+  /** Reinterprets the bits of an integer as a float */
+  inline float bitsFloat(int32_t bits)
+  {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
 
-  // Determine lobe and compute antenna gain
-  if (phi < 1.29)
+  /**
+  * Returns condition ? a : b; both values are always evaluated. Compilers will not turn a float ?: into a vector
+  * blend when strict floating point semantics are in effect, but do for the equivalent integer masking.
+  */
+  inline float approxSelect(bool condition, float a, float b)
   {
-    gain = params.refGain_ - 12.0 * square(phi);
+    const int32_t mask = -static_cast<int32_t>(condition);
+    return bitsFloat((floatBits(a) & mask) | (floatBits(b) & ~mask));
   }
-  else if (phi < 4.00)
+
+  /** Rounds to the nearest integer (ties to even) for |value| < 2^22; a vectorizable alternative to floor(value + 0.5) */
+  inline float approxRound(float value)
   {
-    gain = params.refGain_ - 20.0;
+    const float magic = 12582912.f; // 1.5 * 2^23
+    return (value + magic) - magic;
   }
-  else if (phi < 5.00)
+
+  /** Wraps an angle (rad) into [-PI, PI] */
+  inline float approxAngFixPI(float angle)
   {
-    gain = 5.0 * params.refGain_ - phi * (params.refGain_ - 10.0) - 60.0;
+    return angle - APPROX_TWO_PI * approxRound(angle * APPROX_INV_TWO_PI);
   }
-  else
+
+  /** Square root of a non-negative value from an estimated reciprocal square root refined by Newton's method */
+  inline float approxSqrt(float value)
   {
-    gain = -10.0;
+    float y = bitsFloat(0x5f3759df - (floatBits(value) >> 1));
+    const float half = 0.5f * value;
+    y *= 1.5f - half * y * y;
+    y *= 1.5f - half * y * y;
+    y *= 1.5f - half * y * y;
+    // zero stays zero, as y remains finite
+    return value * y;
   }
 
-  if (gain < -10.0)
-    gain = -10.0;
+  /**
+  * Approximates sin(x) in single precision. The argument is reduced to [-PI/2, PI/2] and evaluated with an
+  * 11th order odd polynomial; absolute error is below 2.5e-7 for |x| < 1e4 and grows linearly with |x| beyond that.
+  */
+  inline float approxSin(float x)
+  {
+    // x = r + k*PI, sin(x) = (-1)^k * sin(r)
+    const float k = approxRound(x * APPROX_INV_PI);
+    float r = x - k * APPROX_PI_A;
+    r -= k * APPROX_PI_B;
+    r -= k * APPROX_PI_C;
+    const float r2 = r * r;
+    const float s = r + r * r2 * (-1.6666667e-1f + r2 * (8.3333333e-3f + r2 * (-1.9841270e-4f + r2 * (2.7557319e-6f + r2 * -2.5052108e-8f))));
+    // move the low bit of k into the sign bit; shifted unsigned, as k is negative for negative x
+    const uint32_t sign = (static_cast<uint32_t>(static_cast<int32_t>(k)) & 1u) << 31;
+    return bitsFloat(floatBits(s) ^ static_cast<int32_t>(sign));
+  }
 
-  return static_cast<float>(gain);
+  /**
+  * Approximates log10(x) in single precision from the float exponent and a 2*atanh series for the mantissa;
+  * relative error is below 1e-7 for finite, positive x. Returns -inf for zero and NaN for negative x, as log10 does.
+  */
+  inline float approxLog10(float x)
+  {
+    // x = m * 2^e, with m in [sqrt(1/2), sqrt(2)); denormals are treated as FLT_MIN
+    const int32_t xBits = floatBits(x);
+    const int32_t bits = (xBits < 0x00800000) ? 0x00800000 : xBits;
+    const int32_t mantissa = bits & 0x007fffff;
+    const int32_t high = (mantissa > 0x003504f3) ? 1 : 0;
+    const float e = static_cast<float>(((bits >> 23) & 0xff) - 127 + high);
+    const float m = bitsFloat(mantissa | (0x3f800000 - (high << 23)));
+    // ln(m) = 2 * atanh(t), |t| <= 0.1716
+    const float t = (m - 1.f) / (m + 1.f);
+    const float t2 = t * t;
+    const float lnm = 2.f * t * (1.f + t2 * (3.3333333e-1f + t2 * (2.0e-1f + t2 * (1.4285714e-1f + t2 * 1.1111111e-1f))));
+    const float result = (e * static_cast<float>(M_LN2) + lnm) * static_cast<float>(M_LOG10E);
+    const float special = approxSelect((xBits & 0x7fffffff) == 0, -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN());
+    return approxSelect(xBits > 0, result, special);
+  }
 }
 
+// ----------------------------------------------------------------------------
 
-void AntennaPatternPedestal::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
+AntennaPatternGauss::AntennaPatternGauss()
+  : AntennaPattern()
 {
-  assert(min && max);
-  if (!min || !max)
-    return;
+  valid_ = true;
+  filename_ = ANTENNA_STRING_ALGORITHM_GAUSS;
+}
+
+namespace
+{
+  /// Padding of gain bounds, covering the rounding of the interpolation in gain() (dB)
+  const double BOUND_MARGIN_DB = 1e-3;
+  /// Padding of the angles bounded, covering the rounding of the angle conversions in gain() (rad)
+  const double BOUND_ANGLE_MARGIN = 2e-5;
 
-  if (params.vbw_ == lastVbw_ && params.hbw_ == lastHbw_ && params.refGain_ == lastGain_)
+  /**
+  * Pads a gain bound and rounds it up past the nearest float, so that it stays at or above gains that gain()
+  * computes along a different sequence of roundings
+  * @param[in ] bound Gain bound (dB)
+  * @return bound rounded up (dB)
+  */
+  inline float roundBoundUp(double bound)
   {
-    *min = minGain_;
-    *max = maxGain_;
-    return;
+    return std::nextafter(static_cast<float>(bound + BOUND_MARGIN_DB), std::numeric_limits<float>::max());
   }
 
-  lastVbw_ = params.vbw_;
-  lastHbw_ = params.hbw_;
-  lastGain_ = params.refGain_;
-  // determine min & max values
-  float radius;
-  AntennaGainParameters agp(params);
-  for (int ii = -180; ii <= 180; ++ii)
+  /**
+  * Returns the angle of a range nearest to zero
+  * @param[in ] minAngle Low end of the range (rad)
+  * @param[in ] maxAngle High end of the range (rad), at least minAngle
+  * @return 0 if the range contains it, otherwise the end of the range nearest to it
+  */
+  inline float nearestToZero(float minAngle, float maxAngle)
   {
-    agp.azim_ = static_cast<float>(DEG2RAD*(ii));
-    for (int jj = -90; jj <= 90; ++jj)
-    {
-      agp.elev_ = static_cast<float>(DEG2RAD*(jj));
-      radius = gain(agp);
-      if (radius > SMALL_DB_COMPARE)
-      {
-        minGain_ = sdkMin(minGain_, radius);
+    if (minAngle > 0.f)
+      return minAngle;
+    return (maxAngle < 0.f) ? maxAngle : 0.f;
+  }
+}
+
+float AntennaPatternGauss::gain(const AntennaGainParameters &params) const
+{
+  return AntennaKernels::gaussGain(params.elev_, AntennaKernels::gaussAntennaFactor(params.vbw_), params.refGain_);
+}
+
+void AntennaPatternGauss::gainBatch(const AntennaGainParameters &params, const float* /*azim*/, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (elev && gains));
+  if (count == 0 || !elev || !gains)
+    return;
+
+  // pattern depends on elevation only
+  const double antfac = AntennaKernels::gaussAntennaFactor(params.vbw_);
+  for (size_t i = 0; i < count; ++i)
+    gains[i] = AntennaKernels::gaussGain(elev[i], antfac, params.refGain_);
+}
+
+void AntennaPatternGauss::gainBatchApprox(const AntennaGainParameters &params, const float* /*azim*/, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (elev && gains));
+  if (count == 0 || !elev || !gains)
+    return;
+
+  // 20*log10(exp(x)) == 20*log10(e)*x, so the pattern needs no exp or log, and clipping the linear factor
+  // at 0.03 becomes clipping the dB value at 20*log10(0.03); sin^2 has period PI, so no angle fixing is needed
+  const float dbFactor = static_cast<float>(20.0 * M_LOG10E * AntennaKernels::gaussAntennaFactor(params.vbw_));
+  const float minDb = static_cast<float>(20.0 * log10(0.03));
+  const float refGain = params.refGain_;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const float s = approxSin(elev[i]);
+    const float db = dbFactor * s * s;
+    gains[i] = refGain + approxSelect(db < minDb, minDb, db);
+  }
+}
+
+void AntennaPatternGauss::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
+{
+  assert(min && max);
+  if (!min || !max)
+    return;
+
+  // the exponent factor is negative and sin^2 increases with |elev| over [0, PI/2], so the
+  // pattern peaks at boresight and is lowest straight up or down
+  const double antfac = AntennaKernels::gaussAntennaFactor(params.vbw_);
+  *min = AntennaKernels::gaussGain(static_cast<float>(M_PI_2), antfac, 0.f) + params.refGain_;
+  *max = AntennaKernels::gaussGain(0.f, antfac, 0.f) + params.refGain_;
+}
+
+float AntennaPatternGauss::upperBoundGain(float /*azimMin*/, float /*azimMax*/, float elevMin, float elevMax, const AntennaGainParameters &params) const
+{
+  // the pattern falls as sin^2(elev) rises, so within the sector it peaks at the elevation nearest boresight
+  const float elev = nearestToZero(elevMin, elevMax);
+  return roundBoundUp(AntennaKernels::gaussGain(elev, AntennaKernels::gaussAntennaFactor(params.vbw_), params.refGain_));
+}
+
+// ----------------------------------------------------------------------------
+
+AntennaPatternCscSq::AntennaPatternCscSq()
+  : AntennaPattern()
+{
+  valid_ = true;
+  filename_ = ANTENNA_STRING_ALGORITHM_CSCSQ;
+}
+
+float AntennaPatternCscSq::gain(const AntennaGainParameters &params) const
+{
+  return AntennaKernels::cscSqGain(params.elev_, params.vbw_, params.refGain_);
+}
+
+void AntennaPatternCscSq::gainBatch(const AntennaGainParameters &params, const float* /*azim*/, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (elev && gains));
+  if (count == 0 || !elev || !gains)
+    return;
+
+  // pattern depends on elevation only
+  for (size_t i = 0; i < count; ++i)
+    gains[i] = AntennaKernels::cscSqGain(elev[i], params.vbw_, params.refGain_);
+}
+
+void AntennaPatternCscSq::gainBatchApprox(const AntennaGainParameters &params, const float* /*azim*/, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (elev && gains));
+  if (count == 0 || !elev || !gains)
+    return;
+
+  // vbw should not be zero, gain() asserts and uses an unscaled elevation
+  assert(params.vbw_ != 0.f);
+  const float vbw = params.vbw_;
+  const float invVbw = (vbw != 0.f) ? 1.f / vbw : 1.f;
+  const float refGain = params.refGain_;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const float delev = approxAngFixPI(elev[i]);
+    // both branches are computed and one is selected, keeping the loop free of branches
+    const float onePlus = 1.f + delev * invVbw;
+    float mainFactor = approxSelect(onePlus < 0.03f, 0.03f, onePlus);
+    mainFactor = approxSelect(mainFactor > 1.f, 1.f, mainFactor);
+    // sin(|delev|) == |sin(elev)|; reducing elev directly keeps the precision lost by the float angle fix
+    float denom = std::fabs(approxSin(elev[i]));
+    denom = approxSelect(denom == 0.f, 1.f, denom);
+    float elevFactor = approxSelect(delev <= vbw, mainFactor, approxSin(vbw / denom));
+    elevFactor = approxSelect(elevFactor == 0.f, 0.03f, elevFactor);
+    gains[i] = refGain + 20.f * approxLog10(elevFactor);
+  }
+}
+
+void AntennaPatternCscSq::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
+{
+  assert(min && max);
+  if (!min || !max)
+    return;
+
+  float minGain = -SMALL_DB_VAL;
+  float maxGain = SMALL_DB_VAL;
+  if (params.vbw_ > 0.f)
+  {
+    // below vbw the factor rises linearly to 1 at boresight and stays there; above it sin(vbw/sin(elev))
+    // falls as elev rises, since vbw/sin(elev) stays below PI/2 for vbw <= PI/2 (and no elev in [-PI/2, PI/2]
+    // is above a wider vbw); so the pattern peaks at boresight and is lowest straight up or down
+    minGain = sdkMin(AntennaKernels::cscSqGain(static_cast<float>(-M_PI_2), params.vbw_, 0.f), AntennaKernels::cscSqGain(static_cast<float>(M_PI_2), params.vbw_, 0.f));
+    maxGain = AntennaKernels::cscSqGain(0.f, params.vbw_, 0.f);
+  }
+  else
+  {
+    // no closed form for a non-positive beam width, determine min & max values
+    AntennaGainParameters agp(params);
+    agp.refGain_ = 0.;
+    for (int jj = -90; jj <= 90; ++jj)
+    {
+      agp.elev_ = static_cast<float>(DEG2RAD*(jj));
+      float radius = gain(agp);
+      if (radius > SMALL_DB_COMPARE)
+      {
+        minGain = sdkMin(minGain, radius);
       }
-      maxGain_ = sdkMax(maxGain_, radius);
+      maxGain = sdkMax(maxGain, radius);
     } // end for jj
-  } // end for ii
+  }
 
-  *min = minGain_;
-  *max = maxGain_;
+  *min = minGain + params.refGain_;
+  *max = maxGain + params.refGain_;
+}
+
+float AntennaPatternCscSq::upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const
+{
+  // non-positive beam widths have no closed form, see minMaxGain()
+  if (!(params.vbw_ > 0.f))
+    return AntennaPattern::upperBoundGain(azimMin, azimMax, elevMin, elevMax, params);
+  // the factor rises toward boresight from below and does not rise above it, so within the sector the pattern
+  // peaks at the elevation nearest boresight
+  return roundBoundUp(AntennaKernels::cscSqGain(nearestToZero(elevMin, elevMax), params.vbw_, params.refGain_));
+}
+
+// ----------------------------------------------------------------------------
+
+AntennaPatternSinXX::AntennaPatternSinXX()
+  : AntennaPattern()
+{
+  valid_ = true;
+  filename_ = ANTENNA_STRING_ALGORITHM_SINXX;
+}
+
+float AntennaPatternSinXX::gain(const AntennaGainParameters &params) const
+{
+  // Avoid divide by zero below
+  if (params.hbw_ == 0.f || params.vbw_ == 0.f)
+    return params.refGain_;
+  return AntennaKernels::sinXXGain(params.azim_, params.elev_, params.hbw_, params.vbw_, params.refGain_, params.firstLobe_);
+}
+
+void AntennaPatternSinXX::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+
+  // Avoid divide by zero below
+  if (params.hbw_ == 0.f || params.vbw_ == 0.f)
+  {
+    std::fill(gains, gains + count, params.refGain_);
+    return;
+  }
+  for (size_t i = 0; i < count; ++i)
+    gains[i] = AntennaKernels::sinXXGain(azim[i], elev[i], params.hbw_, params.vbw_, params.refGain_, params.firstLobe_);
+}
+
+void AntennaPatternSinXX::gainBatchApprox(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+
+  // Avoid divide by zero below
+  if (params.hbw_ == 0.f || params.vbw_ == 0.f)
+  {
+    std::fill(gains, gains + count, params.refGain_);
+    return;
+  }
+
+  const float invHbw = 1.f / params.hbw_;
+  const float invVbw = 1.f / params.vbw_;
+  const float refGain = params.refGain_;
+  const float lobeGain = params.firstLobe_ + 13.2f;
+  const float sideLobePhi = static_cast<float>(M_2_SQRTPI);
+  for (size_t i = 0; i < count; ++i)
+  {
+    const float dazim = approxAngFixPI(azim[i]) * invHbw;
+    const float delev = approxAngFixPI(elev[i]) * invVbw;
+    const float phi = approxSqrt(dazim * dazim + delev * delev);
+    // 10*log10((sin(x)/x)^2) == 20*log10(|sin(x)/x|); guard x for the phi == 0 case selected away below
+    const float x = 2.783f * phi;
+    const float db = 20.f * approxLog10(std::fabs(approxSin(x) / approxSelect(x == 0.f, 1.f, x)));
+    const float gain = refGain + db + approxSelect(phi > sideLobePhi, lobeGain, 0.f);
+    gains[i] = approxSelect(phi == 0.f, refGain, gain);
+  }
+}
+
+void AntennaPatternSinXX::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
+{
+  assert(min && max);
+  if (!min || !max)
+    return;
+
+  // bounds relative to the reference gain depend on the beam widths only
+  const MinMaxGainCache::Key key(params.vbw_, params.hbw_);
+  float minGain = -SMALL_DB_VAL;
+  float maxGain = SMALL_DB_VAL;
+  if (!minMaxCache_.find(key, &minGain, &maxGain))
+  {
+    // the peak is the reference gain at boresight, but the lowest sampled side lobe depends on how close samples
+    // fall to the nulls, so it is swept; the pattern depends on |azim| and |elev| only, so one quadrant suffices
+    float radius;
+    AntennaGainParameters agp(params);
+    agp.refGain_ = 0.;
+    for (int ii = 0; ii <= 180; ++ii)
+    {
+      agp.azim_ = static_cast<float>(DEG2RAD*(ii));
+      for (int jj = 0; jj <= 90; ++jj)
+      {
+        agp.elev_ = static_cast<float>(DEG2RAD*(jj));
+        radius = gain(agp);
+        if (radius > SMALL_DB_COMPARE)
+        {
+          minGain = sdkMin(minGain, radius);
+        }
+        maxGain = sdkMax(maxGain, radius);
+      } // end for jj
+    } // end for ii
+    minMaxCache_.store(key, minGain, maxGain);
+  }
+
+  *min = minGain + params.refGain_;
+  *max = maxGain + params.refGain_;
+}
+
+// ----------------------------------------------------------------------------
+
+AntennaPatternOmni::AntennaPatternOmni()
+  : AntennaPattern()
+{
+  valid_ = true;
+  filename_ = ANTENNA_STRING_ALGORITHM_OMNI;
+}
+
+float AntennaPatternOmni::gain(const AntennaGainParameters &params) const
+{
+  return params.refGain_;
+}
+
+void AntennaPatternOmni::gainBatch(const AntennaGainParameters &params, const float* /*azim*/, const float* /*elev*/, size_t count, float *gains) const
+{
+  assert(count == 0 || gains);
+  if (count == 0 || !gains)
+    return;
+  std::fill(gains, gains + count, params.refGain_);
+}
+
+void AntennaPatternOmni::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
+{
+  assert(min && max);
+  if (!min || !max)
+    return;
+
+  *min = params.refGain_;
+  *max = params.refGain_;
+}
+
+// ----------------------------------------------------------------------------
+
+AntennaPatternPedestal::AntennaPatternPedestal()
+  : AntennaPattern()
+{
+  valid_ = true;
+  filename_ = ANTENNA_STRING_ALGORITHM_PEDESTAL;
+}
+
+float AntennaPatternPedestal::gain(const AntennaGainParameters &params) const
+{
+  // Avoid divide by zero below
+  if (params.hbw_ == 0.f || params.vbw_ == 0.f)
+    return params.refGain_;
+  return AntennaKernels::pedestalGain(params.azim_, params.elev_, params.hbw_, params.vbw_, params.refGain_);
+}
+
+void AntennaPatternPedestal::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+
+  // Avoid divide by zero below
+  if (params.hbw_ == 0.f || params.vbw_ == 0.f)
+  {
+    std::fill(gains, gains + count, params.refGain_);
+    return;
+  }
+  for (size_t i = 0; i < count; ++i)
+    gains[i] = AntennaKernels::pedestalGain(azim[i], elev[i], params.hbw_, params.vbw_, params.refGain_);
+}
+
+void AntennaPatternPedestal::gainBatchApprox(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+
+  // Avoid divide by zero below
+  if (params.hbw_ == 0.f || params.vbw_ == 0.f)
+  {
+    std::fill(gains, gains + count, params.refGain_);
+    return;
+  }
+
+  const float invHbw = 1.f / params.hbw_;
+  const float invVbw = 1.f / params.vbw_;
+  const float refGain = params.refGain_;
+  const float sideGain = refGain - 20.f;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const float dazim = approxAngFixPI(azim[i]) * invHbw;
+    const float delev = approxAngFixPI(elev[i]) * invVbw;
+    const float phi = approxSqrt(dazim * dazim + delev * delev);
+    // lobes are selected rather than branched to, see pedestalGain()
+    float gain = approxSelect(phi < 5.00f, 5.f * refGain - phi * (refGain - 10.f) - 60.f, -10.f);
+    gain = approxSelect(phi < 4.00f, sideGain, gain);
+    gain = approxSelect(phi < 1.29f, refGain - 12.f * phi * phi, gain);
+    gains[i] = approxSelect(gain < -10.f, -10.f, gain);
+  }
+}
+
+
+void AntennaPatternPedestal::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
+{
+  assert(min && max);
+  if (!min || !max)
+    return;
+
+  // Avoid divide by zero below, gain() is the reference gain everywhere
+  if (params.hbw_ == 0.f || params.vbw_ == 0.f)
+  {
+    *min = params.refGain_;
+    *max = params.refGain_;
+    return;
+  }
+
+  // gain depends on the angular distance in beam widths only, and is monotonic within each lobe, so the
+  // extremes lie at boresight, at the farthest direction, or at the lobe edges in between
+  const double maxPhi = sqrt(square(M_PI / params.hbw_) + square(M_PI_2 / params.vbw_));
+  float minGain = sdkMin(AntennaKernels::pedestalLobeGain(0.0, params.refGain_), AntennaKernels::pedestalLobeGain(maxPhi, params.refGain_));
+  float maxGain = sdkMax(AntennaKernels::pedestalLobeGain(0.0, params.refGain_), AntennaKernels::pedestalLobeGain(maxPhi, params.refGain_));
+  const double lobeEdges[] = { 1.29, 5.00 };
+  for (size_t i = 0; i < sizeof(lobeEdges) / sizeof(lobeEdges[0]); ++i)
+  {
+    if (maxPhi < lobeEdges[i])
+      break;
+    const float edgeGain = AntennaKernels::pedestalLobeGain(lobeEdges[i], params.refGain_);
+    minGain = sdkMin(minGain, edgeGain);
+    maxGain = sdkMax(maxGain, edgeGain);
+  }
+
+  *min = minGain;
+  *max = maxGain;
 }
 
 
@@ -566,98 +1224,708 @@ namespace
     if (areEqual(angle, riter->first))
       return riter->second;
 
-    return SMALL_DB_VAL;
+    return SMALL_DB_VAL;
+  }
+
+  /**
+  * @brief Convenience function that returns the gain for a specified angle from a compiled antenna pattern lookup table
+  * @param[in ] angle angle to lookup (rad)
+  * @param[in ] angle/gain lookup table
+  * @return table gain (dB), or SMALL_DB_VAL on invalid input
+  */
+  inline float gainAtAngle(float angle, const AngleGainTable& table)
+  {
+    return table.gain(angle);
+  }
+
+  /** Compiled table searched from the breakpoint of a previous lookup, see AntennaLookupCursor */
+  struct HintedAngleTable
+  {
+    const AngleGainTable& table_; ///< Table to search
+    size_t& hint_;                ///< Breakpoint of the previous lookup, updated by each lookup
+
+    /** @return true if the table has no breakpoints */
+    bool empty() const { return table_.empty(); }
+  };
+
+  /**
+  * @brief Convenience function that returns the gain for a specified angle from a compiled antenna pattern lookup table,
+  * searching from the breakpoint of the previous lookup
+  * @param[in ] angle angle to lookup (rad)
+  * @param[in ] table compiled table and search hint
+  * @return table gain (dB), identical to gainAtAngle(angle, table.table_), or SMALL_DB_VAL on invalid input
+  */
+  inline float gainAtAngle(float angle, const HintedAngleTable& table)
+  {
+    table.hint_ = table.table_.locate(angle, table.hint_);
+    return table.table_.gainAt(table.hint_, angle);
+  }
+
+  /**
+  * Checks whether the values at and next to a previous result bracket x as upper_bound() would, values[lower] <= x <
+  * values[lower + 1], for x strictly inside the values
+  * @param[in ] values Values in increasing order
+  * @param[in ] x Value to bracket
+  * @param[in,out] lower Lower index of the previous bracket; set to the lower index of the bracket if found
+  * @return true if found next to the previous bracket
+  */
+  bool bracketNear(const std::vector<double>& values, double x, size_t& lower)
+  {
+    const size_t previous = lower;
+    for (size_t candidate = (previous > 0) ? previous - 1 : 0; candidate <= previous + 1; ++candidate)
+    {
+      if (candidate + 1 < values.size() && values[candidate] <= x && x < values[candidate + 1])
+      {
+        lower = candidate;
+        return true;
+      }
+    }
+    return false;
+  }
+}
+
+// ----------------------------------------------------------------------------
+/// AntennaLookupCursor methods
+
+AntennaLookupCursor::AntennaLookupCursor()
+  : azimIndex_(0),
+    elevIndex_(0),
+    freqIndex_(0)
+{
+}
+
+void AntennaLookupCursor::reset()
+{
+  azimIndex_ = 0;
+  elevIndex_ = 0;
+  freqIndex_ = 0;
+}
+
+// ----------------------------------------------------------------------------
+/// AngleGainTable methods
+
+namespace
+{
+  /// Arrays of an AngleGainTable built by AngleGainTable::compile()
+  struct AngleGainTableStorage
+  {
+    std::vector<float> angles_;
+    std::vector<float> gains_;
+    std::vector<uint32_t> buckets_;
+  };
+
+  /**
+  * Returns the number of buckets per radian for a compiled table; one bucket per breakpoint on average, and a
+  * degenerate span maps everything to the first bucket
+  * @param[in ] angles Breakpoint angles in increasing order (rad)
+  * @param[in ] size Number of breakpoints, non-zero
+  * @return number of buckets per radian
+  */
+  float angleGainBucketScale(const float *angles, size_t size)
+  {
+    const float span = angles[size - 1] - angles[0];
+    return (span > 0.f) ? static_cast<float>(size) / span : 0.f;
+  }
+}
+
+AngleGainTable::AngleGainTable()
+  : angles_(nullptr),
+    gains_(nullptr),
+    buckets_(nullptr),
+    size_(0),
+    invStep_(0.f)
+{
+}
+
+void AngleGainTable::clear()
+{
+  angles_ = nullptr;
+  gains_ = nullptr;
+  buckets_ = nullptr;
+  size_ = 0;
+  invStep_ = 0.f;
+  storage_.reset();
+}
+
+void AngleGainTable::compile(const std::map<float, float>& table)
+{
+  clear();
+  if (table.empty())
+    return;
+
+  std::shared_ptr<AngleGainTableStorage> storage(new AngleGainTableStorage);
+  storage->angles_.reserve(table.size());
+  storage->gains_.reserve(table.size());
+  for (std::map<float, float>::const_iterator iter = table.begin(); iter != table.end(); ++iter)
+  {
+    storage->angles_.push_back(iter->first);
+    storage->gains_.push_back(iter->second);
+  }
+  storage->buckets_.resize(table.size());
+
+  angles_ = storage->angles_.data();
+  gains_ = storage->gains_.data();
+  size_ = table.size();
+  invStep_ = angleGainBucketScale(angles_, size_);
+
+  // buckets_[b] is the first breakpoint whose own bucket is >= b. Since bucket_() is non-decreasing, every
+  // breakpoint before buckets_[b] is less than any angle in bucket b, so lookups can start there
+  size_t index = 0;
+  for (size_t b = 0; b < size_; ++b)
+  {
+    while (index < size_ && bucket_(angles_[index]) < b)
+      ++index;
+    storage->buckets_[b] = static_cast<uint32_t>(index);
+  }
+  buckets_ = storage->buckets_.data();
+  storage_ = storage;
+}
+
+int AngleGainTable::assign(const float *angles, const float *gains, const uint32_t *buckets, size_t size, float bucketScale, const std::shared_ptr<const void>& storage)
+{
+  clear();
+  if (size == 0)
+    return 0;
+  if (!angles || !gains || !buckets || size > std::numeric_limits<uint32_t>::max())
+    return 1;
+
+  // lookups rely on strictly increasing angles and on the bucket index, so verify both before using them
+  for (size_t i = 1; i < size; ++i)
+  {
+    if (!(angles[i] > angles[i - 1]))
+      return 1;
+  }
+  if (bucketScale != angleGainBucketScale(angles, size))
+    return 1;
+
+  angles_ = angles;
+  gains_ = gains;
+  size_ = size;
+  invStep_ = bucketScale;
+  size_t index = 0;
+  for (size_t b = 0; b < size_; ++b)
+  {
+    while (index < size_ && bucket_(angles_[index]) < b)
+      ++index;
+    if (buckets[b] != index)
+    {
+      clear();
+      return 1;
+    }
+  }
+  buckets_ = buckets;
+  storage_ = storage;
+  return 0;
+}
+
+void AngleGainTable::toMap(std::map<float, float> *table) const
+{
+  assert(table);
+  if (!table)
+    return;
+  for (size_t i = 0; i < size_; ++i)
+    (*table)[angles_[i]] = gains_[i];
+}
+
+size_t AngleGainTable::bucket_(float angle) const
+{
+  const float pos = (angle - angles_[0]) * invStep_;
+  const size_t last = size_ - 1;
+  return (pos < static_cast<float>(last)) ? static_cast<size_t>(pos) : last;
+}
+
+float AngleGainTable::gain(float angle) const
+{
+  return gainAt(locate(angle), angle);
+}
+
+size_t AngleGainTable::locate(float angle, size_t hint) const
+{
+  // an angle strictly inside the table has a unique breakpoint hi with angles_[hi - 1] < angle <= angles_[hi];
+  // the edge cases are left to locate(angle)
+  if (size_ > 1 && angle > angles_[0] && !(angle > angles_[size_ - 1]))
+  {
+    for (size_t hi = (hint > 1) ? hint - 1 : 1; hi <= hint + 1 && hi < size_; ++hi)
+    {
+      if (angles_[hi - 1] < angle && !(angles_[hi] < angle))
+        return hi;
+    }
+  }
+  return locate(angle);
+}
+
+size_t AngleGainTable::locate(float angle) const
+{
+  if (size_ == 0)
+    return 0;
+
+  // the first breakpoint covers everything at or below it, including NaN, as map::lower_bound() does
+  if (!(angle > angles_[0]))
+    return 0;
+
+  if (angle > angles_[size_ - 1])
+  {
+    // possibly missed due to rounding errors due to casting
+    if (areEqual(angle, angles_[0]))
+      return 0;
+    if (areEqual(angle, angles_[size_ - 1]))
+      return size_ - 1;
+    return size_;
+  }
+
+  // first breakpoint >= angle; exists since angle <= back, and is not the first since angle > front
+  size_t hi = buckets_[bucket_(angle)];
+  while (angles_[hi] < angle)
+    ++hi;
+  return hi;
+}
+
+float AngleGainTable::gainAt(size_t index, float angle) const
+{
+  if (index >= size_)
+    return SMALL_DB_VAL;
+  // the first breakpoint, an exact match, or an angle rounded past the last breakpoint take the breakpoint gain
+  if (index == 0 || !(angle < angles_[index]))
+    return gains_[index];
+  // linearInterpolate casts to double as needed to avoid loss of precision
+  return linearInterpolate(gains_[index - 1], gains_[index], angles_[index - 1], angle, angles_[index]);
+}
+
+bool AngleGainTable::sameAngles(const AngleGainTable& other) const
+{
+  return size_ == other.size_ && (angles_ == other.angles_ || std::equal(angles_, angles_ + size_, other.angles_));
+}
+
+namespace
+{
+  /** Implements calculateGain() for either the authored (std::map) or compiled (AngleGainTable) table form */
+  template <typename TableType>
+  float calculateTableGain(const TableType *azimData,
+    const TableType *elevData,
+    AntennaLobeType &lastLobe,
+    float azim,
+    float elev,
+    float hbw,
+    float vbw,
+    float maxGain,
+    bool applyWeight)
+  {
+    if (!azimData || azimData->empty() || !elevData || elevData->empty())
+      return SMALL_DB_VAL;
+
+    if (hbw == 0.f || vbw == 0.f)
+    {
+      assert(0); // hbw and vbw must be non-zero to avoid divide-by-zero errors
+      return SMALL_DB_VAL;
+    }
+
+    float gain = SMALL_DB_VAL;
+
+    if (!applyWeight)
+    {
+      const float az_gain = gainAtAngle(static_cast<float>(azim), *azimData);
+      if (az_gain == SMALL_DB_VAL)
+        return SMALL_DB_VAL;
+      const float el_gain = gainAtAngle(static_cast<float>(elev), *elevData);
+      if (el_gain == SMALL_DB_VAL)
+        return SMALL_DB_VAL;
+
+      gain = maxGain + (az_gain + el_gain) / 2.0f;
+    }
+
+    // Compute angular distance in normalized beam widths
+    const double azim_bw = azim / hbw;
+    const double elev_bw = elev / vbw;
+    const double phi = sqrt(square(azim_bw) + square(elev_bw));
+
+    // Determine lobe
+    if (phi < 1.29)
+      lastLobe = ANTENNA_LOBE_MAIN;
+    else if (phi < 4.0)
+      lastLobe = ANTENNA_LOBE_SIDE;
+    else if (phi < 5.0)
+      lastLobe = ANTENNA_LOBE_SIDE;
+    else
+      lastLobe = ANTENNA_LOBE_BACK;
+
+    if (!applyWeight)
+      return gain;
+
+    const double azim_ang = sdkMin(phi * hbw, M_PI);
+    const float az_gain = gainAtAngle(static_cast<float>(azim_ang), *azimData);
+    if (az_gain == SMALL_DB_VAL)
+      return SMALL_DB_VAL;
+
+    const double elev_ang = sdkMin(phi * vbw, M_PI_2);
+    const float el_gain = gainAtAngle(static_cast<float>(elev_ang), *elevData);
+    if (el_gain == SMALL_DB_VAL)
+      return SMALL_DB_VAL;
+
+    // Determine angles (alpha & beta) associated with normalized
+    // azim / elev components.  They will be used to obtain a
+    // 'weighted average' antenna loss value
+    if ((azim_bw == 0.0 && elev_bw == 0.0) || vbw == hbw)
+      return maxGain + (az_gain + el_gain) / 2.0f;
+
+    double alpha, beta;
+    if (azim_bw <= elev_bw)
+    {
+      // since atan2 returns values between -pi and pi,
+      // alpha and beta should be in rad instead of deg
+      alpha = fabs(atan2(azim_bw, elev_bw));
+      if (alpha > M_PI_2)
+        alpha = M_PI - alpha;
+      beta = M_PI_2 - alpha;
+      return static_cast<float>(maxGain + (alpha * az_gain + beta * el_gain) / M_PI_2);
+    }
+
+    // since atan2 returns values between -pi and pi,
+    // alpha and beta should be in rad instead of deg
+    beta = fabs(atan2(elev_bw, azim_bw));
+    if (beta > M_PI_2)
+      beta = M_PI - beta;
+    alpha = M_PI_2 - beta;
+    return static_cast<float>(maxGain + (alpha * az_gain + beta * el_gain) / M_PI_2);
+  }
+}
+
+/* This function returns the gain for lookup table-based antennaPatterns */
+
+float calculateGain(const std::map<float, float> *azimData,
+  const std::map<float, float> *elevData,
+  AntennaLobeType &lastLobe,
+  float azim,
+  float elev,
+  float hbw,
+  float vbw,
+  float maxGain,
+  bool applyWeight)
+{
+  return calculateTableGain(azimData, elevData, lastLobe, azim, elev, hbw, vbw, maxGain, applyWeight);
+}
+
+float calculateGain(const AngleGainTable *azimData,
+  const AngleGainTable *elevData,
+  AntennaLobeType &lastLobe,
+  float azim,
+  float elev,
+  float hbw,
+  float vbw,
+  float maxGain,
+  bool applyWeight)
+{
+  return calculateTableGain(azimData, elevData, lastLobe, azim, elev, hbw, vbw, maxGain, applyWeight);
+}
+
+// ----------------------------------------------------------------------------
+/// WeightedGainGridCache methods
+
+struct WeightedGainGridCache::Grid
+{
+  float hbw_;            ///< Horizontal beam width the grid was rasterized for (rad)
+  float vbw_;            ///< Vertical beam width the grid was rasterized for (rad)
+  size_t numAzim_;       ///< Number of azimuths, from -pi to pi
+  size_t numElev_;       ///< Number of elevations, from -pi/2 to pi/2
+  double azimScale_;     ///< Azimuth index per radian
+  double elevScale_;     ///< Elevation index per radian
+  std::vector<float> gains_;  ///< numAzim_ by numElev_ gains relative to the reference gain (dB), elevation minor
+  mutable std::atomic<uint64_t> lastUse_;  ///< Use stamp of the most recent lookup, for least recently used eviction
+};
+
+WeightedGainGridCache::WeightedGainGridCache()
+  : resolution_(0.f),
+  maxGrids_(1),
+  useCount_(0)
+{}
+
+WeightedGainGridCache::WeightedGainGridCache(const WeightedGainGridCache& other)
+  : resolution_(other.resolution_),
+  maxGrids_(other.maxGrids_),
+  useCount_(0)
+{}
+
+WeightedGainGridCache& WeightedGainGridCache::operator=(const WeightedGainGridCache& other)
+{
+  if (this != &other)
+    configure(other.resolution_, other.maxGrids_);
+  return *this;
+}
+
+void WeightedGainGridCache::configure(float resolution, size_t maxGrids)
+{
+  // negative and NaN resolutions disable rasterizing
+  resolution_ = (resolution > 0.f) ? resolution : 0.f;
+  maxGrids_ = sdkMax(maxGrids, static_cast<size_t>(1));
+  clear();
+}
+
+void WeightedGainGridCache::clear()
+{
+  std::atomic_store(&grids_, std::shared_ptr<const std::vector<std::shared_ptr<const Grid> > >());
+}
+
+std::shared_ptr<const WeightedGainGridCache::Grid> WeightedGainGridCache::grid(const AngleGainTable& azimTable, const AngleGainTable& elevTable, float hbw, float vbw) const
+{
+  if (!enabled() || hbw == 0.f || vbw == 0.f)
+    return std::shared_ptr<const Grid>();
+
+  typedef std::vector<std::shared_ptr<const Grid> > GridVec;
+  const std::shared_ptr<const GridVec> grids = std::atomic_load(&grids_);
+  if (grids)
+  {
+    for (GridVec::const_iterator iter = grids->begin(); iter != grids->end(); ++iter)
+    {
+      if ((*iter)->hbw_ == hbw && (*iter)->vbw_ == vbw)
+      {
+        // restamp only when another grid was used since, so repeated lookups of one grid do not write shared state
+        if ((*iter)->lastUse_.load(std::memory_order_relaxed) != useCount_.load(std::memory_order_relaxed))
+          (*iter)->lastUse_.store(++useCount_, std::memory_order_relaxed);
+        return *iter;
+      }
+    }
+  }
+
+  // rasterize the weighted gain over the directions calculateGain() is called with
+  std::shared_ptr<Grid> newGrid(new Grid);
+  newGrid->hbw_ = hbw;
+  newGrid->vbw_ = vbw;
+  newGrid->numAzim_ = static_cast<size_t>(ceil(2.0 * M_PI / resolution_)) + 1;
+  newGrid->numElev_ = static_cast<size_t>(ceil(M_PI / resolution_)) + 1;
+  newGrid->azimScale_ = (newGrid->numAzim_ - 1) / (2.0 * M_PI);
+  newGrid->elevScale_ = (newGrid->numElev_ - 1) / M_PI;
+  newGrid->gains_.resize(newGrid->numAzim_ * newGrid->numElev_);
+  newGrid->lastUse_.store(++useCount_, std::memory_order_relaxed);
+  AntennaLobeType lastLobe;
+  for (size_t i = 0; i < newGrid->numAzim_; ++i)
+  {
+    const float azim = static_cast<float>(i / newGrid->azimScale_ - M_PI);
+    float *gains = &newGrid->gains_[i * newGrid->numElev_];
+    for (size_t j = 0; j < newGrid->numElev_; ++j)
+    {
+      const float elev = static_cast<float>(j / newGrid->elevScale_ - M_PI_2);
+      gains[j] = calculateGain(&azimTable, &elevTable, lastLobe, azim, elev, hbw, vbw, 0.f, true);
+    }
   }
-}
 
-/* This function returns the gain for lookup table-based antennaPatterns */
+  // keep the most recently used grids, leaving room for this one
+  std::shared_ptr<GridVec> updated(new GridVec);
+  if (grids)
+  {
+    updated->assign(grids->begin(), grids->end());
+    while (updated->size() >= maxGrids_)
+    {
+      GridVec::iterator oldest = updated->begin();
+      for (GridVec::iterator iter = updated->begin(); iter != updated->end(); ++iter)
+      {
+        if ((*iter)->lastUse_.load(std::memory_order_relaxed) < (*oldest)->lastUse_.load(std::memory_order_relaxed))
+          oldest = iter;
+      }
+      updated->erase(oldest);
+    }
+  }
+  updated->push_back(newGrid);
+  std::atomic_store(&grids_, std::shared_ptr<const GridVec>(updated));
+  return newGrid;
+}
 
-float calculateGain(const std::map<float, float> *azimData,
-  const std::map<float, float> *elevData,
-  AntennaLobeType &lastLobe,
-  float azim,
-  float elev,
-  float hbw,
-  float vbw,
-  float maxGain,
-  bool applyWeight)
+float WeightedGainGridCache::sample(const Grid& grid, float azim, float elev)
 {
-  if (!azimData || azimData->size() == 0 || !elevData || elevData->size() == 0)
+  // clamp so that rounding at the ends of the angle ranges stays within the grid
+  const double x = sdkMin(sdkMax((azim + M_PI) * grid.azimScale_, 0.0), static_cast<double>(grid.numAzim_ - 1));
+  const double y = sdkMin(sdkMax((elev + M_PI_2) * grid.elevScale_, 0.0), static_cast<double>(grid.numElev_ - 1));
+  const size_t i = sdkMin(static_cast<size_t>(x), grid.numAzim_ - 2);
+  const size_t j = sdkMin(static_cast<size_t>(y), grid.numElev_ - 2);
+  const double dx = x - i;
+  const double dy = y - j;
+  const float *lo = &grid.gains_[i * grid.numElev_ + j];
+  const float *hi = lo + grid.numElev_;
+  if (lo[0] == SMALL_DB_VAL || lo[1] == SMALL_DB_VAL || hi[0] == SMALL_DB_VAL || hi[1] == SMALL_DB_VAL)
     return SMALL_DB_VAL;
+  return static_cast<float>((lo[0] * (1.0 - dy) + lo[1] * dy) * (1.0 - dx) + (hi[0] * (1.0 - dy) + hi[1] * dy) * dx);
+}
+
+// ----------------------------------------------------------------------------
 
-  if (hbw == 0.f || vbw == 0.f)
+namespace
+{
+  /**
+  * Finds the extreme gains of a compiled table over a range of lookup angles. Gains interpolate linearly between
+  * breakpoints, so the extremes lie at the ends of the range or at breakpoints within it.
+  * @param[in ] table Compiled angle/gain table
+  * @param[in ] minAngle Smallest angle looked up (rad)
+  * @param[in ] maxAngle Largest angle looked up (rad)
+  * @param[out] minGain Minimum gain (dB)
+  * @param[out] maxGain Maximum gain (dB)
+  * @return false if no angle in the range has a gain
+  */
+  bool angleGainLimits(const AngleGainTable& table, float minAngle, float maxAngle, float &minGain, float &maxGain)
   {
-    assert(0); // hbw and vbw must be non-zero to avoid divide-by-zero errors
-    return SMALL_DB_VAL;
+    minGain = -SMALL_DB_VAL;
+    maxGain = SMALL_DB_VAL;
+    const float ends[2] = { table.gain(minAngle), table.gain(maxAngle) };
+    for (size_t i = 0; i < 2; ++i)
+    {
+      if (ends[i] == SMALL_DB_VAL)
+        continue;
+      minGain = sdkMin(minGain, ends[i]);
+      maxGain = sdkMax(maxGain, ends[i]);
+    }
+    const float *angles = table.angles();
+    const float *gains = table.gains();
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+      if (angles[i] < minAngle || angles[i] > maxAngle)
+        continue;
+      minGain = sdkMin(minGain, gains[i]);
+      maxGain = sdkMax(maxGain, gains[i]);
+    }
+    return minGain <= maxGain;
   }
 
-  float gain = SMALL_DB_VAL;
-
-  if (!applyWeight)
+  /**
+  * Finds the extreme unweighted gains of an azimuth/elevation table pattern over all directions, relative to the
+  * reference gain. Unweighted gains are the mean of independent azimuth and elevation lookups, so their extremes
+  * are the means of the extremes of each table.
+  * @param[in ] azimTable Compiled azimuth gain table
+  * @param[in ] elevTable Compiled elevation gain table
+  * @param[out] minGain Minimum gain (dB), -SMALL_DB_VAL if no direction has a gain
+  * @param[out] maxGain Maximum gain (dB), SMALL_DB_VAL if no direction has a gain
+  */
+  void tableGainLimits(const AngleGainTable& azimTable, const AngleGainTable& elevTable, float &minGain, float &maxGain)
   {
-    const float az_gain = gainAtAngle(static_cast<float>(azim), *azimData);
-    if (az_gain == SMALL_DB_VAL)
-      return SMALL_DB_VAL;
-    const float el_gain = gainAtAngle(static_cast<float>(elev), *elevData);
-    if (el_gain == SMALL_DB_VAL)
-      return SMALL_DB_VAL;
-
-    gain = maxGain + (az_gain + el_gain) / 2.0f;
+    // lookups are at angFixPI(azim) and angFixPI2(elev)
+    float azimMin, azimMax, elevMin, elevMax;
+    if (!angleGainLimits(azimTable, static_cast<float>(-M_PI), static_cast<float>(M_PI), azimMin, azimMax) ||
+      !angleGainLimits(elevTable, static_cast<float>(-M_PI_2), static_cast<float>(M_PI_2), elevMin, elevMax))
+    {
+      minGain = -SMALL_DB_VAL;
+      maxGain = SMALL_DB_VAL;
+      return;
+    }
+    minGain = (azimMin + elevMin) / 2.0f;
+    maxGain = (azimMax + elevMax) / 2.0f;
   }
 
-  // Compute angular distance in normalized beam widths
-  const double azim_bw = azim / hbw;
-  const double elev_bw = elev / vbw;
-  const double phi = sqrt(square(azim_bw) + square(elev_bw));
-
-  // Determine lobe
-  if (phi < 1.29)
-    lastLobe = ANTENNA_LOBE_MAIN;
-  else if (phi < 4.0)
-    lastLobe = ANTENNA_LOBE_SIDE;
-  else if (phi < 5.0)
-    lastLobe = ANTENNA_LOBE_SIDE;
-  else
-    lastLobe = ANTENNA_LOBE_BACK;
+  /**
+  * Applies the reference gain to extreme gains from tableGainLimits(), as minMaxGain() reports them
+  * @param[out] min Minimum gain value to set (dB)
+  * @param[out] max Maximum gain value to set (dB)
+  * @param[in ] valid Validity of the pattern
+  * @param[in ] minGain Minimum gain relative to the reference gain (dB)
+  * @param[in ] maxGain Maximum gain relative to the reference gain (dB)
+  * @param[in ] params Gain parameters to apply
+  */
+  void tableMinMaxGain(float *min, float *max, bool valid, float minGain, float maxGain, const AntennaGainParameters &params)
+  {
+    // gain() has no value for an invalid pattern, where no direction has a gain, or for zero beam widths
+    if (!valid || minGain > maxGain || params.hbw_ == 0.f || params.vbw_ == 0.f)
+    {
+      *min = -SMALL_DB_VAL;
+      *max = SMALL_DB_VAL;
+      return;
+    }
+    *min = params.refGain_ + minGain;
+    *max = params.refGain_ + maxGain;
+  }
 
-  if (!applyWeight)
-    return gain;
+  /**
+  * Finds the largest gain of a compiled table over a range of lookup angles, the range limited counterpart of
+  * angleGainLimits() that only visits the breakpoints within the range
+  * @param[in ] table Compiled angle/gain table
+  * @param[in ] minAngle Smallest angle looked up (rad)
+  * @param[in ] maxAngle Largest angle looked up (rad)
+  * @param[out] maxGain Maximum gain (dB)
+  * @return false if no angle in the range has a gain
+  */
+  bool angleGainPeak(const AngleGainTable& table, float minAngle, float maxAngle, float &maxGain)
+  {
+    bool found = false;
+    maxGain = SMALL_DB_VAL;
+    const float ends[2] = { table.gain(minAngle), table.gain(maxAngle) };
+    for (size_t i = 0; i < 2; ++i)
+    {
+      if (ends[i] == SMALL_DB_VAL)
+        continue;
+      found = true;
+      maxGain = sdkMax(maxGain, ends[i]);
+    }
+    // breakpoints from the one minAngle interpolates toward, up to maxAngle
+    const float *angles = table.angles();
+    const float *gains = table.gains();
+    for (size_t i = table.locate(minAngle); i < table.size() && !(angles[i] > maxAngle); ++i)
+    {
+      found = true;
+      maxGain = sdkMax(maxGain, gains[i]);
+    }
+    return found;
+  }
 
-  const double azim_ang = sdkMin(phi * hbw, M_PI);
-  const float az_gain = gainAtAngle(static_cast<float>(azim_ang), *azimData);
-  if (az_gain == SMALL_DB_VAL)
-    return SMALL_DB_VAL;
+  /**
+  * Bounds the gain of an azimuth/elevation table pattern over a sector of lookup directions, see
+  * AntennaPattern::upperBoundGain(). Unweighted gains are the mean of the table gains at the azimuth and elevation;
+  * weighted gains average the tables looked up at the normalized beam distance of the direction scaled by each beam
+  * width, so they stay below the larger table peak over the distances within the sector.
+  * @param[in ] azimTable Compiled azimuth gain table, may be nullptr
+  * @param[in ] elevTable Compiled elevation gain table, may be nullptr
+  * @param[in ] grids Rasterized weighted gains used by the pattern, nullptr if none
+  * @param[in ] azimMin Smallest azimuth looked up (rad)
+  * @param[in ] azimMax Largest azimuth looked up (rad)
+  * @param[in ] elevMin Smallest elevation looked up (rad)
+  * @param[in ] elevMax Largest elevation looked up (rad)
+  * @param[in ] hbw Horizontal beam width (rad)
+  * @param[in ] vbw Vertical beam width (rad)
+  * @param[in ] maxGain Gain added to the table gains (dB)
+  * @param[in ] weighting Whether gains are weighted
+  * @return gain bound (dB), SMALL_DB_VAL if no direction in the sector has a gain
+  */
+  float tableUpperBoundGain(const AngleGainTable *azimTable, const AngleGainTable *elevTable, const WeightedGainGridCache *grids,
+    float azimMin, float azimMax, float elevMin, float elevMax, float hbw, float vbw, float maxGain, bool weighting)
+  {
+    if (!azimTable || azimTable->empty() || !elevTable || elevTable->empty() || hbw == 0.f || vbw == 0.f)
+      return SMALL_DB_VAL;
 
-  const double elev_ang = sdkMin(phi * vbw, M_PI_2);
-  const float el_gain = gainAtAngle(static_cast<float>(elev_ang), *elevData);
-  if (el_gain == SMALL_DB_VAL)
-    return SMALL_DB_VAL;
+    float azimPeak = SMALL_DB_VAL;
+    float elevPeak = SMALL_DB_VAL;
+    if (!weighting)
+    {
+      if (!angleGainPeak(*azimTable, azimMin, azimMax, azimPeak) || !angleGainPeak(*elevTable, elevMin, elevMax, elevPeak))
+        return SMALL_DB_VAL;
+      return roundBoundUp(maxGain + (azimPeak + elevPeak) / 2.0f);
+    }
 
-  // Determine angles (alpha & beta) associated with normalized
-  // azim / elev components.  They will be used to obtain a
-  // 'weighted average' antenna loss value
-  if ((azim_bw == 0.0 && elev_bw == 0.0) || vbw == hbw)
-    return maxGain + (az_gain + el_gain) / 2.0f;
+    // rasterized grids interpolate gains of directions up to a grid cell outside the sector
+    const double pad = ((grids && grids->enabled()) ? grids->resolution() : 0.0) + BOUND_ANGLE_MARGIN;
+    const double azim[2] = { sdkMax(azimMin - pad, -M_PI), sdkMin(azimMax + pad, M_PI) };
+    const double elev[2] = { sdkMax(elevMin - pad, -M_PI_2), sdkMin(elevMax + pad, M_PI_2) };
+    // normalized beam distances nearest to and farthest from boresight
+    const double nearAzim = (azim[0] > 0.0) ? azim[0] : ((azim[1] < 0.0) ? -azim[1] : 0.0);
+    const double nearElev = (elev[0] > 0.0) ? elev[0] : ((elev[1] < 0.0) ? -elev[1] : 0.0);
+    const double phiMin = sqrt(square(nearAzim / hbw) + square(nearElev / vbw));
+    const double phiMax = sqrt(square(sdkMax(fabs(azim[0]), fabs(azim[1])) / hbw) + square(sdkMax(fabs(elev[0]), fabs(elev[1])) / vbw));
+    // lookup angles, ordered since beam widths may be negative
+    const double azimAngles[2] = { sdkMin(phiMin * hbw, M_PI), sdkMin(phiMax * hbw, M_PI) };
+    const double elevAngles[2] = { sdkMin(phiMin * vbw, M_PI_2), sdkMin(phiMax * vbw, M_PI_2) };
+    if (!angleGainPeak(*azimTable, static_cast<float>(sdkMin(azimAngles[0], azimAngles[1]) - BOUND_ANGLE_MARGIN),
+      static_cast<float>(sdkMax(azimAngles[0], azimAngles[1]) + BOUND_ANGLE_MARGIN), azimPeak) ||
+      !angleGainPeak(*elevTable, static_cast<float>(sdkMin(elevAngles[0], elevAngles[1]) - BOUND_ANGLE_MARGIN),
+      static_cast<float>(sdkMax(elevAngles[0], elevAngles[1]) + BOUND_ANGLE_MARGIN), elevPeak))
+      return SMALL_DB_VAL;
+    return roundBoundUp(maxGain + sdkMax(azimPeak, elevPeak));
+  }
 
-  double alpha, beta;
-  if (azim_bw <= elev_bw)
+  /**
+  * Samples a weighted gain grid at a direction as calculateGain() calls the tables
+  * @param[in ] grid Grid rasterized for the beam widths of the request
+  * @param[in ] azim Relative azimuth angle (rad)
+  * @param[in ] elev Relative elevation angle (rad)
+  * @param[in ] refGain Reference gain of pattern (dB)
+  * @return antenna pattern gain (dB)
+  */
+  inline float weightedGridGain(const WeightedGainGridCache::Grid& grid, float azim, float elev, float refGain)
   {
-    // since atan2 returns values between -pi and pi,
-    // alpha and beta should be in rad instead of deg
-    alpha = fabs(atan2(azim_bw, elev_bw));
-    if (alpha > M_PI_2)
-      alpha = M_PI - alpha;
-    beta = M_PI_2 - alpha;
-    return static_cast<float>(maxGain + (alpha * az_gain + beta * el_gain) / M_PI_2);
+    const float gain = WeightedGainGridCache::sample(grid, static_cast<float>(angFixPI(azim)), static_cast<float>(angFixPI2(elev)));
+    return (gain == SMALL_DB_VAL) ? SMALL_DB_VAL : refGain + gain;
   }
-
-  // since atan2 returns values between -pi and pi,
-  // alpha and beta should be in rad instead of deg
-  beta = fabs(atan2(elev_bw, azim_bw));
-  if (beta > M_PI_2)
-    beta = M_PI - beta;
-  alpha = M_PI_2 - beta;
-  return static_cast<float>(maxGain + (alpha * az_gain + beta * el_gain) / M_PI_2);
 }
 
 // ----------------------------------------------------------------------------
@@ -666,24 +1934,88 @@ float calculateGain(const std::map<float, float> *azimData,
 AntennaPatternTable::AntennaPatternTable(bool type)
   : AntennaPattern(),
   beamWidthType_(type),
-  lastVbw_(-FLT_MAX),
-  lastHbw_(-FLT_MAX),
-  lastGain_(SMALL_DB_VAL)
+  tablesDirty_(false)
 {}
 
-float AntennaPatternTable::gain(const AntennaGainParameters &params)
+float AntennaPatternTable::gain(const AntennaGainParameters &params) const
 {
-  if (!valid_) return SMALL_DB_VAL;
+  if (!valid_) return countedGain(counters_, SMALL_DB_VAL);
+  if (params.weighting_)
+  {
+    const std::shared_ptr<const WeightedGainGridCache::Grid> grid = weightedGrids_.grid(azimTable_, elevTable_, params.hbw_, params.vbw_);
+    if (grid)
+      return countedGain(counters_, weightedGridGain(*grid, params.azim_, params.elev_, params.refGain_));
+  }
+  AntennaLobeType lastLobe;
+  return countedGain(counters_, calculateGain(&azimTable_,
+    &elevTable_,
+    lastLobe,
+    static_cast<float>(angFixPI(params.azim_)),
+    static_cast<float>(angFixPI2(params.elev_)),
+    params.hbw_,
+    params.vbw_,
+    params.refGain_,
+    params.weighting_));
+}
+
+float AntennaPatternTable::cursorGain(const AntennaGainParameters &params, AntennaLookupCursor &cursor) const
+{
+  if (!valid_) return countedGain(counters_, SMALL_DB_VAL);
+  if (params.weighting_)
+  {
+    const std::shared_ptr<const WeightedGainGridCache::Grid> grid = weightedGrids_.grid(azimTable_, elevTable_, params.hbw_, params.vbw_);
+    if (grid)
+      return countedGain(counters_, weightedGridGain(*grid, params.azim_, params.elev_, params.refGain_));
+  }
   AntennaLobeType lastLobe;
-  return calculateGain(&azimData_,
-    &elevData_,
+  const HintedAngleTable azimTable = { azimTable_, cursor.azimIndex_ };
+  const HintedAngleTable elevTable = { elevTable_, cursor.elevIndex_ };
+  return countedGain(counters_, calculateTableGain(&azimTable,
+    &elevTable,
     lastLobe,
     static_cast<float>(angFixPI(params.azim_)),
     static_cast<float>(angFixPI2(params.elev_)),
     params.hbw_,
     params.vbw_,
     params.refGain_,
-    params.weighting_);
+    params.weighting_));
+}
+
+void AntennaPatternTable::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+  CountedGains counted(counters_, gains, count);
+
+  if (!valid_)
+  {
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+    return;
+  }
+  if (params.weighting_)
+  {
+    const std::shared_ptr<const WeightedGainGridCache::Grid> grid = weightedGrids_.grid(azimTable_, elevTable_, params.hbw_, params.vbw_);
+    if (grid)
+    {
+      for (size_t i = 0; i < count; ++i)
+        gains[i] = weightedGridGain(*grid, azim[i], elev[i], params.refGain_);
+      return;
+    }
+  }
+  AntennaLobeType lastLobe;
+  for (size_t i = 0; i < count; ++i)
+  {
+    gains[i] = calculateGain(&azimTable_,
+      &elevTable_,
+      lastLobe,
+      static_cast<float>(angFixPI(azim[i])),
+      static_cast<float>(angFixPI2(elev[i])),
+      params.hbw_,
+      params.vbw_,
+      params.refGain_,
+      params.weighting_);
+  }
 }
 
 int AntennaPatternTable::readPat(std::istream& fp)
@@ -903,48 +2235,73 @@ int AntennaPatternTable::readPat(std::istream& fp)
     delete [] gain[i];
   }
 
+  azimTable_.compile(azimData_);
+  elevTable_.compile(elevData_);
+  tablesDirty_ = false;
+  setGainLimits_();
   valid_ = true;
   return 0;
 }
 
-void AntennaPatternTable::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
+void AntennaPatternTable::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
 {
   assert(min && max);
   if (!min || !max)
     return;
+  countMinMax(counters_, false);
 
-  if (params.vbw_ == lastVbw_ && params.hbw_ == lastHbw_ && params.refGain_ == lastGain_ && minGain_ != -SMALL_DB_VAL)
-  {
-    *min = minGain_;
-    *max = maxGain_;
+  // unweighted extremes, which do not depend on the beam widths
+  tableMinMaxGain(min, max, valid_, minGain_, maxGain_, params);
+}
+
+float AntennaPatternTable::upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const
+{
+  if (!valid_) return SMALL_DB_VAL;
+  return tableUpperBoundGain(&azimTable_, &elevTable_, &weightedGrids_, azimMin, azimMax, elevMin, elevMax, params.hbw_, params.vbw_, params.refGain_, params.weighting_);
+}
+
+void AntennaPatternTable::setGainLimits_()
+{
+  tableGainLimits(azimTable_, elevTable_, minGain_, maxGain_);
+  weightedGrids_.clear();
+}
+
+void AntennaPatternTable::setAzimData(float ang, float gain)
+{
+  // a pattern loaded from a compiled pattern file has only the compiled form
+  if (azimData_.empty())
+    azimTable_.toMap(&azimData_);
+  azimData_[ang] = gain;
+  tablesDirty_ = true;
+  if (valid_)
+    compileTables();
+}
+
+void AntennaPatternTable::setElevData(float ang, float gain)
+{
+  if (elevData_.empty())
+    elevTable_.toMap(&elevData_);
+  elevData_[ang] = gain;
+  tablesDirty_ = true;
+  if (valid_)
+    compileTables();
+}
+
+void AntennaPatternTable::compileTables()
+{
+  if (!tablesDirty_)
     return;
-  }
+  azimTable_.compile(azimData_);
+  elevTable_.compile(elevData_);
+  tablesDirty_ = false;
+  setGainLimits_();
+}
 
-  lastVbw_ = params.vbw_;
-  lastHbw_ = params.hbw_;
-  lastGain_ = params.refGain_;
-  minGain_ = -SMALL_DB_VAL;
-  maxGain_ = SMALL_DB_VAL;
-  // determine min & max values
-  float radius;
-  AntennaGainParameters agp(params);
-  agp.weighting_ = false;
-  for (int ii = -180; ii <= 180; ++ii)
-  {
-    agp.azim_ = static_cast<float>(DEG2RAD*(ii));
-    for (int jj = -90; jj <= 90; ++jj)
-    {
-      agp.elev_ = static_cast<float>(DEG2RAD*(jj));
-      radius = gain(agp);
-      if (radius > SMALL_DB_COMPARE)
-      {
-        minGain_ = sdkMin(minGain_, radius);
-      }
-      maxGain_ = sdkMax(maxGain_, radius);
-    } // end for jj
-  } // end for ii
-  *min = minGain_;
-  *max = maxGain_;
+void AntennaPatternTable::setValid(bool val)
+{
+  if (val)
+    compileTables();
+  valid_ = val;
 }
 
 int AntennaPatternTable::readPat(const std::string& inFileName)
@@ -968,30 +2325,123 @@ int AntennaPatternTable::readPat(const std::string& inFileName)
   return st;
 }
 
+// Sections: scalars {beamWidthType_}, table 0 azimuth, table 1 elevation
+int AntennaPatternTable::writeCompiled(CompiledPatternWriter& writer) const
+{
+  const double scalars[1] = { beamWidthType_ ? 1.0 : 0.0 };
+  AntennaPattern::writeCompiled(writer);
+  writer.addDoubles(COMPILED_SECTION_SCALARS, scalars, 1);
+  writer.addTable(COMPILED_SECTION_TABLE, azimTable_);
+  writer.addTable(COMPILED_SECTION_TABLE + 4, elevTable_);
+  return 0;
+}
+
+int AntennaPatternTable::readCompiled(const CompiledPatternReader& reader)
+{
+  valid_ = false;
+  // the compiled tables are used in place; the setters recover the maps when needed
+  azimData_.clear();
+  elevData_.clear();
+  tablesDirty_ = false;
+  double scalars[1];
+  if (AntennaPattern::readCompiled(reader) != 0 || !readCompiledScalars(reader, scalars, 1) ||
+    reader.readTable(COMPILED_SECTION_TABLE, &azimTable_) != 0 ||
+    reader.readTable(COMPILED_SECTION_TABLE + 4, &elevTable_) != 0)
+    return 1;
+  beamWidthType_ = (scalars[0] != 0.0);
+  setGainLimits_();
+  valid_ = true;
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 /// AntennaPatternRelativeTable methods
 
 AntennaPatternRelativeTable::AntennaPatternRelativeTable()
-  : AntennaPattern(),
-  lastVbw_(-FLT_MAX),
-  lastHbw_(-FLT_MAX),
-  lastGain_(SMALL_DB_VAL)
+  : AntennaPattern()
 {}
 
-float AntennaPatternRelativeTable::gain(const AntennaGainParameters &params)
+float AntennaPatternRelativeTable::gain(const AntennaGainParameters &params) const
 {
   if (!valid_)
-    return SMALL_DB_VAL;
+    return countedGain(counters_, SMALL_DB_VAL);
+  if (params.weighting_)
+  {
+    const std::shared_ptr<const WeightedGainGridCache::Grid> grid = weightedGrids_.grid(azimTable_, elevTable_, params.hbw_, params.vbw_);
+    if (grid)
+      return countedGain(counters_, weightedGridGain(*grid, params.azim_, params.elev_, params.refGain_));
+  }
+  AntennaLobeType lastLobe;
+  return countedGain(counters_, calculateGain(&azimTable_,
+    &elevTable_,
+    lastLobe,
+    static_cast<float>(angFixPI(params.azim_)),
+    static_cast<float>(angFixPI2(params.elev_)),
+    params.hbw_,
+    params.vbw_,
+    params.refGain_,
+    params.weighting_));
+}
+
+float AntennaPatternRelativeTable::cursorGain(const AntennaGainParameters &params, AntennaLookupCursor &cursor) const
+{
+  if (!valid_)
+    return countedGain(counters_, SMALL_DB_VAL);
+  if (params.weighting_)
+  {
+    const std::shared_ptr<const WeightedGainGridCache::Grid> grid = weightedGrids_.grid(azimTable_, elevTable_, params.hbw_, params.vbw_);
+    if (grid)
+      return countedGain(counters_, weightedGridGain(*grid, params.azim_, params.elev_, params.refGain_));
+  }
   AntennaLobeType lastLobe;
-  return calculateGain(&azimData_,
-    &elevData_,
+  const HintedAngleTable azimTable = { azimTable_, cursor.azimIndex_ };
+  const HintedAngleTable elevTable = { elevTable_, cursor.elevIndex_ };
+  return countedGain(counters_, calculateTableGain(&azimTable,
+    &elevTable,
     lastLobe,
     static_cast<float>(angFixPI(params.azim_)),
     static_cast<float>(angFixPI2(params.elev_)),
     params.hbw_,
     params.vbw_,
     params.refGain_,
-    params.weighting_);
+    params.weighting_));
+}
+
+void AntennaPatternRelativeTable::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+  CountedGains counted(counters_, gains, count);
+
+  if (!valid_)
+  {
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+    return;
+  }
+  if (params.weighting_)
+  {
+    const std::shared_ptr<const WeightedGainGridCache::Grid> grid = weightedGrids_.grid(azimTable_, elevTable_, params.hbw_, params.vbw_);
+    if (grid)
+    {
+      for (size_t i = 0; i < count; ++i)
+        gains[i] = weightedGridGain(*grid, azim[i], elev[i], params.refGain_);
+      return;
+    }
+  }
+  AntennaLobeType lastLobe;
+  for (size_t i = 0; i < count; ++i)
+  {
+    gains[i] = calculateGain(&azimTable_,
+      &elevTable_,
+      lastLobe,
+      static_cast<float>(angFixPI(azim[i])),
+      static_cast<float>(angFixPI2(elev[i])),
+      params.hbw_,
+      params.vbw_,
+      params.refGain_,
+      params.weighting_);
+  }
 }
 
 int AntennaPatternRelativeTable::readPat_(std::istream& fp)
@@ -1134,48 +2584,34 @@ int AntennaPatternRelativeTable::readPat_(std::istream& fp)
     }
   }
 
+  azimTable_.compile(azimData_);
+  elevTable_.compile(elevData_);
+  setGainLimits_();
   valid_ = true;
   return 0;
 }
 
-void AntennaPatternRelativeTable::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
+void AntennaPatternRelativeTable::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
 {
   assert(min && max);
   if (!min || !max)
     return;
+  countMinMax(counters_, false);
 
-  if (params.vbw_ == lastVbw_ && params.hbw_ == lastHbw_ && params.refGain_ == lastGain_ && minGain_ != -SMALL_DB_VAL)
-  {
-    *min = minGain_;
-    *max = maxGain_;
-    return;
-  }
+  // unweighted extremes, which do not depend on the beam widths
+  tableMinMaxGain(min, max, valid_, minGain_, maxGain_, params);
+}
 
-  lastVbw_ = params.vbw_;
-  lastHbw_ = params.hbw_;
-  lastGain_ = params.refGain_;
-  minGain_ = -SMALL_DB_VAL;
-  maxGain_ = SMALL_DB_VAL;
-  // determine min & max values
-  float radius;
-  AntennaGainParameters agp(params);
-  agp.weighting_ = false;
-  for (int ii = -180; ii <= 180; ++ii)
-  {
-    agp.azim_ = static_cast<float>(DEG2RAD*(ii));
-    for (int jj = -90; jj <= 90; ++jj)
-    {
-      agp.elev_ = static_cast<float>(DEG2RAD*(jj));
-      radius = gain(agp);
-      if (radius > SMALL_DB_COMPARE)
-      {
-        minGain_ = sdkMin(minGain_, radius);
-      }
-      maxGain_ = sdkMax(maxGain_, radius);
-    } // end for jj
-  } // end for ii
-  *min = minGain_;
-  *max = maxGain_;
+float AntennaPatternRelativeTable::upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const
+{
+  if (!valid_) return SMALL_DB_VAL;
+  return tableUpperBoundGain(&azimTable_, &elevTable_, &weightedGrids_, azimMin, azimMax, elevMin, elevMax, params.hbw_, params.vbw_, params.refGain_, params.weighting_);
+}
+
+void AntennaPatternRelativeTable::setGainLimits_()
+{
+  tableGainLimits(azimTable_, elevTable_, minGain_, maxGain_);
+  weightedGrids_.clear();
 }
 
 int AntennaPatternRelativeTable::readPat(const std::string& inFileName)
@@ -1199,6 +2635,51 @@ int AntennaPatternRelativeTable::readPat(const std::string& inFileName)
   return st;
 }
 
+// Sections: table 0 azimuth, table 1 elevation
+int AntennaPatternRelativeTable::writeCompiled(CompiledPatternWriter& writer) const
+{
+  AntennaPattern::writeCompiled(writer);
+  writer.addTable(COMPILED_SECTION_TABLE, azimTable_);
+  writer.addTable(COMPILED_SECTION_TABLE + 4, elevTable_);
+  return 0;
+}
+
+int AntennaPatternRelativeTable::readCompiled(const CompiledPatternReader& reader)
+{
+  valid_ = false;
+  azimData_.clear();
+  elevData_.clear();
+  if (AntennaPattern::readCompiled(reader) != 0 ||
+    reader.readTable(COMPILED_SECTION_TABLE, &azimTable_) != 0 ||
+    reader.readTable(COMPILED_SECTION_TABLE + 4, &elevTable_) != 0)
+    return 1;
+  setGainLimits_();
+  valid_ = true;
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+/// 2D lookup table helper functions
+
+namespace
+{
+  /**
+  * Copies a 2D lookup table, converting each entry
+  * @param[in ] from Table to copy
+  * @param[out] to Table to fill, with the extents of from
+  * @param[in ] convert Function converting an entry of from to an entry of to
+  */
+  template <typename From, typename To, typename Convert>
+  void convertGrid(const GridTable<From>& from, GridTable<To>& to, Convert convert)
+  {
+    std::vector<To> values;
+    values.reserve(from.size());
+    for (size_t k = 0; k < from.size(); ++k)
+      values.push_back(convert(from.values()[k]));
+    to.assign(from.minX(), from.maxX(), from.numX(), from.minY(), from.maxY(), from.numY(), std::move(values));
+  }
+}
+
 // ----------------------------------------------------------------------------
 /// AntennaPatternCRUISE methods
 
@@ -1211,26 +2692,11 @@ AntennaPatternCRUISE::AntennaPatternCRUISE()
   elevMin_(0),
   azimStep_(0),
   elevStep_(0),
-  freqData_(nullptr),
-  azimData_(nullptr),
-  elevData_(nullptr)
-{}
-
-void AntennaPatternCRUISE::reset_()
-{
-  int i;
-  for (i = 0; i < freqLen_; i++)
-  {
-    if (azimData_ && azimData_[i])
-      delete [] azimData_[i];
-    if (elevData_ && elevData_[i])
-      delete [] elevData_[i];
-  }
-
-  delete [] freqData_;
-  delete [] azimData_;
-  delete [] elevData_;
+  singlePrecision_(false)
+{}
 
+void AntennaPatternCRUISE::reset_()
+{
   valid_ = false;
   filename_.clear();
   azimLen_= 0;
@@ -1240,122 +2706,375 @@ void AntennaPatternCRUISE::reset_()
   elevMin_= 0;
   azimStep_= 0;
   elevStep_= 0;
-  freqData_ = nullptr;
-  azimData_ = nullptr;
-  elevData_ = nullptr;
+  freqData_.clear();
+  gains_.clear();
+  floatGains_.clear();
   minGain_ = -SMALL_DB_VAL;
   maxGain_ = SMALL_DB_VAL;
 }
 
-float AntennaPatternCRUISE::gain(const AntennaGainParameters &params)
+void AntennaPatternCRUISE::setSinglePrecision(bool singlePrecision)
 {
-  if (!valid_) return SMALL_DB_VAL;
-
-  int alowindex=0;
-  int elowindex=0;
-  int flowindex=0;
-  double adelta=0;
-  double edelta=0;
-  double fdelta=0;
-
-  double dazim = RAD2DEG*(angFixPI(params.azim_));
-  double delev = RAD2DEG*(angFixPI(params.elev_));
+  if (singlePrecision == singlePrecision_)
+    return;
+  singlePrecision_ = singlePrecision;
+  if (!singlePrecision_ && !floatGains_.empty())
+  {
+    convertGrid(floatGains_, gains_, [](float value) { return static_cast<double>(value); });
+    floatGains_.clear();
+  }
+  applyPrecision_();
+}
 
-  // need at least two points to interpolate
-  assert(azimLen_ >= 2 && freqLen_ >= 2);
+void AntennaPatternCRUISE::applyPrecision_()
+{
+  if (!singlePrecision_ || gains_.empty())
+    return;
+  convertGrid(gains_, floatGains_, [](double value) { return static_cast<float>(value); });
+  gains_.clear();
+}
 
-  // Interpolate azimuth
-  if (dazim <= azimMin_)
+namespace
+{
+  /**
+  * Determines the lower interpolation index and fractional offset for a value on a uniformly spaced CRUISE angle axis,
+  * clamping to the end points of the axis
+  * @param[in ] value Angle to locate (deg)
+  * @param[in ] minVal Minimum angle of the axis (deg)
+  * @param[in ] step Angle step of the axis (deg)
+  * @param[in ] len Number of angles in the axis, must be at least 2
+  * @param[out] lowIndex Index of the lower interpolation point
+  * @param[out] delta Fractional offset from the lower interpolation point, in [0, 1]
+  */
+  inline void cruiseAngleIndex(double value, double minVal, double step, int len, int &lowIndex, double &delta)
   {
-    alowindex = 0;
-    adelta    = 0.0;
+    if (value <= minVal)
+    {
+      lowIndex = 0;
+      delta    = 0.0;
+    }
+    else if (value >= minVal + step * (len-1))
+    {
+      lowIndex = len-2;
+      delta    = 1.0;
+    }
+    else
+    {
+      double temp      = (value-minVal);
+      if (step != 0.0)
+        temp    = temp/step;
+      lowIndex = static_cast<int>(floor(temp));
+      delta    = temp - lowIndex;
+    }
   }
-  else if (dazim >= azimMin_ + azimStep_ * (azimLen_-1))
+
+  /**
+  * Bilinearly interpolates a CRUISE gain block stored angle major, see AntennaPatternCRUISE::gains_
+  * @param[in ] block First gain of the azimuth or elevation block
+  * @param[in ] freqLen Number of frequencies in the block
+  * @param[in ] alowindex Index of the lower angle, from cruiseAngleIndex()
+  * @param[in ] adelta Fractional offset from the lower angle
+  * @param[in ] flowindex Index of the lower frequency
+  * @param[in ] fdelta Fractional offset from the lower frequency
+  * @return interpolated voltage gain
+  */
+  template <typename T>
+  inline double cruiseBlockGain(const T *block, int freqLen, int alowindex, double adelta, int flowindex, double fdelta)
   {
-    alowindex = azimLen_-2;
-    adelta    = 1.0;
+    const T *lo = block + static_cast<size_t>(alowindex) * freqLen + flowindex;
+    const T *hi = lo + freqLen;
+    return lo[0]*(1.0-fdelta)*(1.0-adelta) +
+      hi[0]*(1.0-fdelta)*     adelta  +
+      lo[1]*     fdelta *(1.0-adelta) +
+      hi[1]*     fdelta *     adelta;
   }
-  else
+
+  /**
+  * Finds the largest voltage gain magnitude of a CRUISE gain block over a range of angles, which bounds the
+  * magnitude of cruiseBlockGain() between them
+  * @param[in ] block First gain of the azimuth or elevation block
+  * @param[in ] freqLen Number of frequencies in the block
+  * @param[in ] lowIndex Index of the first angle
+  * @param[in ] highIndex Index of the last angle
+  * @param[in ] flowindex Index of the lower frequency
+  * @param[in ] highFreq Whether the next frequency is interpolated as well
+  * @return largest voltage gain magnitude
+  */
+  template <typename T>
+  inline double cruiseBlockPeak(const T *block, int freqLen, int lowIndex, int highIndex, int flowindex, bool highFreq)
   {
-    double temp      = (dazim-azimMin_);
-    if (azimStep_ != 0.0)
-      temp    = temp/azimStep_;
-    alowindex = static_cast<int>(floor(temp));
-    adelta    = temp - alowindex;
+    double peak = 0.0;
+    for (int i = lowIndex; i <= highIndex; ++i)
+    {
+      const T *row = block + static_cast<size_t>(i) * freqLen + flowindex;
+      peak = sdkMax(peak, fabs(static_cast<double>(row[0])));
+      if (highFreq)
+        peak = sdkMax(peak, fabs(static_cast<double>(row[1])));
+    }
+    return peak;
   }
+}
 
-  // Interpolate elevation
-  if (delev <= elevMin_)
+void AntennaPatternCRUISE::freqIndex_(double freq, int &flowindex, double &fdelta, size_t *hint) const
+{
+  // negated so that a NaN frequency uses the first table
+  if (!(freq > freqData_[0]))
   {
-    elowindex = 0;
-    edelta    = 0.0;
+    flowindex  = 0;
+    fdelta     = 0.0;
   }
-  else if (delev >= elevMin_ + elevStep_ * (elevLen_-1))
+  else if (freq >= freqData_[freqLen_-1])
   {
-    elowindex = elevLen_-2;
-    edelta    = 1.0;
+    flowindex  = freqLen_-2;
+    fdelta     = 1.0;
   }
   else
   {
-    double temp      = (delev-elevMin_);
-    if (elevStep_ != 0.0)
-      temp    = temp/elevStep_;
-    elowindex = static_cast<int>(floor(temp));
-    edelta    = temp - elowindex;
+    // freq lies strictly inside the table, so the first frequency above it is in [1, freqLen_-1]
+    if (hint && bracketNear(freqData_, freq, *hint))
+      flowindex = static_cast<int>(*hint);
+    else
+    {
+      const std::vector<double>::const_iterator upper = std::upper_bound(freqData_.begin() + 1, freqData_.end() - 1, freq);
+      flowindex = static_cast<int>(upper - freqData_.begin()) - 1;
+      if (hint)
+        *hint = static_cast<size_t>(flowindex);
+    }
+    fdelta = (freq - freqData_[flowindex]);
+    double denom = (freqData_[flowindex + 1] - freqData_[flowindex]);
+    if (denom != 0.0)
+      fdelta = fdelta / denom;
   }
+}
+
+float AntennaPatternCRUISE::gain(const AntennaGainParameters &params) const
+{
+  if (!valid_) return countedGain(counters_, SMALL_DB_VAL);
+
+  // need at least two points to interpolate
+  assert(azimLen_ >= 2 && freqLen_ >= 2);
 
   // Interpolate frequency
-  if (params.freq_ <= freqData_[0])
+  int flowindex=0;
+  double fdelta=0;
+  freqIndex_(params.freq_, flowindex, fdelta);
+  return countedGain(counters_, gain_(params.azim_, params.elev_, flowindex, fdelta));
+}
+
+float AntennaPatternCRUISE::cursorGain(const AntennaGainParameters &params, AntennaLookupCursor &cursor) const
+{
+  if (!valid_) return countedGain(counters_, SMALL_DB_VAL);
+
+  // need at least two points to interpolate
+  assert(azimLen_ >= 2 && freqLen_ >= 2);
+
+  // Interpolate frequency, starting from the frequencies of the previous query
+  int flowindex=0;
+  double fdelta=0;
+  freqIndex_(params.freq_, flowindex, fdelta, &cursor.freqIndex_);
+  return countedGain(counters_, gain_(params.azim_, params.elev_, flowindex, fdelta));
+}
+
+void AntennaPatternCRUISE::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+  CountedGains counted(counters_, gains, count);
+
+  if (!valid_)
   {
-    flowindex  = 0;
-    fdelta     = 0.0;
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+    return;
   }
-  else if (params.freq_ >= freqData_[freqLen_-1])
+
+  // need at least two points to interpolate
+  assert(azimLen_ >= 2 && freqLen_ >= 2);
+
+  // frequency is shared by all directions, interpolate it once
+  int flowindex=0;
+  double fdelta=0;
+  freqIndex_(params.freq_, flowindex, fdelta);
+  for (size_t i = 0; i < count; ++i)
+    gains[i] = gain_(azim[i], elev[i], flowindex, fdelta);
+}
+
+/// Evaluates a CRUISE pattern from azimuth and elevation tables blended for one frequency
+class AntennaPatternCRUISE::FrequencyEvaluator : public AntennaPatternEvaluator
+{
+public:
+  /**
+  * Blends the tables of the pattern for the frequency
+  * @param[in ] pattern Valid pattern to evaluate
+  * @param[in ] freq Frequency to evaluate the pattern at (Hz)
+  */
+  FrequencyEvaluator(const AntennaPatternCRUISE& pattern, double freq)
+    : AntennaPatternEvaluator(pattern, freq),
+    azimLen_(pattern.azimLen_),
+    elevLen_(pattern.elevLen_),
+    azimMin_(pattern.azimMin_),
+    elevMin_(pattern.elevMin_),
+    azimStep_(pattern.azimStep_),
+    elevStep_(pattern.elevStep_)
   {
-    flowindex  = freqLen_-2;
-    fdelta     = 1.0;
+    int flowindex = 0;
+    double fdelta = 0.0;
+    pattern.freqIndex_(freq, flowindex, fdelta);
+    azimGains_.resize(azimLen_);
+    elevGains_.resize(elevLen_);
+    const size_t elevOffset = static_cast<size_t>(azimLen_) * pattern.freqLen_;
+    for (int i = 0; i < azimLen_; ++i)
+      azimGains_[i] = blend_(pattern, static_cast<size_t>(i) * pattern.freqLen_ + flowindex, fdelta);
+    for (int i = 0; i < elevLen_; ++i)
+      elevGains_[i] = blend_(pattern, elevOffset + static_cast<size_t>(i) * pattern.freqLen_ + flowindex, fdelta);
   }
-  else
+
+  virtual float gain(const AntennaGainParameters &params) const
   {
-    for (int i = 1; i < freqLen_; i++)
-    {
-      if (params.freq_ < freqData_[i])
-      {
-        flowindex = i - 1;
-        fdelta = (params.freq_ - freqData_[flowindex]);
-        double denom = (freqData_[flowindex + 1] - freqData_[flowindex]);
-        if (denom != 0.0)
-          fdelta = fdelta / denom;
-        break;
-      }
-    }
+    return countedGain(counters_(), gain_(params.azim_, params.elev_));
+  }
+
+  virtual void gainBatch(const AntennaGainParameters& /*params*/, const float *azim, const float *elev, size_t count, float *gains) const
+  {
+    assert(count == 0 || (azim && elev && gains));
+    if (count == 0 || !azim || !elev || !gains)
+      return;
+    CountedGains counted(counters_(), gains, count);
+    for (size_t i = 0; i < count; ++i)
+      gains[i] = gain_(azim[i], elev[i]);
+  }
+
+private:
+  /**
+  * Blends a gain with the gain of the next frequency
+  * @param[in ] pattern Pattern holding the gains
+  * @param[in ] index Index in the pattern gains of the gain at the lower frequency
+  * @param[in ] fdelta Fractional offset from the lower frequency
+  * @return blended voltage gain
+  */
+  static double blend_(const AntennaPatternCRUISE& pattern, size_t index, double fdelta)
+  {
+    if (pattern.singlePrecision_)
+      return pattern.floatGains_.values()[index]*(1.0-fdelta) + pattern.floatGains_.values()[index + 1]*fdelta;
+    return pattern.gains_.values()[index]*(1.0-fdelta) + pattern.gains_.values()[index + 1]*fdelta;
   }
 
-  double azGain = (azimData_[flowindex  ][alowindex  ]*(1.0-fdelta)*(1.0-adelta) +
-    azimData_[flowindex  ][alowindex+1]*(1.0-fdelta)*     adelta  +
-    azimData_[flowindex+1][alowindex  ]*     fdelta *(1.0-adelta) +
-    azimData_[flowindex+1][alowindex+1]*     fdelta *     adelta);
+  /**
+  * Computes the gain for a single direction
+  * @param[in ] azim Relative azimuth angle (rad)
+  * @param[in ] elev Relative elevation angle (rad)
+  * @return antenna pattern gain
+  */
+  float gain_(float azim, float elev) const
+  {
+    int alowindex=0;
+    int elowindex=0;
+    double adelta=0;
+    double edelta=0;
+    cruiseAngleIndex(RAD2DEG*(angFixPI(azim)), azimMin_, azimStep_, azimLen_, alowindex, adelta);
+    cruiseAngleIndex(RAD2DEG*(angFixPI(elev)), elevMin_, elevStep_, elevLen_, elowindex, edelta);
+    const double azGain = azimGains_[alowindex]*(1.0-adelta) + azimGains_[alowindex+1]*adelta;
+    const double elGain = elevGains_[elowindex]*(1.0-edelta) + elevGains_[elowindex+1]*edelta;
+    // voltage gains, see AntennaPatternCRUISE::gain_()
+    return static_cast<float>(square(azGain * elGain));
+  }
+
+  int azimLen_;                     ///< Size of azimuth table
+  int elevLen_;                     ///< Size of elevation table
+  double azimMin_;                  ///< Minimum azimuth value (deg)
+  double elevMin_;                  ///< Minimum elevation value (deg)
+  double azimStep_;                 ///< Azimuth step value (deg)
+  double elevStep_;                 ///< Elevation step value (deg)
+  std::vector<double> azimGains_;   ///< Azimuth voltage gains at the bound frequency
+  std::vector<double> elevGains_;   ///< Elevation voltage gains at the bound frequency
+};
+
+std::unique_ptr<AntennaPatternEvaluator> AntennaPatternCRUISE::bindFrequency(double freq) const
+{
+  if (!valid_)
+    return AntennaPattern::bindFrequency(freq);
+  return std::unique_ptr<AntennaPatternEvaluator>(new FrequencyEvaluator(*this, freq));
+}
+
+float AntennaPatternCRUISE::gain_(float azim, float elev, int flowindex, double fdelta) const
+{
+  int alowindex=0;
+  int elowindex=0;
+  double adelta=0;
+  double edelta=0;
+
+  double dazim = RAD2DEG*(angFixPI(azim));
+  double delev = RAD2DEG*(angFixPI(elev));
+
+  // Interpolate azimuth
+  cruiseAngleIndex(dazim, azimMin_, azimStep_, azimLen_, alowindex, adelta);
 
-  double elGain = (elevData_[flowindex  ][elowindex  ]*(1.0-fdelta)*(1.0-edelta) +
-    elevData_[flowindex  ][elowindex+1]*(1.0-fdelta)*     edelta  +
-    elevData_[flowindex+1][elowindex  ]*     fdelta *(1.0-edelta) +
-    elevData_[flowindex+1][elowindex+1]*     fdelta *     edelta);
+  // Interpolate elevation
+  cruiseAngleIndex(delev, elevMin_, elevStep_, elevLen_, elowindex, edelta);
+
+  const size_t elevOffset = static_cast<size_t>(azimLen_) * freqLen_;
+  double azGain;
+  double elGain;
+  if (singlePrecision_)
+  {
+    azGain = cruiseBlockGain(floatGains_.values(), freqLen_, alowindex, adelta, flowindex, fdelta);
+    elGain = cruiseBlockGain(floatGains_.values() + elevOffset, freqLen_, elowindex, edelta, flowindex, fdelta);
+  }
+  else
+  {
+    azGain = cruiseBlockGain(gains_.values(), freqLen_, alowindex, adelta, flowindex, fdelta);
+    elGain = cruiseBlockGain(gains_.values() + elevOffset, freqLen_, elowindex, edelta, flowindex, fdelta);
+  }
 
   // CRUISE Antenna Table data are saved as voltage gains instead of power gains
   // We expect all gains to be power gains, hence the square.
   return static_cast<float>(square(azGain * elGain));
 }
 
-void AntennaPatternCRUISE::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
+void AntennaPatternCRUISE::minMaxGain(float *min, float *max, const AntennaGainParameters& /*params*/) const
 {
   assert(min && max);
   if (!min || !max)
     return;
+  countMinMax(counters_, false);
 
   *min = minGain_;
   *max = maxGain_;
 }
 
+float AntennaPatternCRUISE::upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const
+{
+  if (!valid_) return SMALL_DB_VAL;
+
+  int flowindex = 0;
+  double fdelta = 0;
+  freqIndex_(params.freq_, flowindex, fdelta);
+  // angles clamp to the ends of each axis; each located angle interpolates toward the next one
+  const double margin = RAD2DEG*BOUND_ANGLE_MARGIN;
+  int azimLow, azimHigh, elevLow, elevHigh;
+  double delta = 0;
+  cruiseAngleIndex(RAD2DEG*azimMin - margin, azimMin_, azimStep_, azimLen_, azimLow, delta);
+  cruiseAngleIndex(RAD2DEG*azimMax + margin, azimMin_, azimStep_, azimLen_, azimHigh, delta);
+  cruiseAngleIndex(RAD2DEG*elevMin - margin, elevMin_, elevStep_, elevLen_, elevLow, delta);
+  cruiseAngleIndex(RAD2DEG*elevMax + margin, elevMin_, elevStep_, elevLen_, elevHigh, delta);
+
+  const size_t elevOffset = static_cast<size_t>(azimLen_) * freqLen_;
+  double azPeak;
+  double elPeak;
+  if (singlePrecision_)
+  {
+    azPeak = cruiseBlockPeak(floatGains_.values(), freqLen_, azimLow, azimHigh + 1, flowindex, fdelta > 0.0);
+    elPeak = cruiseBlockPeak(floatGains_.values() + elevOffset, freqLen_, elevLow, elevHigh + 1, flowindex, fdelta > 0.0);
+  }
+  else
+  {
+    azPeak = cruiseBlockPeak(gains_.values(), freqLen_, azimLow, azimHigh + 1, flowindex, fdelta > 0.0);
+    elPeak = cruiseBlockPeak(gains_.values() + elevOffset, freqLen_, elevLow, elevHigh + 1, flowindex, fdelta > 0.0);
+  }
+  // gains are linear power, so the padding is relative
+  return std::nextafter(static_cast<float>(square(azPeak * elPeak) * (1.0 + 1e-6)), std::numeric_limits<float>::max());
+}
+
 int AntennaPatternCRUISE::readPat_(std::istream& fp)
 {
   assert(fp);
@@ -1379,10 +3098,16 @@ int AntennaPatternCRUISE::readPat_(std::istream& fp)
   // Read in Azimuth #angle limits
   fp >> azimMin_ >> azimStep_;
 
+  // need at least two points to interpolate
+  if (!fp || azimLen_ < 2 || freqLen_ < 2)
+  {
+    SIM_ERROR << "CRUISE azimLen_(" << azimLen_ << ") and freqLen_(" << freqLen_ << ") must be at least 2!" << std::endl;
+    reset_();
+    return 1;
+  }
+
   // Allocate tables
-  freqData_ = new double[freqLen_];
-  elevData_ = new double*[freqLen_];
-  azimData_ = new double*[freqLen_];
+  freqData_.resize(freqLen_);
 
   // Read in freq pattern table
   for (i = 0; i < freqLen_; i++)
@@ -1392,13 +3117,13 @@ int AntennaPatternCRUISE::readPat_(std::istream& fp)
     freqData_[i] *= 1e09;
   }
 
-  // Read in azim pattern tables
+  // Read in azim pattern tables, the file is frequency major and the table is angle major
+  std::vector<double> gains(static_cast<size_t>(azimLen_) * freqLen_);
   for (i = 0; i < freqLen_; i++)
   {
-    azimData_[i] = new double[azimLen_];
     for (j = 0; j < azimLen_; j++)
     {
-      fp >> azimData_[i][j];
+      fp >> gains[static_cast<size_t>(j) * freqLen_ + i];
     }
   }
 
@@ -1411,9 +3136,14 @@ int AntennaPatternCRUISE::readPat_(std::istream& fp)
 
   if ((azimLen_ != elevLen_ && tmpFreq != freqLen_))
   {
-    delete [] elevData_;
-    elevData_ = 0;
     SIM_ERROR << "CRUISE azimLen_(" << azimLen_ << ") != elevLen_(" << elevLen_ << ") or freqLen_s (" << tmpFreq << ", "<< freqLen_ << ") do not match!" << std::endl;
+    reset_();
+    return 1;
+  }
+  if (!fp || elevLen_ < 2)
+  {
+    SIM_ERROR << "CRUISE elevLen_(" << elevLen_ << ") must be at least 2!" << std::endl;
+    reset_();
     return 1;
   }
 
@@ -1431,16 +3161,20 @@ int AntennaPatternCRUISE::readPat_(std::istream& fp)
 #endif
   }
 
-  // Read in elev pattern tables
+  // Read in elev pattern tables, stored after the azimuth block
+  const size_t elevOffset = gains.size();
+  gains.resize(elevOffset + static_cast<size_t>(elevLen_) * freqLen_);
   for (i = 0; i < freqLen_; i++)
   {
-    elevData_[i] = new double[elevLen_];
     for (j = 0; j < elevLen_; j++)
     {
-      fp >> elevData_[i][j];
+      fp >> gains[elevOffset + static_cast<size_t>(j) * freqLen_ + i];
     }
   }
+  const size_t numAngles = static_cast<size_t>(azimLen_) + elevLen_;
+  gains_.assign(0.0, static_cast<double>(numAngles - 1), numAngles, 0.0, static_cast<double>(freqLen_ - 1), freqLen_, std::move(gains));
 
+  applyPrecision_();
   valid_ = true;
   return 0;
 }
@@ -1460,17 +3194,17 @@ int AntennaPatternCRUISE::readPat(const std::string& inFileName)
       if (st == 0)
       {
         filename_ = inFileName;
-        // determine min & max values
+        // determine min & max values; gain_() directly, so that the sweep is not counted as lookups
         float radius;
-        AntennaGainParameters agp;
-        agp.freq_ = freqData_[0];
+        int flowindex = 0;
+        double fdelta = 0.0;
+        freqIndex_(freqData_[0], flowindex, fdelta);
         for (int ii = -180; ii <= 180; ++ii)
         {
-          agp.azim_ = static_cast<float>(DEG2RAD*(ii));
+          const float azim = static_cast<float>(DEG2RAD*(ii));
           for (int jj = -90; jj <= 90; ++jj)
           {
-            agp.elev_ = static_cast<float>(DEG2RAD*(jj));
-            radius = gain(agp);
+            radius = gain_(azim, static_cast<float>(DEG2RAD*(jj)), flowindex, fdelta);
             if (radius > SMALL_DB_COMPARE)
             {
               minGain_ = sdkMin(minGain_, radius);
@@ -1484,209 +3218,628 @@ int AntennaPatternCRUISE::readPat(const std::string& inFileName)
   return st;
 }
 
+// Sections: scalars {azimLen_, elevLen_, freqLen_, azimMin_, elevMin_, azimStep_, elevStep_},
+// array 0 freqData_, grid 0 gains_ in its angle major layout
+int AntennaPatternCRUISE::writeCompiled(CompiledPatternWriter& writer) const
+{
+  const double scalars[7] = { static_cast<double>(azimLen_), static_cast<double>(elevLen_), static_cast<double>(freqLen_),
+    azimMin_, elevMin_, azimStep_, elevStep_ };
+  AntennaPattern::writeCompiled(writer);
+  writer.addDoubles(COMPILED_SECTION_SCALARS, scalars, 7);
+  writer.addDoubles(COMPILED_SECTION_ARRAY, freqData_.data(), freqData_.size());
+  // compiled patterns hold double precision gains
+  if (!singlePrecision_)
+    writer.addGrid(COMPILED_SECTION_GRID, gains_);
+  else
+  {
+    GridTable<double> widened;
+    convertGrid(floatGains_, widened, [](float value) { return static_cast<double>(value); });
+    writer.addGrid(COMPILED_SECTION_GRID, widened);
+  }
+  return 0;
+}
+
+int AntennaPatternCRUISE::readCompiled(const CompiledPatternReader& reader)
+{
+  reset_();
+  double scalars[7];
+  if (AntennaPattern::readCompiled(reader) != 0 || !readCompiledScalars(reader, scalars, 7))
+    return 1;
+
+  size_t numFreq = 0;
+  const double *freqData = reader.doubles(COMPILED_SECTION_ARRAY, &numFreq);
+  // the gains are used in place, their grid must match the lengths the lookups index them by
+  if (!freqData || numFreq < 2 || scalars[2] != static_cast<double>(numFreq) || !(scalars[0] >= 2.0) ||
+    !(scalars[1] >= 2.0) || reader.readGrid(COMPILED_SECTION_GRID, &gains_) != 0 || gains_.numY() != numFreq ||
+    static_cast<double>(gains_.numX()) != scalars[0] + scalars[1])
+  {
+    reset_();
+    return 1;
+  }
+
+  azimLen_ = static_cast<int>(scalars[0]);
+  elevLen_ = static_cast<int>(scalars[1]);
+  freqLen_ = static_cast<int>(numFreq);
+  azimMin_ = scalars[3];
+  elevMin_ = scalars[4];
+  azimStep_ = scalars[5];
+  elevStep_ = scalars[6];
+  freqData_.assign(freqData, freqData + numFreq);
+  applyPrecision_();
+  valid_ = true;
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 /// AntennaPatternMonopulse helper functions
 
 /* SymmetricAntennaPattern                                                    */
 
-bool readPattern(SymmetricAntennaPattern *sap, std::istream &in, const std::string &name, double frequency, double frequencythreshold)
+namespace
 {
-  // check for valid pattern
-  std::string st;
-  std::vector<std::string> vec;
-  bool found = false;
-  // on name match, perform extra getStrippedLine to get freq data line, then break out
-  while (getStrippedLine(in, st) && !found)
+  /**
+  * Combines single precision real and imaginary parts into a double precision complex table
+  * @param[in ] real Real parts
+  * @param[in ] imag Imaginary parts, with the extents of real
+  * @param[out] to Table to fill
+  */
+  void joinComplexGrid(const GridTable<float>& real, const GridTable<float>& imag, GridTable<std::complex<double> >& to)
   {
-    stringTokenizer(vec, st);
-    if (!vec.empty() && vec[0] == name)
-    {
-      found = true;
-    }
+    std::vector<std::complex<double> > values;
+    values.reserve(real.size());
+    for (size_t k = 0; k < real.size(); ++k)
+      values.push_back(std::complex<double>(real.values()[k], imag.values()[k]));
+    to.assign(real.minX(), real.maxX(), real.numX(), real.minY(), real.maxY(), real.numY(), std::move(values));
   }
 
-  if (!found)
+  /**
+  * Returns the whole degree extents of a 2D lookup table, for the integer degree sweeps of minimum and maximum gains
+  * @param[in ] grid Table with x azimuth and y elevation (deg)
+  * @param[out] minX Minimum azimuth (deg)
+  * @param[out] maxX Maximum azimuth (deg)
+  * @param[out] minY Minimum elevation (deg)
+  * @param[out] maxY Maximum elevation (deg)
+  */
+  template <typename T>
+  void gridDegreeExtents(const GridTable<T>& grid, int &minX, int &maxX, int &minY, int &maxY)
   {
-    SIM_ERROR << "SymmetricAntennaPattern could not find pattern " << name;
-    return false;
+    minX = static_cast<int>(grid.minX());
+    maxX = static_cast<int>(grid.maxX());
+    minY = static_cast<int>(grid.minY());
+    maxY = static_cast<int>(grid.maxY());
   }
 
-  double minfreq = 0;
-  double stepfreq = 1;
-  double minel = 0;
-  double maxel = 0;
-  double minaz = 0;
-  double maxaz = 0;
-  size_t numfreq = 0;
-  size_t numel = 0;
-  size_t numaz = 0;
-  std::complex<double> magphase;
-  double magnitude = 0, phase = 0;
-  bool freqFound = false;
+  /// Cell of a 2D lookup table containing a point, and the interpolation weights of the point within it
+  struct BilinearCell
+  {
+    size_t x0;  ///< Lower x index
+    size_t x1;  ///< Upper x index, x0 for a single column
+    size_t y0;  ///< Lower y index
+    size_t y1;  ///< Upper y index, y0 for a single row
+    double dx;  ///< Fractional offset of the point from x0 toward x1
+    double dy;  ///< Fractional offset of the point from y0 toward y1
+  };
 
-  // parse freq data
-  stringTokenizer(vec, st);
-  if (vec.size() > 2)
+  /**
+  * Locates a value along one evenly spaced axis of a 2D lookup table
+  * @param[in ] value Value to locate, within [minValue, maxValue]
+  * @param[in ] minValue First axis value
+  * @param[in ] maxValue Last axis value
+  * @param[in ] num Number of axis values
+  * @param[out] lower Index of the axis value at or below value
+  * @param[out] upper Index of the next axis value, lower if there is a single value or the axis has no extent
+  * @param[out] offset Fractional offset of value from lower toward upper
+  */
+  void locateAxis(double value, double minValue, double maxValue, size_t num, size_t &lower, size_t &upper, double &offset)
   {
-    if (!isValidNumber(vec[0], minfreq))
-    {
-      SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern minimum frequency" << std::endl;
-      return 1;
-    }
-    double maxfreq = 0;
-    if (!isValidNumber(vec[1], maxfreq))
+    // a degenerate axis has no spacing to divide by; every value maps to its first entry
+    if (num < 2 || !(maxValue > minValue))
     {
-      SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern maximum frequency" << std::endl;
-      return 1;
+      lower = upper = 0;
+      offset = 0.0;
+      return;
     }
-    if (!isValidNumber(vec[2], stepfreq))
+    const double index = (value - minValue) / ((maxValue - minValue) / static_cast<double>(num - 1));
+    lower = sdkMin(static_cast<size_t>(index), num - 2);
+    upper = lower + 1;
+    offset = index - static_cast<double>(lower);
+  }
+
+  /**
+  * Locates the cell of a 2D lookup table containing a point, the first half of bilinearLookup()
+  * @param[in ] lut Table to search
+  * @param[in ] x X value of the point
+  * @param[in ] y Y value of the point
+  * @param[out] cell Cell containing the point
+  * @return true on success, false if the point is outside of the table
+  */
+  template <typename T>
+  bool bilinearCell(const GridTable<T>& lut, double x, double y, BilinearCell &cell)
+  {
+    // written to reject NaN as well as out of range values
+    if (lut.numX() == 0 || lut.numY() == 0 || !(x >= lut.minX() && x <= lut.maxX() && y >= lut.minY() && y <= lut.maxY()))
+      return false;
+    locateAxis(x, lut.minX(), lut.maxX(), lut.numX(), cell.x0, cell.x1, cell.dx);
+    locateAxis(y, lut.minY(), lut.maxY(), lut.numY(), cell.y0, cell.y1, cell.dy);
+    return true;
+  }
+
+  /**
+  * Interpolates a 2D lookup table within a cell from bilinearCell(), the second half of bilinearLookup()
+  * @param[in ] lut Table to interpolate
+  * @param[in ] cell Cell of lut containing the point
+  * @return interpolated value
+  */
+  template <typename T>
+  T bilinearValue(const GridTable<T>& lut, const BilinearCell &cell)
+  {
+    return static_cast<T>(lut(cell.x0, cell.y0) * ((1.0 - cell.dx) * (1.0 - cell.dy)) + lut(cell.x1, cell.y0) * (cell.dx * (1.0 - cell.dy)) +
+      lut(cell.x0, cell.y1) * ((1.0 - cell.dx) * cell.dy) + lut(cell.x1, cell.y1) * (cell.dx * cell.dy));
+  }
+
+  /**
+  * Bilinearly interpolates a 2D lookup table. The limits are checked before the lookup, so an out of coverage query,
+  * e.g. a target behind the antenna, costs the same as one in coverage and never throws.
+  * @param[in ] table Table to interpolate
+  * @param[in ] x Table x value (deg)
+  * @param[in ] y Table y value (deg)
+  * @param[out] value Interpolated value, unchanged when (x, y) is outside the table
+  * @return true if (x, y) lies within the table
+  */
+  template <typename T>
+  inline bool bilinearLookup(const GridTable<T>& table, double x, double y, T &value)
+  {
+    BilinearCell cell;
+    if (!bilinearCell(table, x, y, cell))
+      return false;
+    value = bilinearValue(table, cell);
+    return true;
+  }
+
+  /**
+  * Returns whether two 2D lookup tables have the same extents and sizes, so that their cells coincide
+  * @param[in ] first First table to compare
+  * @param[in ] second Second table to compare
+  * @return true if the tables share a grid
+  */
+  template <typename T>
+  bool sameGrid(const GridTable<T>& first, const GridTable<T>& second)
+  {
+    return first.numX() == second.numX() && first.numY() == second.numY() && first.minX() == second.minX() &&
+      first.maxX() == second.maxX() && first.minY() == second.minY() && first.maxY() == second.maxY();
+  }
+
+  /**
+  * Locates the cells of two 2D lookup tables containing a point, searching once when the tables share a grid
+  * @param[in ] first First table to search
+  * @param[in ] second Second table to search
+  * @param[in ] x X value of the point
+  * @param[in ] y Y value of the point
+  * @param[out] firstCell Cell of first containing the point
+  * @param[out] secondCell Cell of second containing the point
+  * @return true on success, false if the point is outside of either table
+  */
+  template <typename T>
+  bool bilinearCells(const GridTable<T>& first, const GridTable<T>& second, double x, double y, BilinearCell &firstCell, BilinearCell &secondCell)
+  {
+    if (!bilinearCell(first, x, y, firstCell))
+      return false;
+    if (sameGrid(first, second))
     {
-      SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern step frequency" << std::endl;
-      return 1;
+      secondCell = firstCell;
+      return true;
     }
+    return bilinearCell(second, x, y, secondCell);
+  }
 
-    if (stepfreq == 0.) // Protect against divide by zero below
+  /**
+  * Finds the node indices along one evenly spaced axis of a 2D lookup table whose cells a range of values reaches
+  * @param[in ] minValue Smallest value of the range
+  * @param[in ] maxValue Largest value of the range
+  * @param[in ] first First axis value
+  * @param[in ] last Last axis value
+  * @param[in ] num Number of axis values, at least 1
+  * @param[out] lower Index of the first node
+  * @param[out] upper Index of the last node
+  */
+  void axisNodeRange(double minValue, double maxValue, double first, double last, size_t num, size_t &lower, size_t &upper)
+  {
+    size_t next = 0;
+    double offset = 0.0;
+    locateAxis(sdkMax(minValue, first), first, last, num, lower, next, offset);
+    locateAxis(sdkMin(maxValue, last), first, last, num, upper, next, offset);
+    // cells reach one node past the located one, and by rounding a lookup may locate a neighboring node
+    lower = (lower > 0) ? lower - 1 : 0;
+    upper = sdkMin(upper + 2, num - 1);
+  }
+
+  /**
+  * Finds the largest node value of a 2D lookup table over the cells reached by a rectangle of points. Bilinear
+  * interpolation weights the corners of a cell by non-negative weights that sum to 1, so node values bound every
+  * value interpolated within the rectangle, as does any node value that is convex, such as a magnitude.
+  * @param[in ] lut Table to search
+  * @param[in ] minX Smallest x value of the rectangle
+  * @param[in ] maxX Largest x value of the rectangle
+  * @param[in ] minY Smallest y value of the rectangle
+  * @param[in ] maxY Largest y value of the rectangle
+  * @param[in ] nodeValue Function of the x and y node indices returning the value to bound
+  * @param[in,out] peak Largest value found, unchanged if the rectangle misses the table
+  * @return false if the rectangle misses the table
+  */
+  template <typename T, typename NodeValue>
+  bool gridNodeMax(const GridTable<T>& lut, double minX, double maxX, double minY, double maxY, NodeValue nodeValue, double &peak)
+  {
+    // negated so that NaN limits miss the table
+    if (lut.numX() == 0 || lut.numY() == 0 || !(maxX >= lut.minX() && minX <= lut.maxX() && maxY >= lut.minY() && minY <= lut.maxY()))
+      return false;
+    size_t x0, x1, y0, y1;
+    axisNodeRange(minX, maxX, lut.minX(), lut.maxX(), lut.numX(), x0, x1);
+    axisNodeRange(minY, maxY, lut.minY(), lut.maxY(), lut.numY(), y0, y1);
+    for (size_t i = x0; i <= x1; ++i)
     {
-      SIM_ERROR << "SymmetricAntennaPattern can not use step frequency of 0" << std::endl;
-      return 1;
+      for (size_t j = y0; j <= y1; ++j)
+        peak = sdkMax(peak, static_cast<double>(nodeValue(i, j)));
     }
-    if (minfreq == maxfreq && minfreq == 0)
+    return true;
+  }
+
+  /**
+  * Finds the largest node value of a 2D lookup table over the cells reached by a rectangle of points, see gridNodeMax()
+  * @param[in ] table Table to search
+  * @param[in ] minX Smallest x value of the rectangle
+  * @param[in ] maxX Largest x value of the rectangle
+  * @param[in ] minY Smallest y value of the rectangle
+  * @param[in ] maxY Largest y value of the rectangle
+  * @param[in,out] peak Largest value found, unchanged if the rectangle misses the table
+  * @return false if the rectangle misses the table
+  */
+  template <typename T>
+  bool gridValueMax(const GridTable<T>& table, double minX, double maxX, double minY, double maxY, double &peak)
+  {
+    return gridNodeMax(table, minX, maxX, minY, maxY, [&table](size_t i, size_t j) { return table(i, j); }, peak);
+  }
+
+  /**
+  * Finds the largest value of a table spanning azimuths [0, 360] over an azimuth range that may leave that interval,
+  * splitting the range where it wraps; see gridValueMax()
+  * @param[in ] table Table to search, x values are azimuths (deg)
+  * @param[in ] minAzim Smallest azimuth of the range (deg)
+  * @param[in ] maxAzim Largest azimuth of the range (deg)
+  * @param[in ] minY Smallest y value of the range
+  * @param[in ] maxY Largest y value of the range
+  * @param[in,out] peak Largest value found, unchanged if the range misses the table
+  * @return false if the range misses the table
+  */
+  template <typename T>
+  bool wrappedGridValueMax(const GridTable<T>& table, double minAzim, double maxAzim, double minY, double maxY, double &peak)
+  {
+    if (!(maxAzim - minAzim < 360.0))
+      return gridValueMax(table, 0.0, 360.0, minY, maxY, peak);
+    const double shift = 360.0 * floor(minAzim / 360.0);
+    minAzim -= shift;
+    maxAzim -= shift;
+    bool found = gridValueMax(table, minAzim, sdkMin(maxAzim, 360.0), minY, maxY, peak);
+    if (maxAzim > 360.0 && gridValueMax(table, 0.0, maxAzim - 360.0, minY, maxY, peak))
+      found = true;
+    return found;
+  }
+
+  /**
+  * Copies parsed lookup tables into tables used for lookups, releasing each parsed table once it is copied
+  * @param[in,out] parsed Parsed tables, emptied
+  * @param[out] grids Tables to fill, one per parsed table
+  */
+  template <typename T>
+  void assignGrids(std::vector<InterpTable<T> >& parsed, std::vector<GridTable<T> >& grids)
+  {
+    grids.resize(parsed.size());
+    for (size_t i = 0; i < parsed.size(); ++i)
     {
-      SIM_ERROR << "SymmetricAntennaPattern could not determine frequency limits" << std::endl;
+      grids[i].assign(parsed[i]);
+      parsed[i] = InterpTable<T>();
     }
-    numfreq = size_t(floor((maxfreq - minfreq) / stepfreq)) + 1;
+    std::vector<InterpTable<T> >().swap(parsed);
   }
-  else
+
+  /**
+  * Sets a monopulse response to that of a direction outside of the pattern
+  * @param[out] response Response to clear
+  */
+  void clearResponse(AntennaPatternMonopulse::Response &response)
   {
-    SIM_ERROR << "SymmetricAntennaPattern expected 3 values for frequency limits" << std::endl;
-    return false;
+    response.sum_ = std::complex<double>();
+    response.delta_ = std::complex<double>();
+    response.ratio_ = std::complex<double>();
+    response.sumGain_ = SMALL_DB_VAL;
+    response.deltaGain_ = SMALL_DB_VAL;
   }
 
-  // parse azimuth data
-  if (getTokens(in, vec, 3))
-  {
-    if (!isValidNumber(vec[0], minaz))
-    {
-      SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern minimum azimuth" << std::endl;
-      return 1;
-    }
-    if (!isValidNumber(vec[1], maxaz))
-    {
-      SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern maximum azimuth" << std::endl;
-      return 1;
-    }
-    double stepaz = 0.;
-    if (!isValidNumber(vec[2], stepaz))
+  /**
+  * Parses the block of a named SymmetricAntennaPattern that follows its name line, either keeping the data within the
+  * threshold of the requested frequency and skipping the data of other frequencies, or keeping every frequency
+  * @param[out] sap SymmetricAntennaPattern class to fill, unused when allPats is set
+  * @param[in ] in Input stream positioned after the frequency limits line
+  * @param[in ] st Frequency limits line of the block
+  * @param[in ] name Name of antenna pattern
+  * @param[in ] frequency Frequency of antenna pattern (Hz), unused when allPats is set
+  * @param[in ] frequencythreshold Frequency threshold between different frequencies in pattern (Hz), unused when allPats is set
+  * @param[out] allPats If set, receives the pattern of every frequency instead of sap
+  * @param[out] allFreqs If allPats is set, receives the frequency of each pattern (Hz)
+  * @return boolean, true:success, false on failure
+  * @pre sap valid param, or allPats and allFreqs valid params
+  */
+  bool readPatternBlock(SymmetricAntennaPattern *sap, std::istream &in, std::string st, const std::string &name, double frequency, double frequencythreshold,
+    std::vector<SymmetricAntennaPattern> *allPats = nullptr, std::vector<double> *allFreqs = nullptr)
+  {
+    std::vector<std::string> vec;
+    double minfreq = 0;
+    double stepfreq = 1;
+    double minel = 0;
+    double maxel = 0;
+    double minaz = 0;
+    double maxaz = 0;
+    size_t numfreq = 0;
+    size_t numel = 0;
+    size_t numaz = 0;
+    std::complex<double> magphase;
+    double magnitude = 0, phase = 0;
+    bool freqFound = false;
+
+    // parse freq data
+    stringTokenizer(vec, st);
+    if (vec.size() > 2)
     {
-      SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern step azimuth" << std::endl;
-      return 1;
+      if (!isValidNumber(vec[0], minfreq))
+      {
+        SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern minimum frequency" << std::endl;
+        return false;
+      }
+      double maxfreq = 0;
+      if (!isValidNumber(vec[1], maxfreq))
+      {
+        SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern maximum frequency" << std::endl;
+        return false;
+      }
+      if (!isValidNumber(vec[2], stepfreq))
+      {
+        SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern step frequency" << std::endl;
+        return false;
+      }
+
+      if (stepfreq == 0.) // Protect against divide by zero below
+      {
+        SIM_ERROR << "SymmetricAntennaPattern can not use step frequency of 0" << std::endl;
+        return false;
+      }
+      if (minfreq == maxfreq && minfreq == 0)
+      {
+        SIM_ERROR << "SymmetricAntennaPattern could not determine frequency limits" << std::endl;
+      }
+      numfreq = size_t(floor((maxfreq - minfreq) / stepfreq)) + 1;
     }
-    if (stepaz == 0.) // Protect against divide by zero below
+    else
     {
-      SIM_ERROR << "SymmetricAntennaPattern can not use step azimuth of 0" << std::endl;
-      return 1;
+      SIM_ERROR << "SymmetricAntennaPattern expected 3 values for frequency limits" << std::endl;
+      return false;
     }
-    numaz = size_t(floor((maxaz - minaz) / stepaz)) + 1;
-  }
-  else
-  {
-    SIM_ERROR << "SymmetricAntennaPattern expected 3 values for azimuth limits" << std::endl;
-    return false;
-  }
 
-  // parse elevation data
-  if (getTokens(in, vec, 3))
-  {
-    if (!isValidNumber(vec[0], minel))
+    // parse azimuth data
+    if (getTokens(in, vec, 3))
     {
-      SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern minimum elevation" << std::endl;
-      return 1;
+      if (!isValidNumber(vec[0], minaz))
+      {
+        SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern minimum azimuth" << std::endl;
+        return false;
+      }
+      if (!isValidNumber(vec[1], maxaz))
+      {
+        SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern maximum azimuth" << std::endl;
+        return false;
+      }
+      double stepaz = 0.;
+      if (!isValidNumber(vec[2], stepaz))
+      {
+        SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern step azimuth" << std::endl;
+        return false;
+      }
+      if (stepaz == 0.) // Protect against divide by zero below
+      {
+        SIM_ERROR << "SymmetricAntennaPattern can not use step azimuth of 0" << std::endl;
+        return false;
+      }
+      numaz = size_t(floor((maxaz - minaz) / stepaz)) + 1;
     }
-    if (!isValidNumber(vec[1], maxel))
+    else
     {
-      SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern maximum elevation" << std::endl;
-      return 1;
+      SIM_ERROR << "SymmetricAntennaPattern expected 3 values for azimuth limits" << std::endl;
+      return false;
     }
-    double stepel = 0;
-    if (!isValidNumber(vec[2], stepel))
+
+    // parse elevation data
+    if (getTokens(in, vec, 3))
     {
-      SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern step elevation" << std::endl;
-      return 1;
+      if (!isValidNumber(vec[0], minel))
+      {
+        SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern minimum elevation" << std::endl;
+        return false;
+      }
+      if (!isValidNumber(vec[1], maxel))
+      {
+        SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern maximum elevation" << std::endl;
+        return false;
+      }
+      double stepel = 0;
+      if (!isValidNumber(vec[2], stepel))
+      {
+        SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern step elevation" << std::endl;
+        return false;
+      }
+      if (stepel == 0.) // Protect against divide by zero below
+      {
+        SIM_ERROR << "SymmetricAntennaPattern can not use step elevation of 0" << std::endl;
+        return false;
+      }
+      numel = size_t(floor((maxel - minel) / stepel)) + 1;
     }
-    if (stepel == 0.) // Protect against divide by zero below
+    else
     {
-      SIM_ERROR << "SymmetricAntennaPattern can not use step elevation of 0" << std::endl;
-      return 1;
+      SIM_ERROR << "SymmetricAntennaPattern expected 3 values for elevation limits" << std::endl;
+      return false;
     }
-    numel = size_t(floor((maxel - minel) / stepel)) + 1;
-  }
-  else
-  {
-    SIM_ERROR << "SymmetricAntennaPattern expected 3 values for elevation limits" << std::endl;
-    return false;
-  }
 
-  sap->initialize(minaz, maxaz, numaz, minel, maxel, numel);
+    if (!allPats)
+      sap->initialize(minaz, maxaz, numaz, minel, maxel, numel);
 
-  // parse mag phase pairs
-  for (size_t i = 0; i < numfreq; ++i)
-  {
-    const double currentFreq = minfreq + i * stepfreq;
-    if (frequency < (currentFreq + frequencythreshold) && frequency >(currentFreq - frequencythreshold))
+    // parse mag phase pairs
+    for (size_t i = 0; i < numfreq; ++i)
     {
-      freqFound = true;
-      for (size_t j = 0; j < numaz; ++j)
+      const double currentFreq = minfreq + i * stepfreq;
+      SymmetricAntennaPattern *target = nullptr;
+      if (allPats)
       {
-        for (size_t k = 0; k < numel; ++k)
+        allPats->push_back(SymmetricAntennaPattern());
+        allFreqs->push_back(currentFreq);
+        target = &allPats->back();
+        target->initialize(minaz, maxaz, numaz, minel, maxel, numel);
+      }
+      else if (frequency < (currentFreq + frequencythreshold) && frequency >(currentFreq - frequencythreshold))
+        target = sap;
+
+      if (target)
+      {
+        freqFound = true;
+        for (size_t j = 0; j < numaz; ++j)
         {
-          st.clear();
-          getStrippedLine(in, st);
-          stringTokenizer(vec, st);
-          if (vec.size() > 1)
+          for (size_t k = 0; k < numel; ++k)
           {
-            if (!isValidNumber(vec[0], magnitude))
+            st.clear();
+            getStrippedLine(in, st);
+            stringTokenizer(vec, st);
+            if (vec.size() > 1)
             {
-              SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern magnitude" << std::endl;
-              return 1;
+              if (!isValidNumber(vec[0], magnitude))
+              {
+                SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern magnitude" << std::endl;
+                return false;
+              }
+              if (!isValidNumber(vec[1], phase))
+              {
+                SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern phase" << std::endl;
+                return false;
+              }
+              magphase = std::polar(simCore::dB2Linear(magnitude), simCore::DEG2RAD*(phase));
+              (*target)(j, k) = magphase;
             }
-            if (!isValidNumber(vec[1], phase))
+            else
             {
-              SIM_ERROR << "Encountered invalid number for SymmetricAntennaPattern phase" << std::endl;
-              return 1;
+              SIM_ERROR << "SymmetricAntennaPattern expected magnitude and phase" << std::endl;
+              return false;
+            }
+            if (!in)
+            {
+              SIM_ERROR << "SymmetricAntennaPattern ran out of data for frequency " << currentFreq << std::endl;
+              return false;
             }
-            magphase = std::polar(simCore::dB2Linear(magnitude), simCore::DEG2RAD*(phase));
-            (*sap)(j, k) = magphase;
-          }
-          else
-          {
-            SIM_ERROR << "SymmetricAntennaPattern expected magnitude and phase" << std::endl;
-            return false;
-          }
-          if (!in)
-          {
-            SIM_ERROR << "SymmetricAntennaPattern ran out of data for frequency " << frequency << std::endl;
-            return false;
           }
         }
       }
-    }
-    else
-    {
-      // skip over data until the next frequency
-      for (size_t j = 0; j < numaz*numel; ++j)
+      else
       {
-        getStrippedLine(in, st);
+        // skip over data until the next frequency
+        for (size_t j = 0; j < numaz*numel; ++j)
+        {
+          getStrippedLine(in, st);
+        }
       }
     }
+
+    if (!freqFound)
+    {
+      SIM_ERROR << "SymmetricAntennaPattern could not find pattern " << name << " with frequency " << frequency << " within threshold " << frequencythreshold << std::endl;
+      return false;
+    }
+
+    return true;
   }
 
-  if (!freqFound)
+  /**
+  * Scans a stream once, calling parseBlock for each requested pattern block where its name line appears
+  * @param[in ] targets Requested patterns, by name
+  * @param[in ] in Input stream to read
+  * @param[in ] parseBlock Called as parseBlock(name, target, frequency limits line) to parse the rest of the block
+  * @return boolean, true if every requested block was found and parsed, false on failure
+  */
+  template <typename Target, typename ParseBlock>
+  bool readNamedBlocks(const std::map<std::string, Target>& targets, std::istream &in, ParseBlock parseBlock)
   {
-    SIM_ERROR << "SymmetricAntennaPattern could not find pattern " << name << " with frequency " << frequency << " within threshold " << frequencythreshold << std::endl;
-    return false;
+    std::map<std::string, Target> remaining(targets);
+    std::string st;
+    std::vector<std::string> vec;
+    while (!remaining.empty() && getStrippedLine(in, st))
+    {
+      stringTokenizer(vec, st);
+      if (vec.empty())
+        continue;
+      const typename std::map<std::string, Target>::iterator iter = remaining.find(vec[0]);
+      if (iter == remaining.end())
+        continue;
+
+      // the frequency limits line follows the name line
+      st.clear();
+      getStrippedLine(in, st);
+      assert(iter->second);
+      if (!iter->second || !parseBlock(iter->first, iter->second, st))
+        return false;
+      remaining.erase(iter);
+    }
+
+    for (typename std::map<std::string, Target>::const_iterator iter = remaining.begin(); iter != remaining.end(); ++iter)
+      SIM_ERROR << "SymmetricAntennaPattern could not find pattern " << iter->first << std::endl;
+    return remaining.empty();
   }
+}
 
-  return true;
+bool readPattern(SymmetricAntennaPattern *sap, std::istream &in, const std::string &name, double frequency, double frequencythreshold)
+{
+  std::map<std::string, SymmetricAntennaPattern*> patterns;
+  patterns[name] = sap;
+  return readPatterns(patterns, in, frequency, frequencythreshold);
+}
+
+bool readPatterns(const std::map<std::string, SymmetricAntennaPattern*>& patterns, std::istream &in, double frequency, double frequencythreshold)
+{
+  return readNamedBlocks(patterns, in,
+    [&](const std::string& name, SymmetricAntennaPattern *sap, const std::string& st)
+    {
+      return readPatternBlock(sap, in, st, name, frequency, frequencythreshold);
+    });
+}
+
+bool readPatterns(const std::map<std::string, std::vector<SymmetricAntennaPattern>*>& patterns, std::vector<double> *frequencies, std::istream &in)
+{
+  assert(frequencies);
+  if (!frequencies)
+    return false;
+  frequencies->clear();
+  bool first = true;
+  return readNamedBlocks(patterns, in,
+    [&](const std::string& name, std::vector<SymmetricAntennaPattern> *saps, const std::string& st)
+    {
+      std::vector<double> blockFrequencies;
+      saps->clear();
+      if (!readPatternBlock(nullptr, in, st, name, 0.0, 0.0, saps, &blockFrequencies))
+        return false;
+      // every block is looked up with the same frequency index
+      if (first)
+        frequencies->swap(blockFrequencies);
+      else if (blockFrequencies != *frequencies)
+      {
+        SIM_ERROR << "SymmetricAntennaPattern " << name << " frequencies differ from the other patterns" << std::endl;
+        return false;
+      }
+      first = false;
+      return true;
+    });
 }
 
 bool readPattern(SymmetricAntennaPattern *sap, const std::string &filename, const std::string &name, double frequency, double frequencythreshold)
@@ -1695,14 +3848,26 @@ bool readPattern(SymmetricAntennaPattern *sap, const std::string &filename, cons
   return readPattern(sap, in, name, frequency, frequencythreshold);
 }
 
+bool readPatterns(const std::map<std::string, SymmetricAntennaPattern*>& patterns, const std::string &filename, double frequency, double frequencythreshold)
+{
+  std::fstream in(simCore::streamFixUtf8(filename), std::ios::in);
+  return readPatterns(patterns, in, frequency, frequencythreshold);
+}
+
+bool readPatterns(const std::map<std::string, std::vector<SymmetricAntennaPattern>*>& patterns, std::vector<double> *frequencies, const std::string &filename)
+{
+  std::fstream in(simCore::streamFixUtf8(filename), std::ios::in);
+  return readPatterns(patterns, frequencies, in);
+}
+
 // ----------------------------------------------------------------------------
 /// AntennaPatternMonopulse methods
 
 AntennaPatternMonopulse::AntennaPatternMonopulse()
   : AntennaPattern(),
   freq_(0),
-  minDelGain_(-SMALL_DB_VAL),
-  maxDelGain_(SMALL_DB_VAL)
+  singlePrecision_(false),
+  precomputedGain_(false)
 {}
 
 AntennaPatternMonopulse::~AntennaPatternMonopulse()
@@ -1717,62 +3882,368 @@ void AntennaPatternMonopulse::reset_()
   filename_.clear();
   minGain_ = -SMALL_DB_VAL;
   maxGain_ = SMALL_DB_VAL;
-  minDelGain_ = -SMALL_DB_VAL;
-  maxDelGain_ = SMALL_DB_VAL;
+  minMaxCache_.clear();
+  freqData_.clear();
+  sumPat_.clear();
+  delPat_.clear();
+  sumPats_.clear();
+  delPats_.clear();
+  floatPats_.clear();
+  gainPats_.clear();
+}
+
+void AntennaPatternMonopulse::setPrecomputedGain(bool precomputedGain)
+{
+  if (precomputedGain == precomputedGain_)
+    return;
+  precomputedGain_ = precomputedGain;
+  applyPrecomputedGain_();
+}
+
+void AntennaPatternMonopulse::applyPrecomputedGain_()
+{
+  if (!valid_)
+    return;
+
+  if (!precomputedGain_)
+    std::vector<GridTable<float> >().swap(gainPats_);
+  else if (gainPats_.empty())
+  {
+    const auto toGain = [](const std::complex<double>& value)
+      { return static_cast<float>(sdkMax(static_cast<double>(SMALL_DB_VAL), linear2dB(std::abs(value)))); };
+    const size_t numFreq = (freqData_.empty()) ? 1 : freqData_.size();
+    gainPats_.resize(2 * numFreq);
+    GridTable<std::complex<double> > widened;
+    for (size_t i = 0; i < gainPats_.size(); ++i)
+    {
+      if (floatPats_.empty())
+        convertGrid(pattern_((i % 2) != 0, i / 2), gainPats_[i], toGain);
+      else
+      {
+        joinComplexGrid(floatPats_[i].real_, floatPats_[i].imag_, widened);
+        convertGrid(widened, gainPats_[i], toGain);
+      }
+    }
+  }
+  minMaxCache_.clear();
+}
+
+void AntennaPatternMonopulse::setSinglePrecision(bool singlePrecision)
+{
+  if (singlePrecision == singlePrecision_)
+    return;
+  singlePrecision_ = singlePrecision;
+  applyPrecision_();
+}
+
+void AntennaPatternMonopulse::applyPrecision_()
+{
+  if (!valid_)
+    return;
+
+  const size_t numFreq = (freqData_.empty()) ? 1 : freqData_.size();
+  if (singlePrecision_ && floatPats_.empty())
+  {
+    floatPats_.resize(2 * numFreq);
+    for (size_t i = 0; i < floatPats_.size(); ++i)
+    {
+      const GridTable<std::complex<double> > &pat = pattern_((i % 2) != 0, i / 2);
+      convertGrid(pat, floatPats_[i].real_, [](const std::complex<double>& value) { return static_cast<float>(value.real()); });
+      convertGrid(pat, floatPats_[i].imag_, [](const std::complex<double>& value) { return static_cast<float>(value.imag()); });
+    }
+    sumPat_.clear();
+    delPat_.clear();
+    std::vector<GridTable<std::complex<double> > >().swap(sumPats_);
+    std::vector<GridTable<std::complex<double> > >().swap(delPats_);
+  }
+  else if (!singlePrecision_ && !floatPats_.empty())
+  {
+    if (freqData_.empty())
+    {
+      joinComplexGrid(floatPats_[0].real_, floatPats_[0].imag_, sumPat_);
+      joinComplexGrid(floatPats_[1].real_, floatPats_[1].imag_, delPat_);
+    }
+    else
+    {
+      sumPats_.resize(numFreq);
+      delPats_.resize(numFreq);
+      for (size_t i = 0; i < numFreq; ++i)
+      {
+        joinComplexGrid(floatPats_[2 * i].real_, floatPats_[2 * i].imag_, sumPats_[i]);
+        joinComplexGrid(floatPats_[2 * i + 1].real_, floatPats_[2 * i + 1].imag_, delPats_[i]);
+      }
+    }
+    std::vector<FloatChannel>().swap(floatPats_);
+  }
+  minMaxCache_.clear();
+}
+
+size_t AntennaPatternMonopulse::freqIndex_(double freq) const
+{
+  if (freqData_.size() < 2 || !(freq > freqData_.front()))
+    return 0;
+  if (freq >= freqData_.back())
+    return freqData_.size() - 1;
+
+  // phase does not interpolate across frequencies, use the nearest one
+  const size_t upper = std::upper_bound(freqData_.begin(), freqData_.end(), freq) - freqData_.begin();
+  return (freq - freqData_[upper - 1] <= freqData_[upper] - freq) ? upper - 1 : upper;
+}
+
+const GridTable<std::complex<double> >& AntennaPatternMonopulse::pattern_(bool delta, size_t findex) const
+{
+  if (sumPats_.empty())
+    return (delta) ? delPat_ : sumPat_;
+  return (delta) ? delPats_[findex] : sumPats_[findex];
+}
+
+bool AntennaPatternMonopulse::lookup_(bool delta, size_t findex, float azim, float elev, std::complex<double> &magph) const
+{
+  if (floatPats_.empty())
+    return bilinearLookup(pattern_(delta, findex), RAD2DEG*(azim), RAD2DEG*(elev), magph);
+
+  const FloatChannel &channel = floatPats_[2 * findex + ((delta) ? 1 : 0)];
+  float real = 0.f;
+  float imag = 0.f;
+  if (!bilinearLookup(channel.real_, RAD2DEG*(azim), RAD2DEG*(elev), real) ||
+    !bilinearLookup(channel.imag_, RAD2DEG*(azim), RAD2DEG*(elev), imag))
+    return false;
+  magph = std::complex<double>(real, imag);
+  return true;
+}
+
+float AntennaPatternMonopulse::gain_(bool delta, size_t findex, float azim, float elev, float refGain) const
+{
+  if (!gainPats_.empty())
+  {
+    // nulls were clamped to SMALL_DB_VAL when the table was computed, so the interpolated dB stays finite
+    float gain = 0.f;
+    if (!bilinearLookup(gainPats_[2 * findex + ((delta) ? 1 : 0)], RAD2DEG*(azim), RAD2DEG*(elev), gain))
+      return SMALL_DB_VAL;
+    return refGain + gain;
+  }
+
+  std::complex<double> magph;
+  if (!lookup_(delta, findex, azim, elev, magph))
+    return SMALL_DB_VAL;
+  return static_cast<float>(refGain + linear2dB(std::abs(magph)));
+}
+
+bool AntennaPatternMonopulse::complexGain(const AntennaGainParameters &params, std::complex<double> &magph) const
+{
+  if (!valid_)
+    return false;
+  return lookup_(params.delta_, freqIndex_(params.freq_), params.azim_, params.elev_, magph);
+}
+
+bool AntennaPatternMonopulse::response_(size_t findex, float azim, float elev, float refGain, Response &response) const
+{
+  const double x = RAD2DEG*(azim);
+  const double y = RAD2DEG*(elev);
+  BilinearCell sumCell;
+  BilinearCell delCell;
+  if (floatPats_.empty())
+  {
+    const GridTable<std::complex<double> > &sumLut = pattern_(false, findex);
+    const GridTable<std::complex<double> > &delLut = pattern_(true, findex);
+    if (!bilinearCells(sumLut, delLut, x, y, sumCell, delCell))
+    {
+      clearResponse(response);
+      return false;
+    }
+    response.sum_ = bilinearValue(sumLut, sumCell);
+    response.delta_ = bilinearValue(delLut, delCell);
+  }
+  else
+  {
+    // the real and imaginary parts of a channel share its grid
+    const FloatChannel &sumChannel = floatPats_[2 * findex];
+    const FloatChannel &delChannel = floatPats_[2 * findex + 1];
+    if (!bilinearCells(sumChannel.real_, delChannel.real_, x, y, sumCell, delCell))
+    {
+      clearResponse(response);
+      return false;
+    }
+    response.sum_ = std::complex<double>(bilinearValue(sumChannel.real_, sumCell), bilinearValue(sumChannel.imag_, sumCell));
+    response.delta_ = std::complex<double>(bilinearValue(delChannel.real_, delCell), bilinearValue(delChannel.imag_, delCell));
+  }
+
+  response.ratio_ = (response.sum_ == std::complex<double>()) ? std::complex<double>() : response.delta_ / response.sum_;
+  response.sumGain_ = static_cast<float>(refGain + linear2dB(std::abs(response.sum_)));
+  response.deltaGain_ = static_cast<float>(refGain + linear2dB(std::abs(response.delta_)));
+  return true;
+}
+
+bool AntennaPatternMonopulse::response(const AntennaGainParameters &params, Response &response) const
+{
+  if (!valid_)
+  {
+    clearResponse(response);
+    return false;
+  }
+  return response_(freqIndex_(params.freq_), params.azim_, params.elev_, params.refGain_, response);
+}
+
+size_t AntennaPatternMonopulse::responseBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, Response *responses) const
+{
+  assert(count == 0 || (azim && elev && responses));
+  if (count == 0 || !azim || !elev || !responses)
+    return 0;
+
+  if (!valid_)
+  {
+    std::for_each(responses, responses + count, clearResponse);
+    return 0;
+  }
+
+  const size_t findex = freqIndex_(params.freq_);
+  size_t found = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (response_(findex, azim[i], elev[i], params.refGain_, responses[i]))
+      ++found;
+  }
+  return found;
+}
+
+float AntennaPatternMonopulse::gain(const AntennaGainParameters &params) const
+{
+  if (!valid_) return countedGain(counters_, SMALL_DB_VAL);
+  return countedGain(counters_, gain_(params.delta_, freqIndex_(params.freq_), params.azim_, params.elev_, params.refGain_));
+}
+
+void AntennaPatternMonopulse::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+  CountedGains counted(counters_, gains, count);
+
+  if (!valid_)
+  {
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+    return;
+  }
+
+  const size_t findex = freqIndex_(params.freq_);
+  for (size_t i = 0; i < count; ++i)
+    gains[i] = gain_(params.delta_, findex, azim[i], elev[i], params.refGain_);
 }
 
-float AntennaPatternMonopulse::gain(const AntennaGainParameters &params)
+/// Evaluates a monopulse pattern from the sum and delta tables nearest one frequency
+class AntennaPatternMonopulse::FrequencyEvaluator : public AntennaPatternEvaluator
 {
-  if (!valid_) return SMALL_DB_VAL;
-
-  std::complex<double> magph;
+public:
+  /**
+  * Selects the tables of the pattern nearest the frequency
+  * @param[in ] pattern Valid pattern to evaluate
+  * @param[in ] freq Frequency to evaluate the pattern at (Hz)
+  */
+  FrequencyEvaluator(const AntennaPatternMonopulse& pattern, double freq)
+    : AntennaPatternEvaluator(pattern, freq),
+    monopulse_(pattern),
+    findex_(pattern.freqIndex_(freq))
+  {
+  }
 
-  if (params.delta_)
+  virtual float gain(const AntennaGainParameters &params) const
   {
-    try
-    {
-      magph = BilinearLookup(delPat_, RAD2DEG*(params.azim_), RAD2DEG*(params.elev_));
-    }
-    catch (const SymmetricAntennaPatternLimitException&)
-    {
-      return SMALL_DB_VAL;
-    }
+    return countedGain(counters_(), monopulse_.gain_(params.delta_, findex_, params.azim_, params.elev_, params.refGain_));
   }
-  else
+
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
   {
-    try
-    {
-      magph = BilinearLookup(sumPat_, RAD2DEG*(params.azim_), RAD2DEG*(params.elev_));
-    }
-    catch (const SymmetricAntennaPatternLimitException&)
-    {
-      return SMALL_DB_VAL;
-    }
+    assert(count == 0 || (azim && elev && gains));
+    if (count == 0 || !azim || !elev || !gains)
+      return;
+    CountedGains counted(counters_(), gains, count);
+    for (size_t i = 0; i < count; ++i)
+      gains[i] = monopulse_.gain_(params.delta_, findex_, azim[i], elev[i], params.refGain_);
   }
 
-  return static_cast<float>(params.refGain_ + linear2dB(std::abs(magph)));
+private:
+  const AntennaPatternMonopulse& monopulse_;  ///< Pattern being evaluated
+  size_t findex_;                             ///< Index of the sum and delta tables nearest the bound frequency
+};
+
+std::unique_ptr<AntennaPatternEvaluator> AntennaPatternMonopulse::bindFrequency(double freq) const
+{
+  if (!valid_)
+    return AntennaPattern::bindFrequency(freq);
+  return std::unique_ptr<AntennaPatternEvaluator>(new FrequencyEvaluator(*this, freq));
 }
 
-void AntennaPatternMonopulse::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
+void AntennaPatternMonopulse::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
 {
   assert(min && max);
   if (!min || !max)
     return;
 
-  if (params.delta_ && minDelGain_ == -SMALL_DB_VAL)
+  // sum and delta channels of each frequency are cached separately, relative to the reference gain; the extremes
+  // of interpolated complex values need not lie at grid points, so each channel is swept once
+  const size_t findex = freqIndex_(params.freq_);
+  const MinMaxGainCache::Key key(0.f, 0.f, 0.f, static_cast<int>(2 * findex) + ((params.delta_) ? 1 : 0));
+  float minGain = -SMALL_DB_VAL;
+  float maxGain = SMALL_DB_VAL;
+  const bool cached = minMaxCache_.find(key, &minGain, &maxGain);
+  countMinMax(counters_, !cached);
+  if (!cached)
   {
-    setMinMaxGain_(&minDelGain_, &maxDelGain_, params.refGain_, params.delta_);
+    setMinMaxGain_(&minGain, &maxGain, 0.f, params.delta_, findex);
+    minMaxCache_.store(key, minGain, maxGain);
   }
-  else if (!params.delta_ && minGain_ == -SMALL_DB_VAL)
+
+  *min = minGain + params.refGain_;
+  *max = maxGain + params.refGain_;
+}
+
+float AntennaPatternMonopulse::upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const
+{
+  if (!valid_) return SMALL_DB_VAL;
+
+  const size_t findex = freqIndex_(params.freq_);
+  const double minX = RAD2DEG*(azimMin - BOUND_ANGLE_MARGIN);
+  const double maxX = RAD2DEG*(azimMax + BOUND_ANGLE_MARGIN);
+  const double minY = RAD2DEG*(elevMin - BOUND_ANGLE_MARGIN);
+  const double maxY = RAD2DEG*(elevMax + BOUND_ANGLE_MARGIN);
+  double peak = -HUGE_VAL;
+  if (!gainPats_.empty())
   {
-    setMinMaxGain_(&minGain_, &maxGain_, params.refGain_, params.delta_);
+    if (!gridValueMax(gainPats_[2 * findex + ((params.delta_) ? 1 : 0)], minX, maxX, minY, maxY, peak))
+      return SMALL_DB_VAL;
+    return roundBoundUp(params.refGain_ + peak);
   }
 
-  *min = (params.delta_) ? minDelGain_ : minGain_;
-  *max = (params.delta_) ? maxDelGain_ : maxGain_;
+  // the magnitude of an interpolated complex value is at most the largest magnitude at the cell corners
+  bool found = false;
+  if (floatPats_.empty())
+  {
+    const GridTable<std::complex<double> >& lut = pattern_(params.delta_, findex);
+    found = gridNodeMax(lut, minX, maxX, minY, maxY, [&lut](size_t i, size_t j) { return std::abs(lut(i, j)); }, peak);
+  }
+  else
+  {
+    const FloatChannel &channel = floatPats_[2 * findex + ((params.delta_) ? 1 : 0)];
+    const GridTable<float>& real = channel.real_;
+    const GridTable<float>& imag = channel.imag_;
+    if (sameGrid(real, imag))
+      found = gridNodeMax(real, minX, maxX, minY, maxY, [&real, &imag](size_t i, size_t j) { return std::hypot(real(i, j), imag(i, j)); }, peak);
+    else
+    {
+      // parts interpolate in cells of their own, bound each separately
+      double realPeak = 0.0;
+      double imagPeak = 0.0;
+      found = gridNodeMax(real, minX, maxX, minY, maxY, [&real](size_t i, size_t j) { return fabs(real(i, j)); }, realPeak) &&
+        gridNodeMax(imag, minX, maxX, minY, maxY, [&imag](size_t i, size_t j) { return fabs(imag(i, j)); }, imagPeak);
+      peak = std::hypot(realPeak, imagPeak);
+    }
+  }
+  if (!found)
+    return SMALL_DB_VAL;
+  return roundBoundUp(params.refGain_ + linear2dB(peak));
 }
 
-void AntennaPatternMonopulse::setMinMaxGain_(float *min, float *max, float maxGain, bool delta)
+void AntennaPatternMonopulse::setMinMaxGain_(float *min, float *max, float maxGain, bool delta, size_t findex) const
 {
   assert(min && max);
   if (!min || !max)
@@ -1782,20 +4253,18 @@ void AntennaPatternMonopulse::setMinMaxGain_(float *min, float *max, float maxGa
   double radius;
   double dmin = HUGE_VAL;
   double dmax = -HUGE_VAL;
-  int maxAz = static_cast<int>((delta) ? delPat_.lut().maxX() : sumPat_.lut().maxX());
-  int minAz = static_cast<int>((delta) ? delPat_.lut().minX() : sumPat_.lut().minX());
-  int maxEl = static_cast<int>((delta) ? delPat_.lut().maxY() : sumPat_.lut().maxY());
-  int minEl = static_cast<int>((delta) ? delPat_.lut().minY() : sumPat_.lut().minY());
-  AntennaGainParameters agp;
-  agp.refGain_ = maxGain;
-  agp.delta_ = delta;
+  int minAz, maxAz, minEl, maxEl;
+  if (floatPats_.empty())
+    gridDegreeExtents(pattern_(delta, findex), minAz, maxAz, minEl, maxEl);
+  else
+    gridDegreeExtents(floatPats_[2 * findex + ((delta) ? 1 : 0)].real_, minAz, maxAz, minEl, maxEl);
+  // gain_() directly, so that the sweep is not counted as lookups
   for (int ii = minAz; ii <= maxAz; ++ii)
   {
-    agp.azim_ = static_cast<float>(DEG2RAD*(ii));
+    const float azim = static_cast<float>(DEG2RAD*(ii));
     for (int jj = minEl; jj <= maxEl; ++jj)
     {
-      agp.elev_ = static_cast<float>(DEG2RAD*(jj));
-      radius = gain(agp);
+      radius = (valid_) ? gain_(delta, findex, azim, static_cast<float>(DEG2RAD*(jj)), maxGain) : SMALL_DB_VAL;
       if (radius > SMALL_DB_COMPARE)
       {
         dmin = sdkMin(dmin, radius);
@@ -1809,7 +4278,7 @@ void AntennaPatternMonopulse::setMinMaxGain_(float *min, float *max, float maxGa
   *max = static_cast<float>(dmax);
 }
 
-int AntennaPatternMonopulse::readPat(const std::string& inFileName, double freq)
+int AntennaPatternMonopulse::readPat(const std::string& inFileName, double freq, bool allFrequencies)
 {
   reset_();
   if (inFileName.empty())
@@ -1817,29 +4286,146 @@ int AntennaPatternMonopulse::readPat(const std::string& inFileName, double freq)
 
   freq_ = freq;
 
-  if (!readPattern(&sumPat_, inFileName, "sum", freq_))
+  // read both channels in a single pass over the file
+  if (allFrequencies)
   {
-    SIM_ERROR << inFileName << " sum channel failed to load" << std::endl;
-    return 2;
+    std::vector<SymmetricAntennaPattern> sumPats;
+    std::vector<SymmetricAntennaPattern> delPats;
+    std::map<std::string, std::vector<SymmetricAntennaPattern>*> channels;
+    channels["sum"] = &sumPats;
+    channels["diff"] = &delPats;
+    if (!readPatterns(channels, &freqData_, inFileName))
+    {
+      SIM_ERROR << inFileName << " monopulse channels failed to load" << std::endl;
+      reset_();
+      return 2;
+    }
+    // frequencies are evenly spaced, so a negative step lists them in decreasing order
+    if (freqData_.front() > freqData_.back())
+    {
+      std::reverse(freqData_.begin(), freqData_.end());
+      std::reverse(sumPats.begin(), sumPats.end());
+      std::reverse(delPats.begin(), delPats.end());
+    }
+    assignGrids(sumPats, sumPats_);
+    assignGrids(delPats, delPats_);
   }
-
-  if (!readPattern(&delPat_, inFileName, "diff", freq_))
+  else
   {
-    SIM_ERROR << inFileName << " diff channel failed to load" << std::endl;
-    return 2;
+    SymmetricAntennaPattern sumPat;
+    SymmetricAntennaPattern delPat;
+    std::map<std::string, SymmetricAntennaPattern*> channels;
+    channels["sum"] = &sumPat;
+    channels["diff"] = &delPat;
+    if (!readPatterns(channels, inFileName, freq_))
+    {
+      SIM_ERROR << inFileName << " monopulse channels failed to load" << std::endl;
+      return 2;
+    }
+    sumPat_.assign(sumPat);
+    delPat_.assign(delPat);
   }
 
   filename_ = inFileName;
   valid_ = true;
+  applyPrecomputedGain_();
+  applyPrecision_();
+
+  return 0;
+}
+
+// Sections: scalars {freq_}, grid 0 sum pattern, grid 1 delta pattern; when every frequency is kept,
+// array 0 frequencies, grids 2n and 2n + 1 the sum and delta patterns of frequency n
+int AntennaPatternMonopulse::writeCompiled(CompiledPatternWriter& writer) const
+{
+  // compiled patterns hold double precision complex values, single precision patterns are widened one at a time
+  GridTable<std::complex<double> > widened;
+  auto pattern = [&](bool delta, size_t findex) -> const GridTable<std::complex<double> >&
+  {
+    if (floatPats_.empty())
+      return pattern_(delta, findex);
+    const FloatChannel &channel = floatPats_[2 * findex + ((delta) ? 1 : 0)];
+    joinComplexGrid(channel.real_, channel.imag_, widened);
+    return widened;
+  };
+
+  AntennaPattern::writeCompiled(writer);
+  writer.addDoubles(COMPILED_SECTION_SCALARS, &freq_, 1);
+  if (freqData_.empty())
+  {
+    writer.addGrid(COMPILED_SECTION_GRID, pattern(false, 0));
+    writer.addGrid(COMPILED_SECTION_GRID + 2, pattern(true, 0));
+    return 0;
+  }
+
+  if (freqData_.size() > COMPILED_GRID_LIMIT / 2)
+  {
+    SIM_ERROR << "Monopulse pattern has too many frequencies to compile: " << freqData_.size() << std::endl;
+    return 1;
+  }
+  writer.addDoubles(COMPILED_SECTION_ARRAY, &freqData_[0], freqData_.size());
+  for (size_t i = 0; i < freqData_.size(); ++i)
+  {
+    writer.addGrid(static_cast<uint32_t>(COMPILED_SECTION_GRID + 4 * i), pattern(false, i));
+    writer.addGrid(static_cast<uint32_t>(COMPILED_SECTION_GRID + 4 * i + 2), pattern(true, i));
+  }
+  return 0;
+}
+
+int AntennaPatternMonopulse::readCompiled(const CompiledPatternReader& reader)
+{
+  reset_();
+  double scalars[1];
+  if (AntennaPattern::readCompiled(reader) != 0 || !readCompiledScalars(reader, scalars, 1) ||
+    !readCompiledFrequencies(reader, COMPILED_GRID_LIMIT / 2, &freqData_))
+    return 1;
 
+  if (freqData_.empty())
+  {
+    if (reader.readGrid(COMPILED_SECTION_GRID, &sumPat_) != 0 ||
+      reader.readGrid(COMPILED_SECTION_GRID + 2, &delPat_) != 0)
+      return 1;
+  }
+  else
+  {
+    sumPats_.resize(freqData_.size());
+    delPats_.resize(freqData_.size());
+    for (size_t i = 0; i < freqData_.size(); ++i)
+    {
+      if (reader.readGrid(static_cast<uint32_t>(COMPILED_SECTION_GRID + 4 * i), &sumPats_[i]) != 0 ||
+        reader.readGrid(static_cast<uint32_t>(COMPILED_SECTION_GRID + 4 * i + 2), &delPats_[i]) != 0)
+      {
+        reset_();
+        return 1;
+      }
+    }
+  }
+  freq_ = scalars[0];
+  valid_ = true;
+  applyPrecomputedGain_();
+  applyPrecision_();
   return 0;
 }
 
 // ----------------------------------------------------------------------------
 /// AntennaPatternBiLinear helper functions
 
-/* Bilinear lookup table for gain only antenna patterns                      */
-bool readPattern(SymmetricGainAntPattern *sap, std::istream &in, double frequency, double frequencyThreshold)
+namespace
+{
+/**
+* Finds the bilinear block in a stream and parses it, either keeping the data within the threshold of the requested
+* frequency and skipping the data of other frequencies, or keeping every frequency
+* @param[out] sap SymmetricGainAntPattern class to fill, unused when allPats is set
+* @param[in ] in Input stream to read
+* @param[in ] frequency Frequency of antenna pattern (Hz), unused when allPats is set
+* @param[in ] frequencyThreshold Frequency threshold between different frequencies in pattern (Hz), unused when allPats is set
+* @param[out] allPats If set, receives the pattern of every frequency instead of sap
+* @param[out] allFreqs If allPats is set, receives the frequency of each pattern (Hz)
+* @return boolean, true:success, false on failure
+* @pre sap valid param, or allPats and allFreqs valid params
+*/
+bool readGainPattern(SymmetricGainAntPattern *sap, std::istream &in, double frequency, double frequencyThreshold,
+  std::vector<SymmetricGainAntPattern> *allPats = nullptr, std::vector<double> *allFreqs = nullptr)
 {
   double minfreq = 0;
   double stepfreq = 1;
@@ -1975,13 +4561,25 @@ bool readPattern(SymmetricGainAntPattern *sap, std::istream &in, double frequenc
     return false;
   }
 
-  sap->initialize(minaz, maxaz, numaz, minel, maxel, numel);
+  if (!allPats)
+    sap->initialize(minaz, maxaz, numaz, minel, maxel, numel);
 
   // parse mag phase pairs
   for (i = 0; i < numfreq; ++i)
   {
     double currentFreq = minfreq + i * stepfreq;
-    if (frequency < currentFreq + frequencyThreshold && frequency > currentFreq - frequencyThreshold)
+    SymmetricGainAntPattern *target = nullptr;
+    if (allPats)
+    {
+      allPats->push_back(SymmetricGainAntPattern());
+      allFreqs->push_back(currentFreq);
+      target = &allPats->back();
+      target->initialize(minaz, maxaz, numaz, minel, maxel, numel);
+    }
+    else if (frequency < currentFreq + frequencyThreshold && frequency > currentFreq - frequencyThreshold)
+      target = sap;
+
+    if (target)
     {
       freqFound = true;
       for (size_t j = 0; j < numaz; ++j)
@@ -1998,7 +4596,7 @@ bool readPattern(SymmetricGainAntPattern *sap, std::istream &in, double frequenc
               SIM_ERROR << "Encountered invalid number for SymmetricGainAntPattern magnitude" << std::endl;
               return 1;
             }
-            (*sap)(j, k) = magnitude;
+            (*target)(j, k) = magnitude;
           }
           else
           {
@@ -2007,7 +4605,7 @@ bool readPattern(SymmetricGainAntPattern *sap, std::istream &in, double frequenc
           }
           if (!in)
           {
-            SIM_ERROR << "SymmetricGainAntPattern ran out of data for frequency " << frequency << std::endl;
+            SIM_ERROR << "SymmetricGainAntPattern ran out of data for frequency " << currentFreq << std::endl;
             return false;
           }
         }
@@ -2031,6 +4629,13 @@ bool readPattern(SymmetricGainAntPattern *sap, std::istream &in, double frequenc
 
   return true;
 }
+}
+
+/* Bilinear lookup table for gain only antenna patterns                      */
+bool readPattern(SymmetricGainAntPattern *sap, std::istream &in, double frequency, double frequencyThreshold)
+{
+  return readGainPattern(sap, in, frequency, frequencyThreshold);
+}
 
 bool readPattern(SymmetricGainAntPattern *sap, const std::string &filename, double frequency, double frequencythreshold)
 {
@@ -2038,12 +4643,29 @@ bool readPattern(SymmetricGainAntPattern *sap, const std::string &filename, doub
   return readPattern(sap, in, frequency, frequencythreshold);
 }
 
+bool readPatterns(std::vector<SymmetricGainAntPattern> *saps, std::vector<double> *frequencies, std::istream &in)
+{
+  assert(saps && frequencies);
+  if (!saps || !frequencies)
+    return false;
+  saps->clear();
+  frequencies->clear();
+  return readGainPattern(nullptr, in, 0.0, 0.0, saps, frequencies);
+}
+
+bool readPatterns(std::vector<SymmetricGainAntPattern> *saps, std::vector<double> *frequencies, const std::string &filename)
+{
+  std::fstream in(simCore::streamFixUtf8(filename), std::ios::in);
+  return readPatterns(saps, frequencies, in);
+}
+
 // ----------------------------------------------------------------------------
 /// AntennaPatternBiLinear methods
 
 AntennaPatternBiLinear::AntennaPatternBiLinear()
   : AntennaPattern(),
-  freq_(0)
+  freq_(0),
+  singlePrecision_(false)
 {}
 
 AntennaPatternBiLinear::~AntennaPatternBiLinear()
@@ -2058,75 +4680,437 @@ void AntennaPatternBiLinear::reset_()
   filename_.clear();
   minGain_ = -SMALL_DB_VAL;
   maxGain_ = SMALL_DB_VAL;
+  freqData_.clear();
+  antPat_.clear();
+  freqPats_.clear();
+  floatPats_.clear();
+  freqMinGain_.clear();
+  freqMaxGain_.clear();
 }
 
-float AntennaPatternBiLinear::gain(const AntennaGainParameters &params)
+void AntennaPatternBiLinear::setSinglePrecision(bool singlePrecision)
 {
-  if (!valid_) return SMALL_DB_VAL;
+  if (singlePrecision == singlePrecision_)
+    return;
+  singlePrecision_ = singlePrecision;
+  applyPrecision_();
+}
+
+void AntennaPatternBiLinear::applyPrecision_()
+{
+  if (!valid_)
+    return;
+
+  if (singlePrecision_ && floatPats_.empty())
+  {
+    const auto narrow = [](double value) { return static_cast<float>(value); };
+    if (freqData_.empty())
+    {
+      floatPats_.resize(1);
+      convertGrid(antPat_, floatPats_[0], narrow);
+      antPat_.clear();
+    }
+    else
+    {
+      floatPats_.resize(freqPats_.size());
+      for (size_t i = 0; i < freqPats_.size(); ++i)
+        convertGrid(freqPats_[i], floatPats_[i], narrow);
+      std::vector<GridTable<double> >().swap(freqPats_);
+    }
+  }
+  else if (!singlePrecision_ && !floatPats_.empty())
+  {
+    const auto widen = [](float value) { return static_cast<double>(value); };
+    if (freqData_.empty())
+      convertGrid(floatPats_[0], antPat_, widen);
+    else
+    {
+      freqPats_.resize(floatPats_.size());
+      for (size_t i = 0; i < floatPats_.size(); ++i)
+        convertGrid(floatPats_[i], freqPats_[i], widen);
+    }
+    std::vector<GridTable<float> >().swap(floatPats_);
+  }
+}
+
+void AntennaPatternBiLinear::freqIndex_(double freq, size_t &flowindex, double &fdelta, size_t *hint) const
+{
+  flowindex = 0;
+  fdelta = 0.0;
+  if (freqData_.size() < 2 || !(freq > freqData_.front()))
+    return;
+  if (freq >= freqData_.back())
+  {
+    flowindex = freqData_.size() - 2;
+    fdelta = 1.0;
+    return;
+  }
+
+  if (hint && bracketNear(freqData_, freq, *hint))
+    flowindex = *hint;
+  else
+  {
+    flowindex = std::upper_bound(freqData_.begin(), freqData_.end(), freq) - freqData_.begin() - 1;
+    if (hint)
+      *hint = flowindex;
+  }
+  fdelta = (freq - freqData_[flowindex]) / (freqData_[flowindex + 1] - freqData_[flowindex]);
+}
+
+bool AntennaPatternBiLinear::lookup_(size_t findex, float azim, float elev, double &gain) const
+{
+  if (floatPats_.empty())
+  {
+    const GridTable<double> &pat = (freqData_.empty()) ? antPat_ : freqPats_[findex];
+    return bilinearLookup(pat, RAD2DEG*(azim), RAD2DEG*(elev), gain);
+  }
+
+  float floatGain = 0.f;
+  if (!bilinearLookup(floatPats_[findex], RAD2DEG*(azim), RAD2DEG*(elev), floatGain))
+    return false;
+  gain = floatGain;
+  return true;
+}
+
+bool AntennaPatternBiLinear::gain_(float azim, float elev, size_t flowindex, double fdelta, float &gain) const
+{
+  double lowGain = 0.0;
+  if (freqData_.empty())
+  {
+    if (!lookup_(0, azim, elev, lowGain))
+      return false;
+    gain = static_cast<float>(lowGain);
+    return true;
+  }
+
+  // interpolate the dB gains of the bracketing frequencies
+  if (!lookup_(flowindex, azim, elev, lowGain))
+    return false;
+  if (fdelta > 0.0)
+  {
+    double highGain = 0.0;
+    if (!lookup_(flowindex + 1, azim, elev, highGain))
+      return false;
+    lowGain += fdelta * (highGain - lowGain);
+  }
+  gain = static_cast<float>(lowGain);
+  return true;
+}
 
+float AntennaPatternBiLinear::gain(const AntennaGainParameters &params) const
+{
+  if (!valid_) return countedGain(counters_, SMALL_DB_VAL);
+
+  size_t flowindex = 0;
+  double fdelta = 0.0;
+  freqIndex_(params.freq_, flowindex, fdelta);
   float gain = 0.f;
-  try
+  if (!gain_(params.azim_, params.elev_, flowindex, fdelta, gain))
   {
-    gain = static_cast<float>(BilinearLookup(antPat_, RAD2DEG*(params.azim_), RAD2DEG*(params.elev_)));
+    // error, could not find requested angles
+    return countedGain(counters_, SMALL_DB_VAL);
   }
-  catch (const SymmetricGainAntPatternLimitException&)
+  // units are stored as dB, therefore add
+  return countedGain(counters_, params.refGain_ + gain);
+}
+
+float AntennaPatternBiLinear::cursorGain(const AntennaGainParameters &params, AntennaLookupCursor &cursor) const
+{
+  if (!valid_) return countedGain(counters_, SMALL_DB_VAL);
+
+  size_t flowindex = 0;
+  double fdelta = 0.0;
+  freqIndex_(params.freq_, flowindex, fdelta, &cursor.freqIndex_);
+  float gain = 0.f;
+  if (!gain_(params.azim_, params.elev_, flowindex, fdelta, gain))
   {
     // error, could not find requested angles
-    return SMALL_DB_VAL;
+    return countedGain(counters_, SMALL_DB_VAL);
   }
   // units are stored as dB, therefore add
-  return params.refGain_ + gain;
+  return countedGain(counters_, params.refGain_ + gain);
+}
+
+void AntennaPatternBiLinear::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+  CountedGains counted(counters_, gains, count);
+
+  if (!valid_)
+  {
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+    return;
+  }
+
+  // frequency is shared by all directions, interpolate it once
+  size_t flowindex = 0;
+  double fdelta = 0.0;
+  freqIndex_(params.freq_, flowindex, fdelta);
+  for (size_t i = 0; i < count; ++i)
+  {
+    float gain = 0.f;
+    // units are stored as dB, therefore add; on error, could not find requested angles
+    gains[i] = (gain_(azim[i], elev[i], flowindex, fdelta, gain)) ? params.refGain_ + gain : SMALL_DB_VAL;
+  }
+}
+
+/// Evaluates a bilinear pattern from the tables bracketing one frequency
+class AntennaPatternBiLinear::FrequencyEvaluator : public AntennaPatternEvaluator
+{
+public:
+  /**
+  * Locates the tables of the pattern bracketing the frequency
+  * @param[in ] pattern Valid pattern to evaluate
+  * @param[in ] freq Frequency to evaluate the pattern at (Hz)
+  */
+  FrequencyEvaluator(const AntennaPatternBiLinear& pattern, double freq)
+    : AntennaPatternEvaluator(pattern, freq),
+    bilinear_(pattern),
+    flowindex_(0),
+    fdelta_(0.0)
+  {
+    pattern.freqIndex_(freq, flowindex_, fdelta_);
+  }
+
+  virtual float gain(const AntennaGainParameters &params) const
+  {
+    float gain = 0.f;
+    // units are stored as dB, therefore add; on error, could not find requested angles
+    return countedGain(counters_(), (bilinear_.gain_(params.azim_, params.elev_, flowindex_, fdelta_, gain)) ? params.refGain_ + gain : SMALL_DB_VAL);
+  }
+
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+  {
+    assert(count == 0 || (azim && elev && gains));
+    if (count == 0 || !azim || !elev || !gains)
+      return;
+    CountedGains counted(counters_(), gains, count);
+    for (size_t i = 0; i < count; ++i)
+    {
+      float gain = 0.f;
+      gains[i] = (bilinear_.gain_(azim[i], elev[i], flowindex_, fdelta_, gain)) ? params.refGain_ + gain : SMALL_DB_VAL;
+    }
+  }
+
+private:
+  const AntennaPatternBiLinear& bilinear_;  ///< Pattern being evaluated
+  size_t flowindex_;                        ///< Index of the lower frequency table
+  double fdelta_;                           ///< Fractional offset from the lower frequency table
+};
+
+std::unique_ptr<AntennaPatternEvaluator> AntennaPatternBiLinear::bindFrequency(double freq) const
+{
+  if (!valid_)
+    return AntennaPattern::bindFrequency(freq);
+  return std::unique_ptr<AntennaPatternEvaluator>(new FrequencyEvaluator(*this, freq));
 }
 
-void AntennaPatternBiLinear::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
+void AntennaPatternBiLinear::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
 {
   assert(min && max);
   if (!min || !max)
     return;
+  countMinMax(counters_, false);
+
+  if (freqData_.empty())
+  {
+    *min = minGain_ + params.refGain_;
+    *max = maxGain_ + params.refGain_;
+    return;
+  }
+
+  // interpolated gains lie between those of the bracketing frequencies
+  size_t flowindex = 0;
+  double fdelta = 0.0;
+  freqIndex_(params.freq_, flowindex, fdelta);
+  const size_t fhighindex = (fdelta > 0.0) ? flowindex + 1 : flowindex;
+  *min = sdkMin(freqMinGain_[flowindex], freqMinGain_[fhighindex]) + params.refGain_;
+  *max = sdkMax(freqMaxGain_[flowindex], freqMaxGain_[fhighindex]) + params.refGain_;
+}
+
+float AntennaPatternBiLinear::upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const
+{
+  if (!valid_) return SMALL_DB_VAL;
+
+  size_t flowindex = 0;
+  double fdelta = 0.0;
+  freqIndex_(params.freq_, flowindex, fdelta);
+  const size_t fhighindex = (fdelta > 0.0) ? flowindex + 1 : flowindex;
+  const double minX = RAD2DEG*(azimMin - BOUND_ANGLE_MARGIN);
+  const double maxX = RAD2DEG*(azimMax + BOUND_ANGLE_MARGIN);
+  const double minY = RAD2DEG*(elevMin - BOUND_ANGLE_MARGIN);
+  const double maxY = RAD2DEG*(elevMax + BOUND_ANGLE_MARGIN);
+  // interpolated gains lie between those of the bracketing frequencies, and gain() needs both of them
+  double peak = -HUGE_VAL;
+  for (size_t findex = flowindex; findex <= fhighindex; ++findex)
+  {
+    const bool found = (floatPats_.empty()) ?
+      gridValueMax((freqData_.empty()) ? antPat_ : freqPats_[findex], minX, maxX, minY, maxY, peak) :
+      gridValueMax(floatPats_[findex], minX, maxX, minY, maxY, peak);
+    if (!found)
+      return SMALL_DB_VAL;
+  }
+  return roundBoundUp(params.refGain_ + peak);
+}
+
+int AntennaPatternBiLinear::readPat(const std::string& inFileName, double freq, bool allFrequencies)
+{
+  reset_();
+  if (inFileName.empty())
+    return 1;
+
+  freq_ = freq;
+
+  if (allFrequencies)
+  {
+    std::vector<SymmetricGainAntPattern> freqPats;
+    if (!readPatterns(&freqPats, &freqData_, inFileName))
+    {
+      SIM_ERROR << inFileName << " Bilinear pattern failed to load" << std::endl;
+      reset_();
+      return 2;
+    }
+    // frequencies are evenly spaced, so a negative step lists them in decreasing order
+    if (freqData_.front() > freqData_.back())
+    {
+      std::reverse(freqData_.begin(), freqData_.end());
+      std::reverse(freqPats.begin(), freqPats.end());
+    }
+    assignGrids(freqPats, freqPats_);
+  }
+  else
+  {
+    SymmetricGainAntPattern antPat;
+    if (!readPattern(&antPat, inFileName, freq_))
+    {
+      SIM_ERROR << inFileName << " Bilinear pattern failed to load" << std::endl;
+      return 2;
+    }
+    antPat_.assign(antPat);
+  }
+
+  filename_ = inFileName;
+  valid_ = true;
+
+  // determine min & max values of each frequency
+  const size_t numPats = (freqPats_.empty()) ? 1 : freqPats_.size();
+  for (size_t i = 0; i < numPats; ++i)
+  {
+    const GridTable<double> &pat = (freqPats_.empty()) ? antPat_ : freqPats_[i];
+    float patMinGain = -SMALL_DB_VAL;
+    float patMaxGain = SMALL_DB_VAL;
+    float radius;
+    int maxAz = static_cast<int>(pat.maxX());
+    int minAz = static_cast<int>(pat.minX());
+    int maxEl = static_cast<int>(pat.maxY());
+    int minEl = static_cast<int>(pat.minY());
+    for (int ii = minAz; ii <= maxAz; ++ii)
+    {
+      const float azim = static_cast<float>(DEG2RAD*(ii));
+      for (int jj = minEl; jj <= maxEl; ++jj)
+      {
+        if (!gain_(azim, static_cast<float>(DEG2RAD*(jj)), i, 0.0, radius))
+          radius = SMALL_DB_VAL;
+        if (radius > SMALL_DB_COMPARE)
+        {
+          patMinGain = sdkMin(patMinGain, radius);
+        }
+        patMaxGain = sdkMax(patMaxGain, radius);
+      } // end for jj
+    } // end for ii
+
+    if (!freqPats_.empty())
+    {
+      freqMinGain_.push_back(patMinGain);
+      freqMaxGain_.push_back(patMaxGain);
+    }
+    minGain_ = sdkMin(minGain_, patMinGain);
+    maxGain_ = sdkMax(maxGain_, patMaxGain);
+  }
+  applyPrecision_();
+
+  return 0;
+}
+
+// Sections: scalars {freq_}, grid 0 gain pattern; when every frequency is kept, array 0 frequencies,
+// array 1 minimum and maximum gain of each frequency, grid n the gain pattern of frequency n
+int AntennaPatternBiLinear::writeCompiled(CompiledPatternWriter& writer) const
+{
+  // compiled patterns hold double precision gains, single precision patterns are widened one at a time
+  GridTable<double> widened;
+  auto pattern = [&](size_t findex) -> const GridTable<double>&
+  {
+    if (floatPats_.empty())
+      return (freqData_.empty()) ? antPat_ : freqPats_[findex];
+    convertGrid(floatPats_[findex], widened, [](float value) { return static_cast<double>(value); });
+    return widened;
+  };
+
+  AntennaPattern::writeCompiled(writer);
+  writer.addDoubles(COMPILED_SECTION_SCALARS, &freq_, 1);
+  if (freqData_.empty())
+  {
+    writer.addGrid(COMPILED_SECTION_GRID, pattern(0));
+    return 0;
+  }
 
-  *min = minGain_ + params.refGain_;
-  *max = maxGain_ + params.refGain_;
+  if (freqData_.size() > COMPILED_GRID_LIMIT)
+  {
+    SIM_ERROR << "Bilinear pattern has too many frequencies to compile: " << freqData_.size() << std::endl;
+    return 1;
+  }
+  std::vector<float> gainLimits;
+  for (size_t i = 0; i < freqData_.size(); ++i)
+  {
+    gainLimits.push_back(freqMinGain_[i]);
+    gainLimits.push_back(freqMaxGain_[i]);
+  }
+  writer.addDoubles(COMPILED_SECTION_ARRAY, &freqData_[0], freqData_.size());
+  writer.addFloats(COMPILED_SECTION_ARRAY + 1, &gainLimits[0], gainLimits.size());
+  for (size_t i = 0; i < freqData_.size(); ++i)
+    writer.addGrid(static_cast<uint32_t>(COMPILED_SECTION_GRID + 2 * i), pattern(i));
+  return 0;
 }
 
-int AntennaPatternBiLinear::readPat(const std::string& inFileName, double freq)
+int AntennaPatternBiLinear::readCompiled(const CompiledPatternReader& reader)
 {
   reset_();
-  if (inFileName.empty())
+  double scalars[1];
+  if (AntennaPattern::readCompiled(reader) != 0 || !readCompiledScalars(reader, scalars, 1) ||
+    !readCompiledFrequencies(reader, COMPILED_GRID_LIMIT, &freqData_))
     return 1;
 
-  freq_ = freq;
-
-  if (!readPattern(&antPat_, inFileName, freq_))
+  if (freqData_.empty())
   {
-    SIM_ERROR << inFileName << " Bilinear pattern failed to load" << std::endl;
-    return 2;
+    if (reader.readGrid(COMPILED_SECTION_GRID, &antPat_) != 0)
+      return 1;
   }
-
-  filename_ = inFileName;
-  valid_ = true;
-
-  // determine min & max values
-  float radius;
-  int maxAz = static_cast<int>(antPat_.lut().maxX());
-  int minAz = static_cast<int>(antPat_.lut().minX());
-  int maxEl = static_cast<int>(antPat_.lut().maxY());
-  int minEl = static_cast<int>(antPat_.lut().minY());
-  AntennaGainParameters agp;
-  for (int ii = minAz; ii <= maxAz; ++ii)
+  else
   {
-    agp.azim_ = static_cast<float>(DEG2RAD*(ii));
-    for (int jj = minEl; jj <= maxEl; ++jj)
+    size_t numLimits = 0;
+    const float *gainLimits = reader.floats(COMPILED_SECTION_ARRAY + 1, &numLimits);
+    if (!gainLimits || numLimits != 2 * freqData_.size())
     {
-      agp.elev_ = static_cast<float>(DEG2RAD*(jj));
-      radius = gain(agp);
-      if (radius > SMALL_DB_COMPARE)
+      reset_();
+      return 1;
+    }
+    freqPats_.resize(freqData_.size());
+    for (size_t i = 0; i < freqData_.size(); ++i)
+    {
+      if (reader.readGrid(static_cast<uint32_t>(COMPILED_SECTION_GRID + 2 * i), &freqPats_[i]) != 0)
       {
-        minGain_ = sdkMin(minGain_, radius);
+        reset_();
+        return 1;
       }
-      maxGain_ = sdkMax(maxGain_, radius);
-    } // end for jj
-  } // end for ii
-
+      freqMinGain_.push_back(gainLimits[2 * i]);
+      freqMaxGain_.push_back(gainLimits[2 * i + 1]);
+    }
+  }
+  freq_ = scalars[0];
+  valid_ = true;
+  applyPrecision_();
   return 0;
 }
 
@@ -2139,148 +5123,188 @@ AntennaPatternNSMA::AntennaPatternNSMA()
   halfPowerBeamWidth_(0),
   minFreq_(0),
   maxFreq_(0),
-  minHVGain_(-SMALL_DB_VAL),
-  maxHVGain_(SMALL_DB_VAL),
-  minVHGain_(-SMALL_DB_VAL),
-  maxVHGain_(SMALL_DB_VAL),
-  minVVGain_(-SMALL_DB_VAL),
-  maxVVGain_(SMALL_DB_VAL)
+  sharedAzimAngles_(false),
+  sharedElevAngles_(false)
 {}
 
-float AntennaPatternNSMA::gain(const AntennaGainParameters &params)
+void AntennaPatternNSMA::dataTables_(PolarityType polarity, const AngleGainTable **azimData, const AngleGainTable **elevData) const
 {
-  if (!valid_) return SMALL_DB_VAL;
-  AntennaLobeType lastLobe;
-  switch (params.polarity_)
+  switch (polarity)
   {
   case POLARITY_VERTICAL:
-    return calculateGain(&VVDataMap_,
-      &ELVVDataMap_,
-      lastLobe,
-      params.azim_,
-      params.elev_,
-      halfPowerBeamWidth_,
-      halfPowerBeamWidth_,
-      midBandGain_ + params.refGain_,
-      false);
+    *azimData = &VVTable_;
+    *elevData = &ELVVTable_;
     break;
 
   case POLARITY_HORZVERT:
   case POLARITY_RIGHTCIRC:
-    return calculateGain(&HVDataMap_,
-      &ELHVDataMap_,
-      lastLobe,
-      params.azim_,
-      params.elev_,
-      halfPowerBeamWidth_,
-      halfPowerBeamWidth_,
-      midBandGain_ + params.refGain_,
-      false);
+    *azimData = &HVTable_;
+    *elevData = &ELHVTable_;
     break;
 
   case POLARITY_VERTHORZ:
   case POLARITY_LEFTCIRC:
-    return calculateGain(&VHDataMap_,
-      &ELVHDataMap_,
-      lastLobe,
-      params.azim_,
-      params.elev_,
-      halfPowerBeamWidth_,
-      halfPowerBeamWidth_,
-      midBandGain_ + params.refGain_,
-      false);
+    *azimData = &VHTable_;
+    *elevData = &ELVHTable_;
     break;
 
   default:
-    return calculateGain(&HHDataMap_,
-      &ELHHDataMap_,
+    *azimData = &HHTable_;
+    *elevData = &ELHHTable_;
+    break;
+  }
+}
+
+void AntennaPatternNSMA::setSharedAngles_()
+{
+  sharedAzimAngles_ = HHTable_.sameAngles(HVTable_) && HHTable_.sameAngles(VHTable_) && HHTable_.sameAngles(VVTable_);
+  sharedElevAngles_ = ELHHTable_.sameAngles(ELHVTable_) && ELHHTable_.sameAngles(ELVHTable_) && ELHHTable_.sameAngles(ELVVTable_);
+}
+
+float AntennaPatternNSMA::gain(const AntennaGainParameters &params) const
+{
+  if (!valid_) return countedGain(counters_, SMALL_DB_VAL);
+  AntennaLobeType lastLobe;
+  const AngleGainTable *azimData = nullptr;
+  const AngleGainTable *elevData = nullptr;
+  dataTables_(params.polarity_, &azimData, &elevData);
+  return countedGain(counters_, calculateGain(azimData,
+    elevData,
+    lastLobe,
+    params.azim_,
+    params.elev_,
+    halfPowerBeamWidth_,
+    halfPowerBeamWidth_,
+    midBandGain_ + params.refGain_,
+    false));
+}
+
+std::unique_ptr<AntennaPatternEvaluator> AntennaPatternNSMA::bindFrequency(double freq) const
+{
+  return std::unique_ptr<AntennaPatternEvaluator>(new AntennaPatternEvaluator(*this, freq, valid_ && freq >= minFreq_ && freq <= maxFreq_));
+}
+
+void AntennaPatternNSMA::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+  CountedGains counted(counters_, gains, count);
+
+  if (!valid_)
+  {
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+    return;
+  }
+
+  AntennaLobeType lastLobe;
+  const AngleGainTable *azimData = nullptr;
+  const AngleGainTable *elevData = nullptr;
+  dataTables_(params.polarity_, &azimData, &elevData);
+  const float maxGain = midBandGain_ + params.refGain_;
+  for (size_t i = 0; i < count; ++i)
+  {
+    gains[i] = calculateGain(azimData,
+      elevData,
       lastLobe,
-      params.azim_,
-      params.elev_,
+      azim[i],
+      elev[i],
       halfPowerBeamWidth_,
       halfPowerBeamWidth_,
-      midBandGain_ + params.refGain_,
+      maxGain,
       false);
-    break;
   }
 }
 
-void AntennaPatternNSMA::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
+void AntennaPatternNSMA::polarityGains(const AntennaGainParameters &params, const PolarityType *polarities, size_t count, float *gains) const
 {
-  assert(min && max);
-  if (!min || !max)
+  assert(count == 0 || (polarities && gains));
+  if (count == 0 || !polarities || !gains)
     return;
 
-  switch (params.polarity_)
+  if (!valid_)
   {
-  case POLARITY_VERTICAL:
-    {
-      if (minVVGain_ == -SMALL_DB_VAL)
-      {
-        setMinMax_(&minVVGain_, &maxVVGain_, params.refGain_, params.polarity_);
-      }
-      *min = minVVGain_;
-      *max = maxVVGain_;
-    }
-    break;
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+    return;
+  }
+  if (halfPowerBeamWidth_ == 0.f)
+  {
+    // rejected by calculateGain()
+    AntennaPattern::polarityGains(params, polarities, count, gains);
+    return;
+  }
 
-  case POLARITY_HORZVERT:
-  case POLARITY_RIGHTCIRC:
-    {
-      if (minHVGain_ == -SMALL_DB_VAL)
-      {
-        setMinMax_(&minHVGain_, &maxHVGain_, params.refGain_, params.polarity_);
-      }
-      *min = minHVGain_;
-      *max = maxHVGain_;
-    }
-    break;
+  // the fallback counts through gain()
+  CountedGains counted(counters_, gains, count);
+
+  // unweighted calculateGain(): the mean of the azimuth and elevation gains, unless either is past its table
+  const size_t azimIndex = (sharedAzimAngles_) ? HHTable_.locate(params.azim_) : 0;
+  const size_t elevIndex = (sharedElevAngles_) ? ELHHTable_.locate(params.elev_) : 0;
+  const float maxGain = midBandGain_ + params.refGain_;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const AngleGainTable *azimData = nullptr;
+    const AngleGainTable *elevData = nullptr;
+    dataTables_(polarities[i], &azimData, &elevData);
+    gains[i] = SMALL_DB_VAL;
+    if (azimData->empty() || elevData->empty())
+      continue;
+    const float azimGain = (sharedAzimAngles_) ? azimData->gainAt(azimIndex, params.azim_) : azimData->gain(params.azim_);
+    if (azimGain == SMALL_DB_VAL)
+      continue;
+    const float elevGain = (sharedElevAngles_) ? elevData->gainAt(elevIndex, params.elev_) : elevData->gain(params.elev_);
+    if (elevGain != SMALL_DB_VAL)
+      gains[i] = maxGain + (azimGain + elevGain) / 2.0f;
+  }
+}
 
-  case POLARITY_VERTHORZ:
-  case POLARITY_LEFTCIRC:
-    {
-      if (minVHGain_ == -SMALL_DB_VAL)
-      {
-        setMinMax_(&minVHGain_, &maxVHGain_, params.refGain_, params.polarity_);
-      }
-      *min = minVHGain_;
-      *max = maxVHGain_;
-    }
-    break;
+void AntennaPatternNSMA::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
+{
+  assert(min && max);
+  if (!min || !max)
+    return;
 
-  default:
-    {
-      if (minGain_ == -SMALL_DB_VAL)
-      {
-        setMinMax_(&minGain_, &maxGain_, params.refGain_, params.polarity_);
-      }
-      *min = minGain_;
-      *max = maxGain_;
-    }
-    break;
-  }
+  // each polarity selects its own azimuth and elevation data, see dataTables_()
+  const MinMaxGainCache::Key key(0.f, 0.f, params.refGain_, static_cast<int>(params.polarity_));
+  const bool cached = minMaxCache_.find(key, min, max);
+  countMinMax(counters_, !cached);
+  if (cached)
+    return;
+
+  setMinMax_(min, max, params.refGain_, params.polarity_);
+  minMaxCache_.store(key, *min, *max);
 }
 
-void AntennaPatternNSMA::setMinMax_(float *min, float *max, float maxGain, PolarityType polarity)
+float AntennaPatternNSMA::upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const
+{
+  if (!valid_) return SMALL_DB_VAL;
+  const AngleGainTable *azimData = nullptr;
+  const AngleGainTable *elevData = nullptr;
+  dataTables_(params.polarity_, &azimData, &elevData);
+  return tableUpperBoundGain(azimData, elevData, nullptr, azimMin, azimMax, elevMin, elevMax, halfPowerBeamWidth_, halfPowerBeamWidth_, midBandGain_ + params.refGain_, false);
+}
+
+void AntennaPatternNSMA::setMinMax_(float *min, float *max, float maxGain, PolarityType polarity) const
 {
   assert(min && max);
   if (!min || !max)
     return;
 
-  // determine min & max values
+  // determine min & max values; calculateGain() as in gain(), so that the sweep is not counted as lookups
   float radius;
-  AntennaGainParameters agp;
-  agp.refGain_ = maxGain;
-  agp.polarity_ = polarity;
+  const AngleGainTable *azimData = nullptr;
+  const AngleGainTable *elevData = nullptr;
+  dataTables_(polarity, &azimData, &elevData);
+  AntennaLobeType lastLobe;
   float fmin = -SMALL_DB_VAL;
   float fmax = SMALL_DB_VAL;
   for (int ii = -180; ii <= 180; ++ii)
   {
-    agp.azim_ = static_cast<float>(DEG2RAD*(ii));
+    const float azim = static_cast<float>(DEG2RAD*(ii));
     for (int jj = -90; jj <= 90; ++jj)
     {
-      agp.elev_ = static_cast<float>(DEG2RAD*(jj));
-      radius = gain(agp);
+      radius = (valid_) ? calculateGain(azimData, elevData, lastLobe, azim, static_cast<float>(DEG2RAD*(jj)),
+        halfPowerBeamWidth_, halfPowerBeamWidth_, midBandGain_ + maxGain, false) : SMALL_DB_VAL;
       if (radius > SMALL_DB_COMPARE)
       {
         fmin = sdkMin(fmin, radius);
@@ -2642,6 +5666,16 @@ int AntennaPatternNSMA::readPat_(std::istream& fp)
     }
   }
 
+  HHTable_.compile(HHDataMap_);
+  ELHHTable_.compile(ELHHDataMap_);
+  HVTable_.compile(HVDataMap_);
+  ELHVTable_.compile(ELHVDataMap_);
+  VHTable_.compile(VHDataMap_);
+  ELVHTable_.compile(ELVHDataMap_);
+  VVTable_.compile(VVDataMap_);
+  ELVVTable_.compile(ELVVDataMap_);
+  setSharedAngles_();
+  minMaxCache_.clear();
   valid_ = true;
   return 0;
 }
@@ -2656,15 +5690,543 @@ int AntennaPatternNSMA::readPat(const std::string& inFileName)
     inFile.open(simCore::streamFixUtf8(inFileName), std::ios::in);
     if (inFile.is_open())
     {
-      st = readPat_(inFile);
-      inFile.close();
-      if (st == 0)
+      st = readPat_(inFile);
+      inFile.close();
+      if (st == 0)
+      {
+        filename_ = inFileName;
+      }
+    }
+  }
+  return st;
+}
+
+// Sections: scalars {midBandGain_, halfPowerBeamWidth_, minFreq_, maxFreq_},
+// tables 0-7 HH, ELHH, HV, ELHV, VH, ELVH, VV, ELVV
+int AntennaPatternNSMA::writeCompiled(CompiledPatternWriter& writer) const
+{
+  const double scalars[4] = { midBandGain_, halfPowerBeamWidth_, minFreq_, maxFreq_ };
+  const AngleGainTable* const tables[8] = { &HHTable_, &ELHHTable_, &HVTable_, &ELHVTable_, &VHTable_, &ELVHTable_, &VVTable_, &ELVVTable_ };
+  AntennaPattern::writeCompiled(writer);
+  writer.addDoubles(COMPILED_SECTION_SCALARS, scalars, 4);
+  for (uint32_t i = 0; i < 8; ++i)
+    writer.addTable(COMPILED_SECTION_TABLE + 4 * i, *tables[i]);
+  return 0;
+}
+
+int AntennaPatternNSMA::readCompiled(const CompiledPatternReader& reader)
+{
+  valid_ = false;
+  minMaxCache_.clear();
+  std::map<float, float>* const maps[8] = { &HHDataMap_, &ELHHDataMap_, &HVDataMap_, &ELHVDataMap_, &VHDataMap_, &ELVHDataMap_, &VVDataMap_, &ELVVDataMap_ };
+  AngleGainTable* const tables[8] = { &HHTable_, &ELHHTable_, &HVTable_, &ELHVTable_, &VHTable_, &ELVHTable_, &VVTable_, &ELVVTable_ };
+  double scalars[4];
+  if (AntennaPattern::readCompiled(reader) != 0 || !readCompiledScalars(reader, scalars, 4))
+    return 1;
+  for (uint32_t i = 0; i < 8; ++i)
+  {
+    // the compiled tables are used in place
+    maps[i]->clear();
+    if (reader.readTable(COMPILED_SECTION_TABLE + 4 * i, tables[i]) != 0)
+      return 1;
+  }
+  midBandGain_ = static_cast<float>(scalars[0]);
+  halfPowerBeamWidth_ = static_cast<float>(scalars[1]);
+  minFreq_ = scalars[2];
+  maxFreq_ = scalars[3];
+  setSharedAngles_();
+  valid_ = true;
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+/// AntennaPatternLoadOptions methods
+
+AntennaPatternLoadOptions::AntennaPatternLoadOptions()
+  : maxMemory_(0),
+    maxErrorDb_(0.f)
+{}
+
+namespace
+{
+  /**
+  * Reads the lines of a stream through one fixed size buffer and splits them into tokens in place, so that the data
+  * sections of large EZNEC and XFDTD files are parsed without allocating per line
+  */
+  class StreamingLineReader
+  {
+  public:
+    /// Size of the buffer, the longest line accepted including its end of line
+    static const size_t BUFFER_SIZE = 65536;
+    /// Most tokens split from a line, any further text is left in the last token
+    static const size_t MAX_TOKENS = 8;
+
+    /**
+    * Reads from the current position of the stream
+    * @param[in ] is Stream to read
+    * @param[in ] options Progress reporting of the load
+    */
+    StreamingLineReader(std::istream& is, const AntennaPatternLoadOptions& options)
+      : is_(is),
+      progress_(options.progress_),
+      buffer_(BUFFER_SIZE + 1),
+      begin_(0),
+      end_(0),
+      line_(&buffer_[0]),
+      lineLength_(0),
+      numTokens_(0),
+      position_(0),
+      size_(0),
+      eof_(false),
+      error_(false)
+    {
+      const std::streampos start = is_.tellg();
+      if (start != std::streampos(-1))
+      {
+        position_ = static_cast<uint64_t>(start);
+        is_.seekg(0, std::ios::end);
+        const std::streampos end = is_.tellg();
+        if (end != std::streampos(-1))
+          size_ = static_cast<uint64_t>(end);
+        is_.clear();
+        is_.seekg(start);
+      }
+    }
+
+    /**
+    * Advances to the next line, without its end of line
+    * @return true if a line was read, false at the end of the stream or on error, see error()
+    */
+    bool nextLine()
+    {
+      while (true)
+      {
+        char* const begin = &buffer_[begin_];
+        char* const newline = static_cast<char*>(memchr(begin, '\n', end_ - begin_));
+        if (newline || (eof_ && begin_ < end_))
+        {
+          // the buffer holds one extra byte to terminate a last line without an end of line
+          char* const end = (newline) ? newline : &buffer_[end_];
+          *end = '\0';
+          line_ = begin;
+          lineLength_ = end - begin;
+          if (lineLength_ > 0 && line_[lineLength_ - 1] == '\r')
+            line_[--lineLength_] = '\0';
+          begin_ = (newline) ? (newline - &buffer_[0]) + 1 : end_;
+          return true;
+        }
+        if (eof_ || !fill_())
+          return false;
+      }
+    }
+
+    /**
+    * Returns whether the current line contains a text, ignoring case; call before tokenize(), which splits the line
+    * @param[in ] text Lower case text to find
+    * @return true if the line contains text
+    */
+    bool contains(const char* text) const
+    {
+      const size_t length = strlen(text);
+      for (size_t i = 0; i + length <= lineLength_; ++i)
+      {
+        size_t j = 0;
+        while (j < length && tolower(static_cast<unsigned char>(line_[i + j])) == text[j])
+          ++j;
+        if (j == length)
+          return true;
+      }
+      return false;
+    }
+
+    /**
+    * Returns the first character of the current line that is not a delimiter
+    * @param[in ] delimiters Characters separating tokens
+    * @return first character of the first token, '\0' for an empty line
+    */
+    char firstChar(const char* delimiters) const
+    {
+      const size_t start = strspn(line_, delimiters);
+      return (start < lineLength_) ? line_[start] : '\0';
+    }
+
+    /**
+    * Splits the current line into tokens, replacing delimiters with terminators; empty tokens are skipped
+    * @param[in ] delimiters Characters separating tokens
+    * @return number of tokens
+    */
+    size_t tokenize(const char* delimiters)
+    {
+      numTokens_ = 0;
+      char* pos = line_ + strspn(line_, delimiters);
+      while (*pos != '\0' && numTokens_ < MAX_TOKENS)
+      {
+        tokens_[numTokens_++] = pos;
+        pos += strcspn(pos, delimiters);
+        if (*pos == '\0' || numTokens_ == MAX_TOKENS)
+          break;
+        *pos++ = '\0';
+        pos += strspn(pos, delimiters);
+      }
+      return numTokens_;
+    }
+
+    /**
+    * Parses a token of the current line as a number, the whole token must be numeric
+    * @param[in ] index Token index, less than the value returned by tokenize()
+    * @param[out] value Number parsed, unchanged on failure
+    * @return true on success, false if the token is not a finite number
+    */
+    bool number(size_t index, float& value) const
+    {
+      assert(index < numTokens_);
+      char* end = nullptr;
+      const double parsed = strtod(tokens_[index], &end);
+      if (end == tokens_[index])
+        return false;
+      end += strspn(end, " \t");
+      if (*end != '\0' || !(std::fabs(parsed) <= std::numeric_limits<float>::max()))
+        return false;
+      value = static_cast<float>(parsed);
+      return true;
+    }
+
+    /// @return true if reading stopped on a line longer than the buffer or a cancelled load, rather than at the end
+    bool error() const { return error_; }
+
+  private:
+    /**
+    * Moves the unread part of the buffer to its start and reads more of the stream after it
+    * @return false if the buffer holds a whole line already or the load was cancelled
+    */
+    bool fill_()
+    {
+      if (begin_ == 0 && end_ == BUFFER_SIZE)
+      {
+        SIM_ERROR << "Antenna pattern line exceeds " << BUFFER_SIZE << " characters" << std::endl;
+        error_ = true;
+        return false;
+      }
+      memmove(&buffer_[0], &buffer_[begin_], end_ - begin_);
+      end_ -= begin_;
+      begin_ = 0;
+      is_.read(&buffer_[end_], BUFFER_SIZE - end_);
+      const size_t count = static_cast<size_t>(is_.gcount());
+      end_ += count;
+      position_ += count;
+      eof_ = !is_;
+      if (progress_ && !progress_(position_, size_))
+      {
+        SIM_ERROR << "Antenna pattern load cancelled" << std::endl;
+        error_ = true;
+        return false;
+      }
+      return true;
+    }
+
+    std::istream& is_;                  ///< Stream to read
+    const std::function<bool(uint64_t, uint64_t)>& progress_;  ///< Progress callback, may be empty
+    std::vector<char> buffer_;          ///< Data read from is_, one byte longer than BUFFER_SIZE
+    size_t begin_;                      ///< Start of the unread data in buffer_
+    size_t end_;                        ///< End of the data in buffer_
+    char* line_;                        ///< Current line, terminated
+    size_t lineLength_;                 ///< Length of the current line
+    char* tokens_[MAX_TOKENS];          ///< Tokens of the current line, terminated
+    size_t numTokens_;                  ///< Number of tokens in tokens_
+    uint64_t position_;                 ///< Position of the end of the data in buffer_ in the stream
+    uint64_t size_;                     ///< Size of the stream, 0 if unknown
+    bool eof_;                          ///< Whether the stream has been read to its end
+    bool error_;                        ///< Whether reading stopped on an error
+  };
+
+  /**
+  * Returns whether a character can start a number
+  * @param[in ] c Character to test
+  * @return true for digits, signs and decimal points
+  */
+  bool startsNumber(char c)
+  {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.';
+  }
+
+  /**
+  * Checks the memory of the gain tables a load is about to create against the limit of the load options
+  * @param[in ] options Load options
+  * @param[in ] numValues Number of gain values to hold
+  * @param[in ] format Name of the pattern format, for the error message
+  * @return true if the tables fit the limit
+  */
+  bool fitsLoadMemory(const AntennaPatternLoadOptions& options, size_t numValues, const char* format)
+  {
+    if (options.maxMemory_ == 0 || numValues <= options.maxMemory_ / sizeof(float))
+      return true;
+    SIM_ERROR << format << " antenna pattern needs more than the " << options.maxMemory_ << " byte load memory limit" << std::endl;
+    return false;
+  }
+
+  /// Largest number of downsampled table sizes checked sample by sample, beyond those the error bound accepts
+  const size_t MAX_EXACT_DOWNSAMPLE_CHECKS = 64;
+
+  /**
+  * Interpolates a 2D lookup table at a point given in sample index units
+  * @param[in ] lut Table to interpolate
+  * @param[in ] x Position along x, within [0, numX() - 1]
+  * @param[in ] y Position along y, within [0, numY() - 1]
+  * @return interpolated value
+  */
+  double indexValue(const GridTable<float>& lut, double x, double y)
+  {
+    BilinearCell cell;
+    locateAxis(x, 0.0, static_cast<double>(lut.numX() - 1), lut.numX(), cell.x0, cell.x1, cell.dx);
+    locateAxis(y, 0.0, static_cast<double>(lut.numY() - 1), lut.numY(), cell.y0, cell.y1, cell.dy);
+    return bilinearValue(lut, cell);
+  }
+
+  /**
+  * Returns the position of a sample of an evenly spaced axis of num samples on an axis of fineNum samples with the
+  * same extents, in sample index units of the latter
+  * @param[in ] index Sample index
+  * @param[in ] num Number of samples of the axis of index
+  * @param[in ] fineNum Number of samples of the axis measured in
+  * @return position, exact at both ends
+  */
+  inline double samplePosition(size_t index, size_t num, size_t fineNum)
+  {
+    return (num < 2) ? 0.0 : static_cast<double>(index * (fineNum - 1)) / static_cast<double>(num - 1);
+  }
+
+  /// Interpolation cell of a position along one axis of a gain table, see locateAxis()
+  struct AxisCell
+  {
+    size_t lower;   ///< Index of the sample at or below the position
+    size_t upper;   ///< Index of the next sample
+    double offset;  ///< Fractional offset of the position from lower toward upper
+  };
+
+  /**
+  * Locates the samples of an evenly spaced axis of num samples on an axis of fineNum samples with the same extents
+  * @param[in ] num Number of samples to locate
+  * @param[in ] fineNum Number of samples of the axis located on, at least 2
+  * @return cell of each sample
+  */
+  std::vector<AxisCell> axisCells(size_t num, size_t fineNum)
+  {
+    std::vector<AxisCell> cells(num);
+    for (size_t k = 0; k < num; ++k)
+      locateAxis(samplePosition(k, num, fineNum), 0.0, static_cast<double>(fineNum - 1), fineNum, cells[k].lower, cells[k].upper, cells[k].offset);
+    return cells;
+  }
+
+  /**
+  * Returns the largest error of resampling every line of gain tables along one axis onto num evenly spaced samples,
+  * measured at the original samples. Lines interpolate linearly between the original samples and the new ones, and
+  * the new samples are taken from the lines, so this is the largest error anywhere along the axis.
+  * @param[in ] tables Gain tables sharing one grid, each with at least 2 samples along the axis
+  * @param[in ] numTables Number of tables
+  * @param[in ] alongX True to resample along x, false along y
+  * @param[in ] num Number of samples to resample onto, at least 2
+  * @param[in ] limit Error beyond which measuring stops
+  * @return largest error (dB), or an error above limit
+  */
+  double axisResampleError(GridTable<float>* const* tables, size_t numTables, bool alongX, size_t num, double limit)
+  {
+    const GridTable<float>& first = *tables[0];
+    const size_t fineNum = (alongX) ? first.numX() : first.numY();
+    const size_t numLines = (alongX) ? first.numY() : first.numX();
+    // cells are the same for every line
+    const std::vector<AxisCell>& coarseCells = axisCells(num, fineNum);
+    const std::vector<AxisCell>& fineCells = axisCells(fineNum, num);
+    std::vector<double> line(fineNum);
+    std::vector<double> coarse(num);
+    double maxError = 0.0;
+    for (size_t t = 0; t < numTables; ++t)
+    {
+      const GridTable<float>& lut = *tables[t];
+      for (size_t l = 0; l < numLines; ++l)
+      {
+        for (size_t i = 0; i < fineNum; ++i)
+          line[i] = (alongX) ? lut(i, l) : lut(l, i);
+        for (size_t k = 0; k < num; ++k)
+          coarse[k] = line[coarseCells[k].lower] * (1.0 - coarseCells[k].offset) + line[coarseCells[k].upper] * coarseCells[k].offset;
+        for (size_t i = 0; i < fineNum; ++i)
+        {
+          const AxisCell& cell = fineCells[i];
+          maxError = sdkMax(maxError, fabs(coarse[cell.lower] * (1.0 - cell.offset) + coarse[cell.upper] * cell.offset - line[i]));
+        }
+        if (maxError > limit)
+          return maxError;
+      }
+    }
+    return maxError;
+  }
+
+  /**
+  * Resamples a gain table onto an evenly spaced grid of the same extents by bilinear interpolation
+  * @param[in ] fine Table to resample
+  * @param[in ] numX Number of x samples, at least 1
+  * @param[in ] numY Number of y samples, at least 1
+  * @return resampled table
+  */
+  GridTable<float> resampleGainTable(const GridTable<float>& fine, size_t numX, size_t numY)
+  {
+    std::vector<float> values;
+    values.reserve(numX * numY);
+    for (size_t i = 0; i < numX; ++i)
+    {
+      const double x = samplePosition(i, numX, fine.numX());
+      for (size_t j = 0; j < numY; ++j)
+        values.push_back(static_cast<float>(indexValue(fine, x, samplePosition(j, numY, fine.numY()))));
+    }
+    GridTable<float> coarse;
+    coarse.assign(fine.minX(), fine.maxX(), numX, fine.minY(), fine.maxY(), numY, std::move(values));
+    return coarse;
+  }
+
+  /**
+  * Locates the samples of an axis of fineNum samples together with those of an evenly spaced axis of num samples
+  * over the same extents on both axes
+  * @param[in ] fineNum Number of original samples
+  * @param[in ] num Number of resampled samples
+  * @param[out] fineCells Cells of the positions on the original axis, in ascending position
+  * @param[out] coarseCells Cells of the same positions on the resampled axis
+  */
+  void mergedCells(size_t fineNum, size_t num, std::vector<AxisCell>& fineCells, std::vector<AxisCell>& coarseCells)
+  {
+    // positions in sample index units of the original axis
+    std::vector<double> positions;
+    positions.reserve(fineNum + num);
+    for (size_t i = 0; i < fineNum; ++i)
+      positions.push_back(static_cast<double>(i));
+    for (size_t k = 0; k < num; ++k)
+      positions.push_back(samplePosition(k, num, fineNum));
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+    const double scale = (fineNum < 2) ? 0.0 : static_cast<double>(num - 1) / static_cast<double>(fineNum - 1);
+    fineCells.resize(positions.size());
+    coarseCells.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+      locateAxis(positions[i], 0.0, static_cast<double>(fineNum - 1), fineNum, fineCells[i].lower, fineCells[i].upper, fineCells[i].offset);
+      const double coarse = sdkMin(positions[i] * scale, static_cast<double>(num - 1));
+      locateAxis(coarse, 0.0, static_cast<double>(num - 1), num, coarseCells[i].lower, coarseCells[i].upper, coarseCells[i].offset);
+    }
+  }
+
+  /**
+  * Returns whether resampling gain tables onto numX by numY evenly spaced samples keeps every value within maxError.
+  * Over the intersection of a cell of each grid both tables are bilinear, so the error is checked at the corners of
+  * all intersections: the original samples, the new samples, and where the lines of one grid cross the other.
+  * @param[in ] tables Gain tables sharing one grid, each with at least 2 samples per axis
+  * @param[in ] numTables Number of tables
+  * @param[in ] numX Number of x samples, at least 2
+  * @param[in ] numY Number of y samples, at least 2
+  * @param[in ] maxError Largest error allowed (dB)
+  * @return true if every value is within maxError
+  */
+  bool resampleFits(GridTable<float>* const* tables, size_t numTables, size_t numX, size_t numY, double maxError)
+  {
+    const GridTable<float>& first = *tables[0];
+    // cells of the checked positions on both grids, the same for every table
+    std::vector<AxisCell> fineX, fineY, coarseX, coarseY;
+    mergedCells(first.numX(), numX, fineX, coarseX);
+    mergedCells(first.numY(), numY, fineY, coarseY);
+    BilinearCell fineCell;
+    BilinearCell coarseCell;
+    for (size_t t = 0; t < numTables; ++t)
+    {
+      const GridTable<float>& coarse = resampleGainTable(*tables[t], numX, numY);
+      const GridTable<float>& fine = *tables[t];
+      for (size_t i = 0; i < fineX.size(); ++i)
+      {
+        fineCell.x0 = fineX[i].lower;
+        fineCell.x1 = fineX[i].upper;
+        fineCell.dx = fineX[i].offset;
+        coarseCell.x0 = coarseX[i].lower;
+        coarseCell.x1 = coarseX[i].upper;
+        coarseCell.dx = coarseX[i].offset;
+        for (size_t j = 0; j < fineY.size(); ++j)
+        {
+          fineCell.y0 = fineY[j].lower;
+          fineCell.y1 = fineY[j].upper;
+          fineCell.dy = fineY[j].offset;
+          coarseCell.y0 = coarseY[j].lower;
+          coarseCell.y1 = coarseY[j].upper;
+          coarseCell.dy = coarseY[j].offset;
+          if (fabs(static_cast<double>(bilinearValue(coarse, coarseCell)) - bilinearValue(fine, fineCell)) > maxError)
+            return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /**
+  * Resamples gain tables sharing one grid onto the smallest evenly spaced grid of the same extents that keeps every
+  * value within maxError, so that the tables, their shared cells and the compiled layout stay uniform.
+  * Resampling one axis and then the other does not amplify the error of the first, being linear interpolation, so
+  * sample counts whose errors along each axis sum to at most maxError fit; smaller grids whose counts fit each axis
+  * alone are then checked exactly, smallest first.
+  * @param[in,out] tables Gain tables to downsample, sharing one grid
+  * @param[in ] numTables Number of tables
+  * @param[in ] maxError Largest gain error allowed (dB)
+  */
+  void downsampleGainTables(GridTable<float>* const* tables, size_t numTables, double maxError)
+  {
+    assert(numTables > 0);
+    const GridTable<float>& lut = *tables[0];
+    const size_t numX = lut.numX();
+    const size_t numY = lut.numY();
+    if (numX < 3 && numY < 3)
+      return;
+
+    // error of each sample count along y, measured only as far as maxError; the original count has none
+    std::vector<double> errorY(numY + 1, 0.0);
+    for (size_t num = 2; num < numY; ++num)
+      errorY[num] = axisResampleError(tables, numTables, false, num, maxError);
+    size_t minY = (numY < 2) ? numY : 2;
+    while (errorY[minY] > maxError)
+      ++minY;
+
+    size_t bestX = numX;
+    size_t bestY = numY;
+    std::vector<std::pair<size_t, std::pair<size_t, size_t> > > candidates;
+    // counts along x whose product with the fewest samples along y is not below the best size cannot improve on it
+    for (size_t x = (numX < 2) ? numX : 2; x <= numX && x * minY < bestX * bestY; ++x)
+    {
+      const double errorX = (x < numX) ? axisResampleError(tables, numTables, true, x, maxError) : 0.0;
+      for (size_t y = minY; y <= numY; ++y)
+      {
+        if (errorX > maxError || errorY[y] > maxError)
+          continue;
+        if (errorX + errorY[y] <= maxError)
+        {
+          if (x * y < bestX * bestY)
+          {
+            bestX = x;
+            bestY = y;
+          }
+        }
+        else
+          candidates.push_back(std::make_pair(x * y, std::make_pair(x, y)));
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    for (size_t i = 0; i < candidates.size() && i < MAX_EXACT_DOWNSAMPLE_CHECKS && candidates[i].first < bestX * bestY; ++i)
+    {
+      if (resampleFits(tables, numTables, candidates[i].second.first, candidates[i].second.second, maxError))
       {
-        filename_ = inFileName;
+        bestX = candidates[i].second.first;
+        bestY = candidates[i].second.second;
+        break;
       }
     }
+    if (bestX == numX && bestY == numY)
+      return;
+
+    for (size_t t = 0; t < numTables; ++t)
+      *tables[t] = resampleGainTable(*tables[t], bestX, bestY);
   }
-  return st;
 }
 
 // ----------------------------------------------------------------------------
@@ -2681,44 +6243,95 @@ AntennaPatternEZNEC::AntennaPatternEZNEC()
   maxHorzGain_(SMALL_DB_VAL)
 {}
 
-float AntennaPatternEZNEC::gain(const AntennaGainParameters &params)
+const GridTable<float>& AntennaPatternEZNEC::gainData_(PolarityType polarity) const
 {
-  if (!valid_) return SMALL_DB_VAL;
+  switch (polarity)
+  {
+  case POLARITY_VERTICAL:
+    return vertData_;
+  case POLARITY_HORIZONTAL:
+    return horzData_;
+  default:
+    break;
+  }
+  return totalData_;
+}
+
+float AntennaPatternEZNEC::gain(const AntennaGainParameters &params) const
+{
+  if (!valid_) return countedGain(counters_, SMALL_DB_VAL);
 
   // adjust requested azim based on pattern's angle convention
   float azim = (angleConvCCW_) ? -params.azim_ : static_cast<float>((M_PI_2 + params.azim_));
   azim = static_cast<float>(RAD2DEG*(angFix2PI(azim)));
   float elev = static_cast<float>(RAD2DEG*(angFixPI2(params.elev_)));
-  float gain = params.refGain_;
-  try
+  float gain = 0.f;
+  if (!bilinearLookup(gainData_(params.polarity_), azim, elev, gain))
+    return countedGain(counters_, SMALL_DB_VAL);
+  return countedGain(counters_, params.refGain_ + gain);
+}
+
+void AntennaPatternEZNEC::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+  CountedGains counted(counters_, gains, count);
+
+  if (!valid_)
   {
-    switch (params.polarity_)
-    {
-    case POLARITY_VERTICAL:
-      gain += BilinearLookup(vertData_, azim, elev);
-      break;
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+    return;
+  }
 
-    case POLARITY_HORIZONTAL:
-      gain += BilinearLookup(horzData_, azim, elev);
-      break;
+  const GridTable<float>& data = gainData_(params.polarity_);
+  for (size_t i = 0; i < count; ++i)
+  {
+    // adjust requested azim based on pattern's angle convention
+    float patAzim = (angleConvCCW_) ? -azim[i] : static_cast<float>((M_PI_2 + azim[i]));
+    patAzim = static_cast<float>(RAD2DEG*(angFix2PI(patAzim)));
+    const float patElev = static_cast<float>(RAD2DEG*(angFixPI2(elev[i])));
+    float gain = 0.f;
+    gains[i] = (bilinearLookup(data, patAzim, patElev, gain)) ? params.refGain_ + gain : SMALL_DB_VAL;
+  }
+}
 
-    default:
-      gain += BilinearLookup(totalData_, azim, elev);
-      break;
-    }
+void AntennaPatternEZNEC::polarityGains(const AntennaGainParameters &params, const PolarityType *polarities, size_t count, float *gains) const
+{
+  assert(count == 0 || (polarities && gains));
+  if (count == 0 || !polarities || !gains)
+    return;
+
+  if (!valid_)
+  {
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+    return;
   }
-  catch (const GainDataLimitException&)
+  if (!sameGrid(vertData_, horzData_) || !sameGrid(vertData_, totalData_))
   {
-    return SMALL_DB_VAL;
+    AntennaPattern::polarityGains(params, polarities, count, gains);
+    return;
   }
-  return gain;
+
+  // the fallback counts through gain()
+  CountedGains counted(counters_, gains, count);
+
+  // adjust requested azim based on pattern's angle convention
+  float azim = (angleConvCCW_) ? -params.azim_ : static_cast<float>((M_PI_2 + params.azim_));
+  azim = static_cast<float>(RAD2DEG*(angFix2PI(azim)));
+  const float elev = static_cast<float>(RAD2DEG*(angFixPI2(params.elev_)));
+  BilinearCell cell;
+  const bool found = bilinearCell(vertData_, azim, elev, cell);
+  for (size_t i = 0; i < count; ++i)
+    gains[i] = (found) ? params.refGain_ + bilinearValue(gainData_(polarities[i]), cell) : SMALL_DB_VAL;
 }
 
-void AntennaPatternEZNEC::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
+void AntennaPatternEZNEC::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
 {
   assert(min && max);
   if (!min || !max)
     return;
+  countMinMax(counters_, false);
 
   switch (params.polarity_)
   {
@@ -2741,6 +6354,20 @@ void AntennaPatternEZNEC::minMaxGain(float *min, float *max, const AntennaGainPa
   *max += params.refGain_;
 }
 
+float AntennaPatternEZNEC::upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const
+{
+  if (!valid_) return SMALL_DB_VAL;
+
+  // pattern azimuths as gain() converts them, see gain()
+  const double minAzim = (angleConvCCW_) ? -azimMax : M_PI_2 + azimMin;
+  const double maxAzim = (angleConvCCW_) ? -azimMin : M_PI_2 + azimMax;
+  double peak = -HUGE_VAL;
+  if (!wrappedGridValueMax(gainData_(params.polarity_), RAD2DEG*(minAzim - BOUND_ANGLE_MARGIN), RAD2DEG*(maxAzim + BOUND_ANGLE_MARGIN),
+    RAD2DEG*(elevMin - BOUND_ANGLE_MARGIN), RAD2DEG*(elevMax + BOUND_ANGLE_MARGIN), peak))
+    return SMALL_DB_VAL;
+  return roundBoundUp(params.refGain_ + peak);
+}
+
 int AntennaPatternEZNEC::readPat_(std::istream& fp)
 {
   assert(fp);
@@ -2917,84 +6544,92 @@ int AntennaPatternEZNEC::readPat_(std::istream& fp)
   size_t i = 0;
   float gainVal;
 
-  // Read in remaining data to figure it out
-  while (getStrippedLine(fp, st))
+  // Read in remaining data to figure it out; the data section can be hundreds of MB, so it is parsed in place,
+  // and only lines that cannot start with a number are searched for the row and pattern headers
+  const char* const delimiters = delimiter.c_str();
+  StreamingLineReader reader(fp, loadOptions_);
+  while (reader.nextLine())
   {
-    stringTokenizer(tmpvec, st, delimiter);
-    if (stringCaseFind(st, "Azimuth Pattern") != std::string::npos)
+    if (!startsNumber(reader.firstChar(delimiters)))
     {
-      // set current elevation value
-      if (csv && tmpvec.size() > 1)
+      if (reader.contains("azimuth pattern"))
       {
-        if (!isValidNumber(tmpvec[1], value))
+        // set current elevation value
+        const size_t numTokens = reader.tokenize(delimiters);
+        if (csv && numTokens > 1)
         {
-          SIM_ERROR << "Encountered invalid number for EZNEC elevation" << std::endl;
-          return 1;
+          if (!reader.number(1, value))
+          {
+            SIM_ERROR << "Encountered invalid number for EZNEC elevation" << std::endl;
+            return 1;
+          }
         }
-      }
-      else if (!csv && tmpvec.size() > 5)
-      {
-        if (!isValidNumber(tmpvec[5], value))
+        else if (!csv && numTokens > 5)
+        {
+          if (!reader.number(5, value))
+          {
+            SIM_ERROR << "Encountered invalid number for EZNEC elevation" << std::endl;
+            return 1;
+          }
+        }
+        else
         {
-          SIM_ERROR << "Encountered invalid number for EZNEC elevation" << std::endl;
+          SIM_ERROR << "EZNEC Azimuth Pattern line has incorrect # of tokens" << std::endl;
           return 1;
         }
+        minElev = sdkMin(value, minElev);
+        maxElev = sdkMax(value, maxElev);
+        elevCnt++;
       }
-      else
+      else if (reader.contains("tot db"))
       {
-        SIM_ERROR << "EZNEC Azimuth Pattern line has incorrect # of tokens" << std::endl;
-        return 1;
+        // skip row header and reset azimuth counter
+        azimCnt = 0;
       }
-      minElev = sdkMin(value, minElev);
-      maxElev = sdkMax(value, maxElev);
-      elevCnt++;
+      continue;
     }
-    else if (stringCaseFind(st, "Tot dB") != std::string::npos)
+
+    if (reader.tokenize(delimiters) < 4 || !reader.number(0, value))
+      continue;
+
+    // process vert, horiz and total gain patterns
+    // EZNEC Pro also saves out circular and linear too
+    // the rows are held until the grid is known, then copied to the tables
+    if (!fitsLoadMemory(loadOptions_, 6 * (vVPol.size() + 1), "EZNEC"))
+      return 1;
+    minAzim = sdkMin(value, minAzim);
+    maxAzim = sdkMax(value, maxAzim);
+    azimCnt++;
+
+    if (!reader.number(1, gainVal))
     {
-      // skip row header and reset azimuth counter
-      azimCnt = 0;
+      SIM_ERROR << "Encountered invalid number for EZNEC V gain" << std::endl;
+      return 1;
     }
-    else if (tmpvec.size() >= 4 && stringIsRealNumber(tmpvec[0]))
-    {
-      // process vert, horiz and total gain patterns
-      // EZNEC Pro also saves out circular and linear too
-      if (!isValidNumber(tmpvec[0], value))
-      {
-        SIM_ERROR << "Encountered invalid number for EZNEC azimuth" << std::endl;
-        return 1;
-      }
-      minAzim = sdkMin(value, minAzim);
-      maxAzim = sdkMax(value, maxAzim);
-      azimCnt++;
-
-      if (!isValidNumber(tmpvec[1], gainVal))
-      {
-        SIM_ERROR << "Encountered invalid number for EZNEC V gain" << std::endl;
-        return 1;
-      }
-      vVPol.push_back(gainVal);
-      minVertGain_ = sdkMin(minVertGain_, gainVal);
-      maxVertGain_ = sdkMax(maxVertGain_, gainVal);
+    vVPol.push_back(gainVal);
+    minVertGain_ = sdkMin(minVertGain_, gainVal);
+    maxVertGain_ = sdkMax(maxVertGain_, gainVal);
 
-      if (!isValidNumber(tmpvec[2], gainVal))
-      {
-        SIM_ERROR << "Encountered invalid number for EZNEC H gain" << std::endl;
-        return 1;
-      }
-      vHPol.push_back(gainVal);
-      minHorzGain_ = sdkMin(minHorzGain_, gainVal);
-      maxHorzGain_ = sdkMax(maxHorzGain_, gainVal);
+    if (!reader.number(2, gainVal))
+    {
+      SIM_ERROR << "Encountered invalid number for EZNEC H gain" << std::endl;
+      return 1;
+    }
+    vHPol.push_back(gainVal);
+    minHorzGain_ = sdkMin(minHorzGain_, gainVal);
+    maxHorzGain_ = sdkMax(maxHorzGain_, gainVal);
 
-      if (!isValidNumber(tmpvec[3], gainVal))
-      {
-        SIM_ERROR << "Encountered invalid number for EZNEC T gain" << std::endl;
-        return 1;
-      }
-      vTPol.push_back(gainVal);
-      minGain_ = sdkMin(minGain_, gainVal);
-      maxGain_ = sdkMax(maxGain_, gainVal);
+    if (!reader.number(3, gainVal))
+    {
+      SIM_ERROR << "Encountered invalid number for EZNEC T gain" << std::endl;
+      return 1;
     }
+    vTPol.push_back(gainVal);
+    minGain_ = sdkMin(minGain_, gainVal);
+    maxGain_ = sdkMax(maxGain_, gainVal);
   }
+  if (reader.error())
+    return 1;
 
   // verify data was processed
   if (vVPol.empty() || vHPol.empty() || vTPol.empty())
@@ -3002,13 +6637,16 @@ int AntennaPatternEZNEC::readPat_(std::istream& fp)
     SIM_ERROR << "EZNEC antenna pattern data was not processed." << std::endl;
     return 1;
   }
+  if (vVPol.size() > azimCnt * elevCnt)
+  {
+    SIM_ERROR << "EZNEC azimuth patterns do not have the same number of azimuths" << std::endl;
+    return 1;
+  }
 
-  // initialize Bilinear LUTs
-  vertData_.initialize(minAzim, maxAzim, azimCnt, minElev, maxElev, elevCnt);
-  horzData_.initialize(minAzim, maxAzim, azimCnt, minElev, maxElev, elevCnt);
-  totalData_.initialize(minAzim, maxAzim, azimCnt, minElev, maxElev, elevCnt);
-
-  // copy data into LUTs and normalize pattern to 0 dBi
+  // copy data into the Bilinear LUTs, azimuth major, and normalize pattern to 0 dBi
+  std::vector<float> vert(azimCnt * elevCnt, 0.f);
+  std::vector<float> horz(azimCnt * elevCnt, 0.f);
+  std::vector<float> total(azimCnt * elevCnt, 0.f);
   size_t j = 0, k = 0;
   for (i = 0; i < vVPol.size(); i++)
   {
@@ -3017,12 +6655,20 @@ int AntennaPatternEZNEC::readPat_(std::istream& fp)
       j = 0;
       k++;
     }
-    vertData_(j, k) = vVPol[i] - reference_;
-    horzData_(j, k) = vHPol[i] - reference_;
-    totalData_(j, k) = vTPol[i] - reference_;
+    vert[j * elevCnt + k] = vVPol[i] - reference_;
+    horz[j * elevCnt + k] = vHPol[i] - reference_;
+    total[j * elevCnt + k] = vTPol[i] - reference_;
     j++;
   }
+  vertData_.assign(minAzim, maxAzim, azimCnt, minElev, maxElev, elevCnt, std::move(vert));
+  horzData_.assign(minAzim, maxAzim, azimCnt, minElev, maxElev, elevCnt, std::move(horz));
+  totalData_.assign(minAzim, maxAzim, azimCnt, minElev, maxElev, elevCnt, std::move(total));
 
+  if (loadOptions_.maxErrorDb_ > 0.f)
+  {
+    GridTable<float>* const tables[] = { &vertData_, &horzData_, &totalData_ };
+    downsampleGainTables(tables, 3, loadOptions_.maxErrorDb_);
+  }
   valid_ = true;
   return 0;
 }
@@ -3054,6 +6700,40 @@ int AntennaPatternEZNEC::readPat(const std::string& inFileName)
   return st;
 }
 
+// Sections: scalars {frequency_, reference_, angleConvCCW_, minVertGain_, maxVertGain_, minHorzGain_, maxHorzGain_},
+// grid 0 vertical, grid 1 horizontal, grid 2 total gain data
+int AntennaPatternEZNEC::writeCompiled(CompiledPatternWriter& writer) const
+{
+  const double scalars[7] = { frequency_, reference_, angleConvCCW_ ? 1.0 : 0.0,
+    minVertGain_, maxVertGain_, minHorzGain_, maxHorzGain_ };
+  AntennaPattern::writeCompiled(writer);
+  writer.addDoubles(COMPILED_SECTION_SCALARS, scalars, 7);
+  writer.addGrid(COMPILED_SECTION_GRID, vertData_);
+  writer.addGrid(COMPILED_SECTION_GRID + 2, horzData_);
+  writer.addGrid(COMPILED_SECTION_GRID + 4, totalData_);
+  return 0;
+}
+
+int AntennaPatternEZNEC::readCompiled(const CompiledPatternReader& reader)
+{
+  valid_ = false;
+  double scalars[7];
+  if (AntennaPattern::readCompiled(reader) != 0 || !readCompiledScalars(reader, scalars, 7) ||
+    reader.readGrid(COMPILED_SECTION_GRID, &vertData_) != 0 ||
+    reader.readGrid(COMPILED_SECTION_GRID + 2, &horzData_) != 0 ||
+    reader.readGrid(COMPILED_SECTION_GRID + 4, &totalData_) != 0)
+    return 1;
+  frequency_ = scalars[0];
+  reference_ = static_cast<float>(scalars[1]);
+  angleConvCCW_ = (scalars[2] != 0.0);
+  minVertGain_ = static_cast<float>(scalars[3]);
+  maxVertGain_ = static_cast<float>(scalars[4]);
+  minHorzGain_ = static_cast<float>(scalars[5]);
+  maxHorzGain_ = static_cast<float>(scalars[6]);
+  valid_ = true;
+  return 0;
+}
+
 // ----------------------------------------------------------------------------
 /// AntennaPatternXFDTD methods
 
@@ -3066,43 +6746,92 @@ AntennaPatternXFDTD::AntennaPatternXFDTD()
   maxHorzGain_(SMALL_DB_VAL)
 {}
 
-float AntennaPatternXFDTD::gain(const AntennaGainParameters &params)
+const GridTable<float>& AntennaPatternXFDTD::gainData_(PolarityType polarity) const
 {
-  if (!valid_) return SMALL_DB_VAL;
+  switch (polarity)
+  {
+  case POLARITY_VERTICAL:
+    return vertData_;
+  case POLARITY_HORIZONTAL:
+    return horzData_;
+  default:
+    break;
+  }
+  return totalData_;
+}
+
+float AntennaPatternXFDTD::gain(const AntennaGainParameters &params) const
+{
+  if (!valid_) return countedGain(counters_, SMALL_DB_VAL);
 
   // XFDTD pattern is offset  by 90
   float azim = static_cast<float>(RAD2DEG*(angFix2PI(params.azim_+M_PI_2)));
   float elev = static_cast<float>(RAD2DEG*(angFixPI2(params.elev_)));
-  float gain = params.refGain_;
-  try
+  float gain = 0.f;
+  if (!bilinearLookup(gainData_(params.polarity_), azim, elev, gain))
+    return countedGain(counters_, SMALL_DB_VAL);
+  return countedGain(counters_, params.refGain_ + gain);
+}
+
+void AntennaPatternXFDTD::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+  CountedGains counted(counters_, gains, count);
+
+  if (!valid_)
   {
-    switch (params.polarity_)
-    {
-    case POLARITY_VERTICAL:
-      gain += BilinearLookup(vertData_, azim, elev);
-      break;
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+    return;
+  }
 
-    case POLARITY_HORIZONTAL:
-      gain += BilinearLookup(horzData_, azim, elev);
-      break;
+  const GridTable<float>& data = gainData_(params.polarity_);
+  for (size_t i = 0; i < count; ++i)
+  {
+    // XFDTD pattern is offset  by 90
+    const float patAzim = static_cast<float>(RAD2DEG*(angFix2PI(azim[i]+M_PI_2)));
+    const float patElev = static_cast<float>(RAD2DEG*(angFixPI2(elev[i])));
+    float gain = 0.f;
+    gains[i] = (bilinearLookup(data, patAzim, patElev, gain)) ? params.refGain_ + gain : SMALL_DB_VAL;
+  }
+}
 
-    default:
-      gain += BilinearLookup(totalData_, azim, elev);
-      break;
-    }
+void AntennaPatternXFDTD::polarityGains(const AntennaGainParameters &params, const PolarityType *polarities, size_t count, float *gains) const
+{
+  assert(count == 0 || (polarities && gains));
+  if (count == 0 || !polarities || !gains)
+    return;
+
+  if (!valid_)
+  {
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+    return;
   }
-  catch (const GainDataLimitException&)
+  if (!sameGrid(vertData_, horzData_) || !sameGrid(vertData_, totalData_))
   {
-    return SMALL_DB_VAL;
+    AntennaPattern::polarityGains(params, polarities, count, gains);
+    return;
   }
-  return gain;
+
+  // the fallback counts through gain()
+  CountedGains counted(counters_, gains, count);
+
+  // XFDTD pattern is offset  by 90
+  const float azim = static_cast<float>(RAD2DEG*(angFix2PI(params.azim_+M_PI_2)));
+  const float elev = static_cast<float>(RAD2DEG*(angFixPI2(params.elev_)));
+  BilinearCell cell;
+  const bool found = bilinearCell(vertData_, azim, elev, cell);
+  for (size_t i = 0; i < count; ++i)
+    gains[i] = (found) ? params.refGain_ + bilinearValue(gainData_(polarities[i]), cell) : SMALL_DB_VAL;
 }
 
-void AntennaPatternXFDTD::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
+void AntennaPatternXFDTD::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
 {
   assert(min && max);
   if (!min || !max)
     return;
+  countMinMax(counters_, false);
 
   switch (params.polarity_)
   {
@@ -3125,6 +6854,20 @@ void AntennaPatternXFDTD::minMaxGain(float *min, float *max, const AntennaGainPa
   *max += params.refGain_;
 }
 
+float AntennaPatternXFDTD::upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const
+{
+  if (!valid_) return SMALL_DB_VAL;
+
+  // XFDTD pattern is offset by 90
+  const double minAzim = M_PI_2 + azimMin;
+  const double maxAzim = M_PI_2 + azimMax;
+  double peak = -HUGE_VAL;
+  if (!wrappedGridValueMax(gainData_(params.polarity_), RAD2DEG*(minAzim - BOUND_ANGLE_MARGIN), RAD2DEG*(maxAzim + BOUND_ANGLE_MARGIN),
+    RAD2DEG*(elevMin - BOUND_ANGLE_MARGIN), RAD2DEG*(elevMax + BOUND_ANGLE_MARGIN), peak))
+    return SMALL_DB_VAL;
+  return roundBoundUp(params.refGain_ + peak);
+}
+
 int AntennaPatternXFDTD::readPat_(std::istream& fp)
 {
   assert(fp);
@@ -3356,11 +7099,14 @@ int AntennaPatternXFDTD::readPat_(std::istream& fp)
   }
 
   // initialize Bilinear LUTs
-  vertData_.initialize(minAzim, maxAzim, azimCnt, minElev, maxElev, elevCnt);
-  horzData_.initialize(minAzim, maxAzim, azimCnt, minElev, maxElev, elevCnt);
-  totalData_.initialize(minAzim, maxAzim, azimCnt, minElev, maxElev, elevCnt);
+  if (!fitsLoadMemory(loadOptions_, 3 * azimCnt * elevCnt, "XFDTD"))
+    return 1;
+  std::vector<float> vert(azimCnt * elevCnt, 0.f);
+  std::vector<float> horz(azimCnt * elevCnt, 0.f);
+  std::vector<float> total(azimCnt * elevCnt, 0.f);
 
-  // Read in remaining data and normalize pattern to 0 dBi
+  // Read in remaining data and normalize pattern to 0 dBi; the data section can be hundreds of MB, so it is parsed
+  // in place
   size_t j = 0;
   size_t k = 0;
   float vVal;
@@ -3372,45 +7118,60 @@ int AntennaPatternXFDTD::readPat_(std::istream& fp)
   maxHorzGain_ = SMALL_DB_VAL;
   minGain_ = -SMALL_DB_VAL;
   maxGain_ = SMALL_DB_VAL;
-  while (getStrippedLine(fp, st))
+  StreamingLineReader reader(fp, loadOptions_);
+  while (reader.nextLine())
   {
-    stringTokenizer(tmpvec, st);
-    if (tmpvec.size() > 5)
+    if (reader.tokenize(" \t\n\r") > 5)
     {
       if (j == azimCnt)
       {
         j = 0;
         k++;
       }
-      if (!isValidNumber(tmpvec[2], value))
+      if (k >= elevCnt)
+      {
+        SIM_ERROR << "XFDTD data has more rows than its parameters describe" << std::endl;
+        return 1;
+      }
+      if (!reader.number(2, value))
       {
         SIM_ERROR << "Encountered invalid number for XFDTD vertical gain" << std::endl;
         return 1;
       }
       vVal = static_cast<float>((magLinear ? linear2dB(value) : value) - reference_);
-      vertData_(j, k) = vVal;
+      vert[j * elevCnt + k] = vVal;
       minVertGain_ = sdkMin(minVertGain_, vVal);
       maxVertGain_ = sdkMax(maxVertGain_, vVal);
 
-      if (!isValidNumber(tmpvec[3], value))
+      if (!reader.number(3, value))
       {
         SIM_ERROR << "Encountered invalid number for XFDTD horizontal gain" << std::endl;
         return 1;
       }
       hVal = static_cast<float>((magLinear ? linear2dB(value) : value) - reference_);
-      horzData_(j, k) = hVal;
+      horz[j * elevCnt + k] = hVal;
       minHorzGain_ = sdkMin(minHorzGain_, hVal);
       maxHorzGain_ = sdkMax(maxHorzGain_, hVal);
 
       tVal = static_cast<float>(linear2dB(dB2Linear(vVal) + dB2Linear(hVal)));
-      totalData_(j, k) = tVal;
+      total[j * elevCnt + k] = tVal;
       minGain_ = sdkMin(minGain_, tVal);
       maxGain_ = sdkMax(maxGain_, tVal);
 
       j++;
     }
   }
+  if (reader.error())
+    return 1;
+  vertData_.assign(minAzim, maxAzim, azimCnt, minElev, maxElev, elevCnt, std::move(vert));
+  horzData_.assign(minAzim, maxAzim, azimCnt, minElev, maxElev, elevCnt, std::move(horz));
+  totalData_.assign(minAzim, maxAzim, azimCnt, minElev, maxElev, elevCnt, std::move(total));
 
+  if (loadOptions_.maxErrorDb_ > 0.f)
+  {
+    GridTable<float>* const tables[] = { &vertData_, &horzData_, &totalData_ };
+    downsampleGainTables(tables, 3, loadOptions_.maxErrorDb_);
+  }
   valid_ = true;
   return 0;
 }
@@ -3436,4 +7197,191 @@ int AntennaPatternXFDTD::readPat(const std::string& inFileName)
   return st;
 }
 
+// Sections: scalars {reference_, minVertGain_, maxVertGain_, minHorzGain_, maxHorzGain_},
+// grid 0 vertical, grid 1 horizontal, grid 2 total gain data
+int AntennaPatternXFDTD::writeCompiled(CompiledPatternWriter& writer) const
+{
+  const double scalars[5] = { reference_, minVertGain_, maxVertGain_, minHorzGain_, maxHorzGain_ };
+  AntennaPattern::writeCompiled(writer);
+  writer.addDoubles(COMPILED_SECTION_SCALARS, scalars, 5);
+  writer.addGrid(COMPILED_SECTION_GRID, vertData_);
+  writer.addGrid(COMPILED_SECTION_GRID + 2, horzData_);
+  writer.addGrid(COMPILED_SECTION_GRID + 4, totalData_);
+  return 0;
+}
+
+int AntennaPatternXFDTD::readCompiled(const CompiledPatternReader& reader)
+{
+  valid_ = false;
+  double scalars[5];
+  if (AntennaPattern::readCompiled(reader) != 0 || !readCompiledScalars(reader, scalars, 5) ||
+    reader.readGrid(COMPILED_SECTION_GRID, &vertData_) != 0 ||
+    reader.readGrid(COMPILED_SECTION_GRID + 2, &horzData_) != 0 ||
+    reader.readGrid(COMPILED_SECTION_GRID + 4, &totalData_) != 0)
+    return 1;
+  reference_ = static_cast<float>(scalars[0]);
+  minVertGain_ = static_cast<float>(scalars[1]);
+  maxVertGain_ = static_cast<float>(scalars[2]);
+  minHorzGain_ = static_cast<float>(scalars[3]);
+  maxHorzGain_ = static_cast<float>(scalars[4]);
+  valid_ = true;
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+/// AntennaPatternLazy methods
+
+AntennaPatternLazy::AntennaPatternLazy(const std::string& filename, float freqMHz)
+  : AntennaPattern(),
+    type_(antennaPatternType(filename)),
+    freqMHz_(freqMHz),
+    loaded_(false)
+{
+  filename_ = filename;
+  if (!lazyPatternType(type_))
+  {
+    SIM_ERROR << "Antenna pattern file has no known text format: " << filename << std::endl;
+    return;
+  }
+  std::ifstream inFile(simCore::streamFixUtf8(filename), std::ios::in);
+  if (!inFile.is_open())
+  {
+    SIM_ERROR << "Unable to open antenna pattern file: " << filename << std::endl;
+    return;
+  }
+  valid_ = true;
+}
+
+AntennaPatternLazy::~AntennaPatternLazy()
+{
+}
+
+const AntennaPattern* AntennaPatternLazy::pattern() const
+{
+  if (!valid_)
+    return nullptr;
+  std::call_once(once_, [this]()
+  {
+    pattern_.reset(loadPatternFile(filename_, freqMHz_));
+    if (pattern_)
+      pattern_->polarity(polarity_);
+    loaded_.store(true, std::memory_order_release);
+  });
+  return pattern_.get();
+}
+
+float AntennaPatternLazy::gain(const AntennaGainParameters &params) const
+{
+  const AntennaPattern* loaded = pattern();
+  return (loaded) ? loaded->gain(params) : SMALL_DB_VAL;
+}
+
+float AntennaPatternLazy::cursorGain(const AntennaGainParameters &params, AntennaLookupCursor &cursor) const
+{
+  const AntennaPattern* loaded = pattern();
+  return (loaded) ? loaded->cursorGain(params, cursor) : SMALL_DB_VAL;
+}
+
+void AntennaPatternLazy::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
+{
+  assert(min && max);
+  if (!min || !max)
+    return;
+
+  const AntennaPattern* loaded = pattern();
+  if (loaded)
+  {
+    loaded->minMaxGain(min, max, params);
+    return;
+  }
+  // no direction has a gain
+  *min = -SMALL_DB_VAL;
+  *max = SMALL_DB_VAL;
+}
+
+float AntennaPatternLazy::upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const
+{
+  const AntennaPattern* loaded = pattern();
+  return (loaded) ? loaded->upperBoundGain(azimMin, azimMax, elevMin, elevMax, params) : SMALL_DB_VAL;
+}
+
+void AntennaPatternLazy::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+
+  const AntennaPattern* loaded = pattern();
+  if (loaded)
+    loaded->gainBatch(params, azim, elev, count, gains);
+  else
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+}
+
+void AntennaPatternLazy::gainBatchApprox(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+
+  const AntennaPattern* loaded = pattern();
+  if (loaded)
+    loaded->gainBatchApprox(params, azim, elev, count, gains);
+  else
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+}
+
+void AntennaPatternLazy::polarityGains(const AntennaGainParameters &params, const PolarityType *polarities, size_t count, float *gains) const
+{
+  assert(count == 0 || (polarities && gains));
+  if (count == 0 || !polarities || !gains)
+    return;
+
+  const AntennaPattern* loaded = pattern();
+  if (loaded)
+    loaded->polarityGains(params, polarities, count, gains);
+  else
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+}
+
+std::unique_ptr<AntennaPatternEvaluator> AntennaPatternLazy::bindFrequency(double freq) const
+{
+  const AntennaPattern* loaded = pattern();
+  if (loaded)
+    return loaded->bindFrequency(freq);
+  return AntennaPattern::bindFrequency(freq);
+}
+
+int AntennaPatternLazy::writeCompiled(CompiledPatternWriter& writer) const
+{
+  const AntennaPattern* loaded = pattern();
+  if (!loaded)
+  {
+    SIM_ERROR << "Unable to load antenna pattern file: " << filename_ << std::endl;
+    return 1;
+  }
+  return loaded->writeCompiled(writer);
+}
+
+int AntennaPatternLazy::readCompiled(const CompiledPatternReader& /*reader*/)
+{
+  SIM_ERROR << "Compiled antenna patterns cannot be read into a lazily loaded pattern" << std::endl;
+  return 1;
+}
+
+AntennaPatternStatistics AntennaPatternLazy::statistics() const
+{
+  // the loaded pattern counts its own lookups; before the load there is nothing to report
+  if (!loaded() || !pattern_)
+    return counters_.statistics();
+  return pattern_->statistics();
+}
+
+void AntennaPatternLazy::resetStatistics()
+{
+  if (loaded() && pattern_)
+    pattern_->resetStatistics();
+  counters_.reset();
+}
+
 }
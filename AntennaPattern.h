@@ -23,11 +23,18 @@
 #ifndef SIMCORE_EM_ANTENNA_PATTERN_H
 #define SIMCORE_EM_ANTENNA_PATTERN_H
 
+#include <atomic>
 #include <cfloat>
 #include <complex>
+#include <cstdint>
+#include <functional>
 #include <iosfwd>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "simCore/Common/Common.h"
 #include "simCore/LUT/InterpTable.h"
@@ -37,6 +44,8 @@
 namespace simCore
 {
 class AntennaPattern;
+class CompiledPatternReader;
+class CompiledPatternWriter;
 
 /**
 * Returns the string representation of the antenna pattern type
@@ -55,9 +64,21 @@ SDKCORE_EXPORT AntennaPatternType antennaPatternType(const std::string& antPatSt
 /** Factory function to load a pattern file with the given gain and frequency, based on the extension of the filename.
 * @param filename Name of the file to load (extension matters)
 * @param freqMHz Frequency value to pass to loader, in MHz
+* @param lazy If true, text pattern files are only checked to be readable, and parsed on first use; see
+*   AntennaPatternLazy. Algorithm keywords and compiled patterns, which load without parsing, are created immediately.
 * @return Pointer to antenna pattern instance
 */
-SDKCORE_EXPORT AntennaPattern* loadPatternFile(const std::string& filename, float freqMHz);
+SDKCORE_EXPORT AntennaPattern* loadPatternFile(const std::string& filename, float freqMHz, bool lazy = false);
+
+struct AntennaPatternLoadOptions;
+
+/** Factory function to load a pattern file like loadPatternFile(), passing options to the loaders that take them
+* @param filename Name of the file to load (extension matters)
+* @param freqMHz Frequency value to pass to loader, in MHz
+* @param options Memory limit, progress reporting and downsampling of EZNEC and XFDTD loads; ignored by other formats
+* @return Pointer to antenna pattern instance
+*/
+SDKCORE_EXPORT AntennaPattern* loadPatternFile(const std::string& filename, float freqMHz, const AntennaPatternLoadOptions& options);
 
 /// Container class that contains antenna parameters for gain calculations
 class SDKCORE_EXPORT AntennaGainParameters
@@ -101,6 +122,274 @@ public:
 
 // ----------------------------------------------------------------------------
 
+/**
+* @brief Thread-safe cache of minMaxGain() results
+*
+* Holds the bounds computed for recently requested parameters. Results are kept in an immutable snapshot that is
+* replaced atomically, so a pattern can answer minMaxGain() from many threads at once without locking; threads that
+* miss concurrently may compute the same result, and only one of them is kept.
+*/
+class SDKCORE_EXPORT MinMaxGainCache
+{
+public:
+  /// Parameters a result was computed for; patterns fill in only the fields their bounds depend on
+  struct Key
+  {
+    /**
+    * Key constructor
+    * @param[in ] vbw Antenna vertical beam width (rad)
+    * @param[in ] hbw Antenna horizontal beam width (rad)
+    * @param[in ] refGain Reference gain of pattern (dB)
+    * @param[in ] variant Pattern specific discriminator, e.g. polarity or monopulse channel
+    */
+    Key(float vbw = 0.f, float hbw = 0.f, float refGain = 0.f, int variant = 0)
+      : vbw_(vbw), hbw_(hbw), refGain_(refGain), variant_(variant) {}
+
+    /** @return true if all fields of the keys are equal */
+    bool operator==(const Key& other) const
+    {
+      return vbw_ == other.vbw_ && hbw_ == other.hbw_ && refGain_ == other.refGain_ && variant_ == other.variant_;
+    }
+
+    float vbw_;      ///< Antenna vertical beam width (rad)
+    float hbw_;      ///< Antenna horizontal beam width (rad)
+    float refGain_;  ///< Reference gain of pattern (dB)
+    int variant_;    ///< Pattern specific discriminator
+  };
+
+  MinMaxGainCache() {}
+
+  /**
+  * Retrieves the bounds stored for the given key
+  * @param[in ] key Parameters the bounds were computed for
+  * @param[out] min Minimum gain value (dB), unchanged if not found
+  * @param[out] max Maximum gain value (dB), unchanged if not found
+  * @return true if the key was found
+  * @pre min and max valid params
+  */
+  bool find(const Key& key, float *min, float *max) const;
+
+  /**
+  * Stores the bounds for the given key, dropping the oldest result when full. Const so that const minMaxGain()
+  * implementations can fill the cache; the cache is not part of a pattern's observable state.
+  * @param[in ] key Parameters the bounds were computed for
+  * @param[in ] min Minimum gain value (dB)
+  * @param[in ] max Maximum gain value (dB)
+  */
+  void store(const Key& key, float min, float max) const;
+
+  /** Removes all results, e.g. when the pattern data changes */
+  void clear();
+
+private:
+  /// Cached result
+  struct Entry
+  {
+    Key key_;    ///< Parameters the bounds were computed for
+    float min_;  ///< Minimum gain value (dB)
+    float max_;  ///< Maximum gain value (dB)
+  };
+
+  /// Immutable snapshot of the cached results, replaced atomically by store() and clear()
+  mutable std::shared_ptr<const std::vector<Entry> > entries_;
+};
+
+// ----------------------------------------------------------------------------
+
+/** Snapshot of the usage counters of an antenna pattern, see AntennaPattern::statistics() */
+struct SDKCORE_EXPORT AntennaPatternStatistics
+{
+  AntennaPatternStatistics();
+
+  uint64_t gains_;         ///< Gains computed by gain(), gainBatch(), polarityGains() and frequency evaluators
+  uint64_t missedGains_;   ///< Gains at or below SMALL_DB_COMPARE, e.g. directions outside the pattern data
+  uint64_t minMaxCalls_;   ///< Calls to minMaxGain()
+  uint64_t minMaxMisses_;  ///< Calls to minMaxGain() that swept the pattern instead of using cached bounds
+  double loadSeconds_;     ///< Time taken by loadPatternFile() to load the pattern (s), 0 if loaded otherwise
+};
+
+/**
+* @brief Usage counters of an antenna pattern
+*
+* File based patterns count their gain and minMaxGain() calls with relaxed atomic increments. Counting is compiled
+* in only when the library is built with SIMCORE_ANTENNA_STATISTICS defined; otherwise the counting methods are never
+* called from the hot paths and all counters stay zero. The counters are members in either build, about 40 bytes per
+* pattern, so that the layout of AntennaPattern does not depend on how the library was built. Counters are not copied
+* with their pattern.
+*/
+class SDKCORE_EXPORT AntennaPatternCounters
+{
+public:
+  AntennaPatternCounters();
+
+  /** Starts at zero; counters are not copied */
+  AntennaPatternCounters(const AntennaPatternCounters& other);
+
+  /** Keeps the current counts; counters are not copied */
+  AntennaPatternCounters& operator=(const AntennaPatternCounters& other);
+
+  /**
+  * Counts computed gains
+  * @param[in ] gains Array of count gains (dB)
+  * @param[in ] count Number of gains
+  */
+  void countGains(const float *gains, size_t count);
+
+  /**
+  * Counts a minMaxGain() call
+  * @param[in ] computed True if the bounds were computed rather than found in a cache
+  */
+  void countMinMax(bool computed);
+
+  /**
+  * Records the time taken to load the pattern
+  * @param[in ] seconds Load time (s)
+  */
+  void setLoadSeconds(double seconds);
+
+  /**
+  * Returns the current counts; counts made concurrently may or may not be included
+  * @return counter snapshot
+  */
+  AntennaPatternStatistics statistics() const;
+
+  /** Resets the gain and minMaxGain() counts to zero; the load time is kept */
+  void reset();
+
+  /** @return true if the library was built with SIMCORE_ANTENNA_STATISTICS, so that patterns update their counters */
+  static bool enabled();
+
+private:
+  std::atomic<uint64_t> gains_;         ///< Number of computed gains
+  std::atomic<uint64_t> missedGains_;   ///< Number of computed gains at or below SMALL_DB_COMPARE
+  std::atomic<uint64_t> minMaxCalls_;   ///< Number of minMaxGain() calls
+  std::atomic<uint64_t> minMaxMisses_;  ///< Number of minMaxGain() calls that computed their bounds
+  std::atomic<double> loadSeconds_;     ///< Load time (s)
+};
+
+// ----------------------------------------------------------------------------
+
+/**
+* @brief Caller-owned lookup state that lets a query start from the cells of the previous one
+*
+* Passed to AntennaPattern::cursorGain(). Table patterns remember the breakpoints the previous query fell between, and
+* CRUISE and bilinear patterns the bracketing frequencies; the next query checks those and their neighbors before
+* searching. The cursor only holds hints that are verified against the pattern on each use, so results equal gain(),
+* and a cursor used with another pattern only costs a search. The state lives with the caller, for instance one cursor
+* per track or per thread, so the pattern stays shared and unmodified.
+*/
+class SDKCORE_EXPORT AntennaLookupCursor
+{
+public:
+  AntennaLookupCursor();
+
+  /** Forgets the cells of the previous query */
+  void reset();
+
+private:
+  friend class AntennaPatternTable;
+  friend class AntennaPatternRelativeTable;
+  friend class AntennaPatternCRUISE;
+  friend class AntennaPatternBiLinear;
+
+  size_t azimIndex_;  ///< Azimuth breakpoint located by the previous query
+  size_t elevIndex_;  ///< Elevation breakpoint located by the previous query
+  size_t freqIndex_;  ///< Index of the lower bracketing frequency of the previous query
+};
+
+/**
+* @brief Evaluates an antenna pattern at a single frequency
+*
+* Returned by AntennaPattern::bindFrequency(). Work that depends only on the frequency, such as locating or blending
+* the bracketing frequency tables, is done once when binding, so each lookup only resolves the direction. The freq_
+* of the parameters passed to the evaluator is ignored. Callers keep an evaluator while their frequency is unchanged
+* and bind again when it changes. An evaluator refers to its pattern, which must outlive it and must not be reloaded
+* while it is in use; like the pattern, it may be queried from multiple threads concurrently.
+*/
+class SDKCORE_EXPORT AntennaPatternEvaluator
+{
+public:
+  /**
+  * AntennaPatternEvaluator constructor; this base evaluator forwards to the pattern with freq_ replaced
+  * @param[in ] pattern Pattern to evaluate
+  * @param[in ] freq Frequency to evaluate the pattern at (Hz)
+  * @param[in ] inBand Whether freq lies within the frequency band of the pattern
+  */
+  AntennaPatternEvaluator(const AntennaPattern& pattern, double freq, bool inBand = true)
+    : pattern_(pattern), freq_(freq), inBand_(inBand) {}
+
+  /** AntennaPatternEvaluator destructor */
+  virtual ~AntennaPatternEvaluator() {}
+
+  /**
+  * This method returns the pattern being evaluated
+  * @return pattern
+  */
+  const AntennaPattern& pattern() const { return pattern_; }
+
+  /**
+  * This method returns the frequency the evaluator is bound to
+  * @return frequency (Hz)
+  */
+  double frequency() const { return freq_; }
+
+  /**
+  * This method returns whether the bound frequency lies within the frequency band the pattern is defined for. Patterns
+  * without a band, or that clamp to the end points of their frequency tables, always return true.
+  * @return true if the frequency is in band
+  */
+  bool inBand() const { return inBand_; }
+
+  /**
+  * This method computes the antenna pattern gain at the bound frequency, see AntennaPattern::gain()
+  * @param[in ] params Collection of antenna parameters used to compute the requested gain value; freq_ is ignored
+  * @return antenna pattern gain (dB)
+  */
+  virtual float gain(const AntennaGainParameters &params) const;
+
+  /**
+  * This method computes the antenna pattern gain at the bound frequency for a batch of directions, see
+  * AntennaPattern::gainBatch()
+  * @param[in ] params Collection of antenna parameters shared by all directions; azim_, elev_ and freq_ are ignored
+  * @param[in ] azim Array of count relative azimuth angles, referenced to host antenna (rad)
+  * @param[in ] elev Array of count relative elevation angles, referenced to host antenna (rad)
+  * @param[in ] count Number of directions to compute
+  * @param[out] gains Array of count antenna pattern gains (dB), gains[i] corresponds to (azim[i], elev[i])
+  * @pre azim, elev and gains valid params when count is non-zero
+  */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * This method returns the minimum and maximum gains of the pattern at the bound frequency, see
+  * AntennaPattern::minMaxGain()
+  * @param[out] min Minimum gain value to retrieve (dB)
+  * @param[out] max Maximum gain value to retrieve (dB)
+  * @param[in ] params Collection of antenna parameters used to compute the requested gain bounds; freq_ is ignored
+  * @pre min and max valid params
+  */
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+protected:
+  /**
+  * This method returns a copy of the parameters with freq_ set to the bound frequency
+  * @param[in ] params Parameters to copy
+  * @return parameters at the bound frequency
+  */
+  AntennaGainParameters boundParams_(const AntennaGainParameters &params) const;
+
+  /**
+  * This method returns the usage counters of the pattern, which evaluators update like the pattern's own lookups
+  * @return counters of the pattern
+  */
+  AntennaPatternCounters& counters_() const;
+
+  const AntennaPattern& pattern_;  ///< Pattern being evaluated
+  double freq_;                    ///< Bound frequency (Hz)
+  bool inBand_;                    ///< Whether freq_ lies within the frequency band of the pattern
+};
+
+// ----------------------------------------------------------------------------
+
 /// Abstract class that all antenna patterns are derived from
 class SDKCORE_EXPORT AntennaPattern
 {
@@ -122,11 +411,23 @@ public:
   virtual AntennaPatternType type() const { return NO_ANTENNA_PATTERN; }
 
   /**
-  * This method computes the antenna pattern gain for the requested parameters
+  * This method computes the antenna pattern gain for the requested parameters. Gain evaluation does not modify the
+  * pattern, so a loaded pattern may be queried from multiple threads concurrently; the same holds for gainBatch(),
+  * gainBatchApprox() and minMaxGain().
   * @param[in ] params Collection of antenna parameters used to compute the requested gain value
   * @return antenna pattern gain (dB)
   */
-  virtual float gain(const AntennaGainParameters &params) = 0;
+  virtual float gain(const AntennaGainParameters &params) const = 0;
+
+  /**
+  * This method computes the antenna pattern gain like gain(), starting the table and frequency searches from the
+  * cells of the previous query made with the same cursor. Queries that move little between calls, such as tracked
+  * targets, mostly skip the searches. The default implementation calls gain().
+  * @param[in ] params Collection of antenna parameters used to compute the requested gain value
+  * @param[in,out] cursor Lookup state of the caller, updated with the cells of this query
+  * @return antenna pattern gain (dB), identical to gain()
+  */
+  virtual float cursorGain(const AntennaGainParameters &params, AntennaLookupCursor &cursor) const;
 
   /**
   * This method returns the minimum and maximum gains for the pattern
@@ -135,7 +436,88 @@ public:
   * @param[in ] params Collection of antenna parameters used to compute the requested gain bounds
   * @pre min and max valid params
   */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) = 0;
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const = 0;
+
+  /**
+  * This method returns an upper bound of the gain over an angular sector, so that directions whose bound is below a
+  * detection threshold can be rejected without computing their gain. The bound is at least gain() for every direction
+  * in the sector, with the other parameters as given, but need not be attained. The default implementation returns
+  * the maximum of minMaxGain(); table patterns override it with bounds local to the sector, taken from the breakpoints
+  * or grid nodes the sector overlaps, and patterns whose minMaxGain() samples the pattern override it with bounds
+  * that hold between the samples.
+  * @param[in ] azimMin Lowest relative azimuth of the sector, at least -PI (rad)
+  * @param[in ] azimMax Highest relative azimuth of the sector, at most PI (rad)
+  * @param[in ] elevMin Lowest relative elevation of the sector, at least -PI/2 (rad)
+  * @param[in ] elevMax Highest relative elevation of the sector, at most PI/2 (rad)
+  * @param[in ] params Collection of antenna parameters used to compute the bound; azim_ and elev_ are ignored
+  * @return upper bound of the gain over the sector (dB), SMALL_DB_VAL if no direction in it has a gain
+  */
+  virtual float upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const;
+
+  /**
+  * This method computes the antenna pattern gain for a batch of directions sharing the same beam, frequency and
+  * polarity parameters. The default implementation calls gain() once per direction; derived classes override it
+  * to hoist per-call setup out of the loop.
+  * @param[in ] params Collection of antenna parameters shared by all directions; azim_ and elev_ are ignored
+  * @param[in ] azim Array of count relative azimuth angles, referenced to host antenna (rad)
+  * @param[in ] elev Array of count relative elevation angles, referenced to host antenna (rad)
+  * @param[in ] count Number of directions to compute
+  * @param[out] gains Array of count antenna pattern gains (dB), gains[i] corresponds to (azim[i], elev[i])
+  * @pre azim, elev and gains valid params when count is non-zero
+  */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * This method computes the antenna pattern gain for a batch of directions like gainBatch(), but lets the pattern trade
+  * accuracy for throughput. Algorithmic patterns evaluate their formulas in single precision using polynomial sin and
+  * log approximations in loops the compiler can vectorize; each override documents its maximum error against gain().
+  * The default implementation calls gainBatch().
+  * @param[in ] params Collection of antenna parameters shared by all directions; azim_ and elev_ are ignored
+  * @param[in ] azim Array of count relative azimuth angles, referenced to host antenna (rad)
+  * @param[in ] elev Array of count relative elevation angles, referenced to host antenna (rad)
+  * @param[in ] count Number of directions to compute
+  * @param[out] gains Array of count antenna pattern gains (dB), gains[i] corresponds to (azim[i], elev[i])
+  * @pre azim, elev and gains valid params when count is non-zero
+  */
+  virtual void gainBatchApprox(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * This method computes the antenna pattern gain of several polarities in one direction. The default implementation
+  * calls gain() once per polarity; patterns holding data per polarity override it to locate the direction in their
+  * tables once for all polarities.
+  * @param[in ] params Collection of antenna parameters shared by all polarities; polarity_ is ignored
+  * @param[in ] polarities Array of count polarities to compute
+  * @param[in ] count Number of polarities to compute
+  * @param[out] gains Array of count antenna pattern gains (dB), gains[i] corresponds to polarities[i]
+  * @pre polarities and gains valid params when count is non-zero
+  */
+  virtual void polarityGains(const AntennaGainParameters &params, const PolarityType *polarities, size_t count, float *gains) const;
+
+  /**
+  * This method binds the pattern to a frequency, returning an evaluator that does the frequency dependent work of
+  * gain() once instead of on every call. The default implementation forwards to gain(); frequency dependent patterns
+  * override it. The evaluator refers to this pattern and must not outlive it.
+  * @param[in ] freq Frequency to evaluate the pattern at (Hz)
+  * @return evaluator bound to freq
+  */
+  virtual std::unique_ptr<AntennaPatternEvaluator> bindFrequency(double freq) const;
+
+  /**
+  * This method adds the pattern data to a compiled pattern, see writeCompiledPattern(). The base implementation adds
+  * the polarity and gain limits; derived classes holding data call it before adding their own sections.
+  * @param[in,out] writer Compiled pattern to add the data to
+  * @return 0 on success.
+  */
+  virtual int writeCompiled(CompiledPatternWriter& writer) const;
+
+  /**
+  * This method replaces the pattern data with the data of a compiled pattern, see loadCompiledPattern(). The base
+  * implementation reads the polarity and gain limits and takes the file name of the compiled pattern; derived classes
+  * holding data call it before reading their own sections.
+  * @param[in ] reader Opened compiled pattern of this pattern's type
+  * @return 0 on success.
+  */
+  virtual int readCompiled(const CompiledPatternReader& reader);
 
   /**
   * This method returns the file name of the antenna pattern
@@ -161,12 +543,36 @@ public:
   */
   bool valid() const { return valid_; }
 
+  /**
+  * This method returns the usage counters of the pattern, for export to a metrics system. The counters show how
+  * heavily a pattern is used and how often its lookups fall outside its data, e.g. to pick patterns worth compiling
+  * or resampling. They stay zero unless the library is built with SIMCORE_ANTENNA_STATISTICS, see
+  * AntennaPatternCounters.
+  * @return counter snapshot
+  */
+  virtual AntennaPatternStatistics statistics() const { return counters_.statistics(); }
+
+  /** This method resets the gain and minMaxGain() counters of the pattern */
+  virtual void resetStatistics() { counters_.reset(); }
+
 protected:
   bool valid_;                  ///< Indicates status of data, true: good, false: bad
   float minGain_;               ///< Minimum gain value (dB)
   float maxGain_;               ///< Maximum gain value (dB)
   PolarityType polarity_;       ///< Antenna pattern polarity
   std::string filename_;        ///< Filename containing antenna pattern data
+  mutable AntennaPatternCounters counters_; ///< Usage counters, updated by const lookups
+
+private:
+  friend class AntennaPatternEvaluator;
+  friend AntennaPattern* loadPatternFile(const std::string& filename, float freqMHz, const AntennaPatternLoadOptions& options);
+
+  /**
+  * This method returns the usage counters that the evaluators of the pattern and loadPatternFile() update; callers
+  * outside the library read them through statistics()
+  * @return counters of the pattern
+  */
+  AntennaPatternCounters& counters() const { return counters_; }
 };
 
 // ----------------------------------------------------------------------------
@@ -182,13 +588,22 @@ public:
   virtual AntennaPatternType type() const { return ANTENNA_PATTERN_GAUSS; }
 
   /** @copydoc AntennaPattern::gain */
-  virtual float gain(const AntennaGainParameters &params);
+  virtual float gain(const AntennaGainParameters &params) const;
 
   /** @copydoc AntennaPattern::minMaxGain */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
 
-protected:
-  float lastVbw_;             ///< Last vertical beam width used to calculate min & max gains
+  /** @copydoc AntennaPattern::upperBoundGain */
+  virtual float upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * @copydoc AntennaPattern::gainBatchApprox
+  * Gains are within 2e-5 dB of gain().
+  */
+  virtual void gainBatchApprox(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
 };
 
 // ----------------------------------------------------------------------------
@@ -204,13 +619,23 @@ public:
   virtual AntennaPatternType type() const { return ANTENNA_PATTERN_CSCSQ; }
 
   /** @copydoc AntennaPattern::gain */
-  virtual float gain(const AntennaGainParameters &params);
+  virtual float gain(const AntennaGainParameters &params) const;
 
   /** @copydoc AntennaPattern::minMaxGain */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
 
-protected:
-  float lastVbw_;             ///< Last vertical beam width used to calculate min & max gains
+  /** @copydoc AntennaPattern::upperBoundGain */
+  virtual float upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * @copydoc AntennaPattern::gainBatchApprox
+  * Gains are within 0.5 dB of gain(); differences above 0.01 dB are limited to the nulls of sin(vbw/sin(elev))
+  * and to elevations near +/-PI, where float precision of the sine argument dominates.
+  */
+  virtual void gainBatchApprox(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
 };
 
 // ----------------------------------------------------------------------------
@@ -226,14 +651,23 @@ public:
   virtual AntennaPatternType type() const { return ANTENNA_PATTERN_SINXX; }
 
   /** @copydoc AntennaPattern::gain */
-  virtual float gain(const AntennaGainParameters &params);
+  virtual float gain(const AntennaGainParameters &params) const;
 
   /** @copydoc AntennaPattern::minMaxGain */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * @copydoc AntennaPattern::gainBatchApprox
+  * Gains are within 0.01 dB of gain() where the pattern is within 40 dB of the reference gain; in deeper nulls
+  * the error in linear amplitude stays below 2e-5 of the peak.
+  */
+  virtual void gainBatchApprox(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
 
 protected:
-  float lastVbw_;             ///< Last vertical beam width used to calculate min & max gains
-  float lastHbw_;             ///< Last horizontal beam width used to calculate min & max gains
+  MinMaxGainCache minMaxCache_; ///< Cached minMaxGain() results, relative to the reference gain
 };
 
 // ----------------------------------------------------------------------------
@@ -249,15 +683,20 @@ public:
   virtual AntennaPatternType type() const { return ANTENNA_PATTERN_PEDESTAL; }
 
   /** @copydoc AntennaPattern::gain */
-  virtual float gain(const AntennaGainParameters &params);
+  virtual float gain(const AntennaGainParameters &params) const;
 
   /** @copydoc AntennaPattern::minMaxGain */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
 
-protected:
-  float lastVbw_;             ///< Last vertical beam width used to calculate min & max gains
-  float lastHbw_;             ///< Last horizontal beam width used to calculate min & max gains
-  float lastGain_;            ///< Last gain value used to calculate min & max gains
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * @copydoc AntennaPattern::gainBatchApprox
+  * Gains are within 0.001 dB of gain(), except within float rounding of a lobe boundary where the neighboring
+  * lobe may be chosen (a 0.03 dB step at the main lobe edge).
+  */
+  virtual void gainBatchApprox(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
 };
 
 // ----------------------------------------------------------------------------
@@ -273,10 +712,257 @@ public:
   virtual AntennaPatternType type() const { return ANTENNA_PATTERN_OMNI; }
 
   /** @copydoc AntennaPattern::gain */
-  virtual float gain(const AntennaGainParameters &params);
+  virtual float gain(const AntennaGainParameters &params) const;
 
   /** @copydoc AntennaPattern::minMaxGain */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+};
+
+// ----------------------------------------------------------------------------
+/**
+* @brief Compiled form of an angle/gain lookup table
+*
+* Stores the breakpoints of an angle to gain map in contiguous sorted arrays, with a uniform bucket index over the
+* angle span, so that a lookup computes its starting breakpoint directly instead of traversing the map. Lookups
+* return exactly what the equivalent std::map lookup in calculateGain() returns.
+*
+* The arrays are immutable once built and shared between copies of a table. They are either owned by the table, when
+* built by compile(), or borrowed from external storage such as a memory mapped compiled pattern file, see assign().
+*/
+class SDKCORE_EXPORT AngleGainTable
+{
+public:
+  AngleGainTable();
+
+  /**
+  * Rebuilds the table from the given angle/gain map, replacing any previous content
+  * @param[in ] table Angle (rad) to gain (dB) map
+  */
+  void compile(const std::map<float, float>& table);
+
+  /**
+  * Replaces the content of the table with previously compiled arrays, used in place without copying. The arrays are
+  * validated against what compile() would have built from the same breakpoints.
+  * @param[in ] angles Array of size breakpoint angles in increasing order (rad)
+  * @param[in ] gains Array of size breakpoint gains (dB)
+  * @param[in ] buckets Array of size bucket indices, as returned by buckets()
+  * @param[in ] size Number of breakpoints
+  * @param[in ] bucketScale Number of buckets per radian, as returned by bucketScale()
+  * @param[in ] storage Owner of the arrays, kept alive as long as the table (or a copy of it) uses them
+  * @return 0 on success, non-zero if the arrays are not a valid compiled table; the table is then left empty
+  */
+  int assign(const float *angles, const float *gains, const uint32_t *buckets, size_t size, float bucketScale, const std::shared_ptr<const void>& storage);
+
+  /**
+  * Recovers the angle/gain map the table was compiled from
+  * @param[out] table Angle (rad) to gain (dB) map to fill, existing entries at the same angles are replaced
+  * @pre table valid param
+  */
+  void toMap(std::map<float, float> *table) const;
+
+  /** Removes all breakpoints */
+  void clear();
+
+  /** @return true if the table has no breakpoints */
+  bool empty() const { return size_ == 0; }
+
+  /** @return number of breakpoints in the table */
+  size_t size() const { return size_; }
+
+  /** @return breakpoint angles in increasing order (rad), size() entries */
+  const float* angles() const { return angles_; }
+
+  /** @return breakpoint gains (dB), size() entries */
+  const float* gains() const { return gains_; }
+
+  /** @return index of the first breakpoint that falls in or after each bucket, size() entries */
+  const uint32_t* buckets() const { return buckets_; }
+
+  /** @return number of buckets per radian */
+  float bucketScale() const { return invStep_; }
+
+  /**
+  * Returns the gain for the specified angle, interpolating between breakpoints if necessary
+  * @param[in ] angle Angle to lookup (rad)
+  * @return table gain (dB), or SMALL_DB_VAL if the angle is past the last breakpoint
+  */
+  float gain(float angle) const;
+
+  /**
+  * Locates an angle among the breakpoints, the search half of gain(). Tables compiled from the same angles, see
+  * sameAngles(), locate an angle identically, so one search serves all of them.
+  * @param[in ] angle Angle to locate (rad)
+  * @return index of the breakpoint to interpolate toward, or size() if the angle is past the last breakpoint
+  */
+  size_t locate(float angle) const;
+
+  /**
+  * Locates an angle like locate(angle), first checking the breakpoints at and next to a previous result
+  * @param[in ] angle Angle to locate (rad)
+  * @param[in ] hint Index returned by an earlier locate() on this table, or any value
+  * @return index of the breakpoint to interpolate toward, identical to locate(angle)
+  */
+  size_t locate(float angle, size_t hint) const;
+
+  /**
+  * Returns the gain for an angle located by locate(), the interpolation half of gain()
+  * @param[in ] index Breakpoint index returned by locate() for angle, on this table or one with the same angles
+  * @param[in ] angle Angle that was located (rad)
+  * @return table gain (dB), identical to gain(angle), or SMALL_DB_VAL if index is size()
+  */
+  float gainAt(size_t index, float angle) const;
+
+  /**
+  * Returns whether both tables have the same breakpoint angles, so that locate() results can be shared
+  * @param[in ] other Table to compare with
+  * @return true if the breakpoint angles are identical
+  */
+  bool sameAngles(const AngleGainTable& other) const;
+
+private:
+  /**
+  * Returns the bucket for an angle greater than the first breakpoint; non-decreasing in angle
+  * @param[in ] angle Angle to locate (rad)
+  * @return index into buckets_
+  */
+  size_t bucket_(float angle) const;
+
+  const float *angles_;                 ///< Breakpoint angles in increasing order (rad)
+  const float *gains_;                  ///< Breakpoint gains (dB), gains_[i] corresponds to angles_[i]
+  const uint32_t *buckets_;             ///< Index of the first breakpoint that falls in or after each bucket, one bucket per breakpoint
+  size_t size_;                         ///< Number of breakpoints
+  float invStep_;                       ///< Number of buckets per radian
+  std::shared_ptr<const void> storage_; ///< Owner of the arrays
+};
+
+// ----------------------------------------------------------------------------
+/**
+* @brief Evenly spaced 2D lookup table of the gridded pattern types
+*
+* Holds the extents and entries of an InterpTable, numX() by numY() entries in row major order of (x, y), for the
+* monopulse, bilinear, EZNEC and XFDTD patterns, and the gain blocks of the CRUISE pattern. Like AngleGainTable, the
+* entries are immutable once assigned and shared between copies of a table. They are either owned by the table, when
+* assigned from parsed or converted data, or borrowed from external storage such as a memory mapped compiled pattern
+* file, so that compiled and shared patterns use their entries in place.
+*/
+template <typename T>
+class GridTable
+{
+public:
+  GridTable()
+    : minX_(0.0), maxX_(0.0), numX_(0), minY_(0.0), maxY_(0.0), numY_(0), values_(nullptr)
+  {
+  }
+
+  /**
+  * Replaces the content of the table with a copy of a parsed lookup table
+  * @param[in ] table Table to copy
+  */
+  void assign(const InterpTable<T>& table)
+  {
+    const LUT::LUT2<T>& lut = table.lut();
+    std::vector<T> values;
+    values.reserve(lut.numX() * lut.numY());
+    for (size_t i = 0; i < lut.numX(); ++i)
+    {
+      for (size_t j = 0; j < lut.numY(); ++j)
+        values.push_back(lut(i, j));
+    }
+    assign(lut.minX(), lut.maxX(), lut.numX(), lut.minY(), lut.maxY(), lut.numY(), std::move(values));
+  }
+
+  /**
+  * Replaces the content of the table, taking ownership of the entries
+  * @param[in ] minX First x value
+  * @param[in ] maxX Last x value
+  * @param[in ] numX Number of x values
+  * @param[in ] minY First y value
+  * @param[in ] maxY Last y value
+  * @param[in ] numY Number of y values
+  * @param[in ] values numX * numY entries in row major order of (x, y)
+  */
+  void assign(double minX, double maxX, size_t numX, double minY, double maxY, size_t numY, std::vector<T>&& values)
+  {
+    const std::shared_ptr<const std::vector<T> > storage = std::make_shared<const std::vector<T> >(std::move(values));
+    assign(minX, maxX, numX, minY, maxY, numY, storage->data(), storage);
+  }
+
+  /**
+  * Replaces the content of the table with entries used in place without copying
+  * @param[in ] minX First x value
+  * @param[in ] maxX Last x value
+  * @param[in ] numX Number of x values
+  * @param[in ] minY First y value
+  * @param[in ] maxY Last y value
+  * @param[in ] numY Number of y values
+  * @param[in ] values numX * numY entries in row major order of (x, y)
+  * @param[in ] storage Owner of the entries, kept alive as long as the table (or a copy of it) uses them
+  */
+  void assign(double minX, double maxX, size_t numX, double minY, double maxY, size_t numY, const T *values, const std::shared_ptr<const void>& storage)
+  {
+    minX_ = minX;
+    maxX_ = maxX;
+    numX_ = numX;
+    minY_ = minY;
+    maxY_ = maxY;
+    numY_ = numY;
+    values_ = values;
+    storage_ = storage;
+  }
+
+  /** Removes all entries, releasing the storage they were held in */
+  void clear()
+  {
+    *this = GridTable();
+  }
+
+  /** @return true if the table has no entries */
+  bool empty() const { return numX_ == 0 || numY_ == 0; }
+
+  /** @return number of entries, numX() * numY() */
+  size_t size() const { return numX_ * numY_; }
+
+  /** @return first x value */
+  double minX() const { return minX_; }
+
+  /** @return last x value */
+  double maxX() const { return maxX_; }
+
+  /** @return number of x values */
+  size_t numX() const { return numX_; }
+
+  /** @return first y value */
+  double minY() const { return minY_; }
+
+  /** @return last y value */
+  double maxY() const { return maxY_; }
+
+  /** @return number of y values */
+  size_t numY() const { return numY_; }
+
+  /** @return entries in row major order of (x, y), size() entries */
+  const T* values() const { return values_; }
+
+  /**
+  * Returns an entry of the table
+  * @param[in ] i X index, less than numX()
+  * @param[in ] j Y index, less than numY()
+  * @return entry at (i, j)
+  */
+  const T& operator()(size_t i, size_t j) const { return values_[i * numY_ + j]; }
+
+private:
+  double minX_;                         ///< First x value
+  double maxX_;                         ///< Last x value
+  size_t numX_;                         ///< Number of x values
+  double minY_;                         ///< First y value
+  double maxY_;                         ///< Last y value
+  size_t numY_;                         ///< Number of y values
+  const T *values_;                     ///< Entries in row major order of (x, y)
+  std::shared_ptr<const void> storage_; ///< Owner of the entries
 };
 
 // ----------------------------------------------------------------------------
@@ -303,6 +989,105 @@ SDKCORE_EXPORT float calculateGain(const std::map<float, float> *azimData,
   float maxGain,
   bool applyWeight);
 
+/**
+* @brief This function returns the gain for a compiled antenna pattern lookup table
+* @param[in ] azimData Azimuth gain data
+* @param[in ] elevData Elevation gain data
+* @param[out ] lastLobe AntennaLobeType of lobe last seen, set based on normalized beam width (phi)
+* @param[in ] azim Azimuth relative to antenna (rad)
+* @param[in ] elev Elevation relative to antenna (rad)
+* @param[in ] hbw Horizontal beam width of radar (rad), must be non-zero
+* @param[in ] vbw Vertical beam width of radar (rad), must be non-zero
+* @param[in ] maxGain Maximum (normalized) antenna gain (dB)
+* @param[in ] applyWeight Boolean toggle to apply weighting (true) to the antenna gain
+* @return Antenna pattern gain (dB).
+*/
+SDKCORE_EXPORT float calculateGain(const AngleGainTable *azimData,
+  const AngleGainTable *elevData,
+  AntennaLobeType &lastLobe,
+  float azim,
+  float elev,
+  float hbw,
+  float vbw,
+  float maxGain,
+  bool applyWeight);
+
+// ----------------------------------------------------------------------------
+
+/**
+* @brief Thread-safe, least recently used cache of rasterized weighted table gains
+*
+* For fixed beam widths, the weighted gain of an azimuth/elevation table pattern (calculateGain() with applyWeight) is a
+* function of direction alone. When enabled, AntennaPatternTable and AntennaPatternRelativeTable rasterize it, relative
+* to the reference gain, into a grid over azimuth [-pi, pi] and elevation [-pi/2, pi/2] the first time a beam width pair
+* is requested, and bilinearly sample the grid afterward, dropping the sqrt, atan2 calls and table lookups off the hot
+* path. Sampled gains differ from calculateGain() by at most the change in gain across one grid cell; directions in a
+* cell with a corner outside the tables have no gain, which may shrink coverage by up to a cell at its edges.
+*
+* A grid takes (2 pi / resolution + 1) * (pi / resolution + 1) floats, about 1 MB at a resolution of 0.5 deg. Grids are
+* kept in an immutable snapshot replaced atomically, like MinMaxGainCache; threads that miss concurrently may rasterize
+* the same grid, and only one of them is kept. configure() and clear() must not race with lookups.
+*/
+class SDKCORE_EXPORT WeightedGainGridCache
+{
+public:
+  /// Rasterized gains for one beam width pair
+  struct Grid;
+
+  WeightedGainGridCache();
+
+  /** Copies the configuration; grids are not copied */
+  WeightedGainGridCache(const WeightedGainGridCache& other);
+
+  /** Copies the configuration and clears the grids */
+  WeightedGainGridCache& operator=(const WeightedGainGridCache& other);
+
+  /**
+  * Enables or disables rasterizing, clearing all grids
+  * @param[in ] resolution Grid spacing (rad), 0 disables rasterizing
+  * @param[in ] maxGrids Maximum number of beam width pairs whose grids are kept, at least 1
+  */
+  void configure(float resolution, size_t maxGrids);
+
+  /** @return true if rasterizing is enabled */
+  bool enabled() const { return resolution_ > 0.f; }
+
+  /** @return grid spacing (rad), 0 when disabled */
+  float resolution() const { return resolution_; }
+
+  /** @return maximum number of beam width pairs whose grids are kept */
+  size_t maxGrids() const { return maxGrids_; }
+
+  /**
+  * Retrieves the grid for a beam width pair, rasterizing it from the tables if it is not cached
+  * @param[in ] azimTable Compiled azimuth gain data
+  * @param[in ] elevTable Compiled elevation gain data
+  * @param[in ] hbw Horizontal beam width (rad)
+  * @param[in ] vbw Vertical beam width (rad)
+  * @return grid of the beam width pair, nullptr if rasterizing is disabled or a beam width is zero
+  */
+  std::shared_ptr<const Grid> grid(const AngleGainTable& azimTable, const AngleGainTable& elevTable, float hbw, float vbw) const;
+
+  /**
+  * Bilinearly samples a grid
+  * @param[in ] grid Grid from grid()
+  * @param[in ] azim Azimuth relative to antenna, in [-pi, pi] (rad)
+  * @param[in ] elev Elevation relative to antenna, in [-pi/2, pi/2] (rad)
+  * @return gain relative to the reference gain (dB), SMALL_DB_VAL if the direction has no gain
+  */
+  static float sample(const Grid& grid, float azim, float elev);
+
+  /** Removes all grids, e.g. when the pattern data changes */
+  void clear();
+
+private:
+  float resolution_;     ///< Grid spacing (rad), 0 when disabled
+  size_t maxGrids_;      ///< Maximum number of grids kept
+  mutable std::atomic<uint64_t> useCount_;  ///< Clock for the last use stamps of the grids
+  /// Immutable snapshot of the cached grids, replaced atomically by grid() and clear()
+  mutable std::shared_ptr<const std::vector<std::shared_ptr<const Grid> > > grids_;
+};
+
 // ----------------------------------------------------------------------------
 
 /// Table based antenna pattern class
@@ -316,10 +1101,33 @@ public:
   virtual AntennaPatternType type() const { return ANTENNA_PATTERN_TABLE; }
 
   /** @copydoc AntennaPattern::gain */
-  virtual float gain(const AntennaGainParameters &params);
+  virtual float gain(const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::cursorGain */
+  virtual float cursorGain(const AntennaGainParameters &params, AntennaLookupCursor &cursor) const;
 
   /** @copydoc AntennaPattern::minMaxGain */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::upperBoundGain */
+  virtual float upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * This method enables sampling weighted gains (AntennaGainParameters::weighting_) from grids rasterized the first
+  * time each beam width pair is seen, see WeightedGainGridCache. Disabled by default.
+  * @param[in ] resolution Grid spacing (rad), 0 disables the grids
+  * @param[in ] maxGrids Maximum number of beam width pairs whose grids are kept, least recently used dropped first
+  */
+  void setWeightedGainGrid(float resolution, size_t maxGrids = 4) { weightedGrids_.configure(resolution, maxGrids); }
+
+  /** @copydoc AntennaPattern::writeCompiled */
+  virtual int writeCompiled(CompiledPatternWriter& writer) const;
+
+  /** @copydoc AntennaPattern::readCompiled */
+  virtual int readCompiled(const CompiledPatternReader& reader);
 
   /**
   * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat
@@ -336,10 +1144,18 @@ public:
   int readPat(std::istream& fp);
 
   /**
-  * This method sets the validity of the antenna pattern, accessed by SimLogic binary FCT loader
+  * This method sets the validity of the antenna pattern, accessed by SimLogic binary FCT loader; marking the
+  * pattern valid compiles data given to setAzimData() and setElevData() while it was invalid, see compileTables()
   * @param[in ] val Boolean, validity of antenna pattern
   */
-  void setValid(bool val) {valid_ = val;}
+  void setValid(bool val);
+
+  /**
+  * This method rebuilds the compiled tables used for lookups from the data given to setAzimData() and
+  * setElevData() while the pattern was invalid; does nothing when no data changed.  Not safe to call while other
+  * threads look up gains from this pattern.
+  */
+  void compileTables();
 
   /**
   * This method sets the type of units for the azimuth and elevation data, accessed by SimLogic binary FCT loader
@@ -354,26 +1170,36 @@ public:
   void setFilename(const std::string& str) {filename_ = str;}
 
   /**
-  * This method sets the gain value for the specified azimuth, accessed by SimLogic binary FCT loader
+  * This method sets the gain value for the specified azimuth, accessed by SimLogic binary FCT loader.  A valid
+  * pattern recompiles its tables so that lookups see the change; an invalid one defers compiling until
+  * setValid(true) or compileTables(), so that a table built point by point before being marked valid is compiled once
   * @param[in ] ang Azimuth position of antenna pattern, units based on type_
   * @param[in ] gain Gain of antenna pattern at specified azimuth (dB)
   */
-  void setAzimData(float ang, float gain) {azimData_[ang] = gain;}
+  void setAzimData(float ang, float gain);
 
   /**
-  * This method sets the gain value for the specified elevation, accessed by SimLogic binary FCT loader
+  * This method sets the gain value for the specified elevation, accessed by SimLogic binary FCT loader.  Like
+  * setAzimData(), a valid pattern recompiles its tables and an invalid one defers compiling until it is marked valid
   * @param[in ] ang Elevation position of antenna pattern, units based on type_
   * @param[in ] gain Gain of antenna pattern at specified elevation (dB)
   */
-  void setElevData(float ang, float gain) {elevData_[ang] = gain;}
+  void setElevData(float ang, float gain);
 
 protected:
   bool beamWidthType_;              ///< false: angles in radians, true: angles in beamwidth (m)
-  float lastVbw_;                   ///< Last vertical beam width used to calculate min & max gains
-  float lastHbw_;                   ///< Last horizontal beam width used to calculate min & max gains
-  float lastGain_;                  ///< Last gain value used to calculate min & max gains
   std::map<float, float> azimData_; ///< Azimuth gain data
   std::map<float, float> elevData_; ///< Elevation gain data
+  AngleGainTable azimTable_;        ///< Compiled azimuth gain data used for lookups
+  AngleGainTable elevTable_;        ///< Compiled elevation gain data used for lookups
+  bool tablesDirty_;                ///< True when azimData_ or elevData_ changed since the tables were compiled
+  WeightedGainGridCache weightedGrids_;  ///< Rasterized weighted gains, see setWeightedGainGrid()
+
+  /**
+  * This method sets minGain_ and maxGain_, relative to the reference gain, from the compiled tables, and drops the
+  * weighted gain grids rasterized from the previous tables; called whenever the compiled tables change
+  */
+  void setGainLimits_();
 };
 
 // ----------------------------------------------------------------------------
@@ -384,16 +1210,38 @@ class SDKCORE_EXPORT AntennaPatternCRUISE : public AntennaPattern
 public:
 
   AntennaPatternCRUISE();
-  virtual ~AntennaPatternCRUISE() {reset_();}
+  virtual ~AntennaPatternCRUISE() {}
 
   /** @copydoc AntennaPattern::type */
   virtual AntennaPatternType type() const { return ANTENNA_PATTERN_CRUISE; }
 
   /** @copydoc AntennaPattern::gain */
-  virtual float gain(const AntennaGainParameters &params);
+  virtual float gain(const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::cursorGain */
+  virtual float cursorGain(const AntennaGainParameters &params, AntennaLookupCursor &cursor) const;
 
   /** @copydoc AntennaPattern::minMaxGain */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::upperBoundGain */
+  virtual float upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * @copydoc AntennaPattern::bindFrequency
+  * The evaluator holds azimuth and elevation tables blended for the frequency, so a lookup reads one pair of
+  * adjacent gains per axis.
+  */
+  virtual std::unique_ptr<AntennaPatternEvaluator> bindFrequency(double freq) const;
+
+  /** @copydoc AntennaPattern::writeCompiled */
+  virtual int writeCompiled(CompiledPatternWriter& writer) const;
+
+  /** @copydoc AntennaPattern::readCompiled */
+  virtual int readCompiled(const CompiledPatternReader& reader);
 
   /**
   * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat_
@@ -402,8 +1250,24 @@ public:
   */
   int readPat(const std::string& file);
 
+  /**
+  * This method selects single precision storage for the gain tables, halving their memory footprint.  Gains
+  * already loaded are converted, and later loads use the selected precision.  Rounding the voltage gains to float
+  * changes them by less than 6e-8 relative, well below the single precision of the returned gain.
+  * @param[in ] singlePrecision true to store the gain tables as float, false (default) to store them as double
+  */
+  void setSinglePrecision(bool singlePrecision);
+
+  /**
+  * This method returns whether the gain tables are stored in single precision
+  * @return true if the gain tables are stored as float
+  */
+  bool singlePrecision() const { return singlePrecision_; }
+
 protected:
 
+  class FrequencyEvaluator;    ///< Evaluator returned by bindFrequency()
+
   int azimLen_;               ///< Size of azimuth array
   int elevLen_;               ///< Size of elevation array
   int freqLen_;               ///< Size of frequency array
@@ -411,15 +1275,46 @@ protected:
   double elevMin_;            ///< Minimum elevation value
   double azimStep_;           ///< Azimuth step value
   double elevStep_;           ///< Elevation step value
-  double *freqData_;          ///< Frequency data
-  double **azimData_;         ///< Azimuth gain data
-  double **elevData_;         ///< Elevation gain data
+  bool singlePrecision_;      ///< true: gains are held in floatGains_, false: gains are held in gains_
+  std::vector<double> freqData_;  ///< Frequency data (Hz), in increasing order
+  /**
+  * Azimuth then elevation voltage gains in one table of azimLen_ + elevLen_ angle rows by freqLen_ frequencies.  Each
+  * block is angle major, so the gain at angle a and frequency f is at a * freqLen_ + f, and the elevation block starts
+  * at azimLen_ * freqLen_.  The four samples of a lookup are then two adjacent pairs a frequency row apart.  The
+  * extents of the table are its angle and frequency indices.
+  */
+  GridTable<double> gains_;
+  GridTable<float> floatGains_;  ///< Single precision copy of gains_, used instead of gains_ when singlePrecision_ is set
 
   /**
   * This method resets the pattern
   */
   void reset_();
 
+  /**
+  * This method moves the gains into the storage selected by singlePrecision_
+  */
+  void applyPrecision_();
+
+  /**
+  * This method determines the frequency interpolation index and offset for the requested frequency
+  * @param[in ] freq Frequency to locate (Hz)
+  * @param[out] flowindex Index of the lower frequency table
+  * @param[out] fdelta Fractional offset from the lower frequency table, in [0, 1]
+  * @param[in,out] hint If not nullptr, lower frequency index of a previous call, checked before searching and updated
+  */
+  void freqIndex_(double freq, int &flowindex, double &fdelta, size_t *hint = nullptr) const;
+
+  /**
+  * This method computes the gain for a single direction using a previously determined frequency interpolation
+  * @param[in ] azim Relative azimuth angle (rad)
+  * @param[in ] elev Relative elevation angle (rad)
+  * @param[in ] flowindex Index of the lower frequency table, from freqIndex_()
+  * @param[in ] fdelta Fractional offset from the lower frequency table, from freqIndex_()
+  * @return antenna pattern gain
+  */
+  float gain_(float azim, float elev, int flowindex, double fdelta) const;
+
   /**
   * This method parses and stores the incoming antenna pattern data
   * @param[in ] fp Input file stream handle
@@ -441,10 +1336,33 @@ public:
   virtual AntennaPatternType type() const { return ANTENNA_PATTERN_RELATIVE; }
 
   /** @copydoc AntennaPattern::gain */
-  virtual float gain(const AntennaGainParameters &params);
+  virtual float gain(const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::cursorGain */
+  virtual float cursorGain(const AntennaGainParameters &params, AntennaLookupCursor &cursor) const;
 
   /** @copydoc AntennaPattern::minMaxGain */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::upperBoundGain */
+  virtual float upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * This method enables sampling weighted gains (AntennaGainParameters::weighting_) from grids rasterized the first
+  * time each beam width pair is seen, see WeightedGainGridCache. Disabled by default.
+  * @param[in ] resolution Grid spacing (rad), 0 disables the grids
+  * @param[in ] maxGrids Maximum number of beam width pairs whose grids are kept, least recently used dropped first
+  */
+  void setWeightedGainGrid(float resolution, size_t maxGrids = 4) { weightedGrids_.configure(resolution, maxGrids); }
+
+  /** @copydoc AntennaPattern::writeCompiled */
+  virtual int writeCompiled(CompiledPatternWriter& writer) const;
+
+  /** @copydoc AntennaPattern::readCompiled */
+  virtual int readCompiled(const CompiledPatternReader& reader);
 
   /**
   * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat_
@@ -454,11 +1372,17 @@ public:
   int readPat(const std::string& file);
 
 protected:
-  float lastVbw_;                   ///< Last vertical beam width used to calculate min & max gains
-  float lastHbw_;                   ///< Last horizontal beam width used to calculate min & max gains
-  float lastGain_;                  ///< Last gain value used to calculate min & max gains
   std::map<float, float> azimData_; ///< Azimuth gain data (dB)
   std::map<float, float> elevData_; ///< Elevation gain data (dB)
+  AngleGainTable azimTable_;        ///< Compiled azimuth gain data used for lookups
+  AngleGainTable elevTable_;        ///< Compiled elevation gain data used for lookups
+  WeightedGainGridCache weightedGrids_;  ///< Rasterized weighted gains, see setWeightedGainGrid()
+
+  /**
+  * This method sets minGain_ and maxGain_, relative to the reference gain, from the compiled tables, and drops the
+  * weighted gain grids rasterized from the previous tables; called whenever the compiled tables change
+  */
+  void setGainLimits_();
 
   /**
   * This method parses and stores the incoming antenna pattern data
@@ -502,12 +1426,66 @@ SDKCORE_EXPORT bool readPattern(SymmetricAntennaPattern *sap, std::istream &in,
 */
 SDKCORE_EXPORT bool readPattern(SymmetricAntennaPattern *sap, const std::string &filename, const std::string &name, double frequency, double frequencythreshold = 0.5e+9);
 
+/**
+* Reads and parses several named SymmetricAntennaPatterns, e.g. the channels of a monopulse antenna, in a single pass
+* over an input stream; each block is parsed where its name appears, in any order
+* @param[in ] patterns SymmetricAntennaPattern classes to fill, by name of antenna pattern
+* @param[in ] in Input stream to read
+* @param[in ] frequency Frequency of antenna pattern (Hz)
+* @param[in ] frequencythreshold Frequency threshold between different frequencies in pattern (Hz)
+* @return boolean, true if every requested pattern was found and parsed, false on failure
+* @pre pointers in patterns valid params
+*/
+SDKCORE_EXPORT bool readPatterns(const std::map<std::string, SymmetricAntennaPattern*>& patterns, std::istream &in, double frequency, double frequencythreshold = 0.5e+9);
+
+/**
+* Reads and parses several named SymmetricAntennaPatterns in a single pass over an input file
+* @param[in ] patterns SymmetricAntennaPattern classes to fill, by name of antenna pattern
+* @param[in ] filename Input file name to read
+* @param[in ] frequency Frequency of antenna pattern (Hz)
+* @param[in ] frequencythreshold Frequency threshold between different frequencies in pattern (Hz)
+* @return boolean, true if every requested pattern was found and parsed, false on failure
+* @pre pointers in patterns valid params
+*/
+SDKCORE_EXPORT bool readPatterns(const std::map<std::string, SymmetricAntennaPattern*>& patterns, const std::string &filename, double frequency, double frequencythreshold = 0.5e+9);
+
+/**
+* Reads and parses every frequency of several named SymmetricAntennaPatterns in a single pass over an input stream;
+* all of the requested patterns must share the same frequencies
+* @param[in ] patterns SymmetricAntennaPattern vectors to fill with one pattern per frequency, by name of antenna pattern
+* @param[out] frequencies Frequency of each pattern (Hz), in file order
+* @param[in ] in Input stream to read
+* @return boolean, true if every requested pattern was found and parsed, false on failure
+* @pre pointers in patterns and frequencies valid params
+*/
+SDKCORE_EXPORT bool readPatterns(const std::map<std::string, std::vector<SymmetricAntennaPattern>*>& patterns, std::vector<double> *frequencies, std::istream &in);
+
+/**
+* Reads and parses every frequency of several named SymmetricAntennaPatterns in a single pass over an input file
+* @param[in ] patterns SymmetricAntennaPattern vectors to fill with one pattern per frequency, by name of antenna pattern
+* @param[out] frequencies Frequency of each pattern (Hz), in file order
+* @param[in ] filename Input file name to read
+* @return boolean, true if every requested pattern was found and parsed, false on failure
+* @pre pointers in patterns and frequencies valid params
+*/
+SDKCORE_EXPORT bool readPatterns(const std::map<std::string, std::vector<SymmetricAntennaPattern>*>& patterns, std::vector<double> *frequencies, const std::string &filename);
+
 // ----------------------------------------------------------------------------
 
 /// Monopulse antenna pattern class
 class SDKCORE_EXPORT AntennaPatternMonopulse : public AntennaPattern
 {
 public:
+  /// Sum and delta channels of a monopulse pattern in one direction
+  struct Response
+  {
+    std::complex<double> sum_;    ///< Interpolated sum pattern (linear), 0 if the angles are outside of the pattern
+    std::complex<double> delta_;  ///< Interpolated delta pattern (linear), 0 if the angles are outside of the pattern
+    std::complex<double> ratio_;  ///< delta_ / sum_, 0 where sum_ is 0
+    float sumGain_;               ///< Gain of the sum pattern including the reference gain (dB), SMALL_DB_VAL outside
+    float deltaGain_;             ///< Gain of the delta pattern including the reference gain (dB), SMALL_DB_VAL outside
+  };
+
   AntennaPatternMonopulse();
   virtual ~AntennaPatternMonopulse();
 
@@ -515,26 +1493,126 @@ public:
   virtual AntennaPatternType type() const { return ANTENNA_PATTERN_MONOPULSE; }
 
   /** @copydoc AntennaPattern::gain */
-  virtual float gain(const AntennaGainParameters &params);
+  virtual float gain(const AntennaGainParameters &params) const;
 
   /** @copydoc AntennaPattern::minMaxGain */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::upperBoundGain */
+  virtual float upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * @copydoc AntennaPattern::bindFrequency
+  * The evaluator selects the sum and delta tables nearest the frequency once.
+  */
+  virtual std::unique_ptr<AntennaPatternEvaluator> bindFrequency(double freq) const;
+
+  /** @copydoc AntennaPattern::writeCompiled */
+  virtual int writeCompiled(CompiledPatternWriter& writer) const;
+
+  /** @copydoc AntennaPattern::readCompiled */
+  virtual int readCompiled(const CompiledPatternReader& reader);
 
   /**
   * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat_
   * @param[in ] file Input file name
-  * @param[in ] freq Frequency of antenna pattern to load (Hz)
+  * @param[in ] freq Frequency of antenna pattern to load (Hz), unused if allFrequencies is set
+  * @param[in ] allFrequencies If true, keeps the patterns of every frequency in the file, and uses the ones
+  *   nearest AntennaGainParameters::freq_ instead of reloading when the frequency changes
   * @return 0 on success.
   */
-  int readPat(const std::string& file, double freq);
+  int readPat(const std::string& file, double freq, bool allFrequencies = false);
+
+  /**
+  * This method interpolates the complex sum or delta pattern, for callers that need its phase
+  * @param[in ] params Antenna gain parameters; azim_, elev_, freq_ and delta_ are used
+  * @param[out] magph Interpolated pattern value (linear), unchanged on failure
+  * @return true on success, false if the pattern is not valid or the angles are outside of the pattern
+  */
+  bool complexGain(const AntennaGainParameters &params, std::complex<double> &magph) const;
+
+  /**
+  * This method interpolates the sum and delta patterns in one direction, locating the grid cell and its weights once
+  * for both channels when they share a grid. The gains are those of the interpolated complex values, which gain()
+  * returns unless precomputedGain() is set.
+  * @param[in ] params Antenna gain parameters; azim_, elev_, freq_ and refGain_ are used, delta_ is ignored
+  * @param[out] response Sum, delta and ratio, set to 0 and SMALL_DB_VAL on failure
+  * @return true on success, false if the pattern is not valid or the angles are outside of the pattern
+  */
+  bool response(const AntennaGainParameters &params, Response &response) const;
+
+  /**
+  * This method computes response() for many directions at the frequency and reference gain of params
+  * @param[in ] params Antenna gain parameters; freq_ and refGain_ are used
+  * @param[in ] azim Array of count relative azimuth angles (rad)
+  * @param[in ] elev Array of count relative elevation angles (rad)
+  * @param[in ] count Number of directions
+  * @param[out] responses Array of count responses to fill, set to 0 and SMALL_DB_VAL outside of the pattern
+  * @return number of directions inside of the pattern
+  */
+  size_t responseBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, Response *responses) const;
+
+  /**
+  * This method selects whether gain() interpolates gain tables precomputed in dB when the pattern is loaded, instead
+  * of interpolating the complex pattern and converting it to dB, which saves an abs and a log10 per call at the cost
+  * of a float table per channel. Patterns already loaded are converted, and later loads use the selected option.
+  * The two agree at grid points; between them interpolating dB ignores phase, so it does not reproduce the nulls
+  * where neighboring values have opposite phase, such as the delta channel at boresight. complexGain() is unaffected.
+  * @param[in ] precomputedGain true to interpolate precomputed dB tables, false (default) to interpolate the complex pattern
+  */
+  void setPrecomputedGain(bool precomputedGain);
+
+  /**
+  * This method returns whether gain() interpolates precomputed dB tables
+  * @return true if gain() interpolates precomputed dB tables
+  */
+  bool precomputedGain() const { return precomputedGain_; }
+
+  /**
+  * This method selects single precision storage for the sum and delta patterns, halving their memory footprint.
+  * Patterns already loaded are converted, and later loads use the selected precision. The real and imaginary parts
+  * are rounded to and interpolated in float, so the interpolated voltage changes by a few parts in 1e7 of the largest
+  * magnitude of the surrounding grid points; away from nulls the gain changes by less than 1e-5 dB.
+  * @param[in ] singlePrecision true to store the patterns as float, false (default) to store them as double
+  */
+  void setSinglePrecision(bool singlePrecision);
+
+  /**
+  * This method returns whether the patterns are stored in single precision
+  * @return true if the patterns are stored as float
+  */
+  bool singlePrecision() const { return singlePrecision_; }
 
 protected:
-  double freq_; ///< Current freq associated with computed gain
-  float minDelGain_; ///< Minimum delta gain value (dB)
-  float maxDelGain_; ///< Maximum delta gain value (dB)
+  class FrequencyEvaluator;    ///< Evaluator returned by bindFrequency()
 
-  SymmetricAntennaPattern sumPat_;  ///< Monopulse sum pattern (linear)
-  SymmetricAntennaPattern delPat_;  ///< Monopulse delta pattern (linear)
+  /// Single precision monopulse pattern; the parts interpolate independently, exactly as the complex values do
+  struct FloatChannel
+  {
+    GridTable<float> real_;  ///< Real part of the pattern (linear)
+    GridTable<float> imag_;  ///< Imaginary part of the pattern (linear)
+  };
+
+  double freq_; ///< Current freq associated with computed gain
+  MinMaxGainCache minMaxCache_; ///< Cached minMaxGain() results, relative to the reference gain
+
+  GridTable<std::complex<double> > sumPat_;  ///< Monopulse sum pattern (linear), for a single frequency
+  GridTable<std::complex<double> > delPat_;  ///< Monopulse delta pattern (linear), for a single frequency
+  std::vector<double> freqData_;    ///< Frequency of each entry of sumPats_ and delPats_ (Hz), in increasing order
+  std::vector<GridTable<std::complex<double> > > sumPats_;  ///< Monopulse sum pattern (linear) of every frequency, empty for a single frequency
+  std::vector<GridTable<std::complex<double> > > delPats_;  ///< Monopulse delta pattern (linear) of every frequency, empty for a single frequency
+  bool singlePrecision_;            ///< Whether loaded patterns are converted to floatPats_
+  /**
+  * Single precision sum and delta patterns, at 2 * frequency index + delta. When not empty they replace sumPat_,
+  * delPat_, sumPats_ and delPats_, which are then empty.
+  */
+  std::vector<FloatChannel> floatPats_;
+  bool precomputedGain_;            ///< Whether loaded patterns are converted to gainPats_
+  /// Gain (dB) of the sum and delta patterns at 2 * frequency index + delta, empty unless precomputedGain_ is set
+  std::vector<GridTable<float> > gainPats_;
 
   /**
   * This method resets the pattern
@@ -542,14 +1620,73 @@ protected:
   void reset_();
 
   /**
-  * This method sets the minimum and maximum gains for the requested pattern type
+  * This method determines the patterns to use for the requested frequency
+  * @param[in ] freq Frequency to locate (Hz)
+  * @return index of the entry of sumPats_ and delPats_ nearest freq, 0 for a single frequency
+  */
+  size_t freqIndex_(double freq) const;
+
+  /**
+  * This method returns the requested pattern
+  * @param[in ] delta Boolean, true: use delta pattern, false: use sum pattern
+  * @param[in ] findex Frequency index, from freqIndex_()
+  * @return monopulse pattern (linear)
+  */
+  const GridTable<std::complex<double> >& pattern_(bool delta, size_t findex) const;
+
+  /**
+  * This method interpolates the requested pattern from whichever storage holds it
+  * @param[in ] delta Boolean, true: use delta pattern, false: use sum pattern
+  * @param[in ] findex Frequency index, from freqIndex_()
+  * @param[in ] azim Relative azimuth angle (rad)
+  * @param[in ] elev Relative elevation angle (rad)
+  * @param[out] magph Interpolated pattern value (linear), unchanged if the angles are outside of the pattern
+  * @return true on success, false if the angles are outside of the pattern
+  */
+  bool lookup_(bool delta, size_t findex, float azim, float elev, std::complex<double> &magph) const;
+
+  /**
+  * This method computes the gain of the requested pattern, from gainPats_ when they are present
+  * @param[in ] delta Boolean, true: use delta pattern, false: use sum pattern
+  * @param[in ] findex Frequency index, from freqIndex_()
+  * @param[in ] azim Relative azimuth angle (rad)
+  * @param[in ] elev Relative elevation angle (rad)
+  * @param[in ] refGain Reference gain of pattern (dB)
+  * @return antenna pattern gain (dB)
+  */
+  float gain_(bool delta, size_t findex, float azim, float elev, float refGain) const;
+
+  /**
+  * This method interpolates both channels of the requested frequency in one direction
+  * @param[in ] findex Frequency index, from freqIndex_()
+  * @param[in ] azim Relative azimuth angle (rad)
+  * @param[in ] elev Relative elevation angle (rad)
+  * @param[in ] refGain Reference gain of pattern (dB)
+  * @param[out] response Sum, delta and ratio, set to 0 and SMALL_DB_VAL on failure
+  * @return true on success, false if the angles are outside of the pattern
+  */
+  bool response_(size_t findex, float azim, float elev, float refGain, Response &response) const;
+
+  /**
+  * This method moves the patterns into the storage selected by singlePrecision_
+  */
+  void applyPrecision_();
+
+  /**
+  * This method computes or releases gainPats_, as selected by precomputedGain_
+  */
+  void applyPrecomputedGain_();
+
+  /**
+  * This method computes the minimum and maximum gains for the requested pattern type
   * @param[out] min Minimum gain value to set (dB)
   * @param[out] max Maximum gain value to set (dB)
   * @param[in ] maxGain Maximum gain to be applied to computed gain value (dB)
   * @param[in ] delta Boolean, true: use delta pattern, false: use sum pattern
+  * @param[in ] findex Frequency index, from freqIndex_()
   * @pre min and max valid params
   */
-  void setMinMaxGain_(float *min, float *max, float maxGain, bool delta);
+  void setMinMaxGain_(float *min, float *max, float maxGain, bool delta, size_t findex) const;
 
 };
 
@@ -586,6 +1723,26 @@ SDKCORE_EXPORT bool readPattern(SymmetricGainAntPattern *sap, std::istream &in,
 */
 SDKCORE_EXPORT bool readPattern(SymmetricGainAntPattern *sap, const std::string &filename, double frequency, double frequencythreshold = 0.5e+9);
 
+/**
+* Reads and parses every frequency of a SymmetricGainAntPattern from an input stream
+* @param[out] saps SymmetricGainAntPattern vector to fill with one pattern per frequency
+* @param[out] frequencies Frequency of each pattern (Hz), in file order
+* @param[in ] in Input stream to read
+* @return boolean, true:success, false on failure
+* @pre saps and frequencies valid params
+*/
+SDKCORE_EXPORT bool readPatterns(std::vector<SymmetricGainAntPattern> *saps, std::vector<double> *frequencies, std::istream &in);
+
+/**
+* Reads and parses every frequency of a SymmetricGainAntPattern from an input file
+* @param[out] saps SymmetricGainAntPattern vector to fill with one pattern per frequency
+* @param[out] frequencies Frequency of each pattern (Hz), in file order
+* @param[in ] filename Input file name to read
+* @return boolean, true:success, false on failure
+* @pre saps and frequencies valid params
+*/
+SDKCORE_EXPORT bool readPatterns(std::vector<SymmetricGainAntPattern> *saps, std::vector<double> *frequencies, const std::string &filename);
+
 // ----------------------------------------------------------------------------
 
 /// Bilinear interpolation antenna pattern class
@@ -599,27 +1756,111 @@ public:
   virtual AntennaPatternType type() const { return ANTENNA_PATTERN_BILINEAR; }
 
   /** @copydoc AntennaPattern::gain */
-  virtual float gain(const AntennaGainParameters &params);
+  virtual float gain(const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::cursorGain */
+  virtual float cursorGain(const AntennaGainParameters &params, AntennaLookupCursor &cursor) const;
 
   /** @copydoc AntennaPattern::minMaxGain */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::upperBoundGain */
+  virtual float upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * @copydoc AntennaPattern::bindFrequency
+  * The evaluator locates the bracketing frequency tables once.
+  */
+  virtual std::unique_ptr<AntennaPatternEvaluator> bindFrequency(double freq) const;
+
+  /** @copydoc AntennaPattern::writeCompiled */
+  virtual int writeCompiled(CompiledPatternWriter& writer) const;
+
+  /** @copydoc AntennaPattern::readCompiled */
+  virtual int readCompiled(const CompiledPatternReader& reader);
 
   /**
   * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat_
   * @param[in ] file Input file name
-  * @param[in ] freq Frequency of antenna pattern to load (Hz)
+  * @param[in ] freq Frequency of antenna pattern to load (Hz), unused if allFrequencies is set
+  * @param[in ] allFrequencies If true, keeps the pattern of every frequency in the file, and interpolates
+  *   between them by AntennaGainParameters::freq_ instead of reloading when the frequency changes
   * @return 0 on success.
   */
-  int readPat(const std::string& file, double freq);
+  int readPat(const std::string& file, double freq, bool allFrequencies = false);
+
+  /**
+  * This method selects single precision storage for the gain patterns, halving their memory footprint. Patterns
+  * already loaded are converted, and later loads use the selected precision. The dB gains are rounded to and
+  * interpolated in float, changing them by a few parts in 1e7, under 1e-4 dB for gains within +/-100 dB.
+  * @param[in ] singlePrecision true to store the patterns as float, false (default) to store them as double
+  */
+  void setSinglePrecision(bool singlePrecision);
+
+  /**
+  * This method returns whether the patterns are stored in single precision
+  * @return true if the patterns are stored as float
+  */
+  bool singlePrecision() const { return singlePrecision_; }
 
 protected:
+  class FrequencyEvaluator;    ///< Evaluator returned by bindFrequency()
+
   double freq_;                     ///< Current freq associated with computed gain
-  SymmetricGainAntPattern antPat_;  ///< Antenna gain data (dB)
+  GridTable<double> antPat_;        ///< Antenna gain data (dB), for a single frequency
+  std::vector<double> freqData_;    ///< Frequency of each entry of freqPats_ (Hz), in increasing order
+  std::vector<GridTable<double> > freqPats_;  ///< Antenna gain data (dB) of every frequency, empty for a single frequency
+  std::vector<float> freqMinGain_;  ///< Minimum gain of each entry of freqPats_ (dB)
+  std::vector<float> freqMaxGain_;  ///< Maximum gain of each entry of freqPats_ (dB)
+  bool singlePrecision_;            ///< Whether loaded patterns are converted to floatPats_
+  /**
+  * Single precision gain data (dB) of each frequency, one entry for a single frequency. When not empty it replaces
+  * antPat_ and freqPats_, which are then empty.
+  */
+  std::vector<GridTable<float> > floatPats_;
 
   /**
   * This method resets the pattern
   */
   void reset_();
+
+  /**
+  * This method determines the frequency interpolation index and offset for the requested frequency
+  * @param[in ] freq Frequency to locate (Hz)
+  * @param[out] flowindex Index of the lower frequency pattern in freqPats_
+  * @param[out] fdelta Fractional offset from the lower frequency pattern, in [0, 1]
+  * @param[in,out] hint If not nullptr, lower frequency index of a previous call, checked before searching and updated
+  */
+  void freqIndex_(double freq, size_t &flowindex, double &fdelta, size_t *hint = nullptr) const;
+
+  /**
+  * This method computes the gain for a single direction, without the reference gain
+  * @param[in ] azim Relative azimuth angle (rad)
+  * @param[in ] elev Relative elevation angle (rad)
+  * @param[in ] flowindex Index of the lower frequency pattern in freqPats_, unused for a single frequency
+  * @param[in ] fdelta Fractional offset from the lower frequency pattern, unused for a single frequency
+  * @param[out] gain Antenna pattern gain (dB)
+  * @return true on success, false if the angles are outside of the pattern
+  */
+  bool gain_(float azim, float elev, size_t flowindex, double fdelta, float &gain) const;
+
+  /**
+  * This method interpolates the pattern of one frequency from whichever storage holds it
+  * @param[in ] findex Index of the frequency pattern, 0 for a single frequency
+  * @param[in ] azim Relative azimuth angle (rad)
+  * @param[in ] elev Relative elevation angle (rad)
+  * @param[out] gain Antenna pattern gain (dB), unchanged if the angles are outside of the pattern
+  * @return true on success, false if the angles are outside of the pattern
+  */
+  bool lookup_(size_t findex, float azim, float elev, double &gain) const;
+
+  /**
+  * This method moves the patterns into the storage selected by singlePrecision_
+  */
+  void applyPrecision_();
 };
 
 // ----------------------------------------------------------------------------
@@ -636,10 +1877,36 @@ public:
   virtual AntennaPatternType type() const { return ANTENNA_PATTERN_NSMA; }
 
   /** @copydoc AntennaPattern::gain */
-  virtual float gain(const AntennaGainParameters &params);
+  virtual float gain(const AntennaGainParameters &params) const;
 
   /** @copydoc AntennaPattern::minMaxGain */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::upperBoundGain */
+  virtual float upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * @copydoc AntennaPattern::bindFrequency
+  * The evaluator checks once whether the frequency lies within the band of the pattern, see
+  * AntennaPatternEvaluator::inBand(); gains do not depend on the frequency.
+  */
+  virtual std::unique_ptr<AntennaPatternEvaluator> bindFrequency(double freq) const;
+
+  /**
+  * @copydoc AntennaPattern::polarityGains
+  * The azimuth and elevation are each located once when the tables of every polarization share their breakpoint
+  * angles, as they do when the file lists the same angles for each.
+  */
+  virtual void polarityGains(const AntennaGainParameters &params, const PolarityType *polarities, size_t count, float *gains) const;
+
+  /** @copydoc AntennaPattern::writeCompiled */
+  virtual int writeCompiled(CompiledPatternWriter& writer) const;
+
+  /** @copydoc AntennaPattern::readCompiled */
+  virtual int readCompiled(const CompiledPatternReader& reader);
 
   /**
   * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat_
@@ -659,18 +1926,38 @@ protected:
 
   std::map<float, float> HVDataMap_;    ///< Azimuth HV polarization gain data (dB)
   std::map<float, float> ELHVDataMap_;  ///< Elevation HV polarization gain data (dB)
-  float minHVGain_;                     ///< Minimum HV gain value (dB)
-  float maxHVGain_;                     ///< Maximum HV gain value (dB)
 
   std::map<float, float> VHDataMap_;    ///< Azimuth VH polarization gain data (dB)
   std::map<float, float> ELVHDataMap_;  ///< Elevation VH polarization gain data (dB)
-  float minVHGain_;                     ///< Minimum VH gain value (dB)
-  float maxVHGain_;                     ///< Maximum VH gain value (dB)
 
   std::map<float, float> VVDataMap_;    ///< Azimuth VV polarization gain data (dB)
   std::map<float, float> ELVVDataMap_;  ///< Elevation VV polarization gain data (dB)
-  float minVVGain_;                     ///< Minimum VV gain value (dB)
-  float maxVVGain_;                     ///< Maximum VV gain value (dB)
+  MinMaxGainCache minMaxCache_;         ///< Cached minMaxGain() results
+
+  AngleGainTable HHTable_;              ///< Compiled HHDataMap_ used for lookups
+  AngleGainTable ELHHTable_;            ///< Compiled ELHHDataMap_ used for lookups
+  AngleGainTable HVTable_;              ///< Compiled HVDataMap_ used for lookups
+  AngleGainTable ELHVTable_;            ///< Compiled ELHVDataMap_ used for lookups
+  AngleGainTable VHTable_;              ///< Compiled VHDataMap_ used for lookups
+  AngleGainTable ELVHTable_;            ///< Compiled ELVHDataMap_ used for lookups
+  AngleGainTable VVTable_;              ///< Compiled VVDataMap_ used for lookups
+  AngleGainTable ELVVTable_;            ///< Compiled ELVVDataMap_ used for lookups
+  bool sharedAzimAngles_;               ///< Whether the azimuth tables of every polarization have the same angles
+  bool sharedElevAngles_;               ///< Whether the elevation tables of every polarization have the same angles
+
+  /**
+  * This method returns the compiled azimuth and elevation data for the requested polarity
+  * @param[in ] polarity Antenna polarity
+  * @param[out] azimData Azimuth gain data for the polarity
+  * @param[out] elevData Elevation gain data for the polarity
+  * @pre azimData and elevData valid params
+  */
+  void dataTables_(PolarityType polarity, const AngleGainTable **azimData, const AngleGainTable **elevData) const;
+
+  /**
+  * This method determines which tables share their breakpoint angles, once they are compiled or read
+  */
+  void setSharedAngles_();
 
   /**
   * This method parses and stores the incoming antenna pattern data
@@ -680,14 +1967,14 @@ protected:
   int readPat_(std::istream& fp);
 
   /**
-  * This method computes and stores the minimum and maximum gains
+  * This method computes the minimum and maximum gains for the requested polarity
   * @param[out] min Minimum gain value to retrieve (dB)
   * @param[out] max Maximum gain value to retrieve (dB)
   * @param[in ] maxGain Maximum gain to be applied to computed gain value (dB)
   * @param[in ] polarity Antenna polarity
   * @pre min and max valid params
   */
-  void setMinMax_(float *min, float *max, float maxGain, PolarityType polarity);
+  void setMinMax_(float *min, float *max, float maxGain, PolarityType polarity) const;
 };
 
 // ----------------------------------------------------------------------------
@@ -697,6 +1984,31 @@ typedef InterpTable< float > GainData;
 /** Lookup table exception handler for floating point gain data */
 typedef InterpTableLimitException< float > GainDataLimitException;
 
+/// Options for loading the large gridded pattern files of AntennaPatternEZNEC and AntennaPatternXFDTD
+struct SDKCORE_EXPORT AntennaPatternLoadOptions
+{
+  AntennaPatternLoadOptions();
+
+  /**
+  * Largest memory the gain values of a load may take, including copies held while parsing (bytes), 0 for no limit;
+  * loads that would exceed it fail before allocating past it
+  */
+  size_t maxMemory_;
+
+  /**
+  * Called as the data section is read, with the position reached in the stream and the size of the stream (bytes),
+  * 0 if the size is unknown; returning false cancels the load
+  */
+  std::function<bool(uint64_t position, uint64_t size)> progress_;
+
+  /**
+  * Largest gain error allowed when downsampling the gain tables after loading (dB), 0 to keep the resolution of the
+  * file. The tables are resampled onto the evenly spaced grid of the same extents with the fewest samples, of any
+  * count, whose bilinear interpolation stays within this error of the file for all polarizations, between samples as
+  * well as at them. Regions that need the full resolution, such as a narrow main lobe, limit the sample counts.
+  */
+  float maxErrorDb_;
+};
 
 /// Easy Numerical Electromagnetic Code (EZNEC) antenna pattern class
 class SDKCORE_EXPORT AntennaPatternEZNEC : public AntennaPattern
@@ -709,10 +2021,28 @@ public:
   virtual AntennaPatternType type() const { return ANTENNA_PATTERN_EZNEC; }
 
   /** @copydoc AntennaPattern::gain */
-  virtual float gain(const AntennaGainParameters &params);
+  virtual float gain(const AntennaGainParameters &params) const;
 
   /** @copydoc AntennaPattern::minMaxGain */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::upperBoundGain */
+  virtual float upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * @copydoc AntennaPattern::polarityGains
+  * The vertical, horizontal and total tables share one grid, so the cell containing the direction is located once.
+  */
+  virtual void polarityGains(const AntennaGainParameters &params, const PolarityType *polarities, size_t count, float *gains) const;
+
+  /** @copydoc AntennaPattern::writeCompiled */
+  virtual int writeCompiled(CompiledPatternWriter& writer) const;
+
+  /** @copydoc AntennaPattern::readCompiled */
+  virtual int readCompiled(const CompiledPatternReader& reader);
 
   /**
   * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat_
@@ -721,17 +2051,37 @@ public:
   */
   int readPat(const std::string& file);
 
+  /**
+  * This method sets the options used by later calls to readPat()
+  * @param[in ] options Memory limit and progress reporting of loads
+  */
+  void setLoadOptions(const AntennaPatternLoadOptions& options) { loadOptions_ = options; }
+
+  /**
+  * This method returns the options used to load patterns
+  * @return load options
+  */
+  const AntennaPatternLoadOptions& loadOptions() const { return loadOptions_; }
+
 protected:
   double frequency_;          ///< Antenna pattern frequency
   float reference_;           ///< Reference gain value (dB)
   bool angleConvCCW_;         ///< Pattern angle convention, CCW:true, Compass:false
-  GainData vertData_;         ///< Vertical component gain values (dB)
+  GridTable<float> vertData_; ///< Vertical component gain values (dB)
   float minVertGain_;         ///< Minimum horizontal gain value (dB)
   float maxVertGain_;         ///< Maximum horizontal gain value (dB)
-  GainData horzData_;         ///< Horizontal component gain values (dB)
+  GridTable<float> horzData_; ///< Horizontal component gain values (dB)
   float minHorzGain_;         ///< Minimum horizontal gain value (dB)
   float maxHorzGain_;         ///< Maximum horizontal gain value (dB)
-  GainData totalData_;        ///< Total gain values (dB)
+  GridTable<float> totalData_; ///< Total gain values (dB)
+  AntennaPatternLoadOptions loadOptions_;  ///< Memory limit and progress reporting of loads
+
+  /**
+  * This method returns the gain data for the requested polarity
+  * @param[in ] polarity Antenna polarity
+  * @return vertical, horizontal or total gain data
+  */
+  const GridTable<float>& gainData_(PolarityType polarity) const;
 
   /**
   * This method parses and stores the incoming antenna pattern data
@@ -754,10 +2104,28 @@ public:
   virtual AntennaPatternType type() const { return ANTENNA_PATTERN_XFDTD; }
 
   /** @copydoc AntennaPattern::gain */
-  virtual float gain(const AntennaGainParameters &params);
+  virtual float gain(const AntennaGainParameters &params) const;
 
   /** @copydoc AntennaPattern::minMaxGain */
-  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::upperBoundGain */
+  virtual float upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * @copydoc AntennaPattern::polarityGains
+  * The vertical, horizontal and total tables share one grid, so the cell containing the direction is located once.
+  */
+  virtual void polarityGains(const AntennaGainParameters &params, const PolarityType *polarities, size_t count, float *gains) const;
+
+  /** @copydoc AntennaPattern::writeCompiled */
+  virtual int writeCompiled(CompiledPatternWriter& writer) const;
+
+  /** @copydoc AntennaPattern::readCompiled */
+  virtual int readCompiled(const CompiledPatternReader& reader);
 
   /**
   * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat_
@@ -766,15 +2134,35 @@ public:
   */
   int readPat(const std::string& file);
 
+  /**
+  * This method sets the options used by later calls to readPat()
+  * @param[in ] options Memory limit and progress reporting of loads
+  */
+  void setLoadOptions(const AntennaPatternLoadOptions& options) { loadOptions_ = options; }
+
+  /**
+  * This method returns the options used to load patterns
+  * @return load options
+  */
+  const AntennaPatternLoadOptions& loadOptions() const { return loadOptions_; }
+
 protected:
   float reference_;           ///< Reference gain value (dB)
-  GainData vertData_;         ///< Vertical component gain values (dB)
+  GridTable<float> vertData_; ///< Vertical component gain values (dB)
   float minVertGain_;         ///< Minimum horizontal gain value (dB)
   float maxVertGain_;         ///< Maximum horizontal gain value (dB)
-  GainData horzData_;         ///< Horizontal component gain values (dB)
+  GridTable<float> horzData_; ///< Horizontal component gain values (dB)
   float minHorzGain_;         ///< Minimum horizontal gain value (dB)
   float maxHorzGain_;         ///< Maximum horizontal gain value (dB)
-  GainData totalData_;        ///< Total gain values (dB)
+  GridTable<float> totalData_; ///< Total gain values (dB)
+  AntennaPatternLoadOptions loadOptions_;  ///< Memory limit and progress reporting of loads
+
+  /**
+  * This method returns the gain data for the requested polarity
+  * @param[in ] polarity Antenna polarity
+  * @return vertical, horizontal or total gain data
+  */
+  const GridTable<float>& gainData_(PolarityType polarity) const;
 
   /**
   * This method parses and stores the incoming antenna pattern data
@@ -784,6 +2172,105 @@ protected:
   int readPat_(std::istream& fp);
 };
 
+// ----------------------------------------------------------------------------
+
+/**
+* @brief Pattern file that is parsed on first use
+*
+* Returned by loadPatternFile() in lazy mode. Construction only checks that the file is readable and derives the type
+* from its extension; the tables, and structures derived from them, are built by the first call that needs them:
+* gain(), minMaxGain(), the batch methods, bindFrequency(), writeCompiled() or pattern(). Loading runs once, under
+* std::call_once, so concurrent first calls from several threads wait for a single load.
+*
+* valid() reports whether the file was readable when the pattern was created. A file that fails to parse later
+* reports errors like loadPatternFile() does and yields no gain: SMALL_DB_VAL, and the bounds of an invalid pattern.
+* Callers needing the interface of the concrete class, such as monopulse responses, use pattern().
+*/
+class SDKCORE_EXPORT AntennaPatternLazy : public AntennaPattern
+{
+public:
+  /**
+  * AntennaPatternLazy constructor; fails quickly (valid() false) if the file cannot be opened or has no known type
+  * @param[in ] filename Name of the file to load (extension matters)
+  * @param[in ] freqMHz Frequency value to pass to loader, in MHz
+  */
+  AntennaPatternLazy(const std::string& filename, float freqMHz);
+  virtual ~AntennaPatternLazy();
+
+  /** @copydoc AntennaPattern::type */
+  virtual AntennaPatternType type() const { return type_; }
+
+  /** @copydoc AntennaPattern::gain */
+  virtual float gain(const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::cursorGain */
+  virtual float cursorGain(const AntennaGainParameters &params, AntennaLookupCursor &cursor) const;
+
+  /** @copydoc AntennaPattern::minMaxGain */
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::upperBoundGain */
+  virtual float upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /** @copydoc AntennaPattern::gainBatchApprox */
+  virtual void gainBatchApprox(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /** @copydoc AntennaPattern::polarityGains */
+  virtual void polarityGains(const AntennaGainParameters &params, const PolarityType *polarities, size_t count, float *gains) const;
+
+  /**
+  * @copydoc AntennaPattern::bindFrequency
+  * The evaluator refers to the loaded pattern, which lives as long as this pattern.
+  */
+  virtual std::unique_ptr<AntennaPatternEvaluator> bindFrequency(double freq) const;
+
+  /** @copydoc AntennaPattern::writeCompiled */
+  virtual int writeCompiled(CompiledPatternWriter& writer) const;
+
+  /**
+  * Compiled patterns cannot be read into a lazy pattern; use loadCompiledPattern()
+  * @param[in ] reader Opened compiled pattern
+  * @return non-zero
+  */
+  virtual int readCompiled(const CompiledPatternReader& reader);
+
+  /**
+  * Returns the counters of the loaded pattern, with the load time measured on first use; zero before loading
+  * @return counter snapshot
+  */
+  virtual AntennaPatternStatistics statistics() const;
+
+  /** @copydoc AntennaPattern::resetStatistics */
+  virtual void resetStatistics();
+
+  /**
+  * This method loads the pattern if it is not loaded yet, and returns it
+  * @return loaded pattern, or nullptr if the file could not be loaded
+  */
+  const AntennaPattern* pattern() const;
+
+  /**
+  * This method returns whether the pattern was loaded; a load in progress on another thread counts as not loaded
+  * @return true once the file has been parsed, successfully or not
+  */
+  bool loaded() const { return loaded_.load(std::memory_order_acquire); }
+
+private:
+  /** Not implemented */
+  AntennaPatternLazy(const AntennaPatternLazy&);
+  /** Not implemented */
+  AntennaPatternLazy& operator=(const AntennaPatternLazy&);
+
+  AntennaPatternType type_;    ///< Type of the pattern, from the file extension
+  float freqMHz_;              ///< Frequency to pass to the loader (MHz)
+  mutable std::once_flag once_;                      ///< Guards the one-time load
+  mutable std::unique_ptr<AntennaPattern> pattern_;  ///< Loaded pattern, set by the one-time load
+  mutable std::atomic<bool> loaded_;                 ///< Whether the one-time load finished
+};
+
 } // namespace simCore
 
 #endif /* SIMCORE_EM_ANTENNA_PATTERN_H */
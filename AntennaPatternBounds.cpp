@@ -0,0 +1,194 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "simNotify/Notify.h"
+#include "simCore/Calc/Math.h"
+#include "simCore/EM/Constants.h"
+#include "simCore/EM/AntennaPattern.h"
+#include "simCore/EM/AntennaPatternBounds.h"
+
+namespace simCore {
+
+namespace
+{
+  /// Padding of each tile bounded, covering the rounding of tile lookups at tile edges (rad)
+  const double TILE_MARGIN = 1e-6;
+}
+
+AntennaGainBounds::AntennaGainBounds()
+{
+}
+
+AntennaGainBounds::~AntennaGainBounds()
+{
+}
+
+int AntennaGainBounds::build(const AntennaPattern& pattern, const AntennaGainParameters& params, size_t azimTiles, size_t elevTiles)
+{
+  levels_.clear();
+  if (azimTiles == 0 || elevTiles == 0)
+  {
+    SIM_ERROR << "Antenna gain bounds need at least one tile across azimuth and elevation" << std::endl;
+    return 1;
+  }
+
+  Level finest;
+  finest.azimTiles_ = azimTiles;
+  finest.elevTiles_ = elevTiles;
+  finest.bounds_.resize(azimTiles * elevTiles);
+  const double azimStep = 2.0 * M_PI / azimTiles;
+  const double elevStep = M_PI / elevTiles;
+  for (size_t j = 0; j < elevTiles; ++j)
+  {
+    const float elevMin = static_cast<float>(sdkMax(-M_PI_2 + j * elevStep - TILE_MARGIN, -M_PI_2));
+    const float elevMax = static_cast<float>(sdkMin(-M_PI_2 + (j + 1) * elevStep + TILE_MARGIN, M_PI_2));
+    for (size_t i = 0; i < azimTiles; ++i)
+    {
+      const float azimMin = static_cast<float>(sdkMax(-M_PI + i * azimStep - TILE_MARGIN, -M_PI));
+      const float azimMax = static_cast<float>(sdkMin(-M_PI + (i + 1) * azimStep + TILE_MARGIN, M_PI));
+      finest.bounds_[j * azimTiles + i] = pattern.upperBoundGain(azimMin, azimMax, elevMin, elevMax, params);
+    }
+  }
+  levels_.push_back(finest);
+
+  // each coarser tile takes the largest bound of the up to 2 x 2 tiles below it
+  while (levels_.back().azimTiles_ > 1 || levels_.back().elevTiles_ > 1)
+  {
+    const Level& fine = levels_.back();
+    Level coarse;
+    coarse.azimTiles_ = (fine.azimTiles_ + 1) / 2;
+    coarse.elevTiles_ = (fine.elevTiles_ + 1) / 2;
+    coarse.bounds_.assign(coarse.azimTiles_ * coarse.elevTiles_, SMALL_DB_VAL);
+    for (size_t j = 0; j < fine.elevTiles_; ++j)
+    {
+      for (size_t i = 0; i < fine.azimTiles_; ++i)
+      {
+        float& bound = coarse.bounds_[(j / 2) * coarse.azimTiles_ + i / 2];
+        bound = sdkMax(bound, fine.bounds_[j * fine.azimTiles_ + i]);
+      }
+    }
+    levels_.push_back(coarse);
+  }
+  return 0;
+}
+
+void AntennaGainBounds::clear()
+{
+  levels_.clear();
+}
+
+float AntennaGainBounds::maxGain() const
+{
+  return (levels_.empty()) ? -SMALL_DB_VAL : levels_.back().bounds_[0];
+}
+
+size_t AntennaGainBounds::tileIndex_(double angle, double range, size_t tiles)
+{
+  const double index = (angle + 0.5 * range) * (tiles / range);
+  return (index > 0.0) ? sdkMin(static_cast<size_t>(index), tiles - 1) : 0;
+}
+
+float AntennaGainBounds::upperBound(float azim, float elev) const
+{
+  // negated so that NaN angles are out of range
+  if (levels_.empty() || !(fabs(azim) <= M_PI && fabs(elev) <= M_PI_2))
+    return -SMALL_DB_VAL;
+  const Level& finest = levels_.front();
+  return finest.bounds_[tileIndex_(elev, M_PI, finest.elevTiles_) * finest.azimTiles_ + tileIndex_(azim, 2.0 * M_PI, finest.azimTiles_)];
+}
+
+float AntennaGainBounds::upperBound(float azimMin, float azimMax, float elevMin, float elevMax) const
+{
+  // negated so that NaN angles are out of range
+  if (levels_.empty() || !(azimMin <= azimMax && elevMin <= elevMax && azimMin >= -M_PI && azimMax <= M_PI && elevMin >= -M_PI_2 && elevMax <= M_PI_2))
+    return -SMALL_DB_VAL;
+
+  const Level& finest = levels_.front();
+  const size_t azim0 = tileIndex_(azimMin, 2.0 * M_PI, finest.azimTiles_);
+  const size_t azim1 = tileIndex_(azimMax, 2.0 * M_PI, finest.azimTiles_);
+  const size_t elev0 = tileIndex_(elevMin, M_PI, finest.elevTiles_);
+  const size_t elev1 = tileIndex_(elevMax, M_PI, finest.elevTiles_);
+  // tile i of a level merges tiles 2i and 2i+1 of the level below; the coarsest level is a single tile
+  size_t level = 0;
+  while ((azim1 >> level) - (azim0 >> level) > 1 || (elev1 >> level) - (elev0 >> level) > 1)
+    ++level;
+  assert(level < levels_.size());
+
+  const Level& tiles = levels_[level];
+  float bound = SMALL_DB_VAL;
+  for (size_t j = elev0 >> level; j <= (elev1 >> level); ++j)
+  {
+    for (size_t i = azim0 >> level; i <= (azim1 >> level); ++i)
+      bound = sdkMax(bound, tiles.bounds_[j * tiles.azimTiles_ + i]);
+  }
+  return bound;
+}
+
+size_t AntennaGainBounds::cull(const float* azim, const float* elev, size_t count, float threshold, size_t* candidates) const
+{
+  assert(count == 0 || (azim && elev && candidates));
+  if (count == 0 || !azim || !elev || !candidates)
+    return 0;
+
+  size_t numCandidates = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (upperBound(azim[i], elev[i]) >= threshold)
+      candidates[numCandidates++] = i;
+  }
+  return numCandidates;
+}
+
+// ----------------------------------------------------------------------------
+
+size_t thresholdGains(const AntennaPattern& pattern, const AntennaGainBounds& bounds, const AntennaGainParameters& params,
+  const float* azim, const float* elev, size_t count, float threshold, float* gains)
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return 0;
+
+  std::vector<size_t> candidates(count);
+  const size_t numCandidates = bounds.cull(azim, elev, count, threshold, candidates.data());
+  std::fill(gains, gains + count, SMALL_DB_VAL);
+  if (numCandidates == 0)
+    return 0;
+
+  // evaluate the survivors together so that the batch path of the pattern applies
+  std::vector<float> candidateAzim(numCandidates);
+  std::vector<float> candidateElev(numCandidates);
+  for (size_t i = 0; i < numCandidates; ++i)
+  {
+    candidateAzim[i] = azim[candidates[i]];
+    candidateElev[i] = elev[candidates[i]];
+  }
+  std::vector<float> candidateGains(numCandidates);
+  pattern.gainBatch(params, candidateAzim.data(), candidateElev.data(), numCandidates, candidateGains.data());
+  for (size_t i = 0; i < numCandidates; ++i)
+    gains[candidates[i]] = candidateGains[i];
+  return numCandidates;
+}
+
+}
@@ -0,0 +1,152 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_EM_ANTENNA_PATTERN_BOUNDS_H
+#define SIMCORE_EM_ANTENNA_PATTERN_BOUNDS_H
+
+#include <cstddef>
+#include <vector>
+
+#include "simCore/Common/Common.h"
+
+namespace simCore
+{
+class AntennaPattern;
+class AntennaGainParameters;
+
+/**
+* @brief Pyramid of azimuth/elevation tiles holding an upper bound of the gain of a pattern over each tile
+*
+* The finest level splits the directions [-PI, PI] x [-PI/2, PI/2] into evenly spaced tiles, each bounded by
+* AntennaPattern::upperBoundGain(); each coarser level merges 2 x 2 tiles of the level below by their largest
+* bound, up to a single tile bounding the whole pattern. A direction whose bound lies below a detection threshold
+* cannot reach it, so callers can reject it with one tile lookup and evaluate gain() only for the remaining ones.
+*
+* Bounds hold for the antenna parameters the pyramid was built with, except for the direction; pyramids of patterns
+* that change, such as AntennaPatternWatched after a reload, must be rebuilt. Queries are thread safe.
+*/
+class SDKCORE_EXPORT AntennaGainBounds
+{
+public:
+  AntennaGainBounds();
+  virtual ~AntennaGainBounds();
+
+  /**
+  * Bounds the gain of a pattern over each tile of the finest level and merges them into the coarser levels,
+  * replacing any previous pyramid
+  * @param[in ] pattern Pattern to bound
+  * @param[in ] params Antenna parameters to bound the pattern for; azim_ and elev_ are ignored
+  * @param[in ] azimTiles Number of tiles across azimuth on the finest level
+  * @param[in ] elevTiles Number of tiles across elevation on the finest level
+  * @return 0 on success, non-zero if either tile count is 0
+  */
+  int build(const AntennaPattern& pattern, const AntennaGainParameters& params, size_t azimTiles = DEFAULT_AZIM_TILES, size_t elevTiles = DEFAULT_ELEV_TILES);
+
+  /** Releases the pyramid; bounds are then never below any gain */
+  void clear();
+
+  /** @return true if the pyramid was built */
+  bool valid() const { return !levels_.empty(); }
+
+  /** @return number of levels, from the finest to the single coarsest tile; 0 if not built */
+  size_t numLevels() const { return levels_.size(); }
+
+  /** @return bound of the gain over all directions (dB), -SMALL_DB_VAL if not built */
+  float maxGain() const;
+
+  /**
+  * Returns an upper bound of the gain in one direction from its tile on the finest level
+  * @param[in ] azim Relative azimuth angle (rad), within [-PI, PI]
+  * @param[in ] elev Relative elevation angle (rad), within [-PI/2, PI/2]
+  * @return gain bound (dB), SMALL_DB_VAL if no direction of the tile has a gain; -SMALL_DB_VAL, which no gain
+  *   exceeds, if not built or for directions outside the ranges
+  */
+  float upperBound(float azim, float elev) const;
+
+  /**
+  * Returns an upper bound of the gain over a sector of directions from the finest level whose tiles cover it with
+  * at most 2 x 2 tiles, so that the cost does not depend on the size of the sector
+  * @param[in ] azimMin Smallest relative azimuth (rad), at least -PI
+  * @param[in ] azimMax Largest relative azimuth (rad), at most PI
+  * @param[in ] elevMin Smallest relative elevation (rad), at least -PI/2
+  * @param[in ] elevMax Largest relative elevation (rad), at most PI/2
+  * @return gain bound (dB); -SMALL_DB_VAL if not built, or if the sector is empty or leaves the ranges
+  */
+  float upperBound(float azimMin, float azimMax, float elevMin, float elevMax) const;
+
+  /**
+  * Selects the directions whose bound reaches a threshold, the only ones whose gain may reach it
+  * @param[in ] azim Array of count relative azimuth angles (rad)
+  * @param[in ] elev Array of count relative elevation angles (rad)
+  * @param[in ] count Number of directions
+  * @param[in ] threshold Gain threshold (dB)
+  * @param[out] candidates Array of at least count entries receiving the indices of the selected directions, in
+  *   increasing order
+  * @return number of selected directions
+  */
+  size_t cull(const float* azim, const float* elev, size_t count, float threshold, size_t* candidates) const;
+
+  /// Default number of tiles across azimuth on the finest level, 2 degree tiles
+  static const size_t DEFAULT_AZIM_TILES = 180;
+  /// Default number of tiles across elevation on the finest level, 2 degree tiles
+  static const size_t DEFAULT_ELEV_TILES = 90;
+
+private:
+  /// One level of the pyramid
+  struct Level
+  {
+    size_t azimTiles_;  ///< Number of tiles across azimuth
+    size_t elevTiles_;  ///< Number of tiles across elevation
+    std::vector<float> bounds_;  ///< azimTiles_ by elevTiles_ gain bounds (dB), azimuth fastest
+  };
+
+  /**
+  * Locates the tile of the finest level containing an angle along one axis
+  * @param[in ] angle Angle to locate (rad), within [-range/2, range/2]
+  * @param[in ] range Extent of the axis (rad)
+  * @param[in ] tiles Number of tiles along the axis
+  * @return tile index
+  */
+  static size_t tileIndex_(double angle, double range, size_t tiles);
+
+  std::vector<Level> levels_;  ///< Levels from the finest to the coarsest
+};
+
+/**
+* Computes the gains of the directions whose bound reaches a threshold, skipping the others. Survivors of
+* AntennaGainBounds::cull() are evaluated together with gainBatch(), culled directions are set to SMALL_DB_VAL.
+* @param[in ] pattern Pattern to evaluate, the one bounds was built for
+* @param[in ] bounds Bounds of pattern for params
+* @param[in ] params Antenna parameters, as given to AntennaGainBounds::build(); azim_ and elev_ are ignored
+* @param[in ] azim Array of count relative azimuth angles (rad)
+* @param[in ] elev Array of count relative elevation angles (rad)
+* @param[in ] count Number of directions
+* @param[in ] threshold Gain threshold (dB)
+* @param[out] gains Array of count gains (dB); every gain at or above threshold equals that of gainBatch()
+* @return number of directions evaluated
+*/
+SDKCORE_EXPORT size_t thresholdGains(const AntennaPattern& pattern, const AntennaGainBounds& bounds, const AntennaGainParameters& params,
+  const float* azim, const float* elev, size_t count, float threshold, float* gains);
+
+}
+
+#endif /* SIMCORE_EM_ANTENNA_PATTERN_BOUNDS_H */
@@ -0,0 +1,616 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifdef WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include "simNotify/Notify.h"
+#include "simCore/String/UtfUtils.h"
+#include "simCore/EM/AntennaPattern.h"
+#include "simCore/EM/AntennaPatternCompiled.h"
+
+namespace simCore {
+
+namespace
+{
+  /// Identifies a compiled antenna pattern file
+  const char COMPILED_MAGIC[8] = { 'S', 'I', 'M', 'A', 'P', 'A', 'T', '\0' };
+
+  /// Written in the byte order of the writing machine, reads back byte swapped on a machine of the other byte order
+  const uint32_t COMPILED_BYTE_ORDER = 0x01020304;
+
+  /// Alignment of section data within the file
+  const uint64_t COMPILED_ALIGNMENT = 16;
+
+  /// Element types of compiled pattern sections
+  enum CompiledElementType
+  {
+    COMPILED_ELEMENT_INT32 = 1,
+    COMPILED_ELEMENT_UINT32 = 2,
+    COMPILED_ELEMENT_FLOAT32 = 3,
+    COMPILED_ELEMENT_FLOAT64 = 4
+  };
+
+  /// Fixed size header at the start of a compiled pattern file
+  struct CompiledFileHeader
+  {
+    char magic_[8];         ///< COMPILED_MAGIC
+    uint32_t byteOrder_;    ///< COMPILED_BYTE_ORDER
+    uint32_t version_;      ///< Format version, COMPILED_PATTERN_VERSION when written
+    uint32_t patternType_;  ///< AntennaPatternType of the pattern
+    uint32_t numSections_;  ///< Number of entries in the section directory, which follows the header
+    uint64_t fileSize_;     ///< Size of the file in bytes
+  };
+
+  /// Entry of the section directory
+  struct CompiledSectionEntry
+  {
+    uint32_t id_;           ///< Section identifier
+    uint32_t elementType_;  ///< CompiledElementType of the elements
+    uint64_t offset_;       ///< Offset of the data from the start of the file, a multiple of COMPILED_ALIGNMENT
+    uint64_t count_;        ///< Number of elements
+  };
+
+  /** Returns the size in bytes of an element type, 0 for unknown types */
+  size_t elementSize(uint32_t elementType)
+  {
+    switch (elementType)
+    {
+    case COMPILED_ELEMENT_INT32:
+      return sizeof(int32_t);
+    case COMPILED_ELEMENT_UINT32:
+      return sizeof(uint32_t);
+    case COMPILED_ELEMENT_FLOAT32:
+      return sizeof(float);
+    case COMPILED_ELEMENT_FLOAT64:
+      return sizeof(double);
+    default:
+      break;
+    }
+    return 0;
+  }
+
+  /** Rounds an offset up to the section alignment */
+  uint64_t alignOffset(uint64_t offset)
+  {
+    return (offset + COMPILED_ALIGNMENT - 1) / COMPILED_ALIGNMENT * COMPILED_ALIGNMENT;
+  }
+
+  /**
+  * Number of values a 2D lookup table entry is stored as; a complex entry is stored as its real and imaginary parts,
+  * the layout of std::complex, so that a table of them is used in place
+  */
+  template <typename T>
+  struct GridValue
+  {
+    static const size_t COUNT = 1;
+  };
+  template <>
+  struct GridValue<std::complex<double> >
+  {
+    static const size_t COUNT = 2;
+  };
+}
+
+int writeCompiledPattern(const AntennaPattern& pattern, const std::string& filename)
+{
+  if (!pattern.valid())
+  {
+    SIM_ERROR << "Cannot compile invalid antenna pattern " << pattern.filename() << std::endl;
+    return 1;
+  }
+  CompiledPatternWriter writer;
+  if (pattern.writeCompiled(writer) != 0)
+  {
+    SIM_ERROR << "Antenna pattern " << pattern.filename() << " could not be compiled" << std::endl;
+    return 1;
+  }
+  return writer.write(filename, pattern.type());
+}
+
+AntennaPattern* loadCompiledPattern(const std::string& filename)
+{
+  CompiledPatternReader reader;
+  if (reader.open(filename) != 0)
+    return nullptr;
+  return loadCompiledPattern(reader);
+}
+
+AntennaPattern* loadCompiledPattern(const CompiledPatternReader& reader)
+{
+  const std::string& filename = reader.filename();
+  AntennaPattern *pattern = nullptr;
+  switch (reader.type())
+  {
+  case ANTENNA_PATTERN_PEDESTAL:
+    pattern = new AntennaPatternPedestal;
+    break;
+  case ANTENNA_PATTERN_GAUSS:
+    pattern = new AntennaPatternGauss;
+    break;
+  case ANTENNA_PATTERN_CSCSQ:
+    pattern = new AntennaPatternCscSq;
+    break;
+  case ANTENNA_PATTERN_SINXX:
+    pattern = new AntennaPatternSinXX;
+    break;
+  case ANTENNA_PATTERN_OMNI:
+    pattern = new AntennaPatternOmni;
+    break;
+  case ANTENNA_PATTERN_TABLE:
+    pattern = new AntennaPatternTable;
+    break;
+  case ANTENNA_PATTERN_MONOPULSE:
+    pattern = new AntennaPatternMonopulse;
+    break;
+  case ANTENNA_PATTERN_CRUISE:
+    pattern = new AntennaPatternCRUISE;
+    break;
+  case ANTENNA_PATTERN_RELATIVE:
+    pattern = new AntennaPatternRelativeTable;
+    break;
+  case ANTENNA_PATTERN_BILINEAR:
+    pattern = new AntennaPatternBiLinear;
+    break;
+  case ANTENNA_PATTERN_NSMA:
+    pattern = new AntennaPatternNSMA;
+    break;
+  case ANTENNA_PATTERN_EZNEC:
+    pattern = new AntennaPatternEZNEC;
+    break;
+  case ANTENNA_PATTERN_XFDTD:
+    pattern = new AntennaPatternXFDTD;
+    break;
+  default:
+    SIM_ERROR << filename << " holds an unsupported antenna pattern type" << std::endl;
+    return nullptr;
+  }
+
+  if (pattern->readCompiled(reader) != 0)
+  {
+    SIM_ERROR << filename << " compiled antenna pattern data is invalid" << std::endl;
+    delete pattern;
+    return nullptr;
+  }
+  return pattern;
+}
+
+// ----------------------------------------------------------------------------
+/// MappedFile methods
+
+MappedFile::MappedFile()
+  : data_(nullptr),
+    size_(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+int MappedFile::open(const std::string& filename)
+{
+  close();
+#ifdef WIN32
+  HANDLE file = CreateFileW(simCore::streamFixUtf8(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return 1;
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0)
+  {
+    CloseHandle(file);
+    return 1;
+  }
+  HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!mapping)
+    return 1;
+  // the view keeps the mapping alive after its handle is closed
+  const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!view)
+    return 1;
+  data_ = static_cast<const char*>(view);
+  size_ = static_cast<size_t>(fileSize.QuadPart);
+#else
+  const int fd = ::open(simCore::streamFixUtf8(filename).c_str(), O_RDONLY);
+  if (fd < 0)
+    return 1;
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0)
+  {
+    ::close(fd);
+    return 1;
+  }
+  // the mapping stays valid after the descriptor is closed
+  void *view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED)
+    return 1;
+  data_ = static_cast<const char*>(view);
+  size_ = static_cast<size_t>(fileStat.st_size);
+#endif
+  return 0;
+}
+
+void MappedFile::close()
+{
+  if (!data_)
+    return;
+#ifdef WIN32
+  UnmapViewOfFile(data_);
+#else
+  munmap(const_cast<char*>(data_), size_);
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
+// ----------------------------------------------------------------------------
+/// CompiledPatternWriter methods
+
+CompiledPatternWriter::CompiledPatternWriter()
+{
+}
+
+CompiledPatternWriter::~CompiledPatternWriter()
+{
+}
+
+void CompiledPatternWriter::add_(uint32_t id, uint32_t elementType, const void *data, size_t count, size_t elementSize)
+{
+  assert(count == 0 || data);
+  Section section;
+  section.id_ = id;
+  section.elementType_ = elementType;
+  section.count_ = count;
+  if (count != 0 && data)
+    section.data_.assign(static_cast<const char*>(data), static_cast<const char*>(data) + count * elementSize);
+  sections_.push_back(section);
+}
+
+void CompiledPatternWriter::addInts(uint32_t id, const int32_t *values, size_t count)
+{
+  add_(id, COMPILED_ELEMENT_INT32, values, count, sizeof(int32_t));
+}
+
+void CompiledPatternWriter::addFloats(uint32_t id, const float *values, size_t count)
+{
+  add_(id, COMPILED_ELEMENT_FLOAT32, values, count, sizeof(float));
+}
+
+void CompiledPatternWriter::addDoubles(uint32_t id, const double *values, size_t count)
+{
+  add_(id, COMPILED_ELEMENT_FLOAT64, values, count, sizeof(double));
+}
+
+void CompiledPatternWriter::addTable(uint32_t id, const AngleGainTable& table)
+{
+  const float bucketScale = table.bucketScale();
+  addFloats(id, table.angles(), table.size());
+  addFloats(id + 1, table.gains(), table.size());
+  add_(id + 2, COMPILED_ELEMENT_UINT32, table.buckets(), table.size(), sizeof(uint32_t));
+  addFloats(id + 3, &bucketScale, 1);
+}
+
+template <typename T>
+void CompiledPatternWriter::addExtents_(uint32_t id, const GridTable<T>& grid)
+{
+  const double extents[6] = { grid.minX(), grid.maxX(), static_cast<double>(grid.numX()),
+    grid.minY(), grid.maxY(), static_cast<double>(grid.numY()) };
+  addDoubles(id, extents, 6);
+}
+
+void CompiledPatternWriter::addGrid(uint32_t id, const GridTable<float>& grid)
+{
+  addExtents_(id, grid);
+  addFloats(id + 1, grid.values(), grid.size());
+}
+
+void CompiledPatternWriter::addGrid(uint32_t id, const GridTable<double>& grid)
+{
+  addExtents_(id, grid);
+  addDoubles(id + 1, grid.values(), grid.size());
+}
+
+void CompiledPatternWriter::addGrid(uint32_t id, const GridTable<std::complex<double> >& grid)
+{
+  addExtents_(id, grid);
+  addDoubles(id + 1, reinterpret_cast<const double*>(grid.values()), GridValue<std::complex<double> >::COUNT * grid.size());
+}
+
+int CompiledPatternWriter::write(const std::string& filename, AntennaPatternType type) const
+{
+  std::vector<char> image;
+  write(image, type);
+
+  std::ofstream out(simCore::streamFixUtf8(filename), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!out.is_open())
+  {
+    SIM_ERROR << "Could not open " << filename << " for writing" << std::endl;
+    return 1;
+  }
+  out.write(image.data(), static_cast<std::streamsize>(image.size()));
+  out.close();
+  if (out.fail())
+  {
+    SIM_ERROR << "Failed to write compiled antenna pattern " << filename << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+void CompiledPatternWriter::write(std::vector<char>& image, AntennaPatternType type) const
+{
+  // lay out the sections after the header and directory
+  std::vector<CompiledSectionEntry> directory(sections_.size());
+  uint64_t offset = alignOffset(sizeof(CompiledFileHeader) + sections_.size() * sizeof(CompiledSectionEntry));
+  for (size_t i = 0; i < sections_.size(); ++i)
+  {
+    directory[i].id_ = sections_[i].id_;
+    directory[i].elementType_ = sections_[i].elementType_;
+    directory[i].offset_ = offset;
+    directory[i].count_ = sections_[i].count_;
+    offset = alignOffset(offset + sections_[i].data_.size());
+  }
+
+  CompiledFileHeader header;
+  memcpy(header.magic_, COMPILED_MAGIC, sizeof(header.magic_));
+  header.byteOrder_ = COMPILED_BYTE_ORDER;
+  header.version_ = COMPILED_PATTERN_VERSION;
+  header.patternType_ = static_cast<uint32_t>(type);
+  header.numSections_ = static_cast<uint32_t>(sections_.size());
+  header.fileSize_ = offset;
+
+  // padding between sections stays zero
+  image.assign(static_cast<size_t>(header.fileSize_), 0);
+  memcpy(image.data(), &header, sizeof(header));
+  if (!directory.empty())
+    memcpy(image.data() + sizeof(header), directory.data(), directory.size() * sizeof(CompiledSectionEntry));
+  for (size_t i = 0; i < sections_.size(); ++i)
+  {
+    if (!sections_[i].data_.empty())
+      memcpy(image.data() + directory[i].offset_, sections_[i].data_.data(), sections_[i].data_.size());
+  }
+}
+
+// ----------------------------------------------------------------------------
+/// CompiledPatternReader methods
+
+CompiledPatternReader::CompiledPatternReader()
+  : type_(NO_ANTENNA_PATTERN),
+    data_(nullptr),
+    directory_(nullptr),
+    numSections_(0)
+{
+}
+
+CompiledPatternReader::~CompiledPatternReader()
+{
+}
+
+int CompiledPatternReader::open(const std::string& filename)
+{
+  std::shared_ptr<MappedFile> file(new MappedFile);
+  if (file->open(filename) != 0)
+  {
+    storage_.reset();
+    filename_.clear();
+    type_ = NO_ANTENNA_PATTERN;
+    data_ = nullptr;
+    directory_ = nullptr;
+    numSections_ = 0;
+    SIM_ERROR << "Could not map compiled antenna pattern " << filename << std::endl;
+    return 1;
+  }
+  return open(file, file->data(), file->size(), filename);
+}
+
+int CompiledPatternReader::open(const std::shared_ptr<const void>& storage, const char *data, size_t size, const std::string& name)
+{
+  storage_.reset();
+  filename_.clear();
+  type_ = NO_ANTENNA_PATTERN;
+  data_ = nullptr;
+  directory_ = nullptr;
+  numSections_ = 0;
+
+  CompiledFileHeader header;
+  if (!data || size < sizeof(header))
+  {
+    SIM_ERROR << name << " is not a compiled antenna pattern" << std::endl;
+    return 1;
+  }
+  // sections are used in place, so the image must keep their alignment
+  if (reinterpret_cast<uintptr_t>(data) % COMPILED_ALIGNMENT != 0)
+  {
+    SIM_ERROR << name << " compiled antenna pattern image is not aligned to " << COMPILED_ALIGNMENT << " bytes" << std::endl;
+    return 1;
+  }
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic_, COMPILED_MAGIC, sizeof(header.magic_)) != 0)
+  {
+    SIM_ERROR << name << " is not a compiled antenna pattern" << std::endl;
+    return 1;
+  }
+  if (header.byteOrder_ != COMPILED_BYTE_ORDER)
+  {
+    SIM_ERROR << name << " was compiled on a machine of different byte order, recompile it from its source pattern" << std::endl;
+    return 1;
+  }
+  if (header.version_ != COMPILED_PATTERN_VERSION)
+  {
+    SIM_ERROR << name << " has unsupported compiled antenna pattern version " << header.version_ <<
+      ", recompile it from its source pattern" << std::endl;
+    return 1;
+  }
+  if (header.patternType_ > static_cast<uint32_t>(ANTENNA_PATTERN_XFDTD))
+  {
+    SIM_ERROR << name << " holds an unsupported antenna pattern type" << std::endl;
+    return 1;
+  }
+  if (header.fileSize_ != size ||
+    header.numSections_ > (size - sizeof(header)) / sizeof(CompiledSectionEntry))
+  {
+    SIM_ERROR << name << " compiled antenna pattern is truncated" << std::endl;
+    return 1;
+  }
+
+  // validate the directory once, so that section lookups can trust it
+  const char *directory = data + sizeof(header);
+  for (uint32_t i = 0; i < header.numSections_; ++i)
+  {
+    CompiledSectionEntry entry;
+    memcpy(&entry, directory + i * sizeof(entry), sizeof(entry));
+    const size_t elemSize = elementSize(entry.elementType_);
+    if (elemSize == 0 || entry.offset_ % COMPILED_ALIGNMENT != 0 || entry.offset_ > size ||
+      entry.count_ > (size - entry.offset_) / elemSize)
+    {
+      SIM_ERROR << name << " compiled antenna pattern has an invalid section" << std::endl;
+      return 1;
+    }
+  }
+
+  storage_ = storage;
+  filename_ = name;
+  type_ = static_cast<AntennaPatternType>(header.patternType_);
+  data_ = data;
+  directory_ = directory;
+  numSections_ = header.numSections_;
+  return 0;
+}
+
+const void* CompiledPatternReader::section_(uint32_t id, uint32_t elementType, size_t *count) const
+{
+  assert(count);
+  *count = 0;
+  for (uint32_t i = 0; i < numSections_; ++i)
+  {
+    CompiledSectionEntry entry;
+    memcpy(&entry, directory_ + i * sizeof(entry), sizeof(entry));
+    if (entry.id_ != id)
+      continue;
+    if (entry.elementType_ != elementType)
+      return nullptr;
+    *count = static_cast<size_t>(entry.count_);
+    return data_ + entry.offset_;
+  }
+  return nullptr;
+}
+
+const int32_t* CompiledPatternReader::ints(uint32_t id, size_t *count) const
+{
+  return static_cast<const int32_t*>(section_(id, COMPILED_ELEMENT_INT32, count));
+}
+
+const float* CompiledPatternReader::floats(uint32_t id, size_t *count) const
+{
+  return static_cast<const float*>(section_(id, COMPILED_ELEMENT_FLOAT32, count));
+}
+
+const double* CompiledPatternReader::doubles(uint32_t id, size_t *count) const
+{
+  return static_cast<const double*>(section_(id, COMPILED_ELEMENT_FLOAT64, count));
+}
+
+int CompiledPatternReader::readTable(uint32_t id, AngleGainTable *table) const
+{
+  assert(table);
+  if (!table)
+    return 1;
+  table->clear();
+  size_t numAngles = 0;
+  size_t numGains = 0;
+  size_t numBuckets = 0;
+  size_t numScales = 0;
+  const float *angles = floats(id, &numAngles);
+  const float *gains = floats(id + 1, &numGains);
+  const uint32_t *buckets = static_cast<const uint32_t*>(section_(id + 2, COMPILED_ELEMENT_UINT32, &numBuckets));
+  const float *bucketScale = floats(id + 3, &numScales);
+  if (!angles || !gains || !buckets || !bucketScale || numGains != numAngles || numBuckets != numAngles || numScales != 1)
+    return 1;
+  return table->assign(angles, gains, buckets, numAngles, *bucketScale, storage_);
+}
+
+template <typename T, typename V>
+int CompiledPatternReader::readGrid_(uint32_t id, const V *values, size_t numValues, GridTable<T> *grid) const
+{
+  grid->clear();
+  size_t count = 0;
+  const double *extents = doubles(id, &count);
+  // check the sizes before converting them, so that the product cannot overflow
+  if (!values || !extents || count != 6 || !(extents[2] >= 1.0) || !(extents[5] >= 1.0) ||
+    extents[2] > static_cast<double>(numValues) || extents[5] > static_cast<double>(numValues))
+    return 1;
+  const size_t numX = static_cast<size_t>(extents[2]);
+  const size_t numY = static_cast<size_t>(extents[5]);
+  if (numValues % GridValue<T>::COUNT != 0 || numValues / GridValue<T>::COUNT / numX != numY ||
+    numValues / GridValue<T>::COUNT % numX != 0)
+    return 1;
+  grid->assign(extents[0], extents[1], numX, extents[3], extents[4], numY, reinterpret_cast<const T*>(values), storage_);
+  return 0;
+}
+
+int CompiledPatternReader::readGrid(uint32_t id, GridTable<float> *grid) const
+{
+  assert(grid);
+  if (!grid)
+    return 1;
+  size_t count = 0;
+  const float *values = floats(id + 1, &count);
+  return readGrid_(id, values, count, grid);
+}
+
+int CompiledPatternReader::readGrid(uint32_t id, GridTable<double> *grid) const
+{
+  assert(grid);
+  if (!grid)
+    return 1;
+  size_t count = 0;
+  const double *values = doubles(id + 1, &count);
+  return readGrid_(id, values, count, grid);
+}
+
+int CompiledPatternReader::readGrid(uint32_t id, GridTable<std::complex<double> > *grid) const
+{
+  assert(grid);
+  if (!grid)
+    return 1;
+  size_t count = 0;
+  const double *values = doubles(id + 1, &count);
+  return readGrid_(id, values, count, grid);
+}
+
+}
@@ -0,0 +1,339 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_EM_ANTENNA_PATTERN_COMPILED_H
+#define SIMCORE_EM_ANTENNA_PATTERN_COMPILED_H
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "simCore/Common/Common.h"
+#include "simCore/EM/Constants.h"
+
+namespace simCore
+{
+class AntennaPattern;
+class AngleGainTable;
+template <typename T> class GridTable;
+
+/** File extension of compiled antenna pattern files, recognized by loadPatternFile() */
+static const std::string ANTENNA_STRING_EXTENSION_COMPILED = ".apc";
+
+/**
+* Version of the compiled antenna pattern format written by CompiledPatternWriter, the only version read back.
+* Version 2 stores CRUISE gains as a single grid, so that they are used in place like the other 2D tables.
+*/
+static const uint32_t COMPILED_PATTERN_VERSION = 2;
+
+/**
+* Section identifiers of a compiled antenna pattern file. Each pattern type documents the sections it writes in its
+* writeCompiled() implementation; identifiers of tables and grids are offsets from the base identifiers below.
+*/
+enum CompiledPatternSection
+{
+  COMPILED_SECTION_POLARITY = 1,     ///< int32: antenna pattern polarity
+  COMPILED_SECTION_GAIN_LIMITS = 2,  ///< float32[2]: minimum and maximum gain of the pattern (dB)
+  COMPILED_SECTION_SCALARS = 3,      ///< float64[]: pattern specific scalar members, in the order the pattern writes them
+  COMPILED_SECTION_TABLE = 0x100,    ///< AngleGainTable n occupies COMPILED_SECTION_TABLE + 4n through + 4n + 3
+  COMPILED_SECTION_GRID = 0x200,     ///< 2D lookup table n occupies COMPILED_SECTION_GRID + 2n and + 2n + 1
+  COMPILED_SECTION_ARRAY = 0x300     ///< Pattern specific array n is COMPILED_SECTION_ARRAY + n
+};
+
+/**
+* Writes a loaded pattern to a compiled antenna pattern file, which loadCompiledPattern() reads back without parsing
+* @param[in ] pattern Pattern to write; must be valid
+* @param[in ] filename Name of the file to write, conventionally with the ANTENNA_STRING_EXTENSION_COMPILED extension
+* @return 0 on success
+*/
+SDKCORE_EXPORT int writeCompiledPattern(const AntennaPattern& pattern, const std::string& filename);
+
+/**
+* Loads a compiled antenna pattern file written by writeCompiledPattern(). The file is memory mapped; angle/gain
+* tables, 2D lookup tables and CRUISE gains are used in place in the mapping.
+* @param[in ] filename Name of the file to load
+* @return Pointer to antenna pattern instance of the type the file was compiled from, or nullptr on failure
+*/
+SDKCORE_EXPORT AntennaPattern* loadCompiledPattern(const std::string& filename);
+
+class CompiledPatternReader;
+
+/**
+* Creates the pattern described by an opened compiled pattern reader, e.g. one over a shared memory image
+* @param[in ] reader Reader opened on a compiled pattern image; tables used in place keep its storage alive
+* @return Pointer to antenna pattern instance of the type the image was compiled from, or nullptr on failure
+*/
+SDKCORE_EXPORT AntennaPattern* loadCompiledPattern(const CompiledPatternReader& reader);
+
+// ----------------------------------------------------------------------------
+
+/// Read-only memory mapping of an entire file
+class SDKCORE_EXPORT MappedFile
+{
+public:
+  MappedFile();
+  virtual ~MappedFile();
+
+  /**
+  * Maps the given file, replacing any previous mapping
+  * @param[in ] filename Name of the file to map, UTF-8
+  * @return 0 on success
+  */
+  int open(const std::string& filename);
+
+  /** Releases the mapping */
+  void close();
+
+  /** @return start of the mapped file, page aligned; nullptr if not mapped */
+  const char* data() const { return data_; }
+
+  /** @return size of the mapped file in bytes */
+  size_t size() const { return size_; }
+
+private:
+  /** Not implemented */
+  MappedFile(const MappedFile&);
+  /** Not implemented */
+  MappedFile& operator=(const MappedFile&);
+
+  const char *data_;                    ///< Start of the mapping
+  size_t size_;       ///< Size of the mapping in bytes
+};
+
+// ----------------------------------------------------------------------------
+
+/**
+* @brief Builds a compiled antenna pattern file
+*
+* A compiled pattern file holds a fixed size header (magic, byte order tag, format version, pattern type, section
+* count and file size), followed by a directory of sections (identifier, element type, offset and element count) and
+* the section data. Every section starts on a 16 byte boundary, so that arrays can be used directly from a mapping of
+* the file. Data is written in the byte order of the writing machine; the byte order tag lets readers reject files
+* from machines of the other byte order.
+*/
+class SDKCORE_EXPORT CompiledPatternWriter
+{
+public:
+  CompiledPatternWriter();
+  virtual ~CompiledPatternWriter();
+
+  /**
+  * Adds an array of 32 bit integers
+  * @param[in ] id Section identifier, unique within the file
+  * @param[in ] values Array of count values
+  * @param[in ] count Number of values
+  */
+  void addInts(uint32_t id, const int32_t *values, size_t count);
+
+  /**
+  * Adds an array of single precision values
+  * @param[in ] id Section identifier, unique within the file
+  * @param[in ] values Array of count values
+  * @param[in ] count Number of values
+  */
+  void addFloats(uint32_t id, const float *values, size_t count);
+
+  /**
+  * Adds an array of double precision values
+  * @param[in ] id Section identifier, unique within the file
+  * @param[in ] values Array of count values
+  * @param[in ] count Number of values
+  */
+  void addDoubles(uint32_t id, const double *values, size_t count);
+
+  /**
+  * Adds a compiled angle/gain table, in the four sections starting at id
+  * @param[in ] id First section identifier, see COMPILED_SECTION_TABLE
+  * @param[in ] table Table to add
+  */
+  void addTable(uint32_t id, const AngleGainTable& table);
+
+  /**
+  * Adds a 2D lookup table, in the two sections starting at id
+  * @param[in ] id First section identifier, see COMPILED_SECTION_GRID
+  * @param[in ] grid Lookup table to add
+  */
+  void addGrid(uint32_t id, const GridTable<float>& grid);
+
+  /** @copydoc addGrid(uint32_t, const GridTable<float>&) */
+  void addGrid(uint32_t id, const GridTable<double>& grid);
+
+  /** @copydoc addGrid(uint32_t, const GridTable<float>&) */
+  void addGrid(uint32_t id, const GridTable<std::complex<double> >& grid);
+
+  /**
+  * Writes the file
+  * @param[in ] filename Name of the file to write, UTF-8
+  * @param[in ] type Type of the pattern the sections describe
+  * @return 0 on success
+  */
+  int write(const std::string& filename, AntennaPatternType type) const;
+
+  /**
+  * Lays out the file in memory, e.g. to place it in shared memory
+  * @param[out] image Contents of the file, as write() would store them
+  * @param[in ] type Type of the pattern the sections describe
+  */
+  void write(std::vector<char>& image, AntennaPatternType type) const;
+
+private:
+  /// Pending section
+  struct Section
+  {
+    uint32_t id_;             ///< Section identifier
+    uint32_t elementType_;    ///< Type of the elements
+    uint64_t count_;          ///< Number of elements
+    std::vector<char> data_;  ///< Element data
+  };
+
+  /**
+  * Adds a section
+  * @param[in ] id Section identifier
+  * @param[in ] elementType Type of the elements
+  * @param[in ] data Element data
+  * @param[in ] count Number of elements
+  * @param[in ] elementSize Size of one element in bytes
+  */
+  void add_(uint32_t id, uint32_t elementType, const void *data, size_t count, size_t elementSize);
+
+  /**
+  * Adds the extents of a 2D lookup table
+  * @param[in ] id Section identifier
+  * @param[in ] grid Lookup table
+  */
+  template <typename T>
+  void addExtents_(uint32_t id, const GridTable<T>& grid);
+
+  std::vector<Section> sections_; ///< Sections in the order added
+};
+
+// ----------------------------------------------------------------------------
+
+/**
+* @brief Reads a compiled antenna pattern file through a memory mapping, or an image already in memory
+*
+* Section accessors return pointers into the mapping, which stays alive as long as the reader or any table assigned
+* from it does.
+*/
+class SDKCORE_EXPORT CompiledPatternReader
+{
+public:
+  CompiledPatternReader();
+  virtual ~CompiledPatternReader();
+
+  /**
+  * Maps the given file and validates its header and section directory
+  * @param[in ] filename Name of the file to read, UTF-8
+  * @return 0 on success
+  */
+  int open(const std::string& filename);
+
+  /**
+  * Reads a compiled pattern image already in memory, validating its header and section directory
+  * @param[in ] storage Owner of the image, kept alive by the reader and by tables assigned from it
+  * @param[in ] data Start of the image, aligned to 16 bytes
+  * @param[in ] size Size of the image in bytes
+  * @param[in ] name Name reported by filename() and recorded by the loaded pattern
+  * @return 0 on success, non-zero if data is misaligned or the image is invalid
+  */
+  int open(const std::shared_ptr<const void>& storage, const char *data, size_t size, const std::string& name);
+
+  /** @return name of the opened file */
+  const std::string& filename() const { return filename_; }
+
+  /** @return type of the pattern the file was compiled from, NO_ANTENNA_PATTERN if not open */
+  AntennaPatternType type() const { return type_; }
+
+  /**
+  * Returns an array of 32 bit integers
+  * @param[in ] id Section identifier
+  * @param[out] count Number of values in the section, 0 if not found
+  * @return values, or nullptr if the file has no such section of this element type
+  * @pre count valid param
+  */
+  const int32_t* ints(uint32_t id, size_t *count) const;
+
+  /** @copydoc ints */
+  const float* floats(uint32_t id, size_t *count) const;
+
+  /** @copydoc ints */
+  const double* doubles(uint32_t id, size_t *count) const;
+
+  /**
+  * Points a table at the angle/gain table added with CompiledPatternWriter::addTable(), without copying
+  * @param[in ] id First section identifier of the table
+  * @param[out] table Table to assign
+  * @return 0 on success
+  * @pre table valid param
+  */
+  int readTable(uint32_t id, AngleGainTable *table) const;
+
+  /**
+  * Points a 2D lookup table at the table added with CompiledPatternWriter::addGrid(), without copying
+  * @param[in ] id First section identifier of the table
+  * @param[out] grid Lookup table to assign
+  * @return 0 on success
+  * @pre grid valid param
+  */
+  int readGrid(uint32_t id, GridTable<float> *grid) const;
+
+  /** @copydoc readGrid(uint32_t, GridTable<float>*) const */
+  int readGrid(uint32_t id, GridTable<double> *grid) const;
+
+  /** @copydoc readGrid(uint32_t, GridTable<float>*) const */
+  int readGrid(uint32_t id, GridTable<std::complex<double> > *grid) const;
+
+private:
+  /**
+  * Locates a section
+  * @param[in ] id Section identifier
+  * @param[in ] elementType Expected type of the elements
+  * @param[out] count Number of elements, 0 if not found
+  * @return section data, or nullptr if not found
+  */
+  const void* section_(uint32_t id, uint32_t elementType, size_t *count) const;
+
+  /**
+  * Points a 2D lookup table at its entries, after checking them against its extents section
+  * @param[in ] id Section identifier of the extents
+  * @param[in ] values Section holding the table entries, nullptr if missing
+  * @param[in ] numValues Number of values in the section holding the table entries
+  * @param[out] grid Lookup table to assign
+  * @return 0 on success, non-zero if the extents are invalid or do not match numValues
+  */
+  template <typename T, typename V>
+  int readGrid_(uint32_t id, const V *values, size_t numValues, GridTable<T> *grid) const;
+
+  std::shared_ptr<const void> storage_; ///< Owner of the image, e.g. the mapping of the file
+  std::string filename_;                ///< Name of the file
+  AntennaPatternType type_;             ///< Type of the pattern
+  const char *data_;                    ///< Start of the image
+  const char *directory_;               ///< Start of the section directory in the mapping
+  uint32_t numSections_;                ///< Number of sections in the directory
+};
+
+}
+
+#endif /* SIMCORE_EM_ANTENNA_PATTERN_COMPILED_H */
@@ -0,0 +1,151 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_EM_ANTENNA_PATTERN_DEVICE_H
+#define SIMCORE_EM_ANTENNA_PATTERN_DEVICE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+* Qualifies the sampling functions below for compilation as device code: host and device functions under CUDA or
+* HIP; SYCL kernels call plain inline functions
+*/
+#ifndef SIMCORE_ANTENNA_DEVICE
+#if defined(__CUDACC__) || defined(__HIPCC__)
+#define SIMCORE_ANTENNA_DEVICE __host__ __device__
+#else
+#define SIMCORE_ANTENNA_DEVICE
+#endif
+#endif
+
+namespace simCore
+{
+
+/**
+* @brief Flat antenna pattern layout, with pointers to host or device memory
+*
+* Plain data describing a pattern sampled on a regular grid over the sphere, as filled by AntennaFlatPattern::view()
+* with pointers to host memory; callers uploading the two arrays replace the pointers with device addresses.
+*
+* The grid has numAzim_ azimuth samples from azimMin_ in steps of azimStep_, covering -pi to pi with both ends
+* included, and numElev_ elevation samples from elevMin_ in steps of elevStep_, covering -pi/2 to pi/2. One layer of
+* numElev_ rows is stored per frequency and polarization channel; rows are padded to pitch_ floats so that each row
+* starts on an aligned boundary. The gain (dB) of azimuth sample a, elevation sample e, channel c and frequency f is
+*
+*   gains_[((f * numChannels_ + c) * numElev_ + e) * pitch_ + a]
+*
+* frequencies_ holds the numFrequencies_ frequencies of the layers (Hz), ascending.
+*/
+struct AntennaDevicePattern
+{
+  const float* gains_;        ///< Gain samples (dB), laid out as described above
+  const float* frequencies_;  ///< Frequency of each layer (Hz), ascending
+  uint32_t numAzim_;          ///< Number of azimuth samples, at least 2
+  uint32_t numElev_;          ///< Number of elevation samples, at least 2
+  uint32_t numFrequencies_;   ///< Number of frequency layers, at least 1
+  uint32_t numChannels_;      ///< Number of polarization channels, at least 1
+  uint32_t pitch_;            ///< Floats between the starts of consecutive rows, at least numAzim_
+  float azimMin_;             ///< Azimuth of the first sample (rad)
+  float azimStep_;            ///< Azimuth spacing of the samples (rad)
+  float elevMin_;             ///< Elevation of the first sample (rad)
+  float elevStep_;            ///< Elevation spacing of the samples (rad)
+};
+
+/**
+* Interpolates bilinearly (in dB) within one layer of a flat pattern. Azimuth wraps around the circle; elevation is
+* clamped to the grid.
+* @param[in ] pattern Flat pattern layout
+* @param[in ] layer First gain of the layer
+* @param[in ] azim Relative azimuth angle, referenced to host antenna (rad)
+* @param[in ] elev Relative elevation angle, referenced to host antenna (rad)
+* @return interpolated gain (dB)
+*/
+SIMCORE_ANTENNA_DEVICE inline float sampleDevicePatternLayer(const AntennaDevicePattern& pattern, const float* layer, float azim, float elev)
+{
+  // wrap azimuth into the grid's full turn; truncation to int avoids any math library call in device code
+  const float period = static_cast<float>(pattern.numAzim_ - 1);
+  float u = (azim - pattern.azimMin_) / pattern.azimStep_;
+  // NaN and values too large to convert to int (over a million turns) sample the first column
+  if (!(u > -1e6f * period && u < 1e6f * period))
+    u = 0.f;
+  u -= period * static_cast<float>(static_cast<int>(u / period));
+  if (u < 0.f)
+    u += period;
+  uint32_t a = static_cast<uint32_t>(u);
+  if (a > pattern.numAzim_ - 2)
+    a = pattern.numAzim_ - 2;
+  const float ta = u - static_cast<float>(a);
+
+  float v = (elev - pattern.elevMin_) / pattern.elevStep_;
+  if (!(v >= 0.f))
+    v = 0.f;
+  else if (v > static_cast<float>(pattern.numElev_ - 1))
+    v = static_cast<float>(pattern.numElev_ - 1);
+  uint32_t e = static_cast<uint32_t>(v);
+  if (e > pattern.numElev_ - 2)
+    e = pattern.numElev_ - 2;
+  const float te = v - static_cast<float>(e);
+
+  const float* row0 = layer + static_cast<size_t>(e) * pattern.pitch_;
+  const float* row1 = row0 + pattern.pitch_;
+  const float g0 = row0[a] + ta * (row0[a + 1] - row0[a]);
+  const float g1 = row1[a] + ta * (row1[a + 1] - row1[a]);
+  return g0 + te * (g1 - g0);
+}
+
+/**
+* Samples a flat pattern in the given direction, at the given frequency and channel. Equals the gain of the pattern at
+* grid samples; between samples the gain is interpolated bilinearly, and between frequency layers linearly, in dB;
+* frequencies outside the layers use the nearest layer.
+* @param[in ] pattern Flat pattern layout
+* @param[in ] azim Relative azimuth angle, referenced to host antenna (rad)
+* @param[in ] elev Relative elevation angle, referenced to host antenna (rad)
+* @param[in ] freq Frequency (Hz)
+* @param[in ] channel Polarization channel, less than numChannels_
+* @return antenna pattern gain (dB)
+*/
+SIMCORE_ANTENNA_DEVICE inline float sampleDevicePattern(const AntennaDevicePattern& pattern, float azim, float elev, float freq, uint32_t channel)
+{
+  const size_t layerSize = static_cast<size_t>(pattern.numElev_) * pattern.pitch_;
+  const size_t freqStride = layerSize * pattern.numChannels_;
+  const float* first = pattern.gains_ + layerSize * channel;
+
+  const uint32_t last = pattern.numFrequencies_ - 1;
+  if (last == 0 || !(freq > pattern.frequencies_[0]))
+    return sampleDevicePatternLayer(pattern, first, azim, elev);
+  if (freq >= pattern.frequencies_[last])
+    return sampleDevicePatternLayer(pattern, first + freqStride * last, azim, elev);
+
+  // few layers: linear search for the bracketing pair
+  uint32_t f = 0;
+  while (freq >= pattern.frequencies_[f + 1])
+    ++f;
+  const float t = (freq - pattern.frequencies_[f]) / (pattern.frequencies_[f + 1] - pattern.frequencies_[f]);
+  const float g0 = sampleDevicePatternLayer(pattern, first + freqStride * f, azim, elev);
+  const float g1 = sampleDevicePatternLayer(pattern, first + freqStride * (f + 1), azim, elev);
+  return g0 + t * (g1 - g0);
+}
+
+}
+
+#endif /* SIMCORE_EM_ANTENNA_PATTERN_DEVICE_H */
@@ -0,0 +1,154 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include "simNotify/Notify.h"
+#include "simCore/EM/AntennaPattern.h"
+#include "simCore/EM/AntennaPatternRaster.h"
+#include "simCore/EM/AntennaPatternFlat.h"
+
+namespace simCore {
+
+AntennaFlatSpec::AntennaFlatSpec()
+  : numAzim_(361),
+    numElev_(181),
+    pitchAlignment_(32),
+    numThreads_(0)
+{
+}
+
+// ----------------------------------------------------------------------------
+
+AntennaFlatPattern::AntennaFlatPattern()
+  : numAzim_(0),
+    numElev_(0),
+    pitch_(0),
+    azimMin_(0.f),
+    azimStep_(0.f),
+    elevMin_(0.f),
+    elevStep_(0.f)
+{
+}
+
+AntennaDevicePattern AntennaFlatPattern::view() const
+{
+  AntennaDevicePattern layout;
+  layout.gains_ = gains_.data();
+  layout.frequencies_ = frequencies_.data();
+  layout.numAzim_ = static_cast<uint32_t>(numAzim_);
+  layout.numElev_ = static_cast<uint32_t>(numElev_);
+  layout.numFrequencies_ = static_cast<uint32_t>(frequencies_.size());
+  layout.numChannels_ = static_cast<uint32_t>(polarities_.size());
+  layout.pitch_ = static_cast<uint32_t>(pitch_);
+  layout.azimMin_ = azimMin_;
+  layout.azimStep_ = azimStep_;
+  layout.elevMin_ = elevMin_;
+  layout.elevStep_ = elevStep_;
+  return layout;
+}
+
+int AntennaFlatPattern::channel(PolarityType polarity) const
+{
+  const std::vector<PolarityType>::const_iterator it = std::find(polarities_.begin(), polarities_.end(), polarity);
+  return (it == polarities_.end()) ? -1 : static_cast<int>(it - polarities_.begin());
+}
+
+// ----------------------------------------------------------------------------
+
+int flattenPattern(const AntennaPattern& pattern, const AntennaGainParameters& params, const AntennaFlatSpec& spec, AntennaFlatPattern& flat)
+{
+  if (spec.numAzim_ < 2 || spec.numElev_ < 2)
+  {
+    SIM_ERROR << "Flat antenna pattern needs at least 2 samples per axis" << std::endl;
+    return 1;
+  }
+  // layers store single precision frequencies, which must stay distinct for sampling to interpolate between them
+  const std::vector<float> layerFrequencies(spec.frequencies_.begin(), spec.frequencies_.end());
+  for (size_t i = 1; i < layerFrequencies.size(); ++i)
+  {
+    // negated so that NaN frequencies are rejected
+    if (!(layerFrequencies[i] > layerFrequencies[i - 1]))
+    {
+      SIM_ERROR << "Flat antenna pattern frequencies must be strictly ascending in single precision" << std::endl;
+      return 1;
+    }
+  }
+
+  AntennaRasterSpec raster;
+  raster.projection_ = ANTENNA_RASTER_AZEL;
+  raster.minX_ = -M_PI;
+  raster.maxX_ = M_PI;
+  raster.numX_ = spec.numAzim_;
+  raster.minY_ = -M_PI_2;
+  raster.maxY_ = M_PI_2;
+  raster.numY_ = spec.numElev_;
+  raster.frequencies_ = spec.frequencies_;
+  raster.polarities_ = spec.polarities_;
+  raster.numThreads_ = spec.numThreads_;
+  std::vector<float> samples(rasterSize(raster));
+  if (rasterizePattern(pattern, params, raster, samples.data(), samples.size()) != 0)
+    return 1;
+
+  AntennaFlatPattern result;
+  result.numAzim_ = spec.numAzim_;
+  result.numElev_ = spec.numElev_;
+  const size_t alignment = std::max<size_t>(1, spec.pitchAlignment_);
+  result.pitch_ = (spec.numAzim_ + alignment - 1) / alignment * alignment;
+  result.azimMin_ = static_cast<float>(-M_PI);
+  result.azimStep_ = static_cast<float>(2.0 * M_PI / static_cast<double>(spec.numAzim_ - 1));
+  result.elevMin_ = static_cast<float>(-M_PI_2);
+  result.elevStep_ = static_cast<float>(M_PI / static_cast<double>(spec.numElev_ - 1));
+  if (spec.frequencies_.empty())
+    result.frequencies_.push_back(static_cast<float>(params.freq_));
+  else
+    result.frequencies_ = layerFrequencies;
+  if (spec.polarities_.empty())
+    result.polarities_.push_back(params.polarity_);
+  else
+    result.polarities_ = spec.polarities_;
+
+  // copy the dense raster rows into pitched rows; padding repeats the last sample, which reads past a row never need
+  const size_t numRows = samples.size() / spec.numAzim_;
+  result.gains_.resize(numRows * result.pitch_);
+  for (size_t row = 0; row < numRows; ++row)
+  {
+    const float* src = &samples[row * spec.numAzim_];
+    float* dst = &result.gains_[row * result.pitch_];
+    std::copy(src, src + spec.numAzim_, dst);
+    std::fill(dst + spec.numAzim_, dst + result.pitch_, src[spec.numAzim_ - 1]);
+  }
+  flat = std::move(result);
+  return 0;
+}
+
+void sampleFlatPattern(const AntennaDevicePattern& pattern, const float* azim, const float* elev, size_t count, float freq, unsigned int channel, float* gains)
+{
+  assert(count == 0 || (azim && elev && gains));
+  assert(channel < pattern.numChannels_);
+  if (count == 0 || !azim || !elev || !gains || channel >= pattern.numChannels_)
+    return;
+  for (size_t i = 0; i < count; ++i)
+    gains[i] = sampleDevicePattern(pattern, azim[i], elev[i], freq, channel);
+}
+
+}
@@ -0,0 +1,115 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_EM_ANTENNA_PATTERN_FLAT_H
+#define SIMCORE_EM_ANTENNA_PATTERN_FLAT_H
+
+#include <cstddef>
+#include <vector>
+
+#include "simCore/Common/Common.h"
+#include "simCore/EM/Constants.h"
+#include "simCore/EM/AntennaPatternDevice.h"
+
+namespace simCore
+{
+class AntennaPattern;
+class AntennaGainParameters;
+
+/** Grid resolution and sweeps of a flattened antenna pattern */
+struct SDKCORE_EXPORT AntennaFlatSpec
+{
+  AntennaFlatSpec();
+
+  size_t numAzim_;  ///< Number of azimuth samples from -pi to pi, both ends included; at least 2
+  size_t numElev_;  ///< Number of elevation samples from -pi/2 to pi/2, both ends included; at least 2
+  std::vector<double> frequencies_;      ///< Frequencies of the layers (Hz), strictly ascending as floats; empty uses the freq_ of the parameters
+  std::vector<PolarityType> polarities_; ///< Polarization channels; empty uses the polarity_ of the parameters
+  size_t pitchAlignment_;   ///< Row pitch is rounded up to a multiple of this many floats; 32 aligns rows to 128 bytes
+  unsigned int numThreads_; ///< Maximum number of worker threads; 0 uses the hardware concurrency
+};
+
+/**
+* @brief Antenna pattern resampled on a regular grid, ready for upload to a device
+*
+* Produced by flattenPattern(). The members describe the layout documented by AntennaDevicePattern; view() returns
+* that layout with pointers to gains_ and frequencies_. Algorithmic patterns and weighted tables depend on the beam
+* widths and reference gain of the parameters, so the flat pattern holds the gains for the parameters it was made with.
+*/
+struct SDKCORE_EXPORT AntennaFlatPattern
+{
+  AntennaFlatPattern();
+
+  /**
+  * Returns the layout of the pattern with pointers to this object's arrays, which must outlive the view
+  * @return layout for sampleDevicePattern()
+  */
+  AntennaDevicePattern view() const;
+
+  /**
+  * Returns the channel holding the given polarity
+  * @param[in ] polarity Polarity to find
+  * @return channel index, or -1 if the polarity was not flattened
+  */
+  int channel(PolarityType polarity) const;
+
+  size_t numAzim_;  ///< Number of azimuth samples
+  size_t numElev_;  ///< Number of elevation samples
+  size_t pitch_;    ///< Floats between the starts of consecutive rows
+  float azimMin_;   ///< Azimuth of the first sample (rad)
+  float azimStep_;  ///< Azimuth spacing of the samples (rad)
+  float elevMin_;   ///< Elevation of the first sample (rad)
+  float elevStep_;  ///< Elevation spacing of the samples (rad)
+  std::vector<float> frequencies_;       ///< Frequency of each layer (Hz)
+  std::vector<PolarityType> polarities_; ///< Polarity of each channel
+  std::vector<float> gains_;             ///< Gain samples (dB), pitched layers by frequency then channel
+};
+
+/**
+* Resamples any antenna pattern on the regular grid of a flat pattern, computing the samples with rasterizePattern().
+* Each sample equals gain() of the pattern at the same (single precision) angles, frequency and polarity.
+* @param[in ] pattern Pattern to flatten; must not be reloaded while flattening
+* @param[in ] params Antenna parameters shared by all samples; azim_ and elev_ are ignored, as are freq_ and
+*   polarity_ when the spec sweeps them
+* @param[in ] spec Grid resolution and sweeps
+* @param[out] flat Flattened pattern; unchanged on failure
+* @return 0 on success, non-zero if the spec has fewer than 2 samples on an axis, or frequencies are not ascending
+*/
+SDKCORE_EXPORT int flattenPattern(const AntennaPattern& pattern, const AntennaGainParameters& params, const AntennaFlatSpec& spec, AntennaFlatPattern& flat);
+
+/**
+* Samples a flat pattern on the host for a batch of directions, with sampleDevicePattern(); the reference for device
+* kernels, which compute the same per direction
+* @param[in ] pattern Flat pattern layout
+* @param[in ] azim Array of count relative azimuth angles, referenced to host antenna (rad)
+* @param[in ] elev Array of count relative elevation angles, referenced to host antenna (rad)
+* @param[in ] count Number of directions to sample
+* @param[in ] freq Frequency (Hz)
+* @param[in ] channel Polarization channel, less than numChannels_
+* @param[out] gains Array of count antenna pattern gains (dB)
+* @pre azim, elev and gains valid params when count is non-zero
+*/
+SDKCORE_EXPORT void sampleFlatPattern(const AntennaDevicePattern& pattern, const float* azim, const float* elev, size_t count, float freq, unsigned int channel, float* gains);
+
+}
+
+#endif /* SIMCORE_EM_ANTENNA_PATTERN_FLAT_H */
@@ -0,0 +1,110 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <type_traits>
+#include <typeinfo>
+#include "simCore/EM/AntennaPatternHandle.h"
+
+namespace simCore
+{
+
+namespace
+{
+  /** Returns pattern typed as T if its dynamic type is exactly T */
+  template <typename T>
+  bool resolveConcrete(const AntennaPattern& pattern, AntennaPatternHandle::ConcretePattern& concrete)
+  {
+    if (typeid(pattern) != typeid(T))
+      return false;
+    concrete = static_cast<const T*>(&pattern);
+    return true;
+  }
+}
+
+AntennaPatternHandle::AntennaPatternHandle()
+  : concrete_(static_cast<const AntennaPattern*>(nullptr))
+{
+}
+
+AntennaPatternHandle::AntennaPatternHandle(const std::shared_ptr<const AntennaPattern>& pattern)
+  : pattern_(pattern),
+    concrete_(pattern.get())
+{
+  if (!pattern_)
+    return;
+  // Exact type match only: a subclass may override any method, so it keeps virtual dispatch
+  const AntennaPattern& p = *pattern_;
+  resolveConcrete<AntennaPatternGauss>(p, concrete_) ||
+    resolveConcrete<AntennaPatternCscSq>(p, concrete_) ||
+    resolveConcrete<AntennaPatternSinXX>(p, concrete_) ||
+    resolveConcrete<AntennaPatternPedestal>(p, concrete_) ||
+    resolveConcrete<AntennaPatternOmni>(p, concrete_) ||
+    resolveConcrete<AntennaPatternTable>(p, concrete_) ||
+    resolveConcrete<AntennaPatternRelativeTable>(p, concrete_) ||
+    resolveConcrete<AntennaPatternCRUISE>(p, concrete_) ||
+    resolveConcrete<AntennaPatternMonopulse>(p, concrete_) ||
+    resolveConcrete<AntennaPatternBiLinear>(p, concrete_) ||
+    resolveConcrete<AntennaPatternNSMA>(p, concrete_) ||
+    resolveConcrete<AntennaPatternEZNEC>(p, concrete_) ||
+    resolveConcrete<AntennaPatternXFDTD>(p, concrete_);
+}
+
+void AntennaPatternHandle::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || gains);
+  if (count == 0 || !gains)
+    return;
+  if (empty())
+  {
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+    return;
+  }
+  std::visit([&](auto pattern) {
+    typedef std::remove_cv_t<std::remove_pointer_t<decltype(pattern)> > T;
+    if constexpr (std::is_same_v<T, AntennaPattern>)
+      pattern->gainBatch(params, azim, elev, count, gains);
+    else
+      pattern->T::gainBatch(params, azim, elev, count, gains);
+  }, concrete_);
+}
+
+void AntennaPatternHandle::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
+{
+  assert(!empty());
+  if (empty())
+    return;
+  std::visit([&](auto pattern) {
+    typedef std::remove_cv_t<std::remove_pointer_t<decltype(pattern)> > T;
+    if constexpr (std::is_same_v<T, AntennaPattern>)
+      pattern->minMaxGain(min, max, params);
+    else
+      pattern->T::minMaxGain(min, max, params);
+  }, concrete_);
+}
+
+AntennaPatternHandle loadPatternHandle(const std::string& filename, float freqMHz, bool lazy)
+{
+  return AntennaPatternHandle(std::shared_ptr<const AntennaPattern>(loadPatternFile(filename, freqMHz, lazy)));
+}
+
+}
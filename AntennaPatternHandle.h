@@ -0,0 +1,205 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_EM_ANTENNA_PATTERN_HANDLE_H
+#define SIMCORE_EM_ANTENNA_PATTERN_HANDLE_H
+
+#include <cassert>
+#include <memory>
+#include <string>
+#include <variant>
+#include "simCore/Common/Common.h"
+#include "simCore/EM/AntennaPattern.h"
+#include "simCore/EM/AntennaPatternKernels.h"
+
+namespace simCore
+{
+
+/**
+* @brief Shared antenna pattern with its concrete type resolved once
+*
+* A value type holding a shared pattern and a pointer to it typed as its concrete class from AntennaPattern.h. Calls
+* dispatch on the stored type instead of the vtable: gain() evaluates the algorithmic patterns (Gauss, CscSq, SinXX,
+* Pedestal, Omni) with the inline formulas of AntennaKernels, so in a loop over directions the compiler can inline the
+* gain and hoist the dispatch; file patterns get a direct, non-virtual call. gainBatch() dispatches once per batch to
+* the batch kernel of the concrete class. visit() passes the concrete pattern to a caller's generic lambda.
+*
+* Only patterns whose dynamic type is exactly one of the listed classes are resolved; derived classes defined
+* elsewhere and lazily loaded patterns are held as AntennaPattern and use their virtual methods. Results are identical
+* to calling the pattern's methods. Like the pattern, a handle may be queried from multiple threads concurrently.
+*/
+class SDKCORE_EXPORT AntennaPatternHandle
+{
+public:
+  /// Pointer to the concrete pattern; AntennaPattern for patterns of other or unknown classes
+  typedef std::variant<const AntennaPattern*,
+    const AntennaPatternGauss*,
+    const AntennaPatternCscSq*,
+    const AntennaPatternSinXX*,
+    const AntennaPatternPedestal*,
+    const AntennaPatternOmni*,
+    const AntennaPatternTable*,
+    const AntennaPatternRelativeTable*,
+    const AntennaPatternCRUISE*,
+    const AntennaPatternMonopulse*,
+    const AntennaPatternBiLinear*,
+    const AntennaPatternNSMA*,
+    const AntennaPatternEZNEC*,
+    const AntennaPatternXFDTD*> ConcretePattern;
+
+  /** Constructs an empty handle */
+  AntennaPatternHandle();
+
+  /**
+  * Constructs a handle sharing the pattern
+  * @param[in ] pattern Pattern to hold, may be nullptr for an empty handle
+  */
+  explicit AntennaPatternHandle(const std::shared_ptr<const AntennaPattern>& pattern);
+
+  /**
+  * Returns whether the handle holds no pattern
+  * @return true if empty
+  */
+  bool empty() const { return !pattern_; }
+
+  /**
+  * Returns the shared pattern
+  * @return pattern, nullptr if empty
+  */
+  const std::shared_ptr<const AntennaPattern>& pattern() const { return pattern_; }
+
+  /**
+  * Returns the pattern as a pointer to its concrete class
+  * @return concrete pattern
+  */
+  const ConcretePattern& concrete() const { return concrete_; }
+
+  /**
+  * Calls visitor with the pattern as a reference to its concrete class, e.g. const AntennaPatternGauss&, or const
+  * AntennaPattern& for other classes
+  * @param[in ] visitor Callable accepting a reference to each concrete class, typically a generic lambda
+  * @return value returned by visitor
+  * @pre handle not empty
+  */
+  template <typename Visitor>
+  decltype(auto) visit(Visitor&& visitor) const
+  {
+    assert(!empty());
+    return std::visit([&visitor](auto pattern) -> decltype(auto) { return visitor(*pattern); }, concrete_);
+  }
+
+  /**
+  * Computes the antenna pattern gain, see AntennaPattern::gain()
+  * @param[in ] params Collection of antenna parameters used to compute the requested gain value
+  * @return antenna pattern gain (dB), SMALL_DB_VAL if empty
+  */
+  float gain(const AntennaGainParameters &params) const
+  {
+    if (empty())
+      return SMALL_DB_VAL;
+    return visit([&params](const auto& pattern) { return gain_(pattern, params); });
+  }
+
+  /**
+  * Computes the antenna pattern gain for a batch of directions, see AntennaPattern::gainBatch()
+  * @param[in ] params Collection of antenna parameters shared by all directions; azim_ and elev_ are ignored
+  * @param[in ] azim Array of count relative azimuth angles, referenced to host antenna (rad)
+  * @param[in ] elev Array of count relative elevation angles, referenced to host antenna (rad)
+  * @param[in ] count Number of directions to compute
+  * @param[out] gains Array of count antenna pattern gains (dB); SMALL_DB_VAL if empty
+  * @pre azim, elev and gains valid params when count is non-zero
+  */
+  void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /**
+  * Returns the minimum and maximum gains of the pattern, see AntennaPattern::minMaxGain()
+  * @param[out] min Minimum gain value to retrieve (dB)
+  * @param[out] max Maximum gain value to retrieve (dB)
+  * @param[in ] params Collection of antenna parameters used to compute the requested gain bounds
+  * @pre min and max valid params, handle not empty
+  */
+  void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+private:
+  /** Gain of a Gaussian pattern, inline */
+  static float gain_(const AntennaPatternGauss&, const AntennaGainParameters &params)
+  {
+    return AntennaKernels::gaussGain(params.elev_, AntennaKernels::gaussAntennaFactor(params.vbw_), params.refGain_);
+  }
+
+  /** Gain of a cosecant squared pattern, inline */
+  static float gain_(const AntennaPatternCscSq&, const AntennaGainParameters &params)
+  {
+    return AntennaKernels::cscSqGain(params.elev_, params.vbw_, params.refGain_);
+  }
+
+  /** Gain of a sin(x)/x pattern, inline */
+  static float gain_(const AntennaPatternSinXX&, const AntennaGainParameters &params)
+  {
+    if (params.hbw_ == 0.f || params.vbw_ == 0.f)
+      return params.refGain_;
+    return AntennaKernels::sinXXGain(params.azim_, params.elev_, params.hbw_, params.vbw_, params.refGain_, params.firstLobe_);
+  }
+
+  /** Gain of a pedestal pattern, inline */
+  static float gain_(const AntennaPatternPedestal&, const AntennaGainParameters &params)
+  {
+    if (params.hbw_ == 0.f || params.vbw_ == 0.f)
+      return params.refGain_;
+    return AntennaKernels::pedestalGain(params.azim_, params.elev_, params.hbw_, params.vbw_, params.refGain_);
+  }
+
+  /** Gain of an omni directional pattern, inline */
+  static float gain_(const AntennaPatternOmni&, const AntennaGainParameters &params)
+  {
+    return params.refGain_;
+  }
+
+  /** Gain of a pattern of another or unknown class, through the vtable */
+  static float gain_(const AntennaPattern& pattern, const AntennaGainParameters &params)
+  {
+    return pattern.gain(params);
+  }
+
+  /** Gain of a file pattern, through a direct call to its class */
+  template <typename T>
+  static float gain_(const T& pattern, const AntennaGainParameters &params)
+  {
+    return pattern.T::gain(params);
+  }
+
+  std::shared_ptr<const AntennaPattern> pattern_;  ///< Shared pattern
+  ConcretePattern concrete_;                       ///< pattern_ typed as its concrete class
+};
+
+/**
+* Loads a pattern file like loadPatternFile(), returning a handle that owns the pattern
+* @param[in ] filename Name of the file to load (extension matters), or an algorithm keyword
+* @param[in ] freqMHz Frequency value to pass to loader, in MHz
+* @param[in ] lazy If true, defer parsing text pattern files until first use, see AntennaPatternLazy
+* @return handle of the loaded pattern, empty if the pattern could not be loaded
+*/
+SDKCORE_EXPORT AntennaPatternHandle loadPatternHandle(const std::string& filename, float freqMHz, bool lazy = false);
+
+}
+
+#endif /* SIMCORE_EM_ANTENNA_PATTERN_HANDLE_H */
@@ -0,0 +1,189 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_EM_ANTENNA_PATTERN_KERNELS_H
+#define SIMCORE_EM_ANTENNA_PATTERN_KERNELS_H
+
+#include <cassert>
+#include <cmath>
+#include "simCore/Common/Common.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Math.h"
+
+namespace simCore
+{
+
+/**
+* Gain formulas of the algorithmic antenna patterns. They are inline so that AntennaPatternHandle can evaluate the
+* algorithmic patterns without a virtual call, in the caller's loop; the pattern classes use the same functions, so
+* both paths give identical gains.
+*/
+namespace AntennaKernels
+{
+
+/**
+* Computes the Gaussian pattern exponent factor for the given vertical beam width
+* @param[in ] vbw Vertical beam width (rad)
+* @return factor applied to sin^2(elev) in the Gaussian exponent
+*/
+inline double gaussAntennaFactor(float vbw)
+{
+  const double var = sin(0.5*vbw); // Avoid divide by zero below
+  return -0.5 * (M_LN2 / square(var == 0.0 ? 1.0 : var));
+}
+
+/**
+* Computes the Gaussian pattern gain for a single elevation
+* @param[in ] elev Relative elevation angle (rad)
+* @param[in ] antfac Factor returned by gaussAntennaFactor()
+* @param[in ] refGain Reference gain of pattern (dB)
+* @return antenna pattern gain (dB)
+*/
+inline float gaussGain(float elev, double antfac, float refGain)
+{
+  const double patfac = exp(antfac * square(sin(angFixPI(elev))));
+  // Ereps clips below 0.03
+  return static_cast<float>(refGain + 20. * log10((patfac < 0.03) ? 0.03 : patfac));
+}
+
+/**
+* Computes the cosecant squared pattern gain for a single elevation
+* @param[in ] elev Relative elevation angle (rad)
+* @param[in ] vbw Vertical beam width (rad), should be non-zero
+* @param[in ] refGain Reference gain of pattern (dB)
+* @return antenna pattern gain (dB)
+*/
+inline float cscSqGain(float elev, float vbw, float refGain)
+{
+  double delev = angFixPI(elev);
+  double elevFactor;
+  if (delev <= vbw)
+  {
+    double onePlus = 1.0 + delev;
+    if (vbw != 0.f)
+      onePlus = 1.0 + delev/vbw; // protect against divide by zero with vbw
+    else
+      assert(0); //vbw should not be zero, would result in a divide by zero
+    elevFactor = sdkMin(1.0, sdkMax(0.03, onePlus));
+  }
+  else
+  {
+    double denom = sin(fabs(delev));
+    if (denom == 0.0)
+      denom = 1.0; // protect against divide by zero below
+    elevFactor = sin(vbw / denom);
+  }
+
+  if (elevFactor == 0.0)
+    elevFactor = 0.03; // Set to minimum possible result from if block above to avoid log10(0) below
+  return static_cast<float>(refGain + 20. * log10(elevFactor));
+}
+
+/**
+* Computes the sin(x)/x pattern gain for a single direction
+* @param[in ] azim Relative azimuth angle (rad)
+* @param[in ] elev Relative elevation angle (rad)
+* @param[in ] hbw Horizontal beam width (rad), must be non-zero
+* @param[in ] vbw Vertical beam width (rad), must be non-zero
+* @param[in ] refGain Reference gain of pattern (dB)
+* @param[in ] firstLobe Value of first side lobe (dB)
+* @return antenna pattern gain (dB)
+*/
+inline float sinXXGain(float azim, float elev, float hbw, float vbw, float refGain, float firstLobe)
+{
+  double delev = angFixPI(elev);
+  double dazim = angFixPI(azim);
+
+  // Compute angular distance in normalized beam widths
+  double phi = sqrt(square(dazim/hbw) + square(delev/vbw));
+
+  // Compute antenna gain
+  if (phi == 0.0)
+    return refGain;
+
+  double gain = square(sin(2.783*phi) / (2.783*phi));
+  gain = refGain + 10.0 * log10(gain);
+
+  // Add sin x/x side lobe gain
+  if (phi > M_2_SQRTPI)
+    gain += firstLobe + 13.2;
+
+  return static_cast<float>(gain);
+}
+
+/**
+* Computes the pedestal pattern gain at an angular distance from boresight
+* @param[in ] phi Angular distance from boresight in normalized beam widths
+* @param[in ] refGain Reference gain of pattern (dB)
+* @return antenna pattern gain (dB)
+*/
+inline float pedestalLobeGain(double phi, float refGain)
+{
+  double gain = 0.;
+
+  // Determine lobe and compute antenna gain
+  if (phi < 1.29)
+  {
+    gain = refGain - 12.0 * square(phi);
+  }
+  else if (phi < 4.00)
+  {
+    gain = refGain - 20.0;
+  }
+  else if (phi < 5.00)
+  {
+    gain = 5.0 * refGain - phi * (refGain - 10.0) - 60.0;
+  }
+  else
+  {
+    gain = -10.0;
+  }
+
+  if (gain < -10.0)
+    gain = -10.0;
+
+  return static_cast<float>(gain);
+}
+
+/**
+* Computes the pedestal pattern gain for a single direction
+* @param[in ] azim Relative azimuth angle (rad)
+* @param[in ] elev Relative elevation angle (rad)
+* @param[in ] hbw Horizontal beam width (rad), must be non-zero
+* @param[in ] vbw Vertical beam width (rad), must be non-zero
+* @param[in ] refGain Reference gain of pattern (dB)
+* @return antenna pattern gain (dB)
+*/
+inline float pedestalGain(float azim, float elev, float hbw, float vbw, float refGain)
+{
+  double delev = angFixPI(elev);
+  double dazim = angFixPI(azim);
+
+  // Compute angular distance in normalized beam widths
+  return pedestalLobeGain(sqrt(square(dazim/hbw) + square(delev/vbw)), refGain);
+}
+
+}
+
+}
+
+#endif /* SIMCORE_EM_ANTENNA_PATTERN_KERNELS_H */
@@ -0,0 +1,105 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_EM_ANTENNA_PATTERN_PATH_H
+#define SIMCORE_EM_ANTENNA_PATTERN_PATH_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include "simCore/EM/Constants.h"
+
+namespace simCore
+{
+
+/**
+* Conversions between UTF-8 file names and std::filesystem paths, and the file key helpers, shared by the registry, the
+* shared store and watched patterns. std::filesystem::u8path() is deprecated in C++20, where path::u8string() returns std::u8string instead of
+* std::string; these functions compile the same under C++17 and C++20.
+*/
+namespace AntennaPaths
+{
+
+/**
+* Returns the path for a UTF-8 file name
+* @param[in ] filename File name, UTF-8
+* @return path of the file
+*/
+inline std::filesystem::path fromUtf8(const std::string& filename)
+{
+#if defined(__cpp_lib_char8_t)
+  return std::filesystem::path(std::u8string(filename.begin(), filename.end()));
+#else
+  return std::filesystem::u8path(filename);
+#endif
+}
+
+/**
+* Returns the UTF-8 file name of a path
+* @param[in ] path Path of the file
+* @return file name, UTF-8
+*/
+inline std::string toUtf8(const std::filesystem::path& path)
+{
+#if defined(__cpp_lib_char8_t)
+  const std::u8string name = path.u8string();
+  return std::string(name.begin(), name.end());
+#else
+  return path.u8string();
+#endif
+}
+
+/**
+* Returns the canonical path of a file, falling back to the absolute path if the file does not exist
+* @param[in ] filename File name, UTF-8
+* @param[out] modified Modification time of the file, in file clock ticks; 0 if unavailable
+* @return canonical path of the file, UTF-8
+*/
+inline std::string canonicalPath(const std::string& filename, int64_t& modified)
+{
+  std::error_code ec;
+  const std::filesystem::path path = fromUtf8(filename);
+  std::filesystem::path canonical = std::filesystem::canonical(path, ec);
+  if (ec)
+    canonical = std::filesystem::absolute(path, ec).lexically_normal();
+  const std::filesystem::file_time_type time = std::filesystem::last_write_time(canonical, ec);
+  modified = (ec) ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+  return toUtf8(canonical);
+}
+
+/**
+* Returns true for formats whose loaded content depends on the requested frequency, so that patterns loaded from the
+* same file at different frequencies are kept apart
+* @param[in ] type Type of the pattern file
+* @return true if the loaded pattern depends on the frequency
+*/
+inline bool frequencyDependent(AntennaPatternType type)
+{
+  return type == ANTENNA_PATTERN_BILINEAR || type == ANTENNA_PATTERN_MONOPULSE;
+}
+
+}
+
+}
+
+#endif /* SIMCORE_EM_ANTENNA_PATTERN_PATH_H */
@@ -0,0 +1,194 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include "simNotify/Notify.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/EM/AntennaPattern.h"
+#include "simCore/EM/AntennaPatternRaster.h"
+
+namespace simCore {
+
+namespace
+{
+  /**
+  * Returns the sample values of one raster axis, spaced evenly from min to max
+  * @param[in ] minValue First sample
+  * @param[in ] maxValue Last sample
+  * @param[in ] count Number of samples
+  * @return sample values
+  */
+  std::vector<double> axisSamples(double minValue, double maxValue, size_t count)
+  {
+    std::vector<double> samples(count, minValue);
+    if (count > 1)
+    {
+      const double step = (maxValue - minValue) / static_cast<double>(count - 1);
+      for (size_t i = 1; i < count; ++i)
+        samples[i] = minValue + step * static_cast<double>(i);
+    }
+    return samples;
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+AntennaRasterSpec::AntennaRasterSpec()
+  : projection_(ANTENNA_RASTER_AZEL),
+    minX_(-M_PI),
+    maxX_(M_PI),
+    numX_(361),
+    minY_(-M_PI_2),
+    maxY_(M_PI_2),
+    numY_(181),
+    outsideGain_(SMALL_DB_VAL),
+    numThreads_(0),
+    approx_(false)
+{
+}
+
+size_t rasterSize(const AntennaRasterSpec& spec)
+{
+  const size_t numFreqs = std::max<size_t>(1, spec.frequencies_.size());
+  const size_t numPols = std::max<size_t>(1, spec.polarities_.size());
+  return spec.numX_ * spec.numY_ * numPols * numFreqs;
+}
+
+int rasterizePattern(const AntennaPattern& pattern, const AntennaGainParameters& params, const AntennaRasterSpec& spec, float* gains, size_t size)
+{
+  const size_t layerSize = spec.numX_ * spec.numY_;
+  if (layerSize == 0)
+  {
+    SIM_ERROR << "Antenna pattern raster has no samples" << std::endl;
+    return 1;
+  }
+  if (gains == nullptr || size < rasterSize(spec))
+  {
+    SIM_ERROR << "Antenna pattern raster buffer holds " << size << " gains, " << rasterSize(spec) << " needed" << std::endl;
+    return 1;
+  }
+
+  const std::vector<double> frequencies = spec.frequencies_.empty() ? std::vector<double>(1, params.freq_) : spec.frequencies_;
+  const std::vector<PolarityType> polarities = spec.polarities_.empty() ? std::vector<PolarityType>(1, params.polarity_) : spec.polarities_;
+  const size_t numPols = polarities.size();
+
+  // frequency dependent work is done once per frequency and shared by all threads
+  std::vector<std::unique_ptr<AntennaPatternEvaluator> > evaluators;
+  if (numPols == 1 && !spec.approx_)
+  {
+    for (std::vector<double>::const_iterator iter = frequencies.begin(); iter != frequencies.end(); ++iter)
+      evaluators.push_back(pattern.bindFrequency(*iter));
+  }
+
+  const std::vector<double> xs = axisSamples(spec.minX_, spec.maxX_, spec.numX_);
+  const std::vector<double> ys = axisSamples(spec.minY_, spec.maxY_, spec.numY_);
+
+  // each row of each frequency is one tile; workers take the next unclaimed tile
+  const size_t numTiles = spec.numY_ * frequencies.size();
+  unsigned int numThreads = (spec.numThreads_ == 0) ? std::thread::hardware_concurrency() : spec.numThreads_;
+  numThreads = static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(numThreads, numTiles)));
+
+  std::atomic<size_t> next(0);
+  auto worker = [&]()
+  {
+    std::vector<float> azim(spec.numX_);
+    std::vector<float> elev(spec.numX_);
+    std::vector<unsigned char> inside(spec.numX_, 1);
+    std::vector<float> polGains(numPols);
+    AntennaGainParameters rowParams(params);
+
+    for (size_t tile = next++; tile < numTiles; tile = next++)
+    {
+      const size_t findex = tile / spec.numY_;
+      const size_t y = tile % spec.numY_;
+      rowParams.freq_ = frequencies[findex];
+
+      // directions of the row
+      if (spec.projection_ == ANTENNA_RASTER_UV)
+      {
+        const double v = ys[y];
+        for (size_t x = 0; x < spec.numX_; ++x)
+        {
+          const double u = xs[x];
+          const double w2 = 1.0 - u * u - v * v;
+          inside[x] = (w2 >= 0.0) ? 1 : 0;
+          azim[x] = inside[x] ? static_cast<float>(atan2(u, sqrt(w2))) : 0.f;
+          elev[x] = inside[x] ? static_cast<float>(asin(v)) : 0.f;
+        }
+      }
+      else
+      {
+        std::fill(elev.begin(), elev.end(), static_cast<float>(ys[y]));
+        for (size_t x = 0; x < spec.numX_; ++x)
+          azim[x] = static_cast<float>(xs[x]);
+      }
+
+      float* layer = gains + (findex * numPols * spec.numY_ + y) * spec.numX_;
+      if (numPols == 1)
+      {
+        rowParams.polarity_ = polarities[0];
+        if (spec.approx_)
+          pattern.gainBatchApprox(rowParams, &azim[0], &elev[0], spec.numX_, layer);
+        else
+          evaluators[findex]->gainBatch(rowParams, &azim[0], &elev[0], spec.numX_, layer);
+      }
+      else
+      {
+        // locate each direction once for all polarities, then scatter into the polarity layers
+        for (size_t x = 0; x < spec.numX_; ++x)
+        {
+          rowParams.azim_ = azim[x];
+          rowParams.elev_ = elev[x];
+          pattern.polarityGains(rowParams, &polarities[0], numPols, &polGains[0]);
+          for (size_t p = 0; p < numPols; ++p)
+            layer[p * layerSize + x] = polGains[p];
+        }
+      }
+
+      if (spec.projection_ == ANTENNA_RASTER_UV)
+      {
+        for (size_t p = 0; p < numPols; ++p)
+        {
+          for (size_t x = 0; x < spec.numX_; ++x)
+          {
+            if (!inside[x])
+              layer[p * layerSize + x] = spec.outsideGain_;
+          }
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < numThreads; ++i)
+    threads.push_back(std::thread(worker));
+  worker();
+  for (std::vector<std::thread>::iterator iter = threads.begin(); iter != threads.end(); ++iter)
+    iter->join();
+  return 0;
+}
+
+}
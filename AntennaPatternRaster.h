@@ -0,0 +1,97 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_EM_ANTENNA_PATTERN_RASTER_H
+#define SIMCORE_EM_ANTENNA_PATTERN_RASTER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "simCore/Common/Common.h"
+#include "simCore/EM/Constants.h"
+
+namespace simCore
+{
+class AntennaPattern;
+class AntennaGainParameters;
+
+/** Coordinates of the sample grid of an antenna pattern raster */
+enum AntennaRasterProjection
+{
+  ANTENNA_RASTER_AZEL = 0,  ///< x is relative azimuth, y is relative elevation (rad)
+  /**
+  * x is u = cos(el) sin(az) and y is v = sin(el), the direction cosines across and above the boresight; only the
+  * forward hemisphere is covered, and samples outside the unit circle are set to AntennaRasterSpec::outsideGain_
+  */
+  ANTENNA_RASTER_UV
+};
+
+/**
+* @brief Layout and sweeps of an antenna pattern raster
+*
+* The grid has numX_ by numY_ samples spaced evenly from min to max on each axis, both ends included. A raster holds
+* one layer per frequency and polarity; gains are stored x fastest, then y, then polarity, then frequency:
+* gains[((f * numPolarities + p) * numY_ + y) * numX_ + x].
+*/
+struct SDKCORE_EXPORT AntennaRasterSpec
+{
+  AntennaRasterSpec();
+
+  AntennaRasterProjection projection_; ///< Coordinates of the grid
+  double minX_;       ///< First x sample: azimuth (rad) or u
+  double maxX_;       ///< Last x sample: azimuth (rad) or u
+  size_t numX_;       ///< Number of x samples
+  double minY_;       ///< First y sample: elevation (rad) or v
+  double maxY_;       ///< Last y sample: elevation (rad) or v
+  size_t numY_;       ///< Number of y samples
+  std::vector<double> frequencies_;       ///< Frequencies to sweep (Hz); empty uses the freq_ of the parameters
+  std::vector<PolarityType> polarities_;  ///< Polarities to sweep; empty uses the polarity_ of the parameters
+  float outsideGain_;       ///< Gain stored for u/v samples outside the unit circle (dB)
+  unsigned int numThreads_; ///< Maximum number of worker threads; 0 uses the hardware concurrency
+  bool approx_;  ///< Evaluate with AntennaPattern::gainBatchApprox() instead of the exact batch path
+};
+
+/**
+* Returns the number of gains in a raster
+* @param[in ] spec Raster layout
+* @return number of floats the gains buffer of rasterizePattern() must hold
+*/
+SDKCORE_EXPORT size_t rasterSize(const AntennaRasterSpec& spec);
+
+/**
+* Evaluates an antenna pattern over a grid of directions for each requested frequency and polarity. Rows of the grid
+* are spread over worker threads, and each row is computed with the batch path of the pattern: gainBatch() of an
+* evaluator bound to the frequency for a single polarity, or polarityGains() per direction when sweeping polarities.
+* Unless approx_ is set, every gain equals gain() of the pattern at the same (single precision) angles.
+* @param[in ] pattern Pattern to evaluate; must not be reloaded while rasterizing
+* @param[in ] params Antenna parameters shared by all samples; azim_ and elev_ are ignored, as are freq_ and
+*   polarity_ when the spec sweeps them
+* @param[in ] spec Raster layout
+* @param[out] gains Buffer receiving the gains (dB), laid out as described by AntennaRasterSpec
+* @param[in ] size Number of floats in gains
+* @return 0 on success, non-zero if the spec is empty or the buffer is smaller than rasterSize()
+*/
+SDKCORE_EXPORT int rasterizePattern(const AntennaPattern& pattern, const AntennaGainParameters& params, const AntennaRasterSpec& spec, float* gains, size_t size);
+
+}
+
+#endif /* SIMCORE_EM_ANTENNA_PATTERN_RASTER_H */
@@ -0,0 +1,309 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <filesystem>
+#include <system_error>
+#include <thread>
+#include "simNotify/Notify.h"
+#include "simCore/String/Format.h"
+#include "simCore/EM/Constants.h"
+#include "simCore/EM/AntennaPattern.h"
+#include "simCore/EM/AntennaPatternPath.h"
+#include "simCore/EM/AntennaPatternRegistry.h"
+
+namespace simCore {
+
+std::shared_ptr<const AntennaPattern> algorithmPattern(const std::string& keyword)
+{
+  // function statics are initialized once, thread safe
+  static const std::shared_ptr<const AntennaPattern> sinXX(new AntennaPatternSinXX);
+  static const std::shared_ptr<const AntennaPattern> pedestal(new AntennaPatternPedestal);
+  static const std::shared_ptr<const AntennaPattern> gauss(new AntennaPatternGauss);
+  static const std::shared_ptr<const AntennaPattern> omni(new AntennaPatternOmni);
+  static const std::shared_ptr<const AntennaPattern> cscSq(new AntennaPatternCscSq);
+
+  // algorithm keywords are all uppercase
+  const std::string algorithm = upperCase(keyword);
+  if (algorithm == ANTENNA_STRING_ALGORITHM_SINXX)
+    return sinXX;
+  if (algorithm == ANTENNA_STRING_ALGORITHM_PEDESTAL)
+    return pedestal;
+  if (algorithm == ANTENNA_STRING_ALGORITHM_GAUSS)
+    return gauss;
+  if (algorithm == ANTENNA_STRING_ALGORITHM_OMNI)
+    return omni;
+  if (algorithm == ANTENNA_STRING_ALGORITHM_CSCSQ)
+    return cscSq;
+  return std::shared_ptr<const AntennaPattern>();
+}
+
+// ----------------------------------------------------------------------------
+
+AntennaPatternLoadResult::AntennaPatternLoadResult()
+  : status_(ANTENNA_LOAD_NO_NAME),
+    shared_(false)
+{
+}
+
+// ----------------------------------------------------------------------------
+
+AntennaPatternRegistry::AntennaPatternRegistry()
+  : maxLoads_(DEFAULT_MAX_CONCURRENT_LOADS),
+    activeLoads_(0),
+    loads_(0),
+    lazy_(false)
+{
+}
+
+AntennaPatternRegistry::~AntennaPatternRegistry()
+{
+}
+
+AntennaPatternRegistry& AntennaPatternRegistry::instance()
+{
+  static AntennaPatternRegistry registry;
+  return registry;
+}
+
+std::shared_ptr<const AntennaPattern> AntennaPatternRegistry::pattern(const std::string& filename, float freqMHz)
+{
+  AntennaPatternLoadResult result;
+  pattern_(filename, freqMHz, result);
+  return result.pattern_;
+}
+
+void AntennaPatternRegistry::pattern_(const std::string& filename, float freqMHz, AntennaPatternLoadResult& result)
+{
+  result = AntennaPatternLoadResult();
+  if (filename.empty())
+    return;
+
+  result.pattern_ = algorithmPattern(filename);
+  if (result.pattern_)
+  {
+    result.status_ = ANTENNA_LOAD_OK;
+    result.shared_ = true;
+    return;
+  }
+
+  int64_t modified = 0;
+  const std::string path = AntennaPaths::canonicalPath(filename, modified);
+  const float keyFreqMHz = AntennaPaths::frequencyDependent(antennaPatternType(filename)) ? freqMHz : 0.f;
+
+  std::promise<std::shared_ptr<const AntennaPattern> > promise;
+  std::shared_future<std::shared_ptr<const AntennaPattern> > future;
+  bool load = false;
+  bool lazy = false;
+  uint64_t loadId = 0;
+  Key key;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lazy = lazy_;
+    key = Key(path, keyFreqMHz, lazy);
+    Entry& entry = entries_[key];
+    if (!entry.pattern_.valid() || entry.modified_ != modified)
+    {
+      // first request, or the file changed since it was loaded; this thread loads it
+      entry.modified_ = modified;
+      entry.load_ = loadId = ++loads_;
+      entry.pattern_ = promise.get_future().share();
+      load = true;
+    }
+    future = entry.pattern_;
+  }
+
+  // parse outside the lock so distinct files load concurrently; other requests for this key wait on the future
+  if (load)
+  {
+    const std::shared_ptr<const AntennaPattern> loaded = loadFile_(filename, freqMHz, lazy);
+    if (!loaded)
+    {
+      // drop the failed entry so that the next request tries again, unless a newer load already replaced it
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::map<Key, Entry>::iterator iter = entries_.find(key);
+      if (iter != entries_.end() && iter->second.load_ == loadId)
+        entries_.erase(iter);
+    }
+    promise.set_value(loaded);
+  }
+  result.pattern_ = future.get();
+  result.shared_ = !load;
+  if (result.pattern_)
+  {
+    result.status_ = ANTENNA_LOAD_OK;
+    return;
+  }
+  std::error_code ec;
+  result.status_ = std::filesystem::exists(AntennaPaths::fromUtf8(path), ec) ? ANTENNA_LOAD_FAILED : ANTENNA_LOAD_NOT_FOUND;
+}
+
+std::shared_ptr<const AntennaPattern> AntennaPatternRegistry::loadFile_(const std::string& filename, float freqMHz, bool lazy)
+{
+  const LoadSlot slot(*this);
+  try
+  {
+    return std::shared_ptr<const AntennaPattern>(loadPatternFile(filename, freqMHz, lazy));
+  }
+  catch (const std::exception& e)
+  {
+    SIM_ERROR << "Unable to load antenna pattern file: " << filename << ": " << e.what() << std::endl;
+  }
+  catch (...)
+  {
+    SIM_ERROR << "Unable to load antenna pattern file: " << filename << std::endl;
+  }
+  return std::shared_ptr<const AntennaPattern>();
+}
+
+AntennaPatternRegistry::LoadSlot::LoadSlot(AntennaPatternRegistry& registry)
+  : registry_(registry)
+{
+  std::unique_lock<std::mutex> lock(registry_.mutex_);
+  while (registry_.maxLoads_ != 0 && registry_.activeLoads_ >= registry_.maxLoads_)
+    registry_.loadFinished_.wait(lock);
+  ++registry_.activeLoads_;
+}
+
+AntennaPatternRegistry::LoadSlot::~LoadSlot()
+{
+  {
+    std::lock_guard<std::mutex> lock(registry_.mutex_);
+    assert(registry_.activeLoads_ > 0);
+    --registry_.activeLoads_;
+  }
+  registry_.loadFinished_.notify_one();
+}
+
+void AntennaPatternRegistry::setMaxConcurrentLoads(unsigned int maxLoads)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxLoads_ = maxLoads;
+  }
+  // a higher limit may admit several waiting loads
+  loadFinished_.notify_all();
+}
+
+unsigned int AntennaPatternRegistry::maxConcurrentLoads() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return maxLoads_;
+}
+
+void AntennaPatternRegistry::setLazyLoading(bool lazy)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  lazy_ = lazy;
+}
+
+bool AntennaPatternRegistry::lazyLoading() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return lazy_;
+}
+
+std::vector<std::shared_ptr<const AntennaPattern> > AntennaPatternRegistry::patterns(const std::vector<std::pair<std::string, float> >& requests, unsigned int numThreads)
+{
+  std::vector<AntennaPatternLoadResult> results;
+  load(requests, results, numThreads);
+  std::vector<std::shared_ptr<const AntennaPattern> > patterns(results.size());
+  for (size_t i = 0; i < results.size(); ++i)
+    patterns[i] = results[i].pattern_;
+  return patterns;
+}
+
+size_t AntennaPatternRegistry::load(const std::vector<std::pair<std::string, float> >& requests, std::vector<AntennaPatternLoadResult>& results, unsigned int numThreads)
+{
+  results.assign(requests.size(), AntennaPatternLoadResult());
+  if (requests.empty())
+    return 0;
+
+  if (numThreads == 0)
+    numThreads = std::thread::hardware_concurrency();
+  numThreads = static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(numThreads, requests.size())));
+
+  // each worker takes the next unclaimed request; duplicates wait on the first load through pattern()
+  std::atomic<size_t> next(0);
+  auto worker = [&]()
+  {
+    for (size_t i = next++; i < requests.size(); i = next++)
+      pattern_(requests[i].first, requests[i].second, results[i]);
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads - 1);
+  {
+    // joins the started workers however this block exits; destroying a joinable thread terminates the process
+    struct JoinThreads
+    {
+      std::vector<std::thread>& threads_;
+      ~JoinThreads()
+      {
+        for (std::vector<std::thread>::iterator iter = threads_.begin(); iter != threads_.end(); ++iter)
+          iter->join();
+      }
+    } joinThreads = { threads };
+
+    try
+    {
+      for (unsigned int i = 1; i < numThreads; ++i)
+        threads.push_back(std::thread(worker));
+    }
+    catch (const std::system_error&)
+    {
+      // no more threads available; the started workers and this thread share the remaining requests
+    }
+    worker();
+  }
+
+  size_t failures = 0;
+  for (std::vector<AntennaPatternLoadResult>::const_iterator iter = results.begin(); iter != results.end(); ++iter)
+  {
+    if (iter->status_ != ANTENNA_LOAD_OK)
+      ++failures;
+  }
+  return failures;
+}
+
+size_t AntennaPatternRegistry::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void AntennaPatternRegistry::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+}
+
+// ----------------------------------------------------------------------------
+
+size_t loadPatternFiles(const std::vector<std::pair<std::string, float> >& requests, std::vector<AntennaPatternLoadResult>& results, unsigned int numThreads)
+{
+  return AntennaPatternRegistry::instance().load(requests, results, numThreads);
+}
+
+}
@@ -0,0 +1,237 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_EM_ANTENNA_PATTERN_REGISTRY_H
+#define SIMCORE_EM_ANTENNA_PATTERN_REGISTRY_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "simCore/Common/Common.h"
+
+namespace simCore
+{
+class AntennaPattern;
+
+/** Outcome of loading one pattern file through the registry */
+enum AntennaPatternLoadStatus
+{
+  ANTENNA_LOAD_OK = 0,    ///< Pattern loaded, or found in the registry
+  ANTENNA_LOAD_NO_NAME,   ///< Request has an empty file name
+  ANTENNA_LOAD_NOT_FOUND, ///< File does not exist
+  ANTENNA_LOAD_FAILED     ///< File exists but is of an unknown type or could not be parsed
+};
+
+/** Pattern and status returned for each request of AntennaPatternRegistry::load() */
+struct SDKCORE_EXPORT AntennaPatternLoadResult
+{
+  AntennaPatternLoadResult();
+
+  std::shared_ptr<const AntennaPattern> pattern_; ///< Loaded pattern, nullptr unless status_ is ANTENNA_LOAD_OK
+  AntennaPatternLoadStatus status_;               ///< Outcome of the request
+  bool shared_;  ///< True if the pattern came from the registry, or another request loaded it, instead of this request
+};
+
+/**
+* Returns the shared instance of an algorithmic antenna pattern. Algorithm patterns hold no per-file data, so a single
+* instance of each serves every caller.
+* @param[in ] keyword Algorithm keyword, e.g. GAUSS or SINXX; case insensitive
+* @return shared pattern, or nullptr if keyword is not an algorithm keyword
+*/
+SDKCORE_EXPORT std::shared_ptr<const AntennaPattern> algorithmPattern(const std::string& keyword);
+
+/**
+* @brief Cache of loaded antenna patterns shared between their users
+*
+* Patterns are keyed on the canonical path of the file, the requested frequency for formats whose content depends on
+* it (bilinear and monopulse), whether parsing is deferred (see setLazyLoading()), and the modification time of the
+* file. The frequency is compared exactly, as passed to pattern(): requests for 1000 and 1000.0001 MHz load two copies
+* of a bilinear or monopulse file, so callers should pass the same value for the same frequency. Repeated requests
+* return the already loaded instance; a request for a file that changed on disk reloads it, while holders of the
+* previous instance keep it alive until they release it. Requests from different threads for the same file wait for a
+* single load, and requests for distinct files load concurrently. Failed loads are not kept, so the next request for
+* the file tries again, e.g. once a file that was still being written is complete. Algorithm keywords resolve to
+* algorithmPattern().
+*/
+class SDKCORE_EXPORT AntennaPatternRegistry
+{
+public:
+  AntennaPatternRegistry();
+  virtual ~AntennaPatternRegistry();
+
+  /**
+  * Returns the pattern for the given file or algorithm keyword, loading it with loadPatternFile() if needed
+  * @param[in ] filename Name of the file to load (extension matters), or an algorithm keyword
+  * @param[in ] freqMHz Frequency value to pass to loader, in MHz; part of the key of bilinear and monopulse files,
+  *   compared exactly
+  * @return shared pattern, or nullptr if the pattern could not be loaded
+  */
+  std::shared_ptr<const AntennaPattern> pattern(const std::string& filename, float freqMHz);
+
+  /**
+  * Loads the requested patterns, spreading distinct files over worker threads
+  * @param[in ] requests File name and frequency (MHz) pairs, as passed to pattern()
+  * @param[in ] numThreads Maximum number of loader threads; 0 uses the hardware concurrency
+  * @return patterns in the order requested; entries are nullptr for patterns that failed to load
+  */
+  std::vector<std::shared_ptr<const AntennaPattern> > patterns(const std::vector<std::pair<std::string, float> >& requests, unsigned int numThreads = 0);
+
+  /**
+  * Loads the requested patterns like patterns(), also reporting the outcome of each request. Duplicate requests, and
+  * requests for patterns already in the registry, share a single load.
+  * @param[in ] requests File name and frequency (MHz) pairs, as passed to pattern()
+  * @param[out] results Pattern and status for each request, in the order requested
+  * @param[in ] numThreads Maximum number of loader threads; 0 uses the hardware concurrency
+  * @return number of requests that failed to load
+  */
+  size_t load(const std::vector<std::pair<std::string, float> >& requests, std::vector<AntennaPatternLoadResult>& results, unsigned int numThreads = 0);
+
+  /**
+  * Limits the number of files parsed at the same time across all callers of the registry. Loads beyond the limit wait
+  * for a running load to finish, which keeps many threads from thrashing a slow or network file system.
+  * @param[in ] maxLoads Maximum number of concurrent file loads; 0 removes the limit
+  */
+  void setMaxConcurrentLoads(unsigned int maxLoads);
+
+  /**
+  * Returns the limit on concurrent file loads
+  * @return maximum number of concurrent file loads, 0 if unlimited
+  */
+  unsigned int maxConcurrentLoads() const;
+
+  /**
+  * Sets whether later loads defer parsing pattern files until the patterns are first used, see AntennaPatternLazy.
+  * Deferred files are only checked to be readable, so requests for files that fail to parse still succeed; such
+  * patterns have no gain. Patterns already in the registry are not affected; deferred and immediate loads of the
+  * same file are separate entries, so a request always gets a pattern loaded the way the current setting asks for.
+  * @param[in ] lazy True to defer parsing
+  */
+  void setLazyLoading(bool lazy);
+
+  /**
+  * Returns whether loads defer parsing pattern files until first use
+  * @return true if parsing is deferred
+  */
+  bool lazyLoading() const;
+
+  /**
+  * Returns the number of file patterns currently held, including loads in progress
+  * @return number of registry entries
+  */
+  size_t size() const;
+
+  /** Releases the registry's references to all patterns; patterns in use elsewhere stay alive */
+  void clear();
+
+  /**
+  * Returns a process wide registry
+  * @return shared registry instance
+  */
+  static AntennaPatternRegistry& instance();
+
+  /// Default limit on concurrent file loads
+  static const unsigned int DEFAULT_MAX_CONCURRENT_LOADS = 8;
+
+private:
+  /// Pattern cache key: canonical path, frequency (MHz), 0 for frequency independent formats, and deferred parsing
+  typedef std::tuple<std::string, float, bool> Key;
+
+  /// Loaded, or loading, pattern for a key
+  struct Entry
+  {
+    Entry() : modified_(0), load_(0) {}
+
+    int64_t modified_;  ///< Modification time of the file when it was loaded, in file clock ticks; 0 if unavailable
+    uint64_t load_;     ///< Serial number of the load that filled pattern_, identifies the entry of a failed load
+    std::shared_future<std::shared_ptr<const AntennaPattern> > pattern_; ///< Pattern, ready once loaded
+  };
+
+  /**
+  * Returns the pattern for the given file or algorithm keyword, loading it if needed
+  * @param[in ] filename Name of the file to load, or an algorithm keyword
+  * @param[in ] freqMHz Frequency value to pass to loader, in MHz
+  * @param[out] result Pattern and outcome of the request
+  */
+  void pattern_(const std::string& filename, float freqMHz, AntennaPatternLoadResult& result);
+
+  /**
+  * Parses a file for the given key, under the concurrent load limit
+  * @param[in ] filename Name of the file to load
+  * @param[in ] freqMHz Frequency value to pass to loader, in MHz
+  * @param[in ] lazy Whether to defer parsing until first use
+  * @return loaded pattern, or nullptr if the file could not be loaded
+  */
+  std::shared_ptr<const AntennaPattern> loadFile_(const std::string& filename, float freqMHz, bool lazy);
+
+  /** Takes a load slot under the concurrent load limit for its lifetime */
+  class LoadSlot
+  {
+  public:
+    /** Waits until a load slot of the registry is free, then takes it */
+    explicit LoadSlot(AntennaPatternRegistry& registry);
+    /** Returns the slot and wakes a waiting load */
+    ~LoadSlot();
+
+  private:
+    /** Not implemented */
+    LoadSlot(const LoadSlot&);
+    /** Not implemented */
+    LoadSlot& operator=(const LoadSlot&);
+
+    AntennaPatternRegistry& registry_; ///< Registry whose slot is taken
+  };
+
+  /** Not implemented */
+  AntennaPatternRegistry(const AntennaPatternRegistry&);
+  /** Not implemented */
+  AntennaPatternRegistry& operator=(const AntennaPatternRegistry&);
+
+  mutable std::mutex mutex_;     ///< Protects entries_ and the load counters
+  std::map<Key, Entry> entries_; ///< Patterns by key
+  std::condition_variable loadFinished_; ///< Signaled when a load slot is released
+  unsigned int maxLoads_;    ///< Maximum number of concurrent file loads, 0 if unlimited
+  unsigned int activeLoads_; ///< Number of file loads in progress
+  uint64_t loads_;           ///< Number of file loads started, gives each Entry::load_
+  bool lazy_;                ///< Whether loads defer parsing until first use
+};
+
+/**
+* Loads a list of pattern files on worker threads through AntennaPatternRegistry::instance(), so that repeated files
+* are parsed once and the patterns are shared with later pattern() requests
+* @param[in ] requests File name and frequency (MHz) pairs, as passed to loadPatternFile()
+* @param[out] results Pattern and status for each request, in the order requested
+* @param[in ] numThreads Maximum number of loader threads; 0 uses the hardware concurrency
+* @return number of requests that failed to load
+*/
+SDKCORE_EXPORT size_t loadPatternFiles(const std::vector<std::pair<std::string, float> >& requests, std::vector<AntennaPatternLoadResult>& results, unsigned int numThreads = 0);
+
+}
+
+#endif /* SIMCORE_EM_ANTENNA_PATTERN_REGISTRY_H */
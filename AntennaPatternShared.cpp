@@ -0,0 +1,628 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifdef WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+#include "simNotify/Notify.h"
+#include "simCore/String/Format.h"
+#include "simCore/String/UtfUtils.h"
+#include "simCore/EM/AntennaPattern.h"
+#include "simCore/EM/AntennaPatternCompiled.h"
+#include "simCore/EM/AntennaPatternPath.h"
+#include "simCore/EM/AntennaPatternRegistry.h"
+#include "simCore/EM/AntennaPatternShared.h"
+
+namespace simCore {
+
+namespace
+{
+  /// Identifies a shared pattern segment
+  const char SHARED_MAGIC[8] = { 'S', 'I', 'M', 'A', 'P', 'S', 'H', 'M' };
+
+  /// Version of the segment layout around the compiled image
+  const uint32_t SHARED_VERSION = 1;
+
+  /// Alignment of the compiled image within a segment, at least the compiled section alignment
+  const uint64_t SHARED_ALIGNMENT = 64;
+
+  /// Publication state of a segment; a new, zero filled segment is being built
+  enum SharedSegmentState
+  {
+    SHARED_BUILDING = 0,
+    SHARED_READY = 1
+  };
+
+  /// Header at the start of a shared pattern segment, followed by the key and the compiled image
+  struct SharedSegmentHeader
+  {
+    std::atomic<uint32_t> state_; ///< SharedSegmentState, set to ready with release order once the segment is written
+    uint32_t version_;      ///< SHARED_VERSION
+    char magic_[8];         ///< SHARED_MAGIC
+    int64_t modified_;      ///< Modification time of the source file, in file clock ticks; 0 if unavailable
+    uint64_t keySize_;      ///< Size of the key, which follows the header
+    uint64_t imageOffset_;  ///< Offset of the compiled image from the start of the segment, a multiple of SHARED_ALIGNMENT
+    uint64_t imageSize_;    ///< Size of the compiled image in bytes
+  };
+
+  // readers in other processes only load the state, which must not rely on a process local lock
+  static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared segment state must be lock free");
+
+  /// Suffix of the name of the claim on publishing a segment, appended to the segment name
+  const std::string SHARED_CLAIM_SUFFIX = "_b";
+
+  /// Time a new claim may stay unwritten before it counts as left by a publisher that died, in milliseconds
+  const int64_t SHARED_CLAIM_WRITE_MS = 1000;
+
+  /// Contents of a claim segment, identifying the process that publishes the segment
+  struct SharedClaimHeader
+  {
+    std::atomic<uint32_t> state_; ///< SharedSegmentState, set to ready with release order once the claim is written
+    uint32_t reserved_;     ///< Unused, 0
+    int64_t process_;       ///< Process id of the publisher
+    int64_t claimed_;       ///< Time the claim was taken, in milliseconds since the system clock epoch
+  };
+
+  /// Outcome of looking up the segment of a pattern file
+  enum SharedSegmentStatus
+  {
+    SHARED_SEGMENT_ABSENT = 0, ///< No segment of that name
+    SHARED_SEGMENT_BUILDING,   ///< Segment exists and is not published yet
+    SHARED_SEGMENT_OUTDATED,   ///< Segment holds an older version of the file
+    SHARED_SEGMENT_ATTACHED,   ///< Segment holds the current file; its pattern was read
+    SHARED_SEGMENT_UNUSABLE    ///< Segment is invalid or belongs to another file whose key has the same hash
+  };
+
+  /** Appends the given number of low order hexadecimal digits of value */
+  void appendHex(uint64_t value, int digits, std::string& str)
+  {
+    for (int shift = 4 * (digits - 1); shift >= 0; shift -= 4)
+      str += "0123456789abcdef"[(value >> shift) & 0xf];
+  }
+
+  /**
+  * Returns the identity of a pattern file and frequency, recorded in its segment
+  * @param[in ] filename File name, UTF-8
+  * @param[in ] freqMHz Requested frequency, in MHz
+  * @param[out] modified Modification time of the file, 0 if unavailable
+  * @return canonical path, followed by the bits of the frequency for frequency dependent formats
+  */
+  std::string patternKey(const std::string& filename, float freqMHz, int64_t& modified)
+  {
+    std::string key = AntennaPaths::canonicalPath(filename, modified);
+    if (AntennaPaths::frequencyDependent(antennaPatternType(filename)))
+    {
+      uint32_t bits = 0;
+      memcpy(&bits, &freqMHz, sizeof(bits));
+      key += '\n';
+      appendHex(bits, 8, key);
+    }
+    return key;
+  }
+
+  /** Returns the segment name of a key: the prefix and the 64 bit FNV-1a hash of the key */
+  std::string keySegmentName(const std::string& prefix, const std::string& key)
+  {
+    uint64_t hash = 14695981039346656037ull;
+    for (std::string::const_iterator iter = key.begin(); iter != key.end(); ++iter)
+    {
+      hash ^= static_cast<unsigned char>(*iter);
+      hash *= 1099511628211ull;
+    }
+    std::string name = prefix + "_";
+    appendHex(hash, 16, name);
+    return name;
+  }
+
+  /** Loads a pattern for use by this process only */
+  std::shared_ptr<const AntennaPattern> privatePattern(const std::string& filename, float freqMHz)
+  {
+    return std::shared_ptr<const AntennaPattern>(loadPatternFile(filename, freqMHz));
+  }
+
+  /** Returns the id of this process */
+  int64_t currentProcess()
+  {
+#ifdef WIN32
+    return static_cast<int64_t>(GetCurrentProcessId());
+#else
+    return static_cast<int64_t>(getpid());
+#endif
+  }
+
+  /** Returns false if no process of the given id runs; processes that cannot be queried count as running */
+  bool processRunning(int64_t process)
+  {
+#ifdef WIN32
+    HANDLE handle = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(process));
+    if (!handle)
+      return GetLastError() != ERROR_INVALID_PARAMETER;
+    const bool running = (WaitForSingleObject(handle, 0) == WAIT_TIMEOUT);
+    CloseHandle(handle);
+    return running;
+#else
+    return kill(static_cast<pid_t>(process), 0) == 0 || errno != ESRCH;
+#endif
+  }
+
+  /** Returns the system clock time in milliseconds, comparable between processes */
+  int64_t systemMilliseconds()
+  {
+    return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+  }
+
+  /**
+  * Maps the published segment of a pattern file and reads its pattern
+  * @param[in ] name Segment name
+  * @param[in ] key Identity of the file and frequency, recorded in the segment
+  * @param[in ] modified Modification time of the file
+  * @param[in ] filename Name of the file, recorded by the pattern
+  * @param[out] pattern Pattern read from the segment if the status is SHARED_SEGMENT_ATTACHED; nullptr if it could not
+  *   be read
+  * @return state of the segment
+  */
+  SharedSegmentStatus attachSegment(const std::string& name, const std::string& key, int64_t modified, const std::string& filename, std::shared_ptr<const AntennaPattern>& pattern)
+  {
+    pattern.reset();
+    std::shared_ptr<SharedMemorySegment> segment(new SharedMemorySegment);
+    if (segment->open(name) != 0)
+      return SHARED_SEGMENT_ABSENT;
+    const SharedSegmentHeader *header = reinterpret_cast<const SharedSegmentHeader*>(segment->data());
+    if (segment->size() < sizeof(SharedSegmentHeader) || header->state_.load(std::memory_order_acquire) != SHARED_READY)
+      return SHARED_SEGMENT_BUILDING;
+    if (memcmp(header->magic_, SHARED_MAGIC, sizeof(header->magic_)) != 0 || header->version_ != SHARED_VERSION ||
+      header->keySize_ > segment->size() - sizeof(SharedSegmentHeader) || header->imageOffset_ % SHARED_ALIGNMENT != 0 ||
+      header->imageOffset_ < sizeof(SharedSegmentHeader) + header->keySize_ || header->imageOffset_ > segment->size() ||
+      header->imageSize_ > segment->size() - header->imageOffset_)
+    {
+      SIM_ERROR << "Shared antenna pattern segment " << name << " is invalid, loading " << filename << " privately" << std::endl;
+      return SHARED_SEGMENT_UNUSABLE;
+    }
+    const char *data = segment->data();
+    // a different file whose key hashes to the same name keeps its segment
+    if (header->keySize_ != key.size() || memcmp(data + sizeof(SharedSegmentHeader), key.data(), key.size()) != 0)
+      return SHARED_SEGMENT_UNUSABLE;
+    if (header->modified_ != modified)
+      return SHARED_SEGMENT_OUTDATED;
+    CompiledPatternReader reader;
+    if (reader.open(segment, data + header->imageOffset_, static_cast<size_t>(header->imageSize_), filename) == 0)
+      pattern.reset(loadCompiledPattern(reader));
+    return SHARED_SEGMENT_ATTACHED;
+  }
+
+  /**
+  * Claim on publishing the segment of a pattern file. Exactly one of several racing processes creates the claim; it
+  * parses the file and publishes the segment, while the others wait for the segment instead of parsing the file too.
+  * The claim records the publishing process and when it was taken, so that waiting processes can take over the claim
+  * of a publisher that died or hangs. The claim is removed when the holder is destroyed, after the segment is published.
+  */
+  class SharedClaim
+  {
+  public:
+    /** @param[in ] name Claim name, the segment name followed by SHARED_CLAIM_SUFFIX */
+    explicit SharedClaim(const std::string& name)
+      : name_(name)
+    {
+    }
+
+    ~SharedClaim()
+    {
+      if (!segment_.data())
+        return;
+      // a waiting process may have taken over the claim, if this process took longer than its timeout
+      SharedMemorySegment current;
+      if (current.open(name_) == 0 && current.size() >= sizeof(SharedClaimHeader) &&
+        memcmp(current.data(), segment_.data(), sizeof(SharedClaimHeader)) == 0)
+        SharedMemorySegment::remove(name_);
+    }
+
+    /**
+    * Takes the claim
+    * @param[out] exists Set to true if another process holds the claim
+    * @return 0 if this process holds the claim
+    */
+    int create(bool& exists)
+    {
+      if (segment_.create(name_, sizeof(SharedClaimHeader), &exists) != 0)
+        return 1;
+      SharedClaimHeader *header = new (segment_.writableData()) SharedClaimHeader;
+      header->process_ = currentProcess();
+      header->claimed_ = systemMilliseconds();
+      header->state_.store(SHARED_READY, std::memory_order_release);
+      return 0;
+    }
+
+    /**
+    * Returns true if a claim held by another process is stale: its process no longer runs, it was taken longer than
+    * the timeout ago, or it stayed unwritten for SHARED_CLAIM_WRITE_MS
+    * @param[in ] name Claim name
+    * @param[in ] timeout Longest time a publisher may hold the claim, in milliseconds
+    * @param[in,out] unwritten Time this process first saw the claim unwritten; reset when the claim is written
+    * @return true if the claim may be taken over
+    */
+    static bool stale(const std::string& name, unsigned int timeout, std::chrono::steady_clock::time_point& unwritten)
+    {
+      SharedMemorySegment claim;
+      // a claim that is gone, or still being sized by its creator, is checked again on the next pass
+      if (claim.open(name) != 0 || claim.size() < sizeof(SharedClaimHeader))
+        return false;
+      const SharedClaimHeader *header = reinterpret_cast<const SharedClaimHeader*>(claim.data());
+      const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      if (header->state_.load(std::memory_order_acquire) != SHARED_READY)
+      {
+        if (unwritten == std::chrono::steady_clock::time_point())
+          unwritten = now;
+        return now - unwritten > std::chrono::milliseconds(SHARED_CLAIM_WRITE_MS);
+      }
+      unwritten = std::chrono::steady_clock::time_point();
+      return !processRunning(header->process_) || systemMilliseconds() - header->claimed_ > static_cast<int64_t>(timeout);
+    }
+
+  private:
+    /** Not implemented */
+    SharedClaim(const SharedClaim&);
+    /** Not implemented */
+    SharedClaim& operator=(const SharedClaim&);
+
+    const std::string name_;        ///< Claim name
+    SharedMemorySegment segment_;   ///< Claim segment, mapped while held; on Windows the mapping keeps the name alive
+  };
+}
+
+// ----------------------------------------------------------------------------
+/// SharedMemorySegment methods
+
+SharedMemorySegment::SharedMemorySegment()
+  : data_(nullptr),
+    size_(0),
+    writable_(false),
+    handle_(nullptr)
+{
+}
+
+SharedMemorySegment::~SharedMemorySegment()
+{
+  close();
+}
+
+int SharedMemorySegment::open(const std::string& name)
+{
+  close();
+#ifdef WIN32
+  HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, simCore::streamFixUtf8("Local\\" + name).c_str());
+  if (!mapping)
+    return 1;
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  MEMORY_BASIC_INFORMATION info;
+  if (!view || VirtualQuery(view, &info, sizeof(info)) == 0)
+  {
+    if (view)
+      UnmapViewOfFile(view);
+    CloseHandle(mapping);
+    return 1;
+  }
+  handle_ = mapping;
+  data_ = static_cast<char*>(view);
+  size_ = static_cast<size_t>(info.RegionSize);
+#else
+  const int fd = shm_open(("/" + name).c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    return 1;
+  struct stat segmentStat;
+  // a segment that is not sized yet is still being created
+  if (fstat(fd, &segmentStat) != 0 || segmentStat.st_size <= 0)
+  {
+    ::close(fd);
+    return 1;
+  }
+  // the mapping stays valid after the descriptor is closed
+  void *view = mmap(nullptr, static_cast<size_t>(segmentStat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED)
+    return 1;
+  data_ = static_cast<char*>(view);
+  size_ = static_cast<size_t>(segmentStat.st_size);
+#endif
+  return 0;
+}
+
+int SharedMemorySegment::create(const std::string& name, size_t size, bool *exists)
+{
+  close();
+  if (exists)
+    *exists = false;
+  if (size == 0)
+    return 1;
+#ifdef WIN32
+  const uint64_t size64 = size;
+  HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+    static_cast<DWORD>(size64 & 0xffffffff), simCore::streamFixUtf8("Local\\" + name).c_str());
+  if (!mapping)
+    return 1;
+  if (GetLastError() == ERROR_ALREADY_EXISTS)
+  {
+    CloseHandle(mapping);
+    if (exists)
+      *exists = true;
+    return 1;
+  }
+  void *view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+  if (!view)
+  {
+    CloseHandle(mapping);
+    return 1;
+  }
+  handle_ = mapping;
+  data_ = static_cast<char*>(view);
+#else
+  const std::string path = "/" + name;
+  const int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0)
+  {
+    if (exists && errno == EEXIST)
+      *exists = true;
+    return 1;
+  }
+  void *view = MAP_FAILED;
+  if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+    view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED)
+  {
+    shm_unlink(path.c_str());
+    return 1;
+  }
+  data_ = static_cast<char*>(view);
+#endif
+  size_ = size;
+  writable_ = true;
+  return 0;
+}
+
+void SharedMemorySegment::close()
+{
+  if (!data_)
+    return;
+#ifdef WIN32
+  UnmapViewOfFile(data_);
+  CloseHandle(static_cast<HANDLE>(handle_));
+#else
+  munmap(data_, size_);
+#endif
+  data_ = nullptr;
+  size_ = 0;
+  writable_ = false;
+  handle_ = nullptr;
+}
+
+int SharedMemorySegment::remove(const std::string& name)
+{
+#ifdef WIN32
+  // named mappings have no unlink; the name goes away with the last handle
+  return 1;
+#else
+  return (shm_unlink(("/" + name).c_str()) == 0 || errno == ENOENT) ? 0 : 1;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+/// AntennaPatternSharedStore methods
+
+const std::string AntennaPatternSharedStore::DEFAULT_PREFIX = "simap";
+
+AntennaPatternSharedStore::AntennaPatternSharedStore(const std::string& prefix)
+  : prefix_(prefix),
+    timeout_(DEFAULT_ATTACH_TIMEOUT_MS)
+{
+}
+
+AntennaPatternSharedStore::~AntennaPatternSharedStore()
+{
+}
+
+std::shared_ptr<const AntennaPattern> AntennaPatternSharedStore::pattern(const std::string& filename, float freqMHz)
+{
+  if (filename.empty())
+    return std::shared_ptr<const AntennaPattern>();
+  std::shared_ptr<const AntennaPattern> pattern = algorithmPattern(filename);
+  if (pattern)
+    return pattern;
+  // mappings of compiled pattern files are already shared through the page cache
+  if (simCore::getExtension(filename) == ANTENNA_STRING_EXTENSION_COMPILED)
+    return privatePattern(filename, freqMHz);
+
+  int64_t modified = 0;
+  const std::string key = patternKey(filename, freqMHz, modified);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<std::string, Entry>::const_iterator iter = entries_.find(key);
+    if (iter != entries_.end() && iter->second.modified_ == modified)
+      return iter->second.pattern_;
+  }
+
+  // attaching waits on other processes, so it runs outside the lock
+  pattern = attach_(filename, freqMHz, key, modified);
+  if (pattern)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_[key];
+    entry.modified_ = modified;
+    entry.pattern_ = pattern;
+  }
+  return pattern;
+}
+
+std::shared_ptr<const AntennaPattern> AntennaPatternSharedStore::attach_(const std::string& filename, float freqMHz, const std::string& key, int64_t modified) const
+{
+  const std::string name = keySegmentName(prefix_, key);
+  const std::string claimName = name + SHARED_CLAIM_SUFFIX;
+  const unsigned int timeout = attachTimeout();
+  const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+  std::chrono::steady_clock::time_point unwritten;
+  while (true)
+  {
+    std::shared_ptr<const AntennaPattern> pattern;
+    const SharedSegmentStatus status = attachSegment(name, key, modified, filename, pattern);
+    if (status == SHARED_SEGMENT_ATTACHED)
+      return pattern ? pattern : privatePattern(filename, freqMHz);
+    if (status == SHARED_SEGMENT_UNUSABLE)
+      return privatePattern(filename, freqMHz);
+
+    // no current segment yet; the process that claims the name publishes it, before parsing the file, and the
+    // others wait for the segment
+    SharedClaim claim(claimName);
+    bool exists = false;
+    if (claim.create(exists) == 0)
+      return publish_(filename, freqMHz, name, key, modified);
+    if (!exists)
+    {
+      SIM_ERROR << "Could not create shared antenna pattern segment " << name << ", loading " << filename << " privately" << std::endl;
+      return privatePattern(filename, freqMHz);
+    }
+    // the publisher died or hangs; remove its claim and take it on the next pass. On Windows the claim of a process that
+    // exited goes away by itself.
+    if (SharedClaim::stale(claimName, timeout, unwritten) && SharedMemorySegment::remove(claimName) == 0)
+    {
+      SIM_ERROR << "Taking over the stale claim on shared antenna pattern segment " << name << std::endl;
+      unwritten = std::chrono::steady_clock::time_point();
+      continue;
+    }
+
+    // every pass that did not attach counts against the timeout
+    if (std::chrono::steady_clock::now() >= deadline)
+    {
+      SIM_ERROR << "Timed out waiting for shared antenna pattern segment " << name << ", loading " << filename << " privately" << std::endl;
+      return privatePattern(filename, freqMHz);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+std::shared_ptr<const AntennaPattern> AntennaPatternSharedStore::publish_(const std::string& filename, float freqMHz, const std::string& name, const std::string& key, int64_t modified) const
+{
+  // another process may have published the segment and released its claim just before this process took it
+  std::shared_ptr<const AntennaPattern> pattern;
+  const SharedSegmentStatus status = attachSegment(name, key, modified, filename, pattern);
+  if (status == SHARED_SEGMENT_ATTACHED && pattern)
+    return pattern;
+  if (status == SHARED_SEGMENT_ATTACHED || status == SHARED_SEGMENT_UNUSABLE)
+    return privatePattern(filename, freqMHz);
+  // only the claim holder creates the segment, so an existing one is of an older file or was left by a publisher that
+  // died. Processes using it keep their mapping. Windows cannot remove a segment that another process still maps, and
+  // publishing under its name would fail.
+  if (status != SHARED_SEGMENT_ABSENT && SharedMemorySegment::remove(name) != 0)
+    return privatePattern(filename, freqMHz);
+
+  std::unique_ptr<AntennaPattern> loaded(loadPatternFile(filename, freqMHz));
+  if (!loaded)
+    return pattern;
+  CompiledPatternWriter writer;
+  if (loaded->writeCompiled(writer) != 0)
+    return std::shared_ptr<const AntennaPattern>(loaded.release());
+  std::vector<char> image;
+  writer.write(image, loaded->type());
+
+  const uint64_t imageOffset = (sizeof(SharedSegmentHeader) + key.size() + SHARED_ALIGNMENT - 1) / SHARED_ALIGNMENT * SHARED_ALIGNMENT;
+  std::shared_ptr<SharedMemorySegment> segment(new SharedMemorySegment);
+  if (segment->create(name, static_cast<size_t>(imageOffset + image.size())) != 0)
+  {
+    SIM_ERROR << "Could not create shared antenna pattern segment " << name << ", loading " << filename << " privately" << std::endl;
+    return std::shared_ptr<const AntennaPattern>(loaded.release());
+  }
+
+  char *data = segment->writableData();
+  SharedSegmentHeader *header = new (data) SharedSegmentHeader;
+  header->version_ = SHARED_VERSION;
+  memcpy(header->magic_, SHARED_MAGIC, sizeof(header->magic_));
+  header->modified_ = modified;
+  header->keySize_ = key.size();
+  header->imageOffset_ = imageOffset;
+  header->imageSize_ = image.size();
+  memcpy(data + sizeof(SharedSegmentHeader), key.data(), key.size());
+  memcpy(data + imageOffset, image.data(), image.size());
+  // readers check the state before anything else in the segment
+  header->state_.store(SHARED_READY, std::memory_order_release);
+
+  // use the pattern just parsed, and keep the segment mapped with it; on Windows the mapping keeps the segment alive
+  return std::shared_ptr<const AntennaPattern>(loaded.release(), [segment](const AntennaPattern* pattern) { delete pattern; });
+}
+
+int AntennaPatternSharedStore::remove(const std::string& filename, float freqMHz)
+{
+  int64_t modified = 0;
+  const std::string key = patternKey(filename, freqMHz, modified);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(key);
+  }
+  return SharedMemorySegment::remove(keySegmentName(prefix_, key));
+}
+
+std::string AntennaPatternSharedStore::segmentName(const std::string& filename, float freqMHz) const
+{
+  int64_t modified = 0;
+  return keySegmentName(prefix_, patternKey(filename, freqMHz, modified));
+}
+
+void AntennaPatternSharedStore::setAttachTimeout(unsigned int milliseconds)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  timeout_ = milliseconds;
+}
+
+unsigned int AntennaPatternSharedStore::attachTimeout() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return timeout_;
+}
+
+size_t AntennaPatternSharedStore::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void AntennaPatternSharedStore::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+}
+
+}
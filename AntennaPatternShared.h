@@ -0,0 +1,233 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_EM_ANTENNA_PATTERN_SHARED_H
+#define SIMCORE_EM_ANTENNA_PATTERN_SHARED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "simCore/Common/Common.h"
+
+namespace simCore
+{
+class AntennaPattern;
+
+/// Named shared memory segment, mapped read-only by readers and read-write by its creator
+class SDKCORE_EXPORT SharedMemorySegment
+{
+public:
+  SharedMemorySegment();
+  virtual ~SharedMemorySegment();
+
+  /**
+  * Maps an existing segment read-only, replacing any previous mapping
+  * @param[in ] name Segment name, letters, digits and underscores only
+  * @return 0 on success, non-zero if the segment does not exist, is still being sized by its creator, or could not be mapped
+  */
+  int open(const std::string& name);
+
+  /**
+  * Creates a segment of the given size and maps it read-write, replacing any previous mapping. Creation fails if a
+  * segment of that name already exists, so that exactly one of several racing processes creates it. New segments are
+  * zero filled.
+  * @param[in ] name Segment name, letters, digits and underscores only
+  * @param[in ] size Size of the segment in bytes
+  * @param[out] exists Set to true if creation failed because the segment already exists; may be nullptr
+  * @return 0 on success
+  */
+  int create(const std::string& name, size_t size, bool *exists = nullptr);
+
+  /** Releases the mapping; the segment itself lives on until removed */
+  void close();
+
+  /** @return start of the mapped segment, page aligned; nullptr if not mapped */
+  const char* data() const { return data_; }
+
+  /** @return start of the mapped segment if this instance created it, nullptr otherwise */
+  char* writableData() const { return writable_ ? data_ : nullptr; }
+
+  /** @return size of the mapped segment in bytes */
+  size_t size() const { return size_; }
+
+  /**
+  * Removes a segment name, so that later open() calls fail and create() calls succeed. Processes that mapped the segment
+  * keep their mapping. On Windows segments are removed by the system once no process maps them, and this does nothing.
+  * @param[in ] name Segment name
+  * @return 0 on success, or if the segment did not exist; non-zero on Windows, where the name stays until unmapped
+  */
+  static int remove(const std::string& name);
+
+private:
+  /** Not implemented */
+  SharedMemorySegment(const SharedMemorySegment&);
+  /** Not implemented */
+  SharedMemorySegment& operator=(const SharedMemorySegment&);
+
+  char *data_;      ///< Start of the mapping
+  size_t size_;     ///< Size of the mapping in bytes
+  bool writable_;   ///< True if this instance created the segment and mapped it read-write
+  void *handle_;    ///< Mapping object handle on Windows, which keeps the segment name alive; unused elsewhere
+};
+
+// ----------------------------------------------------------------------------
+
+/**
+* @brief Pattern store that shares loaded patterns between processes through named shared memory
+*
+* The first process to request a pattern file claims the segment name, loads the file with loadPatternFile(), compiles
+* it to the compiled pattern format (see AntennaPatternCompiled.h) and publishes the image in a shared memory segment
+* named after the store prefix and the file; it keeps using the pattern it loaded. Other requests, from any process on
+* the machine, map the segment read-only and read the pattern from it without parsing the file. Processes that start
+* together wait for the one that claimed the name, so the file is parsed once. Angle/gain tables (.pat, .rel, .nsm),
+* 2D lookup tables (.mon, .bil, .ezn, .uan) and CRUISE gains are used in place in the shared segment, so their memory
+* is held once per machine unless a pattern converts them to single precision.
+*
+* Segments are keyed on the canonical path of the file, the requested frequency for formats whose content depends on
+* it (bilinear and monopulse), and record the modification time of the file. A segment of an older version of the
+* file is replaced on the next request; processes using the old segment keep it until they release their patterns.
+* On Windows a segment cannot be replaced while another process maps it, so the new version is loaded privately.
+* Processes that request a file while another process builds its segment wait for the build, up to the attach
+* timeout, and then fall back to a private load. Patterns that cannot be compiled, such as those of the compiled
+* format itself (whose mapped files are already shared through the page cache), are loaded privately. Algorithm
+* keywords resolve to algorithmPattern().
+*
+* The claim is a small segment named after the pattern's segment followed by "_b". It records the publishing process
+* and when it was taken. A waiting request takes over a claim whose process no longer runs, that is older than the
+* attach timeout, or that its creator never finished writing, and publishes the segment itself; a segment left
+* unpublished by a publisher that died is replaced the same way.
+*
+* Segments outlive the processes that created them on POSIX systems, until removed with remove(); on Windows they
+* are freed once no process maps them.
+*/
+class SDKCORE_EXPORT AntennaPatternSharedStore
+{
+public:
+  /**
+  * AntennaPatternSharedStore constructor
+  * @param[in ] prefix Prefix of the segment names, shared by all processes that share patterns; letters, digits and
+  *   underscores only, short enough for the platform's name limit (31 characters in total on some systems); the
+  *   store appends up to 19 characters
+  */
+  explicit AntennaPatternSharedStore(const std::string& prefix = DEFAULT_PREFIX);
+  virtual ~AntennaPatternSharedStore();
+
+  /**
+  * Returns the pattern for the given file or algorithm keyword, attaching to its shared segment or publishing it
+  * @param[in ] filename Name of the file to load (extension matters), or an algorithm keyword
+  * @param[in ] freqMHz Frequency value to pass to loader, in MHz
+  * @return pattern, or nullptr if the pattern could not be loaded
+  */
+  std::shared_ptr<const AntennaPattern> pattern(const std::string& filename, float freqMHz);
+
+  /**
+  * Removes the shared segment of a pattern file, see SharedMemorySegment::remove(), and releases this store's
+  * reference to it. Processes using the pattern keep it.
+  * @param[in ] filename Name of the pattern file
+  * @param[in ] freqMHz Frequency value the pattern was requested at, in MHz
+  * @return 0 on success, or if the file had no segment; non-zero on Windows, see SharedMemorySegment::remove()
+  */
+  int remove(const std::string& filename, float freqMHz);
+
+  /**
+  * Returns the name of the shared segment that holds a pattern file
+  * @param[in ] filename Name of the pattern file
+  * @param[in ] freqMHz Frequency value the pattern is requested at, in MHz
+  * @return segment name
+  */
+  std::string segmentName(const std::string& filename, float freqMHz) const;
+
+  /**
+  * Sets how long requests wait for another process to publish a segment before loading the pattern privately
+  * @param[in ] milliseconds Attach timeout in milliseconds
+  */
+  void setAttachTimeout(unsigned int milliseconds);
+
+  /**
+  * Returns how long requests wait for another process to publish a segment
+  * @return attach timeout in milliseconds
+  */
+  unsigned int attachTimeout() const;
+
+  /**
+  * Returns the number of patterns this store holds
+  * @return number of held patterns
+  */
+  size_t size() const;
+
+  /** Releases this store's references to all patterns; shared segments stay published for other processes */
+  void clear();
+
+  /// Default prefix of segment names
+  static const std::string DEFAULT_PREFIX;
+  /// Default attach timeout in milliseconds
+  static const unsigned int DEFAULT_ATTACH_TIMEOUT_MS = 10000;
+
+private:
+  /// Pattern held by the store
+  struct Entry
+  {
+    Entry() : modified_(0) {}
+
+    int64_t modified_;  ///< Modification time of the file the pattern came from, in file clock ticks; 0 if unavailable
+    std::shared_ptr<const AntennaPattern> pattern_; ///< Pattern
+  };
+
+  /**
+  * Returns the pattern in the shared segment of a file, publishing the segment first if needed
+  * @param[in ] filename Name of the file to load
+  * @param[in ] freqMHz Frequency value to pass to loader, in MHz
+  * @param[in ] key Identity of the file and frequency, recorded in the segment
+  * @param[in ] modified Modification time of the file
+  * @return pattern, or nullptr if the pattern could not be loaded
+  */
+  std::shared_ptr<const AntennaPattern> attach_(const std::string& filename, float freqMHz, const std::string& key, int64_t modified) const;
+
+  /**
+  * Loads a pattern file and publishes it in a new segment, while holding the claim on the segment name
+  * @param[in ] filename Name of the file to load
+  * @param[in ] freqMHz Frequency value to pass to loader, in MHz
+  * @param[in ] name Segment name
+  * @param[in ] key Identity of the file and frequency, recorded in the segment
+  * @param[in ] modified Modification time of the file
+  * @return loaded pattern, which keeps the published segment mapped; nullptr if the pattern could not be loaded
+  */
+  std::shared_ptr<const AntennaPattern> publish_(const std::string& filename, float freqMHz, const std::string& name, const std::string& key, int64_t modified) const;
+
+  /** Not implemented */
+  AntennaPatternSharedStore(const AntennaPatternSharedStore&);
+  /** Not implemented */
+  AntennaPatternSharedStore& operator=(const AntennaPatternSharedStore&);
+
+  const std::string prefix_;      ///< Prefix of segment names
+  mutable std::mutex mutex_;      ///< Protects entries_ and timeout_
+  std::map<std::string, Entry> entries_; ///< Patterns by key
+  unsigned int timeout_;          ///< Attach timeout in milliseconds
+};
+
+}
+
+#endif /* SIMCORE_EM_ANTENNA_PATTERN_SHARED_H */
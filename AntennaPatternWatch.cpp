@@ -0,0 +1,388 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <system_error>
+#include "simNotify/Notify.h"
+#include "simCore/EM/AntennaPatternPath.h"
+#include "simCore/EM/AntennaPatternWatch.h"
+
+namespace simCore
+{
+
+// ----------------------------------------------------------------------------
+/// AntennaPatternWatched methods
+
+AntennaPatternWatched::ReadSection::ReadSection(const AntennaPatternWatched& watched)
+  : readers_(watched.readers_[watched.epoch_.load() & 1]),
+    version_(nullptr)
+{
+  // count this reader before taking the version, so that publish_() waits for it; see publish_()
+  readers_.fetch_add(1);
+  version_ = watched.current_.load();
+}
+
+AntennaPatternWatched::ReadSection::~ReadSection()
+{
+  readers_.fetch_sub(1);
+}
+
+AntennaPatternWatched::AntennaPatternWatched(const std::string& filename, float freqMHz)
+  : AntennaPattern(),
+    type_(antennaPatternType(filename)),
+    freqMHz_(freqMHz),
+    current_(nullptr),
+    epoch_(0),
+    version_(0)
+{
+  readers_[0] = 0;
+  readers_[1] = 0;
+  filename_ = filename;
+
+  std::lock_guard<std::mutex> lock(reloadMutex_);
+  if (reload_(fileStamp_()) != 0)
+    return;
+  const AntennaPattern* first = current_.load()->pattern_.get();
+  type_ = first->type();
+  polarity_ = first->polarity();
+  valid_ = true;
+}
+
+AntennaPatternWatched::~AntennaPatternWatched()
+{
+  // no query may run while the pattern is destroyed
+  delete current_.load();
+}
+
+float AntennaPatternWatched::gain(const AntennaGainParameters &params) const
+{
+  const ReadSection section(*this);
+  return (section.pattern()) ? section.pattern()->gain(params) : SMALL_DB_VAL;
+}
+
+float AntennaPatternWatched::cursorGain(const AntennaGainParameters &params, AntennaLookupCursor &cursor) const
+{
+  const ReadSection section(*this);
+  return (section.pattern()) ? section.pattern()->cursorGain(params, cursor) : SMALL_DB_VAL;
+}
+
+void AntennaPatternWatched::minMaxGain(float *min, float *max, const AntennaGainParameters &params) const
+{
+  assert(min && max);
+  if (!min || !max)
+    return;
+
+  const ReadSection section(*this);
+  if (section.pattern())
+  {
+    section.pattern()->minMaxGain(min, max, params);
+    return;
+  }
+  // no direction has a gain
+  *min = -SMALL_DB_VAL;
+  *max = SMALL_DB_VAL;
+}
+
+float AntennaPatternWatched::upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const
+{
+  const ReadSection section(*this);
+  return (section.pattern()) ? section.pattern()->upperBoundGain(azimMin, azimMax, elevMin, elevMax, params) : SMALL_DB_VAL;
+}
+
+void AntennaPatternWatched::gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+
+  const ReadSection section(*this);
+  if (section.pattern())
+    section.pattern()->gainBatch(params, azim, elev, count, gains);
+  else
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+}
+
+void AntennaPatternWatched::gainBatchApprox(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const
+{
+  assert(count == 0 || (azim && elev && gains));
+  if (count == 0 || !azim || !elev || !gains)
+    return;
+
+  const ReadSection section(*this);
+  if (section.pattern())
+    section.pattern()->gainBatchApprox(params, azim, elev, count, gains);
+  else
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+}
+
+void AntennaPatternWatched::polarityGains(const AntennaGainParameters &params, const PolarityType *polarities, size_t count, float *gains) const
+{
+  assert(count == 0 || (polarities && gains));
+  if (count == 0 || !polarities || !gains)
+    return;
+
+  const ReadSection section(*this);
+  if (section.pattern())
+    section.pattern()->polarityGains(params, polarities, count, gains);
+  else
+    std::fill(gains, gains + count, SMALL_DB_VAL);
+}
+
+std::unique_ptr<AntennaPatternEvaluator> AntennaPatternWatched::bindFrequency(double freq) const
+{
+  // an evaluator bound to a version would outlive it after a reload
+  return AntennaPattern::bindFrequency(freq);
+}
+
+int AntennaPatternWatched::writeCompiled(CompiledPatternWriter& writer) const
+{
+  const ReadSection section(*this);
+  if (!section.pattern())
+  {
+    SIM_ERROR << "Unable to load antenna pattern file: " << filename_ << std::endl;
+    return 1;
+  }
+  return section.pattern()->writeCompiled(writer);
+}
+
+int AntennaPatternWatched::readCompiled(const CompiledPatternReader& /*reader*/)
+{
+  SIM_ERROR << "Compiled antenna patterns cannot be read into a watched pattern" << std::endl;
+  return 1;
+}
+
+AntennaPatternStatistics AntennaPatternWatched::statistics() const
+{
+  const ReadSection section(*this);
+  return (section.pattern()) ? section.pattern()->statistics() : counters_.statistics();
+}
+
+void AntennaPatternWatched::resetStatistics()
+{
+  const ReadSection section(*this);
+  if (section.shared())
+    (*section.shared())->resetStatistics();
+  counters_.reset();
+}
+
+std::shared_ptr<const AntennaPattern> AntennaPatternWatched::current() const
+{
+  const ReadSection section(*this);
+  return (section.shared()) ? *section.shared() : std::shared_ptr<const AntennaPattern>();
+}
+
+bool AntennaPatternWatched::changed() const
+{
+  std::lock_guard<std::mutex> lock(reloadMutex_);
+  return !(fileStamp_() == stamp_);
+}
+
+bool AntennaPatternWatched::reloadIfChanged()
+{
+  if (!valid_)
+    return false;
+  std::lock_guard<std::mutex> lock(reloadMutex_);
+  const FileStamp stamp = fileStamp_();
+  if (stamp == stamp_)
+    return false;
+  return reload_(stamp) == 0;
+}
+
+int AntennaPatternWatched::reload()
+{
+  if (!valid_)
+    return 1;
+  std::lock_guard<std::mutex> lock(reloadMutex_);
+  return reload_(fileStamp_());
+}
+
+int AntennaPatternWatched::reload_(const FileStamp& stamp)
+{
+  std::shared_ptr<AntennaPattern> pattern(loadPatternFile(filename_, freqMHz_));
+  // a file modified while it was parsed is parsed again on the next check, even if this load succeeded
+  if (fileStamp_() == stamp)
+    stamp_ = stamp;
+  if (!pattern)
+    return 1;
+  publish_(pattern);
+  return 0;
+}
+
+void AntennaPatternWatched::publish_(const std::shared_ptr<AntennaPattern>& pattern)
+{
+  assert(pattern);
+  const Version* previous = current_.exchange(new Version{ pattern });
+  version_.fetch_add(1, std::memory_order_release);
+  if (!previous)
+    return;
+
+  // A read section that may hold the previous version counted itself before the exchange above and still counts.
+  // Flipping the epoch moves new sections to the other count, so each count drains; once both have been seen at
+  // zero after the exchange, every such section has left. Sections entering later take the new version.
+  for (int i = 0; i < 2; ++i)
+  {
+    const unsigned int parity = epoch_.fetch_add(1) & 1;
+    while (readers_[parity].load() != 0)
+      std::this_thread::yield();
+  }
+  // holders of current() keep the pattern itself alive
+  delete previous;
+}
+
+AntennaPatternWatched::FileStamp AntennaPatternWatched::fileStamp_() const
+{
+  FileStamp stamp;
+  std::error_code ec;
+  const std::filesystem::path path = AntennaPaths::fromUtf8(filename_);
+  const std::filesystem::file_time_type time = std::filesystem::last_write_time(path, ec);
+  if (!ec)
+    stamp.modified_ = static_cast<int64_t>(time.time_since_epoch().count());
+  const uintmax_t size = std::filesystem::file_size(path, ec);
+  if (!ec)
+    stamp.size_ = size;
+  return stamp;
+}
+
+// ----------------------------------------------------------------------------
+/// AntennaPatternWatcher methods
+
+AntennaPatternWatcher::AntennaPatternWatcher()
+  : interval_(1.0),
+    stop_(false)
+{
+}
+
+AntennaPatternWatcher::~AntennaPatternWatcher()
+{
+  stop();
+}
+
+std::shared_ptr<AntennaPatternWatched> AntennaPatternWatcher::watch(const std::string& filename, float freqMHz)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::vector<Entry>::const_iterator it = entries_.begin(); it != entries_.end(); ++it)
+    {
+      if (it->filename_ != filename || it->freqMHz_ != freqMHz)
+        continue;
+      std::shared_ptr<AntennaPatternWatched> pattern = it->pattern_.lock();
+      if (pattern)
+        return pattern;
+    }
+  }
+
+  // load outside the lock, so that the watcher thread keeps checking other files
+  std::shared_ptr<AntennaPatternWatched> pattern(new AntennaPatternWatched(filename, freqMHz));
+  if (!pattern->valid())
+    return std::shared_ptr<AntennaPatternWatched>();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry entry;
+  entry.filename_ = filename;
+  entry.freqMHz_ = freqMHz;
+  entry.pattern_ = pattern;
+  entries_.push_back(entry);
+  return pattern;
+}
+
+size_t AntennaPatternWatcher::poll()
+{
+  std::vector<std::shared_ptr<AntennaPatternWatched> > patterns;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // drop patterns released by their users
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+      [](const Entry& entry) { return entry.pattern_.expired(); }), entries_.end());
+    for (std::vector<Entry>::const_iterator it = entries_.begin(); it != entries_.end(); ++it)
+    {
+      std::shared_ptr<AntennaPatternWatched> pattern = it->pattern_.lock();
+      if (pattern)
+        patterns.push_back(pattern);
+    }
+  }
+
+  size_t reloaded = 0;
+  for (std::vector<std::shared_ptr<AntennaPatternWatched> >::const_iterator it = patterns.begin(); it != patterns.end(); ++it)
+  {
+    if ((*it)->reloadIfChanged())
+      ++reloaded;
+  }
+  return reloaded;
+}
+
+void AntennaPatternWatcher::start(double intervalSeconds)
+{
+  assert(intervalSeconds > 0.0);
+  std::lock_guard<std::mutex> lock(mutex_);
+  interval_ = (intervalSeconds > 0.0) ? intervalSeconds : 1.0;
+  if (thread_.joinable())
+  {
+    // restart the wait with the new interval
+    wake_.notify_all();
+    return;
+  }
+  stop_ = false;
+  thread_ = std::thread(&AntennaPatternWatcher::run_, this);
+}
+
+void AntennaPatternWatcher::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!thread_.joinable())
+      return;
+    stop_ = true;
+  }
+  wake_.notify_all();
+  thread_.join();
+}
+
+bool AntennaPatternWatcher::running() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return thread_.joinable();
+}
+
+size_t AntennaPatternWatcher::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void AntennaPatternWatcher::run_()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_)
+  {
+    wake_.wait_for(lock, std::chrono::duration<double>(interval_));
+    if (stop_)
+      break;
+    lock.unlock();
+    poll();
+    lock.lock();
+  }
+}
+
+}
@@ -0,0 +1,294 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_EM_ANTENNA_PATTERN_WATCH_H
+#define SIMCORE_EM_ANTENNA_PATTERN_WATCH_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "simCore/Common/Common.h"
+#include "simCore/EM/AntennaPattern.h"
+
+namespace simCore
+{
+
+/**
+* @brief Pattern file that is reloaded when it changes on disk
+*
+* Holds the current version of a pattern loaded with loadPatternFile() and forwards all queries to it.
+* reloadIfChanged(), usually called by an AntennaPatternWatcher thread, parses a changed file into a new pattern and
+* publishes it with an atomic pointer swap. Queries never block or take a lock. They only mark themselves as readers,
+* so a query running during a reload completes on the version it started with, and never sees a partially built
+* table. The previous version is deleted once every query that may still use it has finished; holders of current()
+* keep their version alive until they release it.
+*
+* A file that fails to parse, for instance while it is still being written, leaves the current version in place; it
+* is parsed again once it changes. valid() reports whether the first load succeeded, and a pattern whose first load
+* failed is never reloaded. Usage counters belong to each version and restart with each reload.
+*/
+class SDKCORE_EXPORT AntennaPatternWatched : public AntennaPattern
+{
+public:
+  /**
+  * AntennaPatternWatched constructor; loads the first version of the pattern, valid() false if it fails
+  * @param[in ] filename Name of the file to load (extension matters)
+  * @param[in ] freqMHz Frequency value to pass to loader, in MHz
+  */
+  AntennaPatternWatched(const std::string& filename, float freqMHz);
+  virtual ~AntennaPatternWatched();
+
+  /** @copydoc AntennaPattern::type */
+  virtual AntennaPatternType type() const { return type_; }
+
+  /** @copydoc AntennaPattern::gain */
+  virtual float gain(const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::cursorGain */
+  virtual float cursorGain(const AntennaGainParameters &params, AntennaLookupCursor &cursor) const;
+
+  /** @copydoc AntennaPattern::minMaxGain */
+  virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::upperBoundGain */
+  virtual float upperBoundGain(float azimMin, float azimMax, float elevMin, float elevMax, const AntennaGainParameters &params) const;
+
+  /** @copydoc AntennaPattern::gainBatch */
+  virtual void gainBatch(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /** @copydoc AntennaPattern::gainBatchApprox */
+  virtual void gainBatchApprox(const AntennaGainParameters &params, const float *azim, const float *elev, size_t count, float *gains) const;
+
+  /** @copydoc AntennaPattern::polarityGains */
+  virtual void polarityGains(const AntennaGainParameters &params, const PolarityType *polarities, size_t count, float *gains) const;
+
+  /**
+  * @copydoc AntennaPattern::bindFrequency
+  * The evaluator queries this pattern, so it follows reloads; it does not precompute the frequency lookup. Callers
+  * wanting the faster evaluator of a given version bind current() instead, and keep that version alive meanwhile.
+  */
+  virtual std::unique_ptr<AntennaPatternEvaluator> bindFrequency(double freq) const;
+
+  /** @copydoc AntennaPattern::writeCompiled */
+  virtual int writeCompiled(CompiledPatternWriter& writer) const;
+
+  /**
+  * Compiled patterns cannot be read into a watched pattern; use loadCompiledPattern()
+  * @param[in ] reader Opened compiled pattern
+  * @return non-zero
+  */
+  virtual int readCompiled(const CompiledPatternReader& reader);
+
+  /**
+  * Returns the counters of the current version
+  * @return counter snapshot
+  */
+  virtual AntennaPatternStatistics statistics() const;
+
+  /** Resets the counters of the current version */
+  virtual void resetStatistics();
+
+  /**
+  * Returns the current version of the pattern, which stays alive while the returned pointer is held. Loops making
+  * many queries can take a version once and query it directly, also through AntennaPatternHandle.
+  * @return current pattern, nullptr if the first load failed
+  */
+  std::shared_ptr<const AntennaPattern> current() const;
+
+  /**
+  * Returns the number of versions loaded, starting at 1 for the first load
+  * @return version number, 0 if the first load failed
+  */
+  uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+  /**
+  * Returns whether the file changed on disk since it was last parsed
+  * @return true if its modification time or size differs
+  */
+  bool changed() const;
+
+  /**
+  * Parses the file again if it changed since it was last parsed, and publishes the new version on success
+  * @return true if a new version was published
+  */
+  bool reloadIfChanged();
+
+  /**
+  * Parses the file and publishes the new version on success, whether or not the file changed
+  * @return 0 on success, non-zero if the file could not be loaded; the current version is kept on failure
+  */
+  int reload();
+
+private:
+  /** Published version of the pattern */
+  struct Version
+  {
+    std::shared_ptr<AntennaPattern> pattern_; ///< Loaded pattern, shared with holders of current()
+  };
+
+  /** Modification time and size of the file, used to detect changes */
+  struct FileStamp
+  {
+    FileStamp() : modified_(0), size_(0) {}
+    bool operator==(const FileStamp& other) const { return modified_ == other.modified_ && size_ == other.size_; }
+
+    int64_t modified_; ///< Modification time in file clock ticks, 0 if unavailable
+    uintmax_t size_;   ///< Size in bytes, 0 if unavailable
+  };
+
+  /** Registers a query as a reader of the current version for the duration of its scope, see publish_() */
+  class ReadSection
+  {
+  public:
+    /** Enters the read section, takes the current version */
+    explicit ReadSection(const AntennaPatternWatched& watched);
+    /** Leaves the read section */
+    ~ReadSection();
+    /** Current version of the pattern when the section was entered, nullptr if none */
+    const AntennaPattern* pattern() const { return (version_) ? version_->pattern_.get() : nullptr; }
+    /** Shared pointer to the current version when the section was entered */
+    const std::shared_ptr<AntennaPattern>* shared() const { return (version_) ? &version_->pattern_ : nullptr; }
+
+  private:
+    std::atomic<unsigned int>& readers_; ///< Reader count of the epoch the section entered in
+    const Version* version_;             ///< Version taken on entry
+  };
+
+  /**
+  * Loads the file and publishes it on success; the caller holds reloadMutex_
+  * @param[in ] stamp File stamp observed before loading
+  * @return 0 on success, non-zero on failure
+  */
+  int reload_(const FileStamp& stamp);
+
+  /**
+  * Replaces the current version, then waits until no read section that may hold the previous one remains, and
+  * deletes it
+  * @param[in ] pattern New version, not nullptr
+  */
+  void publish_(const std::shared_ptr<AntennaPattern>& pattern);
+
+  /**
+  * Returns the stamp of the file on disk
+  * @return modification time and size, zero if unavailable
+  */
+  FileStamp fileStamp_() const;
+
+  /** Not implemented */
+  AntennaPatternWatched(const AntennaPatternWatched&);
+  /** Not implemented */
+  AntennaPatternWatched& operator=(const AntennaPatternWatched&);
+
+  AntennaPatternType type_; ///< Type of the pattern, from its first version
+  float freqMHz_;           ///< Frequency to pass to the loader (MHz)
+  std::atomic<const Version*> current_;          ///< Published version, nullptr if the first load failed
+  mutable std::atomic<unsigned int> epoch_;      ///< Selects the reader count new read sections use
+  mutable std::atomic<unsigned int> readers_[2]; ///< Read sections in progress, by epoch parity
+  std::atomic<uint64_t> version_;                ///< Number of versions loaded
+  mutable std::mutex reloadMutex_;  ///< Serializes reloads; never taken by queries
+  FileStamp stamp_;         ///< Stamp of the file when last parsed, protected by reloadMutex_
+};
+
+/**
+* @brief Thread that reloads watched pattern files when they change
+*
+* Patterns created with watch() are checked every interval while the watcher runs; poll() checks them once from the
+* calling thread instead. The watcher only holds weak references: a pattern is no longer watched once its users
+* release it.
+*/
+class SDKCORE_EXPORT AntennaPatternWatcher
+{
+public:
+  AntennaPatternWatcher();
+  /** Stops the watcher thread */
+  virtual ~AntennaPatternWatcher();
+
+  /**
+  * Loads a pattern file and watches it for changes; repeated calls for the same file and frequency return the same
+  * pattern while it is held
+  * @param[in ] filename Name of the file to load (extension matters)
+  * @param[in ] freqMHz Frequency value to pass to loader, in MHz
+  * @return watched pattern, or nullptr if the file could not be loaded
+  */
+  std::shared_ptr<AntennaPatternWatched> watch(const std::string& filename, float freqMHz);
+
+  /**
+  * Reloads the watched patterns whose files changed, on the calling thread
+  * @return number of patterns reloaded
+  */
+  size_t poll();
+
+  /**
+  * Starts the watcher thread, or changes its interval if it is running
+  * @param[in ] intervalSeconds Time between checks of the watched files (s)
+  */
+  void start(double intervalSeconds = 1.0);
+
+  /** Stops the watcher thread, waiting for a reload in progress to finish */
+  void stop();
+
+  /**
+  * Returns whether the watcher thread is running
+  * @return true if running
+  */
+  bool running() const;
+
+  /**
+  * Returns the number of patterns watched, including those released since the last check
+  * @return number of watched patterns
+  */
+  size_t size() const;
+
+private:
+  /** Watched pattern and the arguments it was loaded with */
+  struct Entry
+  {
+    std::string filename_;                       ///< File name as given to watch()
+    float freqMHz_;                              ///< Frequency given to watch() (MHz)
+    std::weak_ptr<AntennaPatternWatched> pattern_; ///< Watched pattern, expired once released
+  };
+
+  /** Body of the watcher thread */
+  void run_();
+
+  /** Not implemented */
+  AntennaPatternWatcher(const AntennaPatternWatcher&);
+  /** Not implemented */
+  AntennaPatternWatcher& operator=(const AntennaPatternWatcher&);
+
+  mutable std::mutex mutex_;      ///< Protects entries_ and the thread state
+  std::vector<Entry> entries_;    ///< Watched patterns
+  std::condition_variable wake_;  ///< Signaled to stop the thread or change its interval
+  std::thread thread_;            ///< Watcher thread, not joinable when stopped
+  double interval_;               ///< Time between checks (s)
+  bool stop_;                     ///< Requests the thread to exit
+};
+
+}
+
+#endif /* SIMCORE_EM_ANTENNA_PATTERN_WATCH_H */
@@ -0,0 +1,442 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+#include "simCore/EM/AntennaPattern.h"
+#include "simCore/Calc/Angle.h"
+
+/**
+ * 性能基准：每种天线方向图类型的 gain()/minMaxGain()/loadPatternFile 开销及内存占用
+ *
+ * 用法: antenna_pattern_benchmark [JSON输出文件] [数据文件前缀]
+ *   - 在数据文件前缀处 (默认当前目录下的 "bench_") 生成每种文件格式的合成数据文件,
+ *     EZNEC/XFDTD/NSMA 使用 1 度 (NSMA 为 0.1 度) 分辨率的大文件
+ *   - 结果以 JSON 写入输出文件 (默认标准输出), 字段与 Google Benchmark 的 JSON 输出一致
+ *     (name/iterations/real_time/time_unit), 便于用同样的工具对比不同版本
+ */
+
+// ---------------------------------------------------------------------------
+// 堆内存统计：替换全局 operator new/delete, 记录当前存活的堆字节数
+
+namespace
+{
+    std::atomic<long long> g_heapBytes(0);
+
+    // 分配头部保存块大小, 16 字节以保持 new 的对齐
+    const size_t HEAP_HEADER = 16;
+
+    void* countedAlloc(size_t size)
+    {
+        void* block = std::malloc(size + HEAP_HEADER);
+        if (!block)
+            throw std::bad_alloc();
+        *static_cast<size_t*>(block) = size;
+        g_heapBytes += static_cast<long long>(size);
+        return static_cast<char*>(block) + HEAP_HEADER;
+    }
+
+    void countedFree(void* ptr)
+    {
+        if (!ptr)
+            return;
+        void* block = static_cast<char*>(ptr) - HEAP_HEADER;
+        g_heapBytes -= static_cast<long long>(*static_cast<size_t*>(block));
+        std::free(block);
+    }
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { countedFree(ptr); }
+
+namespace
+{
+    // 常驻内存 (字节), 不支持的平台返回 -1
+    long long residentBytes()
+    {
+#ifdef __linux__
+        std::ifstream statm("/proc/self/statm");
+        long long size = 0, resident = 0;
+        if (statm >> size >> resident)
+            return resident * static_cast<long long>(sysconf(_SC_PAGESIZE));
+#endif
+        return -1;
+    }
+
+    double nowSeconds()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 合成方向图增益 (dB): 主瓣为抛物线, 旁瓣为起伏的底电平
+    double synthGain(double angleDeg, double beamWidthDeg, double floorDb = -40.0)
+    {
+        const double mainLobe = -12.0 * (angleDeg / beamWidthDeg) * (angleDeg / beamWidthDeg);
+        return std::max(mainLobe, floorDb + 5.0 * std::sin(angleDeg / 7.0));
+    }
+
+    // -----------------------------------------------------------------------
+    // 合成数据文件, 格式见 "AntennaPattern data_file_examples.md"
+
+    void writeTable(const std::string& filename)
+    {
+        std::ofstream out(filename.c_str());
+        // 类型 0 (角度), 对称性 2, 0.5 度分辨率
+        out << "0 2\n" << 361 << "\n";
+        for (int i = 0; i <= 360; ++i)
+            out << i * 0.5 << " " << synthGain(i * 0.5, 3.0) << "\n";
+        out << 181 << "\n";
+        for (int i = 0; i <= 180; ++i)
+            out << i * 0.5 << " " << synthGain(i * 0.5, 5.0) << "\n";
+    }
+
+    void writeRelative(const std::string& filename)
+    {
+        std::ofstream out(filename.c_str());
+        out << 720 << " " << 361 << "\n";
+        for (int i = 0; i < 720; ++i)
+            out << -180.0 + i * 0.5 << " " << synthGain(-180.0 + i * 0.5, 3.0) << "\n";
+        for (int i = 0; i <= 360; ++i)
+            out << -90.0 + i * 0.5 << " " << synthGain(-90.0 + i * 0.5, 5.0) << "\n";
+    }
+
+    void writeCruise(const std::string& filename)
+    {
+        std::ofstream out(filename.c_str());
+        const int numFreq = 8;
+        // 方位 1 度, 仰角 1 度, 电压增益
+        out << 361 << " " << numFreq << "\n-180.0 1.0\n";
+        for (int k = 0; k < numFreq; ++k)
+            out << 8.0 + k << (k + 1 < numFreq ? " " : "\n");
+        for (int k = 0; k < numFreq; ++k)
+        {
+            for (int i = 0; i <= 360; ++i)
+                out << std::pow(10.0, synthGain(-180.0 + i, 3.0 + k) / 20.0) << (i < 360 ? " " : "\n");
+        }
+        out << 181 << " " << numFreq << "\n-90.0 1.0\n";
+        for (int k = 0; k < numFreq; ++k)
+            out << 8.0 + k << (k + 1 < numFreq ? " " : "\n");
+        for (int k = 0; k < numFreq; ++k)
+        {
+            for (int i = 0; i <= 180; ++i)
+                out << std::pow(10.0, synthGain(-90.0 + i, 5.0 + k) / 20.0) << (i < 180 ? " " : "\n");
+        }
+    }
+
+    void writeMonopulseBlock(std::ofstream& out, const char* name, bool diff)
+    {
+        // 4 个频率, 方位 [-90, 90] 1 度, 仰角 [-45, 45] 1 度
+        out << name << "\n1e9 4e9 1e9\n-90 90 1\n-45 45 1\n";
+        for (int f = 0; f < 4; ++f)
+        {
+            for (int a = -90; a <= 90; ++a)
+            {
+                for (int e = -45; e <= 45; ++e)
+                {
+                    if (diff)
+                        out << synthGain(a, 10.0) + 20.0 * std::log10(std::fabs(a) / 90.0 + 0.02) << " " << (a >= 0 ? 0 : 180) << "\n";
+                    else
+                        out << synthGain(a, 10.0) + synthGain(e, 8.0) - f << " " << (a + e) % 10 << "\n";
+                }
+            }
+        }
+    }
+
+    void writeMonopulse(const std::string& filename)
+    {
+        std::ofstream out(filename.c_str());
+        writeMonopulseBlock(out, "sum", false);
+        writeMonopulseBlock(out, "diff", true);
+    }
+
+    void writeBilinear(const std::string& filename)
+    {
+        std::ofstream out(filename.c_str());
+        out << "bilinear\n1e9 4e9 1e9\n-180 180 1\n-90 90 1\n";
+        for (int f = 0; f < 4; ++f)
+        {
+            for (int a = -180; a <= 180; ++a)
+            {
+                for (int e = -90; e <= 90; ++e)
+                    out << synthGain(a, 10.0 - f) + synthGain(e, 8.0) << "\n";
+            }
+        }
+    }
+
+    void writeNsma(const std::string& filename)
+    {
+        std::ofstream out(filename.c_str());
+        out << "ACME\nModel\nSynthetic benchmark pattern\nFCC\nREV\n2024\nID\n2400-2500\n30.5\n2.0\n";
+        // 0.1 度分辨率的大文件, 每个极化 3601 个方位点和 1801 个仰角点
+        const char* azimTables[] = { "HH", "HV", "VV", "VH" };
+        const char* elevTables[] = { "ELHH", "ELHV", "ELVV", "ELVH" };
+        for (int t = 0; t < 4; ++t)
+        {
+            out << azimTables[t] << " " << 3601 << "\n";
+            for (int i = 0; i <= 3600; ++i)
+                out << -180.0 + i * 0.1 << " " << synthGain(-180.0 + i * 0.1, 2.0 + t) << "\n";
+        }
+        for (int t = 0; t < 4; ++t)
+        {
+            out << elevTables[t] << " " << 1801 << "\n";
+            for (int i = 0; i <= 1800; ++i)
+                out << -90.0 + i * 0.1 << " " << synthGain(-90.0 + i * 0.1, 3.0 + t) << "\n";
+        }
+    }
+
+    void writeEznec(const std::string& filename)
+    {
+        std::ofstream out(filename.c_str());
+        out << "EZNEC+ ver. 5.0\n\nFrequency = 300 MHz\nReference = 2.15 dBi\n";
+        // 仰角 [0, 90] 1 度, 每层方位 [0, 360] 1 度
+        for (int e = 0; e <= 90; ++e)
+        {
+            out << "Azimuth Pattern  Elevation Angle = " << e << " deg.\nDeg V dB H dB Tot dB\n";
+            for (int a = 0; a <= 360; ++a)
+            {
+                const double v = synthGain(a - 180.0, 40.0) + synthGain(e, 30.0);
+                const double h = v - 10.0 + 3.0 * std::cos(a * simCore::DEG2RAD);
+                const double tot = 10.0 * std::log10(std::pow(10.0, v / 10.0) + std::pow(10.0, h / 10.0));
+                out << a << " " << v << " " << h << " " << tot << "\n";
+            }
+        }
+    }
+
+    void writeXfdtd(const std::string& filename)
+    {
+        std::ofstream out(filename.c_str());
+        // 同文件格式示例 (phi_max 360): 加载器按 (phi_max - phi_min) / phi_inc = 360 读取每个 theta 的 phi 行, 对应 [0, 360)
+        out << "begin_<parameters>\nformat free\nphi_min 0\nphi_max 360\nphi_inc 1\ntheta_min 0\ntheta_max 180\ntheta_inc 1\n"
+            "complex\nmag_phase\npattern gain\nmagnitude dB\nmaximum_gain 3\nphase degrees\ndirection degrees\n"
+            "polarization theta_phi\nend_<parameters>\n";
+        for (int th = 0; th <= 180; ++th)
+        {
+            for (int ph = 0; ph < 360; ++ph)
+                out << th << " " << ph << " " << synthGain(ph - 180.0, 40.0) + synthGain(th - 90.0, 30.0) << " "
+                    << synthGain(ph - 180.0, 60.0) - 6.0 << " 0 0\n";
+        }
+    }
+
+    // -----------------------------------------------------------------------
+
+    struct BenchmarkCase
+    {
+        std::string name;                            // 方向图类型名称
+        std::string source;                          // 算法关键字或数据文件名
+        void (*generator)(const std::string&);       // 生成数据文件, 算法型为 nullptr
+        float freqMHz;                               // 加载频率 (MHz)
+    };
+
+    struct BenchmarkResult
+    {
+        std::string name;
+        long long iterations;
+        double nsPerIteration;
+        std::string extra;                           // 附加 JSON 字段
+    };
+
+    // 重复调用 op 直到累计时间不少于 minSeconds, 返回每次调用的纳秒数
+    template <typename Op>
+    double timeOp(Op op, long long &iterations, double minSeconds = 0.2)
+    {
+        iterations = 0;
+        long long batch = 1;
+        const double start = nowSeconds();
+        double elapsed = 0.0;
+        while (elapsed < minSeconds)
+        {
+            for (long long i = 0; i < batch; ++i)
+                op();
+            iterations += batch;
+            elapsed = nowSeconds() - start;
+            batch *= 2;
+        }
+        return elapsed * 1e9 / static_cast<double>(iterations);
+    }
+
+    std::string jsonEscape(const std::string& text)
+    {
+        std::string escaped;
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            if (text[i] == '"' || text[i] == '\\')
+                escaped += '\\';
+            escaped += text[i];
+        }
+        return escaped;
+    }
+
+    // 返回 false 表示方向图无法加载
+    bool benchmarkPattern(const BenchmarkCase& bc, std::vector<BenchmarkResult>& results)
+    {
+        // 加载延迟 (取多次中的最小值) 与内存占用 (首次加载)
+        const long long heapBefore = g_heapBytes;
+        const long long residentBefore = residentBytes();
+        const double loadStart = nowSeconds();
+        std::unique_ptr<simCore::AntennaPattern> pattern(simCore::loadPatternFile(bc.source, bc.freqMHz));
+        double loadSeconds = nowSeconds() - loadStart;
+        const long long heapBytes = g_heapBytes - heapBefore;
+        const long long residentAfter = residentBytes();
+        if (!pattern || !pattern->valid())
+        {
+            std::cerr << "无法加载方向图: " << bc.source << "\n";
+            return false;
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            const double start = nowSeconds();
+            std::unique_ptr<simCore::AntennaPattern> reload(simCore::loadPatternFile(bc.source, bc.freqMHz));
+            loadSeconds = std::min(loadSeconds, nowSeconds() - start);
+        }
+        std::ostringstream memory;
+        memory << ", \"heap_bytes\": " << heapBytes << ", \"resident_bytes\": "
+            << ((residentBefore >= 0 && residentAfter >= 0) ? residentAfter - residentBefore : -1);
+        results.push_back(BenchmarkResult{ "load/" + bc.name, 5, loadSeconds * 1e9, memory.str() });
+
+        // gain(): 固定的伪随机方向集合, 覆盖整个球面
+        simCore::AntennaGainParameters params;
+        params.hbw_ = static_cast<float>(3.0 * simCore::DEG2RAD);
+        params.vbw_ = static_cast<float>(5.0 * simCore::DEG2RAD);
+        params.refGain_ = 30.f;
+        params.freq_ = bc.freqMHz * 1e6;
+        params.polarity_ = simCore::POLARITY_HORIZONTAL;
+        const size_t numDirections = 4096;
+        std::vector<float> azim(numDirections), elev(numDirections);
+        unsigned int seed = 12345;
+        for (size_t i = 0; i < numDirections; ++i)
+        {
+            seed = seed * 1103515245u + 12345u;
+            azim[i] = static_cast<float>((((seed >> 8) & 0xffff) / 65535.0 * 2.0 - 1.0) * M_PI);
+            seed = seed * 1103515245u + 12345u;
+            elev[i] = static_cast<float>((((seed >> 8) & 0xffff) / 65535.0 - 0.5) * M_PI);
+        }
+        size_t next = 0;
+        volatile float sink = 0.f;
+        long long iterations = 0;
+        double ns = timeOp([&]() {
+            params.azim_ = azim[next];
+            params.elev_ = elev[next];
+            next = (next + 1) % numDirections;
+            sink = sink + pattern->gain(params);
+        }, iterations);
+        results.push_back(BenchmarkResult{ "gain/" + bc.name, iterations, ns, "" });
+
+        // 绑定频率后的 gain(): 频率相关的计算只在绑定时进行一次
+        const std::unique_ptr<simCore::AntennaPatternEvaluator> evaluator = pattern->bindFrequency(params.freq_);
+        ns = timeOp([&]() {
+            params.azim_ = azim[next];
+            params.elev_ = elev[next];
+            next = (next + 1) % numDirections;
+            sink = sink + evaluator->gain(params);
+        }, iterations);
+        results.push_back(BenchmarkResult{ "gain_bound/" + bc.name, iterations, ns, "" });
+
+        // minMaxGain(): 固定参数 (可命中缓存) 与逐次变化的波束宽度 (捷变波束)
+        float minGain = 0.f, maxGain = 0.f;
+        ns = timeOp([&]() {
+            pattern->minMaxGain(&minGain, &maxGain, params);
+            sink = sink + maxGain;
+        }, iterations);
+        results.push_back(BenchmarkResult{ "minMaxGain/" + bc.name, iterations, ns, "" });
+
+        int dwell = 0;
+        const float baseHbw = params.hbw_;
+        ns = timeOp([&]() {
+            params.hbw_ = baseHbw * (1.f + 0.001f * static_cast<float>(++dwell));
+            pattern->minMaxGain(&minGain, &maxGain, params);
+            sink = sink + maxGain;
+        }, iterations, 0.5);
+        results.push_back(BenchmarkResult{ "minMaxGain_agile/" + bc.name, iterations, ns, "" });
+        params.hbw_ = baseHbw;
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::string jsonFile = (argc > 1) ? argv[1] : "";
+    const std::string prefix = (argc > 2) ? argv[2] : "bench_";
+
+    const BenchmarkCase cases[] = {
+        { "PEDESTAL", simCore::ANTENNA_STRING_ALGORITHM_PEDESTAL, nullptr, 1000.f },
+        { "GAUSS", simCore::ANTENNA_STRING_ALGORITHM_GAUSS, nullptr, 1000.f },
+        { "CSCSQ", simCore::ANTENNA_STRING_ALGORITHM_CSCSQ, nullptr, 1000.f },
+        { "SINXX", simCore::ANTENNA_STRING_ALGORITHM_SINXX, nullptr, 1000.f },
+        { "OMNI", simCore::ANTENNA_STRING_ALGORITHM_OMNI, nullptr, 1000.f },
+        { "TABLE", prefix + "table" + simCore::ANTENNA_STRING_EXTENSION_TABLE, writeTable, 1000.f },
+        { "MONOPULSE", prefix + "monopulse" + simCore::ANTENNA_STRING_EXTENSION_MONOPULSE, writeMonopulse, 2000.f },
+        { "CRUISE", prefix + "cruise" + simCore::ANTENNA_STRING_EXTENSION_CRUISE, writeCruise, 10000.f },
+        { "RELATIVE", prefix + "relative" + simCore::ANTENNA_STRING_EXTENSION_RELATIVE, writeRelative, 1000.f },
+        { "BILINEAR", prefix + "bilinear" + simCore::ANTENNA_STRING_EXTENSION_BILINEAR, writeBilinear, 2000.f },
+        { "NSMA", prefix + "nsma" + simCore::ANTENNA_STRING_EXTENSION_NSMA, writeNsma, 2450.f },
+        { "EZNEC", prefix + "eznec" + simCore::ANTENNA_STRING_EXTENSION_EZNEC, writeEznec, 300.f },
+        { "XFDTD", prefix + "xfdtd" + simCore::ANTENNA_STRING_EXTENSION_XFDTD, writeXfdtd, 1000.f },
+    };
+
+    std::vector<BenchmarkResult> results;
+    for (const BenchmarkCase& bc : cases)
+    {
+        if (bc.generator)
+            bc.generator(bc.source);
+        std::cerr << "测试 " << bc.name << " ...\n";
+        // 生成的数据文件必须能加载, 否则报告中会悄悄缺少该类型的结果
+        if (!benchmarkPattern(bc, results))
+            return 1;
+    }
+
+    // 控制台摘要
+    std::cerr << "\n" << std::left << std::setw(32) << "名称" << std::right << std::setw(16) << "ns/次" << std::setw(14) << "次数" << "\n";
+    for (const BenchmarkResult& result : results)
+    {
+        std::cerr << std::left << std::setw(32) << result.name << std::right << std::setw(16) << std::fixed << std::setprecision(1)
+            << result.nsPerIteration << std::setw(14) << result.iterations << "\n";
+    }
+
+    // JSON 输出
+    std::ostringstream json;
+    char date[32] = { 0 };
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    json << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n    \"executable\": \"" << jsonEscape(argv[0]) << "\"\n  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult& result = results[i];
+        json << "    { \"name\": \"" << jsonEscape(result.name) << "\", \"iterations\": " << result.iterations
+            << ", \"real_time\": " << std::fixed << std::setprecision(1) << result.nsPerIteration << ", \"time_unit\": \"ns\"" << result.extra
+            << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n}\n";
+
+    if (jsonFile.empty())
+    {
+        std::cout << json.str();
+    }
+    else
+    {
+        std::ofstream out(jsonFile.c_str());
+        out << json.str();
+        if (!out)
+        {
+            std::cerr << "无法写入 " << jsonFile << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,831 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "simCore/EM/AntennaPattern.h"
+#include "simCore/EM/AntennaPatternBounds.h"
+#include "simCore/EM/AntennaPatternCompiled.h"
+#include "simCore/EM/AntennaPatternRegistry.h"
+#include "simCore/EM/AntennaPatternShared.h"
+#include "simCore/EM/AntennaPatternWatch.h"
+#include "simCore/Calc/Angle.h"
+
+/**
+ * 回归测试：加载、缓存与共享路径中对正确性敏感的行为
+ *
+ * 用法: antenna_pattern_tests [数据文件前缀]
+ *   - 在数据文件前缀处 (默认当前目录下的 "test_") 生成小型数据文件
+ *   - 每个失败的检查输出一行, 有失败时返回非零值
+ */
+
+namespace
+{
+    int g_checks = 0;
+    int g_failures = 0;
+
+    // 记录一次检查, 失败时输出位置与表达式
+    void check(bool ok, const char* expression, const char* file, int line)
+    {
+        ++g_checks;
+        if (ok)
+            return;
+        ++g_failures;
+        std::cerr << file << ":" << line << ": 检查失败: " << expression << "\n";
+    }
+
+#define CHECK(expression) check((expression) ? true : false, #expression, __FILE__, __LINE__)
+
+    // 合成方向图增益 (dB), 同性能基准
+    double synthGain(double angleDeg, double beamWidthDeg, double floorDb = -40.0)
+    {
+        const double mainLobe = -12.0 * (angleDeg / beamWidthDeg) * (angleDeg / beamWidthDeg);
+        return std::max(mainLobe, floorDb + 5.0 * std::sin(angleDeg / 7.0));
+    }
+
+    void writeTable(const std::string& filename, double beamWidthDeg = 3.0)
+    {
+        std::ofstream out(filename.c_str());
+        // 类型 0 (角度), 对称性 2, 1 度分辨率
+        out << "0 2\n" << 181 << "\n";
+        for (int i = 0; i <= 180; ++i)
+            out << i << " " << synthGain(i, beamWidthDeg) << "\n";
+        out << 91 << "\n";
+        for (int i = 0; i <= 90; ++i)
+            out << i << " " << synthGain(i, 5.0) << "\n";
+    }
+
+    float gainAt(const simCore::AntennaPattern& pattern, double azimDeg, double elevDeg, double freqHz = 0.0)
+    {
+        simCore::AntennaGainParameters params;
+        params.azim_ = static_cast<float>(azimDeg * simCore::DEG2RAD);
+        params.elev_ = static_cast<float>(elevDeg * simCore::DEG2RAD);
+        params.refGain_ = 0.f;
+        params.freq_ = freqHz;
+        return pattern.gain(params);
+    }
+
+    float radians(double angleDeg)
+    {
+        return static_cast<float>(angleDeg * simCore::DEG2RAD);
+    }
+
+    void writeText(const std::string& filename, const std::string& text)
+    {
+        std::ofstream out(filename.c_str(), std::ios::binary);
+        out << text;
+    }
+
+    // -----------------------------------------------------------------------
+
+    // 逐点设置与 writeTable() 相同的数据
+    void setTableData(simCore::AntennaPatternTable& table)
+    {
+        for (int i = 0; i <= 180; ++i)
+        {
+            const float gain = static_cast<float>(synthGain(i, 3.0));
+            table.setAzimData(static_cast<float>(i * simCore::DEG2RAD), gain);
+            table.setAzimData(static_cast<float>(-i * simCore::DEG2RAD), gain);
+        }
+        for (int i = 0; i <= 90; ++i)
+        {
+            const float gain = static_cast<float>(synthGain(i, 5.0));
+            table.setElevData(static_cast<float>(i * simCore::DEG2RAD), gain);
+            table.setElevData(static_cast<float>(-i * simCore::DEG2RAD), gain);
+        }
+    }
+
+    void testTableSetters(const std::string& prefix)
+    {
+        const std::string table = prefix + "setters" + simCore::ANTENNA_STRING_EXTENSION_TABLE;
+        writeTable(table);
+        simCore::AntennaPatternTable reference;
+        CHECK(reference.readPat(table) == 0);
+
+        // 无效时设置的数据在 setValid(true) 时编译一次; 先标记有效再设置 (FCT 加载器的顺序) 时每次设置后重新编译.
+        // 两种顺序的结果都与读取文件相同 (文件中的增益只保留 6 位有效数字)
+        simCore::AntennaPatternTable built;
+        setTableData(built);
+        built.setValid(true);
+        simCore::AntennaPatternTable validFirst;
+        validFirst.setValid(true);
+        setTableData(validFirst);
+        const double angles[] = { 0.0, 0.5, 2.0, -7.25, 45.0, 179.5, -180.0 };
+        for (double azim : angles)
+        {
+            for (double elev : angles)
+            {
+                if (std::fabs(elev) > 90.0)
+                    continue;
+                CHECK(std::fabs(gainAt(built, azim, elev) - gainAt(reference, azim, elev)) < 1e-3);
+                CHECK(std::fabs(gainAt(validFirst, azim, elev) - gainAt(reference, azim, elev)) < 1e-3);
+            }
+        }
+        float minGain = 0.f;
+        float maxGain = 0.f;
+        float refMin = 0.f;
+        float refMax = 0.f;
+        simCore::AntennaGainParameters params;
+        validFirst.minMaxGain(&minGain, &maxGain, params);
+        reference.minMaxGain(&refMin, &refMax, params);
+        CHECK(std::fabs(minGain - refMin) < 1e-3 && std::fabs(maxGain - refMax) < 1e-3);
+
+        // 有效方向图的修改立即影响查询
+        const float before = gainAt(built, 0.0, 0.0);
+        built.setAzimData(0.f, 10.f);
+        CHECK(gainAt(built, 0.0, 0.0) != before);
+    }
+
+    // 方位与仰角点数不同的 EZNEC 文件内容, 行列顺序错误时增益会错位
+    std::string eznecText()
+    {
+        std::ostringstream out;
+        out << "EZNEC+ ver. 5.0\n\nFrequency = 300 MHz\nReference = 2.15 dBi\n";
+        for (int e = 0; e <= 10; ++e)
+        {
+            out << "Azimuth Pattern  Elevation Angle = " << e << " deg.\nDeg V dB H dB Tot dB\n";
+            for (int a = 0; a <= 36; ++a)
+                out << a * 10 << " " << synthGain(a * 10 - 180.0, 40.0) + synthGain(e, 30.0) << " " << -a - e << " " << a - 2 * e << "\n";
+        }
+        return out.str();
+    }
+
+    void writeEznec(const std::string& filename)
+    {
+        writeText(filename, eznecText());
+    }
+
+    void writeXfdtd(const std::string& filename)
+    {
+        std::ofstream out(filename.c_str());
+        // 2 度分辨率, 每个 theta 的 phi 行对应 [0, 360)
+        out << "begin_<parameters>\nformat free\nphi_min 0\nphi_max 360\nphi_inc 2\ntheta_min 0\ntheta_max 180\ntheta_inc 2\n"
+            "complex\nmag_phase\npattern gain\nmagnitude dB\nmaximum_gain 3\nphase degrees\ndirection degrees\n"
+            "polarization theta_phi\nend_<parameters>\n";
+        for (int th = 0; th <= 180; th += 2)
+        {
+            for (int ph = 0; ph < 360; ph += 2)
+                out << th << " " << ph << " " << synthGain(ph - 180.0, 40.0) + synthGain(th - 90.0, 30.0) << " "
+                    << synthGain(ph - 180.0, 60.0) - 6.0 << " 0 0\n";
+        }
+    }
+
+    void writeCruise(const std::string& filename)
+    {
+        std::ofstream out(filename.c_str());
+        // 2 个频率, 方位 10 度, 仰角 10 度, 电压增益
+        out << "37 2\n-180.0 10.0\n8.0 9.0\n";
+        for (int k = 0; k < 2; ++k)
+        {
+            for (int i = 0; i <= 36; ++i)
+                out << std::pow(10.0, synthGain(-180.0 + 10 * i, 30.0 + 10 * k) / 20.0) << (i < 36 ? " " : "\n");
+        }
+        out << "19 2\n-90.0 10.0\n8.0 9.0\n";
+        for (int k = 0; k < 2; ++k)
+        {
+            for (int i = 0; i <= 18; ++i)
+                out << std::pow(10.0, synthGain(-90.0 + 10 * i, 20.0 + 10 * k) / 20.0) << (i < 18 ? " " : "\n");
+        }
+    }
+
+    void writeBilinear(const std::string& filename)
+    {
+        std::ofstream out(filename.c_str());
+        out << "bilinear\n1e9 2e9 1e9\n-180 180 10\n-90 90 15\n";
+        for (int f = 0; f < 2; ++f)
+        {
+            for (int a = -180; a <= 180; a += 10)
+            {
+                for (int e = -90; e <= 90; e += 15)
+                    out << synthGain(a, 30.0 - 10 * f) + synthGain(e, 20.0) << "\n";
+            }
+        }
+    }
+
+    void writeMonopulse(const std::string& filename)
+    {
+        std::ofstream out(filename.c_str());
+        const char* names[] = { "sum", "diff" };
+        for (int c = 0; c < 2; ++c)
+        {
+            out << names[c] << "\n1e9 1e9 1e9\n-90 90 10\n-45 45 15\n";
+            for (int a = -90; a <= 90; a += 10)
+            {
+                for (int e = -45; e <= 45; e += 15)
+                    out << synthGain(a + 10 * c, 30.0) + synthGain(e, 20.0) << " " << (a + e) % 90 << "\n";
+            }
+        }
+    }
+
+    // 改写已编译文件头中的一个 32 位字段
+    void patchHeader(const std::string& filename, std::streamoff offset, uint32_t value)
+    {
+        std::fstream file(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void testCompiledGrids(const std::string& prefix)
+    {
+        // 二维查找表与 CRUISE 增益在映射中原地使用, 增益与原始文件加载的方向图相同
+        const std::string sources[] = {
+            prefix + "compiled" + simCore::ANTENNA_STRING_EXTENSION_EZNEC,
+            prefix + "compiled" + simCore::ANTENNA_STRING_EXTENSION_CRUISE,
+            prefix + "compiled" + simCore::ANTENNA_STRING_EXTENSION_BILINEAR,
+            prefix + "compiled" + simCore::ANTENNA_STRING_EXTENSION_MONOPULSE
+        };
+        writeEznec(sources[0]);
+        writeCruise(sources[1]);
+        writeBilinear(sources[2]);
+        writeMonopulse(sources[3]);
+        const double freqs[] = { 8.5e9, 8.5e9, 2e9, 1e9 };
+        const double angles[][2] = { { 0.0, 0.0 }, { 12.5, 3.25 }, { -47.0, 8.0 }, { 85.0, -40.0 }, { 175.0, 9.5 } };
+        for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); ++i)
+        {
+            const std::unique_ptr<simCore::AntennaPattern> source(simCore::loadPatternFile(sources[i], static_cast<float>(freqs[i] * 1e-6)));
+            CHECK(source && source->valid());
+            if (!source)
+                continue;
+            const std::string compiled = sources[i] + simCore::ANTENNA_STRING_EXTENSION_COMPILED;
+            CHECK(simCore::writeCompiledPattern(*source, compiled) == 0);
+            const std::unique_ptr<simCore::AntennaPattern> loaded(simCore::loadCompiledPattern(compiled));
+            CHECK(loaded && loaded->valid());
+            if (!loaded)
+                continue;
+            for (const auto& angle : angles)
+                CHECK(gainAt(*loaded, angle[0], angle[1], freqs[i]) == gainAt(*source, angle[0], angle[1], freqs[i]));
+        }
+
+        // 字节序或格式版本不同的文件被拒绝, 不按当前布局解释
+        const std::string compiled = sources[0] + simCore::ANTENNA_STRING_EXTENSION_COMPILED;
+        patchHeader(compiled, 12, simCore::COMPILED_PATTERN_VERSION - 1);
+        CHECK(simCore::loadCompiledPattern(compiled) == nullptr);
+        patchHeader(compiled, 12, simCore::COMPILED_PATTERN_VERSION + 1);
+        CHECK(simCore::loadCompiledPattern(compiled) == nullptr);
+        patchHeader(compiled, 12, simCore::COMPILED_PATTERN_VERSION);
+        const std::unique_ptr<simCore::AntennaPattern> restored(simCore::loadCompiledPattern(compiled));
+        CHECK(restored != nullptr);
+        patchHeader(compiled, 8, 0x04030201);
+        CHECK(simCore::loadCompiledPattern(compiled) == nullptr);
+    }
+
+    void testStreamingReader(const std::string& prefix)
+    {
+        // 数据段就地解析: CRLF 行尾与缺少最后的换行不改变结果
+        const std::string text = eznecText();
+        const std::string lf = prefix + "stream_lf" + simCore::ANTENNA_STRING_EXTENSION_EZNEC;
+        const std::string crlf = prefix + "stream_crlf" + simCore::ANTENNA_STRING_EXTENSION_EZNEC;
+        const std::string unterminated = prefix + "stream_unterminated" + simCore::ANTENNA_STRING_EXTENSION_EZNEC;
+        const std::string longLine = prefix + "stream_long" + simCore::ANTENNA_STRING_EXTENSION_EZNEC;
+        writeText(lf, text);
+        std::string crlfText;
+        for (char c : text)
+            crlfText += (c == '\n') ? std::string("\r\n") : std::string(1, c);
+        writeText(crlf, crlfText);
+        // 最后一行 (最后一个方位) 没有换行时仍被读取
+        writeText(unterminated, text.substr(0, text.size() - 1));
+
+        const std::unique_ptr<simCore::AntennaPattern> reference(simCore::loadPatternFile(lf, 300.f));
+        const std::unique_ptr<simCore::AntennaPattern> fromCrlf(simCore::loadPatternFile(crlf, 300.f));
+        const std::unique_ptr<simCore::AntennaPattern> fromUnterminated(simCore::loadPatternFile(unterminated, 300.f));
+        CHECK(reference && reference->valid());
+        CHECK(fromCrlf && fromCrlf->valid());
+        CHECK(fromUnterminated && fromUnterminated->valid());
+        if (!reference || !fromCrlf || !fromUnterminated)
+            return;
+        const double angles[][2] = { { 0.0, 0.0 }, { 45.0, 3.5 }, { 355.0, 10.0 }, { 360.0, 10.0 }, { 180.0, 7.0 } };
+        for (const auto& angle : angles)
+        {
+            CHECK(gainAt(*fromCrlf, angle[0], angle[1]) == gainAt(*reference, angle[0], angle[1]));
+            CHECK(gainAt(*fromUnterminated, angle[0], angle[1]) == gainAt(*reference, angle[0], angle[1]));
+        }
+
+        // 超过缓冲区的行使加载失败, 而不是被截断后当作数据
+        const size_t dataStart = text.find("Tot dB\n") + 7;
+        writeText(longLine, text.substr(0, dataStart) + std::string(70000, ' ') + "0\n" + text.substr(dataStart));
+        const std::unique_ptr<simCore::AntennaPattern> fromLong(simCore::loadPatternFile(longLine, 300.f));
+        CHECK(!fromLong || !fromLong->valid());
+    }
+
+    void testLazyLoading(const std::string& prefix)
+    {
+        const std::string table = prefix + "lazy" + simCore::ANTENNA_STRING_EXTENSION_TABLE;
+        const std::string broken = prefix + "lazy_broken" + simCore::ANTENNA_STRING_EXTENSION_TABLE;
+        writeTable(table);
+        writeText(broken, "not a table\n");
+        const std::unique_ptr<simCore::AntennaPattern> reference(simCore::loadPatternFile(table, 1000.f));
+        CHECK(reference && reference->valid());
+
+        // 构造时不解析文件; 多个线程同时首次查询时只加载一次, 全部得到加载后的增益
+        simCore::AntennaPatternLazy lazy(table, 1000.f);
+        CHECK(lazy.valid() && !lazy.loaded());
+        const int numThreads = 8;
+        std::vector<float> gains(numThreads);
+        std::vector<const simCore::AntennaPattern*> loaded(numThreads);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i)
+            threads.push_back(std::thread([&, i]() { gains[i] = gainAt(lazy, 2.0, 1.0); loaded[i] = lazy.pattern(); }));
+        for (std::thread& thread : threads)
+            thread.join();
+        CHECK(lazy.loaded());
+        for (int i = 0; i < numThreads; ++i)
+        {
+            CHECK(loaded[i] != nullptr && loaded[i] == loaded[0]);
+            CHECK(reference && gains[i] == gainAt(*reference, 2.0, 1.0));
+        }
+
+        // 无法解析的文件在首次使用时失败一次, 之后的查询不再重新解析
+        simCore::AntennaPatternLazy failing(broken, 1000.f);
+        CHECK(failing.valid() && !failing.loaded());
+        CHECK(gainAt(failing, 2.0, 1.0) == simCore::SMALL_DB_VAL);
+        CHECK(failing.loaded() && failing.pattern() == nullptr);
+        writeTable(broken);
+        CHECK(failing.pattern() == nullptr);
+
+        // 不存在的文件在构造时即无效
+        simCore::AntennaPatternLazy missing(prefix + "lazy_missing" + simCore::ANTENNA_STRING_EXTENSION_TABLE, 1000.f);
+        CHECK(!missing.valid() && missing.pattern() == nullptr);
+    }
+
+    void testWatchedReload(const std::string& prefix)
+    {
+        const std::string table = prefix + "watched" + simCore::ANTENNA_STRING_EXTENSION_TABLE;
+        writeTable(table, 3.0);
+        const std::unique_ptr<simCore::AntennaPattern> narrow(simCore::loadPatternFile(table, 1000.f));
+        writeTable(table, 6.0);
+        const std::unique_ptr<simCore::AntennaPattern> wide(simCore::loadPatternFile(table, 1000.f));
+        CHECK(narrow && wide);
+        if (!narrow || !wide)
+            return;
+        const float narrowGain = gainAt(*narrow, 2.0, 1.0);
+        const float wideGain = gainAt(*wide, 2.0, 1.0);
+        CHECK(narrowGain != wideGain);
+
+        writeTable(table, 3.0);
+        simCore::AntennaPatternWatched watched(table, 1000.f);
+        CHECK(watched.valid() && watched.version() == 1);
+        const std::shared_ptr<const simCore::AntennaPattern> first = watched.current();
+
+        // 查询与反复的重新加载并发: 每次查询得到某个完整版本的增益, 旧版本在读者离开后才释放
+        std::atomic<bool> stop(false);
+        std::atomic<int> mismatches(0);
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; ++i)
+        {
+            readers.push_back(std::thread([&]() {
+                while (!stop.load())
+                {
+                    const float gain = gainAt(watched, 2.0, 1.0);
+                    if (gain != narrowGain && gain != wideGain)
+                        ++mismatches;
+                }
+            }));
+        }
+        const int numReloads = 20;
+        for (int i = 0; i < numReloads; ++i)
+        {
+            writeTable(table, (i % 2 == 0) ? 6.0 : 3.0);
+            CHECK(watched.reload() == 0);
+        }
+        stop = true;
+        for (std::thread& reader : readers)
+            reader.join();
+        CHECK(mismatches == 0);
+        CHECK(watched.version() == 1 + numReloads);
+        CHECK(gainAt(watched, 2.0, 1.0) == narrowGain);
+        // 持有的版本不随重新加载改变
+        CHECK(first && gainAt(*first, 2.0, 1.0) == narrowGain && first != watched.current());
+
+        // 解析失败的文件保留当前版本
+        writeText(table, "not a table\n");
+        CHECK(watched.reload() != 0);
+        CHECK(watched.version() == 1 + numReloads && gainAt(watched, 2.0, 1.0) == narrowGain);
+
+        // 监视器在文件修改后重新加载
+        writeTable(table, 3.0);
+        simCore::AntennaPatternWatcher watcher;
+        const std::shared_ptr<simCore::AntennaPatternWatched> polled = watcher.watch(table, 1000.f);
+        CHECK(polled && watcher.watch(table, 1000.f) == polled);
+        CHECK(watcher.poll() == 0);
+        writeTable(table, 6.0);
+        std::error_code ec;
+        std::filesystem::last_write_time(table, std::filesystem::last_write_time(table, ec) + std::chrono::seconds(10), ec);
+        CHECK(watcher.poll() == 1);
+        CHECK(polled && polled->version() == 2 && gainAt(*polled, 2.0, 1.0) == wideGain);
+    }
+
+    void testRegistry(const std::string& prefix)
+    {
+        const std::string table = prefix + "registry" + simCore::ANTENNA_STRING_EXTENSION_TABLE;
+        const std::string broken = prefix + "registry_broken" + simCore::ANTENNA_STRING_EXTENSION_TABLE;
+        writeTable(table);
+        writeText(broken, "not a table\n");
+
+        simCore::AntennaPatternRegistry registry;
+
+        // 重复的请求共享一次加载
+        std::vector<std::pair<std::string, float> > requests;
+        requests.push_back(std::make_pair(table, 1000.f));
+        requests.push_back(std::make_pair(table, 2000.f));
+        requests.push_back(std::make_pair(std::string(), 1000.f));
+        requests.push_back(std::make_pair(prefix + "registry_missing" + simCore::ANTENNA_STRING_EXTENSION_TABLE, 1000.f));
+        requests.push_back(std::make_pair(broken, 1000.f));
+        requests.push_back(std::make_pair(simCore::ANTENNA_STRING_ALGORITHM_GAUSS, 1000.f));
+        std::vector<simCore::AntennaPatternLoadResult> results;
+        CHECK(registry.load(requests, results, 4) == 3);
+        CHECK(results.size() == requests.size());
+        CHECK(results[0].status_ == simCore::ANTENNA_LOAD_OK && results[0].pattern_);
+        CHECK(results[1].pattern_ == results[0].pattern_);
+        CHECK(registry.size() == 1);
+        CHECK(results[0].shared_ != results[1].shared_);
+        CHECK(results[2].status_ == simCore::ANTENNA_LOAD_NO_NAME);
+        CHECK(results[3].status_ == simCore::ANTENNA_LOAD_NOT_FOUND && !results[3].pattern_);
+        CHECK(results[4].status_ == simCore::ANTENNA_LOAD_FAILED && !results[4].pattern_);
+        CHECK(results[5].pattern_ == simCore::algorithmPattern("gauss"));
+        CHECK(registry.pattern(table, 1000.f) == results[0].pattern_);
+
+        // 失败的加载不缓存: 修改时间不变时修复后的文件也会重新加载
+        std::error_code ec;
+        const std::filesystem::file_time_type modified = std::filesystem::last_write_time(broken, ec);
+        CHECK(!ec);
+        writeTable(broken);
+        std::filesystem::last_write_time(broken, modified, ec);
+        CHECK(!ec);
+        const std::shared_ptr<const simCore::AntennaPattern> repaired = registry.pattern(broken, 1000.f);
+        CHECK(repaired && repaired->valid());
+
+        // 修改过的文件重新加载, 旧实例由持有者保留
+        const std::shared_ptr<const simCore::AntennaPattern> before = registry.pattern(table, 1000.f);
+        writeTable(table, 6.0);
+        std::filesystem::last_write_time(table, modified + std::chrono::seconds(10), ec);
+        const std::shared_ptr<const simCore::AntennaPattern> after = registry.pattern(table, 1000.f);
+        CHECK(after && after != before);
+
+        // 延迟解析与立即加载分别缓存, 修改设置后不返回另一种方式加载的实例
+        registry.setLazyLoading(true);
+        const std::shared_ptr<const simCore::AntennaPattern> lazy = registry.pattern(table, 1000.f);
+        CHECK(dynamic_cast<const simCore::AntennaPatternLazy*>(lazy.get()) != nullptr);
+        registry.setLazyLoading(false);
+        CHECK(registry.pattern(table, 1000.f) == after);
+
+        // 并发上限为 1 时多线程加载仍全部完成
+        registry.clear();
+        registry.setMaxConcurrentLoads(1);
+        CHECK(registry.load(requests, results, 8) == 2);
+        CHECK(results[4].status_ == simCore::ANTENNA_LOAD_OK);
+    }
+
+    void testSharedStore(const std::string& prefix)
+    {
+        const std::string table = prefix + "shared" + simCore::ANTENNA_STRING_EXTENSION_TABLE;
+        writeTable(table);
+        // 每次运行使用独立的段名前缀, 不受之前中断的运行留下的段影响
+        const std::string storePrefix = "simapt" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count() % 1000000);
+
+        // 多个存储 (模拟多个进程) 同时请求: 一个发布, 其他等待后映射同一个段
+        const int numStores = 4;
+        std::vector<std::unique_ptr<simCore::AntennaPatternSharedStore> > stores;
+        for (int i = 0; i < numStores; ++i)
+            stores.push_back(std::unique_ptr<simCore::AntennaPatternSharedStore>(new simCore::AntennaPatternSharedStore(storePrefix)));
+        std::vector<std::shared_ptr<const simCore::AntennaPattern> > patterns(numStores);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numStores; ++i)
+            threads.push_back(std::thread([&, i]() { patterns[i] = stores[i]->pattern(table, 1000.f); }));
+        for (std::thread& thread : threads)
+            thread.join();
+        const std::unique_ptr<simCore::AntennaPattern> reference(simCore::loadPatternFile(table, 1000.f));
+        CHECK(reference && reference->valid());
+        for (int i = 0; i < numStores; ++i)
+        {
+            CHECK(patterns[i] && patterns[i]->valid());
+            CHECK(patterns[i] && reference && gainAt(*patterns[i], 2.0, 1.0) == gainAt(*reference, 2.0, 1.0));
+        }
+        simCore::SharedMemorySegment segment;
+        CHECK(segment.open(stores[0]->segmentName(table, 1000.f)) == 0);
+        segment.close();
+        CHECK(stores[0]->pattern(table, 1000.f) == patterns[0]);
+
+#ifndef WIN32
+        // 发布者在构建段时退出, 留下未就绪的段: 下一次请求删除它并重新发布, 不等待超时
+        const std::string name = stores[0]->segmentName(table, 1000.f);
+        CHECK(stores[0]->remove(table, 1000.f) == 0);
+        CHECK(segment.create(name, 4096) == 0);
+        segment.close();
+        simCore::AntennaPatternSharedStore recovering(storePrefix);
+        recovering.setAttachTimeout(5000);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const std::shared_ptr<const simCore::AntennaPattern> recovered = recovering.pattern(table, 1000.f);
+        CHECK(recovered && recovered->valid());
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(2500));
+        simCore::AntennaPatternSharedStore attaching(storePrefix);
+        CHECK(attaching.pattern(table, 1000.f) != nullptr);
+
+        // 占用标记的创建者在写入前退出: 等待的请求接管占用并发布, 不等待超时
+        CHECK(stores[0]->remove(table, 1000.f) == 0);
+        simCore::SharedMemorySegment claim;
+        CHECK(claim.create(name + "_b", 64) == 0);
+        claim.close();
+        simCore::AntennaPatternSharedStore waiting(storePrefix);
+        waiting.setAttachTimeout(5000);
+        const std::chrono::steady_clock::time_point claimStart = std::chrono::steady_clock::now();
+        const std::shared_ptr<const simCore::AntennaPattern> published = waiting.pattern(table, 1000.f);
+        CHECK(published && published->valid());
+        CHECK(std::chrono::steady_clock::now() - claimStart < std::chrono::milliseconds(2500));
+        CHECK(claim.open(name + "_b") != 0);
+
+        // 另一个文件的段名与其冲突: 段中记录的标识不同, 改为私有加载, 不使用另一个文件的方向图, 也不替换其段
+        const std::string other = prefix + "shared_other" + simCore::ANTENNA_STRING_EXTENSION_TABLE;
+        writeTable(other, 6.0);
+        const std::string otherName = stores[0]->segmentName(other, 1000.f);
+        simCore::SharedMemorySegment::remove(otherName);
+        simCore::SharedMemorySegment publishedSegment;
+        CHECK(publishedSegment.open(name) == 0);
+        simCore::SharedMemorySegment colliding;
+        CHECK(colliding.create(otherName, publishedSegment.size()) == 0);
+        if (colliding.writableData() && publishedSegment.data())
+            std::copy(publishedSegment.data(), publishedSegment.data() + publishedSegment.size(), colliding.writableData());
+        colliding.close();
+        publishedSegment.close();
+        simCore::AntennaPatternSharedStore collidingStore(storePrefix);
+        const std::shared_ptr<const simCore::AntennaPattern> otherPattern = collidingStore.pattern(other, 1000.f);
+        const std::unique_ptr<simCore::AntennaPattern> otherReference(simCore::loadPatternFile(other, 1000.f));
+        CHECK(otherPattern && otherReference && gainAt(*otherPattern, 2.0, 1.0) == gainAt(*otherReference, 2.0, 1.0));
+        CHECK(otherPattern && reference && gainAt(*otherPattern, 2.0, 1.0) != gainAt(*reference, 2.0, 1.0));
+        CHECK(colliding.open(otherName) == 0);
+        CHECK(publishedSegment.open(name) == 0);
+        CHECK(colliding.size() == publishedSegment.size() &&
+            std::equal(colliding.data(), colliding.data() + colliding.size(), publishedSegment.data()));
+        colliding.close();
+        publishedSegment.close();
+        CHECK(simCore::SharedMemorySegment::remove(otherName) == 0);
+#endif
+        stores[0]->remove(table, 1000.f);
+    }
+
+    void testUpperBounds(const std::string& prefix)
+    {
+        // 扇区上界与分块金字塔上界不低于扇区内任一方向的增益
+        const std::string table = prefix + "bounds" + simCore::ANTENNA_STRING_EXTENSION_TABLE;
+        writeTable(table);
+        const std::unique_ptr<simCore::AntennaPattern> patterns[] = {
+            std::unique_ptr<simCore::AntennaPattern>(simCore::loadPatternFile(table, 0.f)),
+            std::unique_ptr<simCore::AntennaPattern>(new simCore::AntennaPatternGauss)
+        };
+        const simCore::AntennaGainParameters params;
+        for (const auto& pattern : patterns)
+        {
+            CHECK(pattern && pattern->valid());
+            if (!pattern)
+                continue;
+            simCore::AntennaGainBounds bounds;
+            CHECK(bounds.build(*pattern, params) == 0);
+            // 5 度扇区, 扇区内按 0.5 度采样
+            for (int azim = -180; azim < 180; azim += 15)
+            {
+                for (int elev = -90; elev < 90; elev += 15)
+                {
+                    const float sectorBound = pattern->upperBoundGain(radians(azim), radians(azim + 5), radians(elev), radians(elev + 5), params);
+                    bool bounded = true;
+                    for (double a = azim; a <= azim + 5; a += 0.5)
+                    {
+                        for (double e = elev; e <= elev + 5; e += 0.5)
+                        {
+                            const float gain = gainAt(*pattern, a, e);
+                            bounded = bounded && gain <= sectorBound && gain <= bounds.upperBound(radians(a), radians(e));
+                        }
+                    }
+                    CHECK(bounded);
+                }
+            }
+        }
+    }
+
+    void testDownsampling(const std::string& prefix)
+    {
+        // 降采样的 EZNEC/XFDTD 表格更小, 增益 (包括采样点之间) 与原分辨率相差不超过 maxErrorDb_
+        const std::string sources[] = {
+            prefix + "downsample" + simCore::ANTENNA_STRING_EXTENSION_EZNEC,
+            prefix + "downsample" + simCore::ANTENNA_STRING_EXTENSION_XFDTD
+        };
+        writeEznec(sources[0]);
+        writeXfdtd(sources[1]);
+        simCore::AntennaPatternLoadOptions options;
+        options.maxErrorDb_ = 0.5f;
+        for (const std::string& source : sources)
+        {
+            const std::unique_ptr<simCore::AntennaPattern> full(simCore::loadPatternFile(source, 300.f));
+            const std::unique_ptr<simCore::AntennaPattern> reduced(simCore::loadPatternFile(source, 300.f, options));
+            CHECK(full && reduced);
+            if (!full || !reduced)
+                continue;
+            const std::string fullCompiled = source + ".full" + simCore::ANTENNA_STRING_EXTENSION_COMPILED;
+            const std::string reducedCompiled = source + ".reduced" + simCore::ANTENNA_STRING_EXTENSION_COMPILED;
+            CHECK(simCore::writeCompiledPattern(*full, fullCompiled) == 0 && simCore::writeCompiledPattern(*reduced, reducedCompiled) == 0);
+            CHECK(std::filesystem::file_size(reducedCompiled) < std::filesystem::file_size(fullCompiled));
+            float maxError = 0.f;
+            for (double azim = -180.0; azim <= 180.0; azim += 0.7)
+            {
+                for (double elev = -90.0; elev <= 90.0; elev += 0.7)
+                    maxError = std::max(maxError, std::fabs(gainAt(*reduced, azim, elev) - gainAt(*full, azim, elev)));
+            }
+            CHECK(maxError <= options.maxErrorDb_ + 1e-4f);
+        }
+    }
+
+    void testApproxGains()
+    {
+        // gainBatchApprox() 与 gain() 的误差不超过各算法型方向图的说明
+        struct ApproxCase
+        {
+            std::unique_ptr<simCore::AntennaPattern> pattern;
+            float maxErrorDb;   // 说明的最大误差 (dB)
+            float rangeDb;      // 只检查增益不低于参考增益减去此值的方向, 0 为检查全部
+        };
+        const ApproxCase cases[] = {
+            { std::unique_ptr<simCore::AntennaPattern>(new simCore::AntennaPatternGauss), 2e-5f, 0.f },
+            { std::unique_ptr<simCore::AntennaPattern>(new simCore::AntennaPatternCscSq), 0.5f, 0.f },
+            { std::unique_ptr<simCore::AntennaPattern>(new simCore::AntennaPatternSinXX), 0.01f, 40.f },
+            { std::unique_ptr<simCore::AntennaPattern>(new simCore::AntennaPatternPedestal), 0.001f, 0.f }
+        };
+        // 采样步长避开波瓣边界
+        std::vector<float> azim;
+        std::vector<float> elev;
+        for (double a = -180.0; a <= 180.0; a += 0.37)
+        {
+            for (double e = -90.0; e <= 90.0; e += 0.37)
+            {
+                azim.push_back(radians(a));
+                elev.push_back(radians(e));
+            }
+        }
+        simCore::AntennaGainParameters params;
+        params.hbw_ = radians(3.0);
+        params.vbw_ = radians(5.0);
+        params.refGain_ = 10.f;
+        std::vector<float> exact(azim.size());
+        std::vector<float> approx(azim.size());
+        for (const ApproxCase& test : cases)
+        {
+            for (size_t i = 0; i < azim.size(); ++i)
+            {
+                params.azim_ = azim[i];
+                params.elev_ = elev[i];
+                exact[i] = test.pattern->gain(params);
+            }
+            test.pattern->gainBatchApprox(params, azim.data(), elev.data(), azim.size(), approx.data());
+            float maxError = 0.f;
+            for (size_t i = 0; i < exact.size(); ++i)
+            {
+                if (test.rangeDb == 0.f || exact[i] >= params.refGain_ - test.rangeDb)
+                    maxError = std::max(maxError, std::fabs(approx[i] - exact[i]));
+            }
+            CHECK(maxError <= test.maxErrorDb);
+        }
+    }
+
+    void testMinMaxGain(const std::string& prefix)
+    {
+        // 解析计算的 minMaxGain() 与逐度扫描 gain() 的结果一致
+        const std::string table = prefix + "minmax" + simCore::ANTENNA_STRING_EXTENSION_TABLE;
+        writeTable(table);
+        const std::unique_ptr<simCore::AntennaPattern> patterns[] = {
+            std::unique_ptr<simCore::AntennaPattern>(simCore::loadPatternFile(table, 0.f)),
+            std::unique_ptr<simCore::AntennaPattern>(new simCore::AntennaPatternGauss),
+            std::unique_ptr<simCore::AntennaPattern>(new simCore::AntennaPatternCscSq),
+            std::unique_ptr<simCore::AntennaPattern>(new simCore::AntennaPatternPedestal)
+        };
+        simCore::AntennaGainParameters params;
+        params.hbw_ = radians(3.0);
+        params.vbw_ = radians(5.0);
+        params.refGain_ = 10.f;
+        for (const auto& pattern : patterns)
+        {
+            CHECK(pattern && pattern->valid());
+            if (!pattern)
+                continue;
+            float minGain = 0.f;
+            float maxGain = 0.f;
+            pattern->minMaxGain(&minGain, &maxGain, params);
+            float sweepMin = -simCore::SMALL_DB_VAL;
+            float sweepMax = simCore::SMALL_DB_VAL;
+            for (int azim = -180; azim <= 180; ++azim)
+            {
+                for (int elev = -90; elev <= 90; ++elev)
+                {
+                    params.azim_ = radians(azim);
+                    params.elev_ = radians(elev);
+                    const float gain = pattern->gain(params);
+                    if (gain > simCore::SMALL_DB_COMPARE)
+                        sweepMin = std::min(sweepMin, gain);
+                    sweepMax = std::max(sweepMax, gain);
+                }
+            }
+            CHECK(std::fabs(minGain - sweepMin) < 1e-3 && std::fabs(maxGain - sweepMax) < 1e-3);
+        }
+    }
+
+    void testCursorGain(const std::string& prefix)
+    {
+        // 沿航迹移动与跳变的查询中 cursorGain() 与 gain() 完全相同, 同一游标在方向图之间交替使用
+        const std::string sources[] = {
+            prefix + "cursor" + simCore::ANTENNA_STRING_EXTENSION_TABLE,
+            prefix + "cursor" + simCore::ANTENNA_STRING_EXTENSION_CRUISE,
+            prefix + "cursor" + simCore::ANTENNA_STRING_EXTENSION_BILINEAR
+        };
+        writeTable(sources[0]);
+        writeCruise(sources[1]);
+        writeBilinear(sources[2]);
+        const double freqs[][2] = { { 0.0, 0.0 }, { 8.2e9, 8.9e9 }, { 1.2e9, 1.9e9 } };
+        simCore::AntennaLookupCursor cursor;
+        for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); ++i)
+        {
+            const std::unique_ptr<simCore::AntennaPattern> pattern(simCore::loadPatternFile(sources[i], static_cast<float>(freqs[i][0] * 1e-6)));
+            CHECK(pattern && pattern->valid());
+            if (!pattern)
+                continue;
+            simCore::AntennaGainParameters params;
+            bool same = true;
+            for (int step = 0; step < 400; ++step)
+            {
+                // 每步移动 0.3 度, 每 50 步跳到另一处并切换频率
+                params.azim_ = radians(-170.0 + 0.3 * step + 97.0 * (step / 50));
+                params.elev_ = radians(-80.0 + 0.2 * step - 31.0 * (step / 50 % 3));
+                params.freq_ = freqs[i][step / 50 % 2];
+                same = same && pattern->cursorGain(params, cursor) == pattern->gain(params);
+            }
+            CHECK(same);
+        }
+    }
+
+    void testBoundFrequency(const std::string& prefix)
+    {
+        // bindFrequency() 的求值器在频带内外都与该频率的 gain() 完全相同
+        const std::string sources[] = {
+            prefix + "bind" + simCore::ANTENNA_STRING_EXTENSION_CRUISE,
+            prefix + "bind" + simCore::ANTENNA_STRING_EXTENSION_BILINEAR,
+            prefix + "bind" + simCore::ANTENNA_STRING_EXTENSION_MONOPULSE
+        };
+        writeCruise(sources[0]);
+        writeBilinear(sources[1]);
+        writeMonopulse(sources[2]);
+        const double freqs[][3] = { { 8.0e9, 8.6e9, 9.5e9 }, { 1.0e9, 1.4e9, 2.5e9 }, { 1.0e9, 0.5e9, 3.0e9 } };
+        const double angles[][2] = { { 0.0, 0.0 }, { 12.5, 3.25 }, { -47.0, 8.0 }, { 85.0, -40.0 }, { 175.0, 9.5 } };
+        for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); ++i)
+        {
+            const std::unique_ptr<simCore::AntennaPattern> pattern(simCore::loadPatternFile(sources[i], static_cast<float>(freqs[i][0] * 1e-6)));
+            CHECK(pattern && pattern->valid());
+            if (!pattern)
+                continue;
+            for (double freq : freqs[i])
+            {
+                const std::unique_ptr<simCore::AntennaPatternEvaluator> evaluator = pattern->bindFrequency(freq);
+                bool same = true;
+                for (const auto& angle : angles)
+                {
+                    simCore::AntennaGainParameters params;
+                    params.azim_ = radians(angle[0]);
+                    params.elev_ = radians(angle[1]);
+                    params.freq_ = freq;
+                    const float gain = pattern->gain(params);
+                    float batchGain = 0.f;
+                    evaluator->gainBatch(params, &params.azim_, &params.elev_, 1, &batchGain);
+                    // 求值器忽略参数中的频率
+                    params.freq_ = 0.0;
+                    same = same && evaluator->gain(params) == gain && batchGain == gain;
+                }
+                CHECK(same);
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::string prefix = (argc > 1) ? argv[1] : "test_";
+
+    testTableSetters(prefix);
+    testCompiledGrids(prefix);
+    testStreamingReader(prefix);
+    testLazyLoading(prefix);
+    testWatchedReload(prefix);
+    testRegistry(prefix);
+    testSharedStore(prefix);
+    testUpperBounds(prefix);
+    testDownsampling(prefix);
+    testApproxGains();
+    testMinMaxGain(prefix);
+    testCursorGain(prefix);
+    testBoundFrequency(prefix);
+
+    std::cerr << g_checks << " 项检查, " << g_failures << " 项失败\n";
+    return (g_failures == 0) ? 0 : 1;
+}
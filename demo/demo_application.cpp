@@ -5,6 +5,7 @@
 #include <memory>
 #include <iomanip>
 #include "simCore/EM/AntennaPattern.h"
+#include "simCore/EM/AntennaPatternRaster.h"
 #include "simCore/Calc/Angle.h"
 
 /**
@@ -62,30 +63,47 @@ public:
         std::cout << "天线类型: " << simCore::antennaPatternTypeString(antennaPattern_->type()) << std::endl;
     }
     
-    // 计算天线在指定方向的增益
-    double getAntennaGain(double azimuth_deg, double elevation_deg) {
+    // 天线增益计算参数 (方向除外)
+    simCore::AntennaGainParameters gainParams() const {
         simCore::AntennaGainParameters params;
-        params.azim_ = simCore::DEG2RAD * azimuth_deg;
-        params.elev_ = simCore::DEG2RAD * elevation_deg;
         params.refGain_ = static_cast<float>(radarParams_.antennaGain);
         params.freq_ = radarParams_.frequency;
         params.hbw_ = simCore::DEG2RAD * 3.0f;  // 假设3度波束宽度
         params.vbw_ = simCore::DEG2RAD * 5.0f;  // 假设5度波束宽度
+        return params;
+    }
+    
+    // 计算天线在指定方向的增益
+    double getAntennaGain(double azimuth_deg, double elevation_deg) {
+        simCore::AntennaGainParameters params = gainParams();
+        params.azim_ = simCore::DEG2RAD * azimuth_deg;
+        params.elev_ = simCore::DEG2RAD * elevation_deg;
         
         return antennaPattern_->gain(params);
     }
     
+    // 多线程计算整个方位/仰角网格的天线增益, 结果与逐点调用 getAntennaGain 相同
+    bool getGainRaster(const simCore::AntennaRasterSpec& spec, std::vector<float>& gains) {
+        gains.resize(simCore::rasterSize(spec));
+        return simCore::rasterizePattern(*antennaPattern_, gainParams(), spec, gains.data(), gains.size()) == 0;
+    }
+    
     // 计算接收功率 (雷达方程)
     double calculateReceivedPower(const TargetParams& target) {
         // 获取发射和接收方向的天线增益
-        double txGain = getAntennaGain(target.azimuth, target.elevation);
+        return calculateReceivedPower(getAntennaGain(target.azimuth, target.elevation), target.range, target.rcs);
+    }
+    
+    // 按已知天线增益计算接收功率
+    double calculateReceivedPower(double antennaGain, double range, double rcs) {
+        double txGain = antennaGain;
         double rxGain = txGain;  // 对于单站雷达，收发天线相同
         
         // 波长
         double wavelength = LIGHT_SPEED / radarParams_.frequency;
         
         // 雷达方程: Pr = (Pt * Gt * Gr * λ² * σ) / ((4π)³ * R⁴ * L)
-        double range4 = std::pow(target.range, 4);
+        double range4 = std::pow(range, 4);
         double lambda2 = wavelength * wavelength;
         double pi4_cubed = std::pow(4.0 * M_PI, 3);
         
@@ -95,14 +113,18 @@ public:
         double lossesLinear = std::pow(10.0, radarParams_.systemLosses / 10.0);
         
         double receivedPower = (radarParams_.transmitPower * txGainLinear * rxGainLinear * 
-                               lambda2 * target.rcs) / (pi4_cubed * range4 * lossesLinear);
+                               lambda2 * rcs) / (pi4_cubed * range4 * lossesLinear);
         
         return receivedPower;  // 返回线性功率值 (W)
     }
     
     // 计算信噪比
     double calculateSNR(const TargetParams& target) {
-        double receivedPower = calculateReceivedPower(target);
+        return calculateSNR(calculateReceivedPower(target));
+    }
+    
+    // 按接收功率计算信噪比
+    double calculateSNR(double receivedPower) {
         double noisePower = BOLTZMANN_CONSTANT * radarParams_.noiseTemperature * 1e6; // 假设1MHz带宽
         
         return 10.0 * std::log10(receivedPower / noisePower);  // dB
@@ -116,8 +138,11 @@ public:
     
     // 计算最大探测距离
     double calculateMaxRange(double azimuth_deg, double elevation_deg, double rcs) {
-        TargetParams target = {1000.0, azimuth_deg, elevation_deg, rcs}; // 初始距离1km
-        
+        return calculateMaxRangeForGain(getAntennaGain(azimuth_deg, elevation_deg), rcs);
+    }
+    
+    // 按已知天线增益计算最大探测距离, 二分查找时无需重复计算增益
+    double calculateMaxRangeForGain(double antennaGain, double rcs) {
         // 二分查找最大探测距离
         double minRange = 1000.0;    // 1km
         double maxRange = 500000.0;  // 500km
@@ -125,9 +150,8 @@ public:
         
         while (maxRange - minRange > epsilon) {
             double midRange = (minRange + maxRange) / 2.0;
-            target.range = midRange;
             
-            if (isTargetDetectable(target)) {
+            if (calculateSNR(calculateReceivedPower(antennaGain, midRange, rcs)) >= radarParams_.detectionThreshold) {
                 minRange = midRange;
             } else {
                 maxRange = midRange;
@@ -223,20 +247,29 @@ public:
         
         std::cout << "\n=== 生成2D覆盖热力图数据 ===\n";
         
-        int totalPoints = 0;
-        int processedPoints = 0;
-        
-        // 计算总点数
-        for (int azimuth = -180; azimuth <= 180; azimuth += 10) {
-            for (int elevation = -30; elevation <= 90; elevation += 5) {
-                totalPoints++;
-            }
+        // 方位 -180~180 度步长10度, 仰角 -30~90 度步长5度, 一次多线程计算整个网格的增益
+        simCore::AntennaRasterSpec spec;
+        spec.minX_ = simCore::DEG2RAD * -180.0;
+        spec.maxX_ = simCore::DEG2RAD * 180.0;
+        spec.numX_ = 37;
+        spec.minY_ = simCore::DEG2RAD * -30.0;
+        spec.maxY_ = simCore::DEG2RAD * 90.0;
+        spec.numY_ = 25;
+        std::vector<float> gains;
+        if (!calculator_.getGainRaster(spec, gains)) {
+            std::cerr << "增益网格计算失败" << std::endl;
+            return;
         }
         
-        for (int azimuth = -180; azimuth <= 180; azimuth += 10) {
-            for (int elevation = -30; elevation <= 90; elevation += 5) {
-                double antennaGain = calculator_.getAntennaGain(azimuth, elevation);
-                double maxRange = calculator_.calculateMaxRange(azimuth, elevation, rcs);
+        int totalPoints = static_cast<int>(spec.numX_ * spec.numY_);
+        int processedPoints = 0;
+        
+        for (size_t x = 0; x < spec.numX_; ++x) {
+            const int azimuth = -180 + 10 * static_cast<int>(x);
+            for (size_t y = 0; y < spec.numY_; ++y) {
+                const int elevation = -30 + 5 * static_cast<int>(y);
+                double antennaGain = gains[y * spec.numX_ + x];
+                double maxRange = calculator_.calculateMaxRangeForGain(antennaGain, rcs);
                 
                 file << azimuth << ", " << elevation << ", " 
                      << std::fixed << std::setprecision(2) << antennaGain << ", " 